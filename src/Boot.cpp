@@ -104,6 +104,31 @@ static void ParseCommandLineArgs(int argc, char** argv)
 			SDL_strlcpy(gCustomTerrainFile, argv[i], sizeof(gCustomTerrainFile));
 			gSkipToLevel = true;
 		}
+		else if (SDL_strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc)
+		{
+			// Restore this game snapshot when the level starts (F12+F6 saves to it, F12+F7 restores)
+			i++;
+			SDL_strlcpy(gSnapshotFile, argv[i], sizeof(gSnapshotFile));
+			gSkipToLevel = true;
+		}
+		else if (SDL_strcmp(argv[i], "--metrics-socket") == 0 && i + 1 < argc)
+		{
+			// Serve live metrics on this UNIX-domain socket (read with tools/metrics_reader.py)
+			i++;
+			SDL_strlcpy(gMetricsSocketPath, argv[i], sizeof(gMetricsSocketPath));
+		}
+		else if (SDL_strcmp(argv[i], "--overdraw") == 0)
+		{
+			// Show how many times each pixel of the 3D view gets drawn (needs a stencil buffer)
+			gOverdrawMode = true;
+		}
+#if RENDER_VULKAN
+		else if (SDL_strcmp(argv[i], "--vulkan") == 0)
+		{
+			// Also draw the 3D view with Vulkan, offscreen (compare with nanosaur_vulkan_submit_ms)
+			gVulkanMode = true;
+		}
+#endif
 	}
 }
 
@@ -183,6 +208,11 @@ static void Boot(int argc, char** argv)
 	// Load game prefs before starting
 	LoadPrefs();
 
+#ifndef __EMSCRIPTEN__
+	// Decode the boot screens in the background while SDL & OpenGL start up
+	PreloadCharity();
+#endif
+
 retryVideo:
 	// Initialize SDL video subsystem
 	if (!SDL_Init(SDL_INIT_VIDEO))
@@ -201,9 +231,18 @@ retryVideo:
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_COMPATIBILITY);
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 2);
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
+
+	if (gOverdrawMode)
+	{
+		SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, 8);		// the overdraw counter
+	}
 #endif
 
 	gCurrentAntialiasingLevel = gGamePrefs.antialiasingLevel;
+	if (gCurrentAntialiasingLevel == ANTIALIASING_LEVEL_FXAA)		// post-process, no multisample buffer needed
+	{
+		gCurrentAntialiasingLevel = 0;
+	}
 	if (gCurrentAntialiasingLevel != 0)
 	{
 		SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, 1);
@@ -249,6 +288,9 @@ static void Shutdown()
 	// Always restore the user's mouse acceleration before exiting.
 	// SetMacLinearMouse(false);
 
+	ShutdownObjectManager();
+	ShutdownMetrics();
+
 	Pomme::Shutdown();
 
 	if (gSDLWindow)
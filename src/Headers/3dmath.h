@@ -14,6 +14,9 @@ extern	float	CalcAngleBetweenVectors3D(TQ3Vector3D *v1, TQ3Vector3D *v2);
 extern	void CalcPointOnObject(ObjNode *theNode, TQ3Point3D *inPt, TQ3Point3D *outPt);
 extern	void CalcFaceNormal(TQ3Point3D *p1, TQ3Point3D *p2, TQ3Point3D *p3, TQ3Vector3D *normal);
 extern	void SetQuickRotationMatrix_XYZ(TQ3Matrix4x4 *m, float rx, float ry, float rz);
+extern	void SetScaleRotateTranslateMatrix(TQ3Matrix4x4 *m, const TQ3Vector3D *scale, const TQ3Vector3D *rot,
+								const TQ3Point3D *coord, uint32_t rotOrder);
+extern	void MultiplyAffineMatrices(const TQ3Matrix4x4 *a, const TQ3Matrix4x4 *b, TQ3Matrix4x4 *result);
 extern	void CalcPlaneEquationOfTriangle(TQ3PlaneEquation *plane, TQ3Point3D *, TQ3Point3D *, TQ3Point3D *);
 extern	Boolean IntersectionOfLineSegAndPlane(TQ3PlaneEquation *plane, float v1x, float v1y, float v1z,
 								 float v2x, float v2y, float v2z, TQ3Point3D *outPoint);
@@ -6,6 +6,7 @@
 
 
 extern	void LoadBonesReferenceModel(FSSpec	*inSpec, SkeletonDefType *skeleton);
+extern	void DecomposeReferenceModel(SkeletonDefType *skeleton);
 extern	void UpdateSkinnedGeometry(ObjNode *theNode);
 extern	void PrimeBoneData(SkeletonDefType *skeleton);
 
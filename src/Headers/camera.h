@@ -18,4 +18,5 @@ extern	void MoveCamera(ObjNode *theNode);
 extern	void CalcCameraMatrixInfo(QD3DSetupOutputType *);
 extern	void ResetCameraSettings(void);
 Boolean IsFirstPersonSteadyCamera(void);
+void LateLatchCamera(void);
 
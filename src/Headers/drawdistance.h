@@ -0,0 +1,11 @@
+//
+// drawdistance.h
+//
+
+#pragma once
+
+#include "qd3d_support.h"
+
+void InitDrawDistance(QD3DSetupOutputType *setupInfo);
+void ResetDrawDistance(void);
+void UpdateDrawDistance(QD3DSetupOutputType *setupInfo);
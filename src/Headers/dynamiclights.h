@@ -0,0 +1,13 @@
+//
+// dynamiclights.h
+//
+
+#pragma once
+
+#define	MAX_DYNAMIC_LIGHTS				64
+#define	MAX_DYNAMIC_LIGHTS_PER_MESH		(8 - MAX_FILL_LIGHTS)	// GL guarantees 8 lights; the fill lights come first
+
+void AddDynamicLight(const TQ3Point3D* where, const TQ3ColorRGB* color, float radius);
+int DynamicLights_Count(void);
+void DynamicLights_Bind(const TQ3Point3D* center, float radius);
+void DynamicLights_EndFrame(void);
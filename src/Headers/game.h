@@ -28,6 +28,8 @@ extern "C"
 #include "bones.h"
 #include "camera.h"
 #include "collision.h"
+#include "drawdistance.h"
+#include "dynamiclights.h"
 #include "effects.h"
 #include "enemy.h"
 #include "environmentmap.h"
@@ -39,18 +41,22 @@ extern "C"
 #include "items.h"
 #include "main.h"
 #include "mainmenu.h"
+#include "meshlod.h"
+#include "metrics.h"
 #include "misc.h"
 #include "movie.h"
 #include "myguy.h"
 #include "mytraps.h"
 #include "objects.h"
 #include "pickups.h"
+#include "propbatch.h"
 #include "player_control.h"
 #include "qd3d_geometry.h"
 #include "renderer.h"
 #include "skeletonanim.h"
 #include "skeletonjoints.h"
 #include "skeletonobj.h"
+#include "snapshot.h"
 #include "sound2.h"
 #include "structformats.h"
 #include "terrain.h"
@@ -59,6 +65,7 @@ extern "C"
 #include "title.h"
 #include "triggers.h"
 #include "version.h"
+#include "vulkanrenderer.h"
 #include "weapons.h"
 #include "window.h"
 
@@ -77,6 +84,7 @@ extern	Byte					gMyStartAim;
 extern	char					gTextInput[64];
 extern	CollisionRec			gCollisionList[];
 extern	const KeyBinding		kDefaultKeyBindings[NUM_CONTROL_NEEDS];
+extern	float					gAutoFireCounter;
 extern	float					gCameraDistFromMe;
 extern	float					gCameraRotX;
 extern	float					gCameraRotY;
@@ -85,6 +93,7 @@ extern	float					gFadeOverlayOpacity;
 extern	float					gFramesPerSecond;
 extern	float					gFramesPerSecondFrac;
 extern	float					gFuel;
+extern	float					gLavaSmokeCounter;
 extern	float					gMinLavaDist;
 extern	float					gMinSteamDist;
 extern	float					gMostRecentCharacterFloorY;
@@ -92,6 +101,9 @@ extern	float					gMyHealth;
 extern	float					gMyHeightOffGround;
 extern	float					gMySpeedPuffCounter;
 extern	float					gObjectGroupRadiusList[MAX_3DMF_GROUPS][MAX_OBJECTS_IN_GROUP];
+extern	float					gShieldTimer;
+extern	float					gSonicScreamWave;
+extern	float					gTimeRemaining;
 extern	FSSpec					gDataSpec;
 extern	GLuint					gShadowGLTextureName;
 extern	int						EXPLODEGEOMETRY_DENOMINATOR;
@@ -102,6 +114,8 @@ extern	int						MAX_STEGO;
 extern	int						MAX_TRICER;
 extern	int						PRO_MODE;
 extern	KeyControlType			gMyControlBits;
+extern	float					gMyTurnSlugFactor;
+extern	int						gCurrentAntialiasingLevel;
 extern	int						gCurrentSuperTileCol;
 extern	int						gCurrentSuperTileRow;
 extern	long					gMyStartX;
@@ -110,6 +124,7 @@ extern	int						gNumSuperTilesDeep;
 extern	int						gNumSuperTilesWide;
 extern	int						gNumTerrainTextureTiles;
 extern	long					gPrefsFolderDirID;
+extern	MeshLODSet*				gObjectGroupLODList[MAX_3DMF_GROUPS][MAX_OBJECTS_IN_GROUP];
 extern	int						gScreenXOffset;
 extern	int						gScreenYOffset;
 extern	int						gTerrainItemDeleteWindow_Far;
@@ -121,9 +136,11 @@ extern	int						gTerrainTileWidth;
 extern	long					gTerrainUnitDepth;
 extern	long					gTerrainUnitWidth;
 extern	NewObjectDefinitionType	gNewObjectDefinition;
+extern	ObjNode*				gCameraNode;
 extern	ObjNode*				gCurrentNode;
 extern	ObjNode*				gFirstNodePtr;
 extern	ObjNode*				gInventoryObject;
+extern	ObjNode*				gMyShield;
 extern	ObjNode*				gMyTimePortal;
 extern	ObjNode*				gPlayerObj;
 extern	Pool*					gObjNodePool;
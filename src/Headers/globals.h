@@ -127,6 +127,9 @@ enum
 	STATUS_BIT_NOTRICACHE 	 =  (1<<16), 	// set if want to disable triangle caching when drawing this xparent obj
 	STATUS_BIT_KEEPBACKFACES =	(1<<17),	// set if want to render both front and back faces
 	STATUS_BIT_NOZWRITE		=	(1<<18),	// set when want to turn off z buffer writes
+	STATUS_BIT_PROPBATCHED	=	(1<<19),	// geometry is drawn as part of its supertile's prop batch (see PropBatch.c)
+	STATUS_BIT_SHADOWDECAL	=	(1<<20),	// shadow node; drawn through the shared shadow quad buffer
+	STATUS_BIT_PARALLELMOVE	=	(1<<21),	// move routine only touches its own node & reads nothing other moves change, so it can run on a worker thread (see MoveParallelRun)
 };
 
 
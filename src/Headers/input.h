@@ -63,6 +63,9 @@ enum
 
 void InitInput(void);
 void UpdateInput(void);
+void LateLatchInput(void);
+void UseLateInputSample(void);
+void MeasureInputLatency(void);
 
 bool GetNewSDLKeyState(unsigned short sdlScanCode);
 bool GetSDLKeyState(unsigned short sdlScanCode);
@@ -72,6 +75,7 @@ bool AreAnyNewKeysPressed(void);
 
 bool GetNewNeedState(int needID);
 bool GetNeedState(int needID);
+bool GetLateNeedState(int needID);
 
 SDL_Gamepad* TryOpenGamepad(bool showMessageOnFailure);
 void OnJoystickRemoved(SDL_JoystickID which);
@@ -14,6 +14,8 @@ extern	Boolean AddTree(TerrainItemEntryType *itemPtr, long  x, long z);
 extern	Boolean AddBoulder(TerrainItemEntryType *itemPtr, long  x, long z);
 extern	Boolean AddMushroom(TerrainItemEntryType *itemPtr, long  x, long z);
 extern	void InitItemsManager(void);
+void GetItemPatchCounts(short counts[3]);
+void SetItemPatchCounts(const short counts[3]);
 extern	void UpdateLavaTextureAnimation(void);
 extern	Boolean AddBush(TerrainItemEntryType *itemPtr, long  x, long z);
 extern	Boolean AddNest(TerrainItemEntryType *itemPtr, long  x, long z);
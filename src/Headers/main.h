@@ -11,9 +11,12 @@ enum
 
 void ToolBoxInit(void);
 void GameMain(void);
+void InitLevel(void);
+void CleanupLevel(void);
 
 extern Boolean	gSkipToLevel;
 extern int		gStartLevelNum;
 extern char		gCustomTerrainFile[512];
+extern char		gSnapshotFile[512];
 extern Boolean	gFenceCollisionsDisabled;
 
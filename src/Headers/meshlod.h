@@ -0,0 +1,45 @@
+//
+// meshlod.h
+//
+
+#pragma once
+
+#include <QD3D.h>
+
+#define	MESHLOD_MAX_LEVELS		3				// including the full-detail level 0
+
+
+		/* REDUCED TRIANGLE LIST FOR ONE MESH */
+		//
+		// A reduced level only ever references vertices that already exist in the source mesh,
+		// so it can be drawn with the source mesh's point/normal/UV arrays as-is.
+		// This is what lets skinned meshes use LODs: UpdateSkinnedGeometry keeps writing
+		// to the same vertex arrays and the decomposed point references stay valid.
+		//
+
+typedef struct
+{
+	int						numTriangles;
+	TQ3TriMeshTriangleData	*triangles;
+}MeshLODTriangleList;
+
+
+		/* ALL REDUCED LEVELS FOR AN OBJECT */
+
+typedef struct MeshLODSet
+{
+	int						numMeshes;								// # meshes in the object this set was built for
+	const TQ3TriMeshData	**sourceMeshes;							// the meshes this set was built from (levels index into their vertex arrays)
+	int						numLevels;								// # levels including level 0 (full detail)
+	int						numTriangles[MESHLOD_MAX_LEVELS];		// total triangle count of the object at each level
+	float					maxScreenSize[MESHLOD_MAX_LEVELS];		// use level N when the object covers less than this fraction of the view
+	MeshLODTriangleList		*levels[MESHLOD_MAX_LEVELS];			// levels[lod][meshNum] (levels[0] is nil -- use the mesh's own triangles)
+}MeshLODSet;
+
+
+//===========================================================
+
+MeshLODSet* MeshLOD_Build(int numMeshes, TQ3TriMeshData** meshList, int** vertexGroups, float radius);
+void MeshLOD_Dispose(MeshLODSet* lodSet);
+Boolean MeshLOD_MatchesMeshes(const MeshLODSet* lodSet, int numMeshes, TQ3TriMeshData** meshList);
+int MeshLOD_SelectLevel(const MeshLODSet* lodSet, float radius, float distance, float tanHalfFOV);
@@ -0,0 +1,29 @@
+//
+// metrics.h
+//
+
+#pragma once
+
+#define	MAX_METRICS				48
+#define	METRICS_SOCKET_PATH_MAX	104						// sun_path is 104 bytes on macOS, 108 on Linux
+
+typedef enum
+{
+	METRIC_COUNTER,										// only goes up (e.g. frames drawn)
+	METRIC_GAUGE,										// a value at this moment (e.g. objects in use)
+	METRIC_HISTOGRAM									// distribution of observed values, in milliseconds
+}MetricKind;
+
+extern	char		gMetricsSocketPath[METRICS_SOCKET_PATH_MAX];
+extern	Boolean		gMetricsEnabled;
+
+void InitMetrics(void);
+void ShutdownMetrics(void);
+int Metrics_Register(const char *name, MetricKind kind, const char *help);
+void Metrics_Add(int metric, double amount);
+void Metrics_Set(int metric, double value);
+void Metrics_Observe(int metric, double milliseconds);
+void Metrics_EndFrame(double frameMilliseconds);
+void Metrics_SetLevelLoadTime(double milliseconds);
+void Metrics_ObserveInputLatency(double milliseconds, Boolean sinceEvent);
+void Metrics_ObserveTerrainRebuild(double milliseconds, Boolean isJump);
@@ -34,6 +34,8 @@ POMME_NORETURN void	DoFatalAlert(const char*);
 POMME_NORETURN void CleanQuit(void);
 extern	void SetMyRandomSeed(unsigned long seed);
 extern	unsigned long MyRandomLong(void);
+void GetMyRandomState(unsigned long state[6]);
+void SetMyRandomState(const unsigned long state[6]);
 POMME_NORETURN void DoFatalAlert2(const char* s1, const char* s2);
 extern	float RandomFloat(void);
 extern	void ShowSystemErr_NonFatal(long err);
@@ -5,6 +5,11 @@
 
 #define INVALID_NODE_FLAG	0xdeadbeef			// put into CType when node is deleted
 
+#define	MAX_OBJECT_COMMAND_BUFFERS	8			// threads that can queue deferred spawns & deletes at once
+#define	DEFERRED_SPAWN_PARAMS_SIZE	64			// max bytes of params passed to a DeferredSpawnProc
+
+typedef void (*DeferredSpawnProc)(const void* params);
+
 
 #define	PLAYER_SLOT		500
 #define	SLOT_OF_DUMB	3000
@@ -22,6 +27,7 @@ enum
 //========================================================
 
 extern	void InitObjectManager(void);
+extern	void ShutdownObjectManager(void);
 extern	ObjNode	*MakeNewObject(NewObjectDefinitionType *newObjDef);
 extern	void MoveObjects(void);
 extern	void DrawObjects(QD3DSetupOutputType *setupInfo);
@@ -37,6 +43,12 @@ extern	void MakeObjectTransparent(ObjNode *theNode, float transPercent);
 
 extern	void MoveStaticObject(ObjNode *theNode);
 
+void BindObjectCommandBuffer(int bufferNum);
+void SetDeferredObjectOrder(int order);
+void DeferObjectSpawn(DeferredSpawnProc proc, const void* params, int paramsSize);
+void DeferDeleteObject(ObjNode *theNode);
+void FlushDeferredObjectCommands(void);
+
 extern	void CalcNewTargetOffsets(ObjNode *theNode, float scale);
 
 //===================
@@ -49,6 +61,9 @@ extern	void SetObjectCollisionBounds(ObjNode *theNode, short top, short bottom,
 extern	void UpdateShadow(ObjNode *theNode);
 extern	void CheckAllObjectsInConeOfVision(void);
 extern	ObjNode	*AttachShadowToObject(ObjNode *theNode, float scaleX, float scaleZ);
+extern	void BeginShadowBatch(void);
+extern	void AddShadowToBatch(ObjNode *shadowNode);
+extern	void SubmitShadowBatch(void);
 extern	void StartObjectStreamEffect(ObjNode *theNode, short effectNum);
 extern	void StopObjectStreamEffect(ObjNode *theNode);
 extern	void KeepOldCollisionBoxes(ObjNode *theNode);
@@ -0,0 +1,11 @@
+//
+// propbatch.h
+//
+
+#pragma once
+
+void PropBatch_AddNode(ObjNode* theNode);
+void PropBatch_RemoveNode(ObjNode* theNode);
+void PropBatch_NodeMoved(ObjNode* theNode);
+void PropBatch_DrawAll(QD3DSetupOutputType* setupInfo);
+void PropBatch_DisposeAll(void);
@@ -81,6 +81,7 @@ typedef struct
 	TQ3ColorRGBA			clearColor;
 	TQ3CameraPlacement		cameraPlacement;
 	QD3DLightDefType		lights;
+	void					(*lateLatchRoutine)(void);	// low-latency mode: re-aims the camera just before the scene is flushed
 }QD3DSetupOutputType;
 
 
@@ -96,5 +97,8 @@ extern	void QD3D_UpdateCameraFrom(QD3DSetupOutputType *setupInfo, TQ3Point3D *fr
 extern	void QD3D_MoveCameraFromTo(QD3DSetupOutputType *setupInfo, TQ3Vector3D *moveVector, TQ3Vector3D *lookAtVector);
 extern	void	QD3D_CalcFramesPerSecond(void);
 extern	void QD3D_NewViewDef(QD3DSetupInputType *viewDef);
+extern	void QD3D_SetYon(QD3DSetupOutputType *setupInfo, float yon);
+void QD3D_BakeVertexLighting(const QD3DLightDefType* lights, const TQ3ColorRGBA* diffuse,
+							 int numVertices, const TQ3Vector3D* normals, TQ3ColorRGBA* outColors);
 void MakeShadowTexture(void);
 void QD3D_OnWindowResized(void);
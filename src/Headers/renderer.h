@@ -25,13 +25,34 @@
 
 #pragma mark -
 
+// gGamePrefs.antialiasingLevel: 0 = off, 1-3 = MSAA 2x/4x/8x (needs a restart), 4 = FXAA post-process
+#define ANTIALIASING_LEVEL_FXAA		4
+
 typedef struct RenderStats
 {
 	int			trianglesDrawn;
 	int			meshQueueSize;
 	int 		batchedStateChanges;
+	int			trianglesSavedByLOD;
+	float		gpuFrameMilliseconds;		// GPU time of a recent frame (0 if the driver can't tell us)
+	float		inputLatencyMilliseconds;	// time from reading the input this frame was built from to the buffer swap
+	float		eventLatencyMilliseconds;	// time from the newest input event to the swap that first showed it (0 if none)
+	float		overdrawAverage;			// overdraw mode: fragment writes per 3D viewport pixel
+	int			overdrawMax;				// overdraw mode: most fragment writes to any one pixel (saturates at 255)
+	int			streamedBytes;				// dynamic vertex & index data copied into the streaming buffer
+	int			pipelineStates;				// distinct fixed-function state combinations drawn with
+	int			pipelineSwitches;			// draws whose state combination differs from the previous draw's
+	float		submitMilliseconds;			// CPU time spent drawing the sorted mesh queue
+	float		vulkanSubmitMilliseconds;	// --vulkan: CPU time spent recording & submitting the same queue to Vulkan
+	int			dynamicLights;				// point lights added by the game this frame
+	int			dynamicLightBinds;			// times a point light was loaded into a GL light slot
+	float		dynamicLightMilliseconds;	// CPU time spent picking & loading point lights
 } RenderStats;
 
+// Overdraw mode (--overdraw): counts fragment writes per pixel in the stencil buffer
+// and shows them as a heatmap over the 3D viewport. Set before the window is created.
+extern	Boolean		gOverdrawMode;
+
 typedef struct RenderModifiers
 {
 	// Copy of the status bits from ObjNode.
@@ -47,8 +68,35 @@ typedef struct RenderModifiers
 	// When several meshes have the same priority, they are sorted according to their depth relative to the camera.
 	// Note that opaque meshes are drawn front-to-back, and transparent meshes are drawn back-to-front.
 	int						sortPriority;
+
+	// Reduced-detail triangle lists for the meshes in the list (see MeshLOD.c). May be nil.
+	const struct MeshLODSet*	lodSet;
+
+	// Which level of lodSet to draw. 0 = full detail.
+	int						lodLevel;
 } RenderModifiers;
 
+		/* PIPELINE STATE KEY */
+		//
+		// The fixed-function state that DrawMeshList sets up for a mesh, as a few bits.
+		// Every distinct key is a pipeline that an explicit API has to build ahead of time
+		// (see VulkanRenderer.c), and every change of key between two draws is a pipeline switch.
+		//
+
+enum
+{
+	kPipelineState_Blend			= 1 << 0,
+	kPipelineState_NoCull			= 1 << 1,
+	kPipelineState_TwoSidedBlend	= 1 << 2,		// backfaces, then frontfaces
+	kPipelineState_Lighting			= 1 << 3,
+	kPipelineState_Texture			= 1 << 4,
+	kPipelineState_EnvMap			= 1 << 5,
+	kPipelineState_DepthWrite		= 1 << 6,
+	kPipelineState_VertexColors		= 1 << 7,
+	kPipelineState_Normals			= 1 << 8,
+	kPipelineState_NumKeys			= 1 << 9
+};
+
 typedef enum
 {
 	kRendererTextureFlags_None			= 0,
@@ -87,10 +135,40 @@ GLuint Render_LoadTexture(
 		RendererTextureFlags flags
 );
 
+// Wrapper for glTexSubImage2D that replaces all the pixels of a texture made by Render_LoadTexture.
+void Render_UpdateTexture(
+		GLuint textureName,
+		int width,
+		int height,
+		GLenum bufferFormat,
+		GLenum bufferType,
+		const GLvoid* pixels
+);
+
 // Uploads all textures from a 3DMF file to the GPU.
 // Requires an OpenGL context to be active.
 void Render_Load3DMFTextures(TQ3MetaFile* metaFile, GLuint* outTextureNames);
 
+// Uploads a compact interleaved copy of a mesh's vertex data to the GPU.
+// Only use this on meshes whose vertex data won't change afterwards.
+// The mesh is still usable on the CPU side; the renderer picks the GPU copy when drawing it.
+void Render_UploadStaticMesh(const TQ3TriMeshData* mesh);
+
+// Frees the GPU copy of a mesh, if any.
+// Call this before disposing of the mesh or modifying its vertex data.
+void Render_ReleaseStaticMesh(const TQ3TriMeshData* mesh);
+
+// Gives meshes that all have the same vertex & triangle counts (e.g. terrain supertiles)
+// a slot each in one shared vertex buffer and one shared index buffer.
+// The meshes must have normals, UVs and vertex colors allocated.
+void Render_CreateMeshPool(TQ3TriMeshData** meshes, int numMeshes);
+
+// Refreshes a pooled mesh's slot after its vertex data or triangles changed.
+void Render_UpdatePooledMesh(const TQ3TriMeshData* mesh);
+
+// Frees the mesh pool. Call this before disposing of the pooled meshes.
+void Render_DisposeMeshPool(void);
+
 #pragma mark -
 
 // Instructs the renderer to get ready to draw a new frame.
@@ -130,6 +208,13 @@ void Render_SubmitMesh(
 		const RenderModifiers* mods,
 		const TQ3Point3D* centerCoord);
 
+// Sorts the submitted meshes in draw order (by sort priority, then front to back).
+// Render_EndFrame() does this on its own; NanosaurBench calls it to time the sort by itself.
+void Render_SortMeshQueue(void);
+
+// Drops all submitted meshes without drawing them.
+void Render_DiscardMeshQueue(void);
+
 #pragma mark -
 
 void Render_Enter2D(void);
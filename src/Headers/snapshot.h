@@ -0,0 +1,9 @@
+//
+// snapshot.h
+//
+
+#pragma once
+
+void GetGameSnapshotSpec(FSSpec *spec);
+Boolean SaveGameSnapshot(FSSpec *spec);
+Boolean LoadGameSnapshot(FSSpec *spec);
@@ -60,4 +60,5 @@ extern	short PlayEffect_Parms(short effectNum, unsigned char volume, unsigned lo
 void PauseAllChannels(Boolean pause);
 extern	void ChangeChannelVolume(short channel, short volume);
 extern	void StartAmbientEffect(void);
+void GetSoundChannelUsage(int *numBusy, int *numChannels);
 
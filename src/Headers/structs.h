@@ -147,6 +147,8 @@ typedef struct
 
 	int					numTextures;
 	GLuint				*textureNames;
+
+	struct MeshLODSet	*lodSet;						// reduced-detail triangle lists for the decomposed trimeshes
 }SkeletonDefType;
 
 
@@ -178,6 +180,10 @@ typedef struct
 
 	TQ3Matrix4x4	jointTransformMatrix[MAX_JOINTS];	// holds matrix xform for each joint
 
+	TQ3Matrix4x4	jointWorldMatrix[MAX_JOINTS];		// cached world-space matrix for each joint (joint * parents * BaseTransformMatrix)
+	uint32_t		poseStamp;						// bumped whenever a joint transform or the base transform changes
+	uint32_t		jointWorldStamp;				// poseStamp at which jointWorldMatrix was last filled in
+
 	const SkeletonDefType	*skeletonDefinition;	// point to skeleton's common/shared data
 }SkeletonObjDataType;
 
@@ -207,6 +213,8 @@ typedef struct TerrainItemEntryType TerrainItemEntryType;
 			/*  OBJECT RECORD STRUCTURE */
 			/****************************/
 
+#define	XFORM_NEEDS_REBUILD		0xffffffffu			// ObjNode.XformRotOrder: force UpdateObjectTransforms to rebuild the matrix
+
 struct ObjNode
 {
 	struct ObjNode	*PrevNode;			// address of previous node in linked list
@@ -254,6 +262,10 @@ struct ObjNode
 	short				StreamingEffect;		// streaming effect (-1 = none)
 	
 	TQ3Matrix4x4		BaseTransformMatrix;	// matrix which contains all of the transforms for the object as a whole
+	TQ3Point3D			XformCoord;				// Coord/Rot/Scale/rot order that BaseTransformMatrix was last built from,
+	TQ3Vector3D			XformRot;				// so UpdateObjectTransforms can skip the rebuild if nothing moved
+	TQ3Vector3D			XformScale;
+	uint32_t			XformRotOrder;			// XFORM_NEEDS_REBUILD if BaseTransformMatrix was set some other way
 
 	int						NumMeshes;
 	TQ3TriMeshData*			MeshList[MAX_DECOMPOSED_TRIMESHES];
@@ -261,6 +273,7 @@ struct ObjNode
 	bool					OwnsMeshMemory[MAX_DECOMPOSED_TRIMESHES];		// if true, DeleteObject will call Q3TriMeshData_Dispose on the corresponding mesh
 
 	RenderModifiers			RenderModifiers;
+	Boolean					HasBakedLighting;	// MeshList holds lit copies of the shared meshes (static props that couldn't be batched)
 
 	float				Radius;					// radius use for object culling calculation
 
@@ -313,8 +326,12 @@ typedef struct
 	Boolean	debugInfoInTitleBar;
 	Boolean	nanosaurTeethFix;
 	Boolean	force4x3;
+	Boolean	meshLOD;
+	Boolean	adaptiveDrawDistance;
+	Boolean	lowLatencyInput;
+	Boolean	bakedLighting;
 	KeyBinding keys[NUM_CONTROL_NEEDS];
 }PrefsType;
 
-#define PREFS_MAGIC "Nanosaur Prefs v5"
+#define PREFS_MAGIC "Nanosaur Prefs v9"
 
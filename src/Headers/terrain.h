@@ -117,11 +117,7 @@ extern int SUPERTILE_ACTIVE_RANGE;					// distance to watch supertiles
 #define	MAX_TILE_ANIMS			32
 #define	MAX_TERRAIN_TILES		((300*3)+1)							// 10x15 * 3pages + 1 blank/black
 
-#define	MAX_TERRAIN_WIDTH		400
-#define	MAX_TERRAIN_DEPTH		400
-
-#define	MAX_SUPERTILES_WIDE		(MAX_TERRAIN_WIDTH/SUPERTILE_SIZE)
-#define	MAX_SUPERTILES_DEEP		(MAX_TERRAIN_DEPTH/SUPERTILE_SIZE)
+#define	TERRAIN_HEADER_SIZE		40						// size of the .ter file header (see LoadTerrain)
 
 #define	NUM_VERTICES_IN_SUPERTILE	((SUPERTILE_SIZE+1)*(SUPERTILE_SIZE+1))				// # vertices in a supertile
 
@@ -218,6 +214,12 @@ extern 	void ScanForPlayfieldItems(long top, long bottom, long left, long right)
 extern 	Boolean TrackTerrainItem(ObjNode *theNode);
 extern 	Boolean NilAdd(TerrainItemEntryType *itemPtr,long x, long z);
 extern	void PrimeInitialTerrain(void);
+extern	void SetSuperTileActiveRange(int range);
+extern	void RecenterTerrainOnPlayer(void);
+extern	Boolean RebuildSuperTile(int superTileNum, Boolean textureOnly);
+extern	void InitTerrainPaging(short refNum, SInt32 textureOffset, SInt32 heightmapOffset, SInt32 pathOffset);
+extern	void PageTerrainAroundScrollWindow(void);
+extern	void DisposeTerrainPaging(void);
 extern 	void FindMyStartCoordItem(void);
 extern 	Boolean TrackTerrainItem_Far(ObjNode *theNode, long range);
 extern 	UInt16	GetPathTileNum(float x, float z);
@@ -35,3 +35,5 @@ enum
 
 OSErr ReadTGA(const FSSpec* spec, uint8_t** outPtr, TGAHeader* outHeader, bool forceARGB);
 PicHandle GetPictureFromTGA(const FSSpec* spec);
+void PreloadPictureFromTGA(const FSSpec* spec);
+PicHandle GetPreloadedPictureFromTGA(const FSSpec* spec);
@@ -6,6 +6,7 @@
 void DoPangeaLogo(void);
 extern	void DoTitleScreen(void);
 extern	void ShowCharity(void);
+void PreloadCharity(void);
 extern	void ShowHelp(void);
 
 
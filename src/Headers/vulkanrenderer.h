@@ -0,0 +1,65 @@
+//
+// vulkanrenderer.h
+//
+// Vulkan backend for the 3D mesh queue (see VulkanRenderer.c).
+// Only compiled in when CMake is run with -DNANOSAUR_VULKAN=ON, which defines RENDER_VULKAN.
+//
+
+#pragma once
+
+#if RENDER_VULKAN
+
+		/* ONE DRAW FROM THE SORTED MESH QUEUE */
+		//
+		// Renderer.c walks the sorted queue the same way as DrawMeshList and hands each
+		// mesh it would draw over as one of these, in the same order.
+		//
+
+typedef struct VulkanDraw
+{
+	const TQ3TriMeshData*			mesh;
+	const TQ3Matrix4x4*				transform;			// nil = the mesh is in world space
+	const TQ3Param2D*				uvs;				// nil = untextured
+	const TQ3TriMeshTriangleData*	triangles;			// full-detail or reduced LOD list
+	int								numTriangles;
+	int								staticMesh;			// VkRender_UploadStaticMesh handle, or -1 to stream the vertex data
+	TQ3ColorRGBA					diffuseColor;		// mesh diffuse * modifier diffuse
+	int								pipelineState;		// kPipelineState_* bits
+	bool							isTerrain;			// recorded on the terrain thread
+} VulkanDraw;
+
+typedef struct VulkanFrameInfo
+{
+	char		deviceName[256];
+	int			width;
+	int			height;
+	float		gpuMilliseconds;						// GPU time of the last finished frame (0 if unknown)
+} VulkanFrameInfo;
+
+// --vulkan: mirror every 3D frame into an offscreen Vulkan render target. Set before the window is created.
+extern	Boolean		gVulkanMode;
+
+bool VkRender_Init(void);
+void VkRender_Shutdown(void);
+bool VkRender_IsActive(void);
+
+void VkRender_LoadTexture(GLuint textureName, GLenum internalFormat, int width, int height,
+						  GLenum bufferFormat, GLenum bufferType, const void* pixels, RendererTextureFlags flags);
+void VkRender_UpdateTexture(GLuint textureName, int width, int height, GLenum bufferFormat, GLenum bufferType, const void* pixels);
+
+// Returns a handle to a copy of the mesh's vertex data & triangles, or -1.
+int VkRender_UploadStaticMesh(const TQ3TriMeshData* mesh);
+void VkRender_ReleaseStaticMesh(int handle);
+
+void VkRender_BeginFrame(int width, int height, TQ3ColorRGBA clearColor);
+void VkRender_AddDraw(const VulkanDraw* draw);
+void VkRender_EndFrame(void);
+
+// Copies the color buffer of the last frame into rgba (width*height*4 bytes, top row first).
+// Call VkRender_RequestReadback before drawing that frame.
+void VkRender_RequestReadback(void);
+bool VkRender_ReadPixels(uint8_t* rgba, int width, int height);
+
+void VkRender_GetFrameInfo(VulkanFrameInfo* info);
+
+#endif
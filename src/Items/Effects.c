@@ -44,7 +44,7 @@ ObjNode	*newObj;
 	gNewObjectDefinition.coord.x = x;
 	gNewObjectDefinition.coord.y = y;
 	gNewObjectDefinition.coord.z = z;
-	gNewObjectDefinition.flags = 0;
+	gNewObjectDefinition.flags = STATUS_BIT_PARALLELMOVE;
 	gNewObjectDefinition.slot = SLOT_OF_DUMB;
 	gNewObjectDefinition.moveCall = MoveDustPuff;
 	gNewObjectDefinition.rot = 0;
@@ -78,7 +78,7 @@ static void MoveDustPuff(ObjNode *theNode)
 	theNode->Health -= theNode->SpecialF[0] * gFramesPerSecondFrac;
 	if (theNode->Health < 0)
 	{
-		DeleteObject(theNode);
+		DeferDeleteObject(theNode);
 		return;
 	}
 	
@@ -108,7 +108,7 @@ ObjNode	*newObj;
 	gNewObjectDefinition.coord.x = x;
 	gNewObjectDefinition.coord.y = y;
 	gNewObjectDefinition.coord.z = z;
-	gNewObjectDefinition.flags = STATUS_BIT_NOTRICACHE;
+	gNewObjectDefinition.flags = STATUS_BIT_NOTRICACHE | STATUS_BIT_PARALLELMOVE;
 	gNewObjectDefinition.slot = SLOT_OF_DUMB;
 	gNewObjectDefinition.moveCall = MoveSmokePuff;
 	gNewObjectDefinition.rot = 0;
@@ -144,7 +144,7 @@ float	t,fps = gFramesPerSecondFrac;
 	theNode->Health -= theNode->SpecialF[0] * fps;
 	if (theNode->Health < 0)
 	{
-		DeleteObject(theNode);
+		DeferDeleteObject(theNode);
 		return;
 	}
 	
@@ -30,6 +30,8 @@ static void MoveTree(ObjNode *theNode);
 #define	DIST_TO_FRONT	36
 #define	DIST_TO_SIDE	21
 
+static const TQ3ColorRGB kFireballLightColor = {1.5f, .7f, .2f};
+
 
 
 /*********************/
@@ -78,6 +80,45 @@ void InitItemsManager(void)
 }
 
 
+/******************** GET/SET ITEM PATCH COUNTS *************************/
+//
+// For game snapshots (see Snapshot.c): the # of lava patches, water patches and gas vents in play.
+// Setting them also starts or stops the bubbling & steam loops to match.
+//
+
+void GetItemPatchCounts(short counts[3])
+{
+	counts[0] = gNumLavaPatches;
+	counts[1] = gNumWaterPatches;
+	counts[2] = gNumSteamVents;
+}
+
+void SetItemPatchCounts(const short counts[3])
+{
+	gNumLavaPatches = counts[0];
+	gNumWaterPatches = counts[1];
+	gNumSteamVents = counts[2];
+
+	if (gNumLavaPatches == 0)
+	{
+		if (gLavaSoundChannel != -1)
+			StopAChannel(&gLavaSoundChannel);
+	}
+	else
+	if (gLavaSoundChannel == -1)
+		gLavaSoundChannel = PlayEffect_Parms(EFFECT_BUBBLES,1,kMiddleC);
+
+	if (gNumSteamVents == 0)
+	{
+		if (gSteamSoundChannel != -1)
+			StopAChannel(&gSteamSoundChannel);
+	}
+	else
+	if (gSteamSoundChannel == -1)
+		gSteamSoundChannel = PlayEffect_Parms(EFFECT_STEAM,1,kMiddleC);
+}
+
+
 /************************* ADD LAVA PATCH *********************************/
 //
 // A lava patch is 8x8 tiles
@@ -273,6 +314,7 @@ ObjNode	*puff;
 	}
 	UpdateObject(theNode);
 
+	AddDynamicLight(&theNode->Coord, &kFireballLightColor, 400);
 }
 
 
@@ -442,6 +484,7 @@ static const float scales[] =
 									-30,30,30,-30);
 
 	UpdateObjectTransforms(newObj);
+	PropBatch_AddNode(newObj);						// merge into supertile's static geometry
 	return(true);									// item was added
 }
 
@@ -464,6 +507,7 @@ float	y;
 		theNode->Coord.y = y;
 		CalcObjectBoxFromNode(theNode);
 		UpdateObjectTransforms(theNode);
+		PropBatch_NodeMoved(theNode);
 	}
 }
 
@@ -499,6 +543,7 @@ float	scale;
 	
 	SetObjectCollisionBounds(newObj,newObj->Radius,0,-100,100,100,-100);
 
+	PropBatch_AddNode(newObj);						// merge into supertile's static geometry
 	return(true);									// item was added
 }
 
@@ -539,6 +584,7 @@ float	scale;
 	
 	CreateCollisionTrianglesForObject(newObj);		// build triangle list
 
+	PropBatch_AddNode(newObj);						// merge into supertile's static geometry
 
 	return(true);									// item was added
 }
@@ -584,6 +630,7 @@ TQ3BoundingBox *bbox;
 	SetObjectCollisionBounds(newObj,120,-100,-100,100,100,-100);
 
 	UpdateObjectTransforms(newObj);
+	PropBatch_AddNode(newObj);						// merge into supertile's static geometry
 	
 	
 			/* PUT TRICERATOPS IN THE BUSH */
@@ -290,6 +290,8 @@ float	iScale;
 			FindJointFullMatrix(holderObj,limbNum,&matrix2);						// get full matrix for mouth
 			Q3Matrix4x4_Multiply(&matrix,&matrix2,&theNode->BaseTransformMatrix);	// concat final matrix
 		}
+
+		theNode->XformRotOrder = XFORM_NEEDS_REBUILD;							// matrix was set by hand
 	}
 	
 			/*****************/
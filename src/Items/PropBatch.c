@@ -0,0 +1,701 @@
+/****************************/
+/*   	PROP BATCH.C	    */
+/****************************/
+//
+// Static terrain props (trees, bushes, mushrooms, boulders) never move once they're placed,
+// yet each one used to be its own mesh queue entry with its own transform.
+//
+// Here, the props on each supertile are merged into pre-transformed meshes, one per material,
+// so the whole supertile's worth of props goes out in one draw call per material.
+// The ObjNodes stay alive for collision, terrain item tracking and explosions;
+// they're just skipped by DrawObjects while STATUS_BIT_PROPBATCHED is set.
+//
+// A batch is rebuilt lazily (at draw time) whenever its set of props changes.
+//
+// With the "baked lighting" pref on, the level's lights are baked into the merged meshes'
+// vertex colors and the batches are drawn unlit, since neither the props nor the lights move.
+// A prop that can't join its batch gets its own lit copies of its meshes instead.
+//
+
+
+/****************************/
+/*    EXTERNALS             */
+/****************************/
+
+#include "game.h"
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	MAX_PROPS_PER_BATCH			64
+#define	MAX_BATCH_MATERIALS			24
+#define	MAX_PROP_BATCHES			512				// way more than the item add window can ever cover
+
+#define	BATCH_RENDER_BITS			(STATUS_BIT_KEEPBACKFACES | STATUS_BIT_NULLSHADER | STATUS_BIT_NOZWRITE)
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+typedef struct
+{
+	GLuint				glTextureName;
+	TQ3TexturingMode	texturingMode;
+	TQ3ColorRGBA		diffuseColor;
+	Boolean				hasVertexNormals;
+	uint32_t			renderBits;
+}PropMaterialKey;
+
+typedef struct
+{
+	PropMaterialKey		key;
+	int					numPoints;
+	int					numTriangles[MESHLOD_MAX_LEVELS];
+	float				maxScreenSize[MESHLOD_MAX_LEVELS];
+	int					numLevels;
+	TQ3TriMeshData		*mesh;
+	MeshLODSet			*lodSet;
+	RenderModifiers		renderMods;
+}PropMaterial;
+
+typedef struct
+{
+	int					superRow,superCol;
+	int					activeIndex;						// index in gActiveBatches
+	Boolean				isDirty;
+
+	int					numNodes;
+	ObjNode				*nodes[MAX_PROPS_PER_BATCH];
+
+	int					numMaterials;
+	PropMaterial		materials[MAX_BATCH_MATERIALS];
+
+	TQ3Point3D			center;
+	float				radius;
+	float				propRadius;							// average radius of a prop, for LOD selection
+}PropBatch;
+
+static PropBatch* GetBatchForNode(ObjNode* theNode, Boolean create);
+static void FreeBatchGeometry(PropBatch* batch);
+static void DisposeBatch(PropBatch* batch);
+static void RebuildBatch(PropBatch* batch);
+static int FindOrAddMaterial(PropBatch* batch, const PropMaterialKey* key);
+static void UnbatchNodeAt(PropBatch* batch, int nodeIndex);
+static void BakeUnbatchedProp(ObjNode* theNode);
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+static PropBatch*	gActiveBatches[MAX_PROP_BATCHES];
+static int			gNumActiveBatches = 0;
+
+
+/******************** PROP BATCH: ADD NODE ***********************/
+//
+// Call this once a static prop's transform is final.
+// If the prop can't be batched, it's simply left to DrawObjects.
+//
+
+void PropBatch_AddNode(ObjNode* theNode)
+{
+	GAME_ASSERT(theNode->Genre == DISPLAY_GROUP_GENRE);
+
+	if (theNode->StatusBits & (STATUS_BIT_PROPBATCHED | STATUS_BIT_REFLECTIONMAP | STATUS_BIT_HIDDEN))
+		return;
+
+	for (int i = 0; i < theNode->NumMeshes; i++)
+	{
+		if (theNode->MeshList[i]->hasVertexColors)				// not worth supporting -- no props have them
+			return;
+	}
+
+	PropBatch* batch = GetBatchForNode(theNode, true);
+	if (!batch || batch->numNodes >= MAX_PROPS_PER_BATCH)
+	{
+		BakeUnbatchedProp(theNode);								// DrawObjects will draw it on its own
+		return;
+	}
+
+	batch->nodes[batch->numNodes++] = theNode;
+	batch->isDirty = true;
+
+	theNode->StatusBits |= STATUS_BIT_PROPBATCHED;
+}
+
+
+/******************** PROP BATCH: REMOVE NODE ***********************/
+//
+// Called by DeleteObject. The batch is rebuilt the next time it's drawn.
+//
+
+void PropBatch_RemoveNode(ObjNode* theNode)
+{
+	if (!(theNode->StatusBits & STATUS_BIT_PROPBATCHED))
+		return;
+
+	PropBatch* batch = GetBatchForNode(theNode, false);
+	GAME_ASSERT(batch);
+
+	for (int i = 0; i < batch->numNodes; i++)
+	{
+		if (batch->nodes[i] == theNode)
+		{
+			UnbatchNodeAt(batch, i);
+			batch->isDirty = true;
+			return;
+		}
+	}
+
+	DoFatalAlert("PropBatch_RemoveNode: node not in its batch");
+}
+
+
+/******************** PROP BATCH: NODE MOVED ***********************/
+//
+// Call this if a batched prop's transform changes (e.g. a tree re-settling on the terrain).
+// Props shouldn't leave their supertile.
+//
+
+void PropBatch_NodeMoved(ObjNode* theNode)
+{
+	if (!(theNode->StatusBits & STATUS_BIT_PROPBATCHED))
+		return;
+
+	PropBatch* batch = GetBatchForNode(theNode, false);
+	GAME_ASSERT(batch);
+	batch->isDirty = true;
+}
+
+
+/******************** PROP BATCH: DRAW ALL ***********************/
+
+void PropBatch_DrawAll(QD3DSetupOutputType* setupInfo)
+{
+	const TQ3Point3D cameraCoord = setupInfo->cameraPlacement.cameraLocation;
+	const float tanHalfFOV = tanf(setupInfo->fov * .5f);
+
+	for (int b = 0; b < gNumActiveBatches; b++)
+	{
+		PropBatch* batch = gActiveBatches[b];
+
+		if (batch->isDirty)
+		{
+			if (batch->numNodes == 0)								// nothing left in here
+			{
+				DisposeBatch(batch);
+				b--;												// another batch was swapped into this slot
+				continue;
+			}
+
+			RebuildBatch(batch);
+		}
+
+		if (batch->numMaterials == 0)
+			continue;
+
+		if (!IsSphereInFrustum_XZ(&batch->center, batch->radius))
+			continue;
+
+				/* PICK LEVEL OF DETAIL FROM THE NEAREST POSSIBLE PROP */
+
+		float dist = Q3Point3D_Distance(&cameraCoord, &batch->center) - batch->radius + batch->propRadius;
+
+		for (int m = 0; m < batch->numMaterials; m++)
+		{
+			PropMaterial* material = &batch->materials[m];
+
+			material->renderMods.lodLevel = MeshLOD_SelectLevel(material->lodSet, batch->propRadius, dist, tanHalfFOV);
+
+			Render_SubmitMesh(material->mesh, nil, &material->renderMods, &batch->center);
+		}
+	}
+}
+
+
+/******************** PROP BATCH: DISPOSE ALL ***********************/
+
+void PropBatch_DisposeAll(void)
+{
+	while (gNumActiveBatches > 0)
+	{
+		PropBatch* batch = gActiveBatches[gNumActiveBatches-1];
+
+		while (batch->numNodes > 0)
+			UnbatchNodeAt(batch, batch->numNodes-1);
+
+		DisposeBatch(batch);
+	}
+}
+
+
+#pragma mark -
+
+/******************** GET BATCH FOR NODE ***********************/
+
+static PropBatch* GetBatchForNode(ObjNode* theNode, Boolean create)
+{
+int		superCol,superRow,tileCol,tileRow;
+
+	GetSuperTileInfo(theNode->Coord.x, theNode->Coord.z, &superCol, &superRow, &tileCol, &tileRow);
+
+	if (superRow < 0 || superRow >= gNumSuperTilesDeep || superCol < 0 || superCol >= gNumSuperTilesWide)
+		return nil;
+
+			/* FIND THIS SUPERTILE'S BATCH */
+			//
+			// Only supertiles near the player ever have a batch, so a scan of the
+			// active list is cheap and doesn't tie us to a maximum map size.
+			//
+
+	PropBatch* batch = nil;
+	for (int i = 0; i < gNumActiveBatches; i++)
+	{
+		if (gActiveBatches[i]->superRow == superRow && gActiveBatches[i]->superCol == superCol)
+		{
+			batch = gActiveBatches[i];
+			break;
+		}
+	}
+
+	if (!batch && create)
+	{
+		if (gNumActiveBatches >= MAX_PROP_BATCHES)
+			return nil;
+
+		batch = (PropBatch*) NewPtrClear(sizeof(PropBatch));
+		GAME_ASSERT(batch);
+
+		batch->superRow = superRow;
+		batch->superCol = superCol;
+		batch->activeIndex = gNumActiveBatches;
+		gActiveBatches[gNumActiveBatches++] = batch;
+	}
+
+	return batch;
+}
+
+
+/******************** UNBATCH NODE AT ***********************/
+
+static void UnbatchNodeAt(PropBatch* batch, int nodeIndex)
+{
+	GAME_ASSERT(nodeIndex < batch->numNodes);
+
+	batch->nodes[nodeIndex]->StatusBits &= ~STATUS_BIT_PROPBATCHED;
+	batch->nodes[nodeIndex] = batch->nodes[batch->numNodes-1];
+	batch->numNodes--;
+}
+
+
+/******************** BAKE UNBATCHED PROP ***********************/
+//
+// A static prop that didn't fit in its supertile's batch is drawn by DrawObjects with the
+// shared 3DMF meshes, which are in object space and can't hold one prop's lighting.
+// So with baked lighting on, the prop gets its own copies of its meshes, with the lighting
+// for its world-space normals in their vertex colors, and DrawObjects draws it unlit.
+//
+// Props only ever slide up and down to follow the terrain, so the lighting stays valid.
+// The copies aren't the meshes the prop's LOD set was built from, so it's drawn at full detail.
+//
+
+static void BakeUnbatchedProp(ObjNode* theNode)
+{
+TQ3Vector3D*	worldNormals;
+
+	if (!gGamePrefs.bakedLighting || !gGameViewInfoPtr || theNode->HasBakedLighting)
+		return;
+
+	if (theNode->StatusBits & (STATUS_BIT_NULLSHADER | STATUS_BIT_REFLECTIONMAP))	// already unlit, or lit by the environment map
+		return;
+
+	for (int i = 0; i < theNode->NumMeshes; i++)
+	{
+		if (!theNode->MeshList[i]->hasVertexNormals || theNode->MeshList[i]->hasVertexColors || theNode->OwnsMeshMemory[i])
+			return;
+	}
+
+	for (int i = 0; i < theNode->NumMeshes; i++)
+	{
+		const TQ3TriMeshData* src = theNode->MeshList[i];
+
+				/* COPY THE MESH, WITH ROOM FOR VERTEX COLORS */
+
+		TQ3TriMeshData* mesh = Q3TriMeshData_New(src->numTriangles, src->numPoints,
+				(src->texturingMode != kQ3TexturingModeOff ? kQ3TriMeshDataFeatureVertexUVs : 0)
+				| kQ3TriMeshDataFeatureVertexNormals | kQ3TriMeshDataFeatureVertexColors);
+		GAME_ASSERT(mesh);
+
+		mesh->texturingMode		= src->texturingMode;
+		mesh->glTextureName		= src->glTextureName;
+		mesh->diffuseColor		= src->diffuseColor;
+		mesh->bBox				= src->bBox;
+		mesh->hasVertexNormals	= true;
+		mesh->hasVertexColors	= true;
+
+		SDL_memcpy(mesh->points, src->points, sizeof(TQ3Point3D) * src->numPoints);
+		SDL_memcpy(mesh->vertexNormals, src->vertexNormals, sizeof(TQ3Vector3D) * src->numPoints);
+		SDL_memcpy(mesh->triangles, src->triangles, sizeof(TQ3TriMeshTriangleData) * src->numTriangles);
+		if (src->texturingMode != kQ3TexturingModeOff)
+			SDL_memcpy(mesh->vertexUVs, src->vertexUVs, sizeof(TQ3Param2D) * src->numPoints);
+
+				/* BAKE FROM THE WORLD-SPACE NORMALS */
+
+		worldNormals = (TQ3Vector3D*) AllocPtr(sizeof(TQ3Vector3D) * src->numPoints);
+		GAME_ASSERT(worldNormals);
+
+		for (int v = 0; v < src->numPoints; v++)
+		{
+			Q3Vector3D_Transform(&src->vertexNormals[v], &theNode->BaseTransformMatrix, &worldNormals[v]);	// props are uniformly scaled
+			Q3Vector3D_Normalize(&worldNormals[v], &worldNormals[v]);
+		}
+
+		QD3D_BakeVertexLighting(&gGameViewInfoPtr->lights, &mesh->diffuseColor, mesh->numPoints, worldNormals, mesh->vertexColors);
+
+		DisposePtr((Ptr) worldNormals);
+
+		theNode->MeshList[i] = mesh;
+		theNode->OwnsMeshMemory[i] = true;							// DeleteObject disposes of it
+	}
+
+	theNode->HasBakedLighting = true;
+}
+
+
+/******************** FREE BATCH GEOMETRY ***********************/
+
+static void FreeBatchGeometry(PropBatch* batch)
+{
+	for (int m = 0; m < batch->numMaterials; m++)
+	{
+		PropMaterial* material = &batch->materials[m];
+
+		if (material->mesh)
+		{
+			Render_ReleaseStaticMesh(material->mesh);
+			Q3TriMeshData_Dispose(material->mesh);
+		}
+
+		MeshLOD_Dispose(material->lodSet);
+	}
+
+	SDL_memset(batch->materials, 0, sizeof(batch->materials));
+	batch->numMaterials = 0;
+}
+
+
+/******************** DISPOSE BATCH ***********************/
+
+static void DisposeBatch(PropBatch* batch)
+{
+	GAME_ASSERT(batch->numNodes == 0);
+
+	FreeBatchGeometry(batch);
+
+	PropBatch* last = gActiveBatches[--gNumActiveBatches];				// swap last active batch into this one's slot
+	gActiveBatches[batch->activeIndex] = last;
+	last->activeIndex = batch->activeIndex;
+
+	DisposePtr((Ptr) batch);
+}
+
+
+/******************** FIND OR ADD MATERIAL ***********************/
+
+static int FindOrAddMaterial(PropBatch* batch, const PropMaterialKey* key)
+{
+	for (int m = 0; m < batch->numMaterials; m++)
+	{
+		const PropMaterialKey* k = &batch->materials[m].key;
+
+		if (k->glTextureName == key->glTextureName
+			&& k->texturingMode == key->texturingMode
+			&& k->hasVertexNormals == key->hasVertexNormals
+			&& k->renderBits == key->renderBits
+			&& k->diffuseColor.r == key->diffuseColor.r
+			&& k->diffuseColor.g == key->diffuseColor.g
+			&& k->diffuseColor.b == key->diffuseColor.b
+			&& k->diffuseColor.a == key->diffuseColor.a)
+		{
+			return m;
+		}
+	}
+
+	if (batch->numMaterials >= MAX_BATCH_MATERIALS)
+		return -1;
+
+	int m = batch->numMaterials++;
+	PropMaterial* material = &batch->materials[m];
+	SDL_memset(material, 0, sizeof(*material));
+	material->key = *key;
+	material->numLevels = MESHLOD_MAX_LEVELS;
+	return m;
+}
+
+
+/******************** REBUILD BATCH ***********************/
+//
+// Merges the geometry of all props in the batch into one pre-transformed mesh per material.
+// Each prop's reduced LOD triangle lists are merged the same way, so distant batches
+// still get the benefit of MeshLOD.
+//
+
+static void RebuildBatch(PropBatch* batch)
+{
+int					materialOfMesh[MAX_PROPS_PER_BATCH][MAX_DECOMPOSED_TRIMESHES];
+
+	FreeBatchGeometry(batch);
+	batch->isDirty = false;
+
+			/***************************************************/
+			/* PASS 1: ASSIGN MATERIALS AND COUNT THE GEOMETRY */
+			/***************************************************/
+
+	for (int n = 0; n < batch->numNodes; n++)
+	{
+		ObjNode* theNode = batch->nodes[n];
+		const MeshLODSet* nodeLOD = theNode->RenderModifiers.lodSet;
+
+		if (nodeLOD && !MeshLOD_MatchesMeshes(nodeLOD, theNode->NumMeshes, theNode->MeshList))	// geometry was changed after creation
+			nodeLOD = nil;
+
+		int savedNumMaterials = batch->numMaterials;
+		Boolean fits = true;
+
+		for (int i = 0; i < theNode->NumMeshes && fits; i++)
+		{
+			const TQ3TriMeshData* mesh = theNode->MeshList[i];
+
+			PropMaterialKey key =
+			{
+				.glTextureName		= mesh->texturingMode == kQ3TexturingModeOff ? 0 : mesh->glTextureName,
+				.texturingMode		= mesh->texturingMode,
+				.diffuseColor		= mesh->diffuseColor,
+				.hasVertexNormals	= mesh->hasVertexNormals,
+				.renderBits			= theNode->StatusBits & BATCH_RENDER_BITS,
+			};
+
+			int m = FindOrAddMaterial(batch, &key);
+			materialOfMesh[n][i] = m;
+			fits = (m >= 0);
+		}
+
+		if (!fits)														// out of materials: leave this prop to DrawObjects
+		{
+			batch->numMaterials = savedNumMaterials;
+			BakeUnbatchedProp(theNode);
+			UnbatchNodeAt(batch, n);									// last node is swapped into slot n...
+			n--;														// ...so process slot n again
+			continue;
+		}
+
+		for (int i = 0; i < theNode->NumMeshes; i++)
+		{
+			const TQ3TriMeshData* mesh = theNode->MeshList[i];
+			PropMaterial* material = &batch->materials[materialOfMesh[n][i]];
+
+			material->numPoints += mesh->numPoints;
+
+			for (int level = 0; level < MESHLOD_MAX_LEVELS; level++)
+			{
+				int nodeLevel = nodeLOD ? SDL_min(level, nodeLOD->numLevels-1) : 0;
+
+				if (nodeLevel > 0)
+				{
+					material->numTriangles[level] += nodeLOD->levels[nodeLevel][i].numTriangles;
+					if (nodeLevel == level)
+						material->maxScreenSize[level] = nodeLOD->maxScreenSize[level];
+				}
+				else
+				{
+					material->numTriangles[level] += mesh->numTriangles;
+				}
+			}
+		}
+	}
+
+	if (batch->numNodes == 0)
+		return;
+
+			/****************************/
+			/* PASS 2: BUILD THE MESHES */
+			/****************************/
+
+	for (int m = 0; m < batch->numMaterials; m++)
+	{
+		PropMaterial* material = &batch->materials[m];
+
+		Boolean bakeLighting = gGamePrefs.bakedLighting && gGameViewInfoPtr
+								&& material->key.hasVertexNormals
+								&& !(material->key.renderBits & STATUS_BIT_NULLSHADER);	// already unlit
+
+		TQ3TriMeshData* batchMesh = Q3TriMeshData_New(material->numTriangles[0], material->numPoints,
+				(material->key.texturingMode != kQ3TexturingModeOff ? kQ3TriMeshDataFeatureVertexUVs : 0)
+				| (material->key.hasVertexNormals ? kQ3TriMeshDataFeatureVertexNormals : 0)
+				| (bakeLighting ? kQ3TriMeshDataFeatureVertexColors : 0));
+		GAME_ASSERT(batchMesh);
+
+		batchMesh->texturingMode	= material->key.texturingMode;
+		batchMesh->glTextureName	= material->key.glTextureName;
+		batchMesh->diffuseColor		= material->key.diffuseColor;
+		batchMesh->hasVertexNormals	= material->key.hasVertexNormals;
+		batchMesh->hasVertexColors	= bakeLighting;
+		batchMesh->numPoints		= 0;								// used as fill cursors below
+		batchMesh->numTriangles		= 0;
+		material->mesh = batchMesh;
+
+				/* ALLOCATE REDUCED LEVELS (ONLY IF SOME PROP ACTUALLY HAS THEM) */
+
+		int numLevels = 1;
+		for (int level = 1; level < MESHLOD_MAX_LEVELS; level++)
+		{
+			if (material->maxScreenSize[level] > 0 && material->numTriangles[level] < material->numTriangles[level-1])
+				numLevels = level+1;
+		}
+
+		if (numLevels > 1)
+		{
+			MeshLODSet* lodSet = (MeshLODSet*) NewPtrClear(sizeof(MeshLODSet));
+			GAME_ASSERT(lodSet);
+			lodSet->numMeshes = 1;
+			lodSet->numLevels = numLevels;
+			lodSet->numTriangles[0] = material->numTriangles[0];
+
+			lodSet->sourceMeshes = (const TQ3TriMeshData**) AllocPtr(sizeof(TQ3TriMeshData*));
+			GAME_ASSERT(lodSet->sourceMeshes);
+			lodSet->sourceMeshes[0] = batchMesh;
+
+			for (int level = 1; level < numLevels; level++)
+			{
+				lodSet->levels[level] = (MeshLODTriangleList*) NewPtrClear(sizeof(MeshLODTriangleList));
+				lodSet->levels[level]->triangles = (TQ3TriMeshTriangleData*) AllocPtr(sizeof(TQ3TriMeshTriangleData) * (material->numTriangles[level] + 1));
+				lodSet->numTriangles[level] = material->numTriangles[level];
+				lodSet->maxScreenSize[level] = material->maxScreenSize[level];
+			}
+
+			material->lodSet = lodSet;
+		}
+		material->numLevels = numLevels;
+
+		Render_SetDefaultModifiers(&material->renderMods);
+		material->renderMods.statusBits = material->key.renderBits | (bakeLighting ? STATUS_BIT_NULLSHADER : 0);
+		material->renderMods.lodSet = material->lodSet;
+	}
+
+			/*******************************************/
+			/* PASS 3: COPY PRE-TRANSFORMED GEOMETRY   */
+			/*******************************************/
+
+	TQ3BoundingBox bbox = { .min = {0,0,0}, .max = {0,0,0}, .isEmpty = kQ3True };
+	float radiusSum = 0;
+
+	for (int n = 0; n < batch->numNodes; n++)
+	{
+		ObjNode* theNode = batch->nodes[n];
+		const TQ3Matrix4x4* transform = &theNode->BaseTransformMatrix;
+		const MeshLODSet* nodeLOD = theNode->RenderModifiers.lodSet;
+
+		if (nodeLOD && !MeshLOD_MatchesMeshes(nodeLOD, theNode->NumMeshes, theNode->MeshList))
+			nodeLOD = nil;
+
+		radiusSum += theNode->Radius;
+
+		for (int i = 0; i < theNode->NumMeshes; i++)
+		{
+			const TQ3TriMeshData* src = theNode->MeshList[i];
+			PropMaterial* material = &batch->materials[materialOfMesh[n][i]];
+			TQ3TriMeshData* dst = material->mesh;
+			const uint32_t base = dst->numPoints;
+
+					/* VERTICES */
+
+			for (int v = 0; v < src->numPoints; v++)
+			{
+				TQ3Point3D* p = &dst->points[base + v];
+				Q3Point3D_Transform(&src->points[v], transform, p);
+
+				if (bbox.isEmpty)
+				{
+					bbox.min = bbox.max = *p;
+					bbox.isEmpty = kQ3False;
+				}
+				else
+				{
+					bbox.min.x = SDL_min(bbox.min.x, p->x);		bbox.max.x = SDL_max(bbox.max.x, p->x);
+					bbox.min.y = SDL_min(bbox.min.y, p->y);		bbox.max.y = SDL_max(bbox.max.y, p->y);
+					bbox.min.z = SDL_min(bbox.min.z, p->z);		bbox.max.z = SDL_max(bbox.max.z, p->z);
+				}
+
+				if (material->key.hasVertexNormals)
+				{
+					TQ3Vector3D* nrm = &dst->vertexNormals[base + v];
+					Q3Vector3D_Transform(&src->vertexNormals[v], transform, nrm);		// props are uniformly scaled
+					Q3Vector3D_Normalize(nrm, nrm);
+				}
+
+				if (material->key.texturingMode != kQ3TexturingModeOff)
+				{
+					dst->vertexUVs[base + v] = src->vertexUVs[v];
+				}
+			}
+			dst->numPoints += src->numPoints;
+
+					/* FULL-DETAIL TRIANGLES */
+
+			for (int t = 0; t < src->numTriangles; t++)
+			{
+				TQ3TriMeshTriangleData* tri = &dst->triangles[dst->numTriangles++];
+				tri->pointIndices[0] = base + src->triangles[t].pointIndices[0];
+				tri->pointIndices[1] = base + src->triangles[t].pointIndices[1];
+				tri->pointIndices[2] = base + src->triangles[t].pointIndices[2];
+			}
+
+					/* REDUCED TRIANGLES */
+
+			for (int level = 1; level < material->numLevels; level++)
+			{
+				MeshLODTriangleList* dstList = material->lodSet->levels[level];
+				int nodeLevel = nodeLOD ? SDL_min(level, nodeLOD->numLevels-1) : 0;
+
+				int numTris = nodeLevel > 0 ? nodeLOD->levels[nodeLevel][i].numTriangles : src->numTriangles;
+				const TQ3TriMeshTriangleData* srcTris = nodeLevel > 0 ? nodeLOD->levels[nodeLevel][i].triangles : src->triangles;
+
+				for (int t = 0; t < numTris; t++)
+				{
+					TQ3TriMeshTriangleData* tri = &dstList->triangles[dstList->numTriangles++];
+					tri->pointIndices[0] = base + srcTris[t].pointIndices[0];
+					tri->pointIndices[1] = base + srcTris[t].pointIndices[1];
+					tri->pointIndices[2] = base + srcTris[t].pointIndices[2];
+				}
+			}
+		}
+	}
+
+			/* FINISH UP */
+
+	for (int m = 0; m < batch->numMaterials; m++)
+	{
+		PropMaterial* material = &batch->materials[m];
+		GAME_ASSERT(material->mesh->numTriangles == material->numTriangles[0]);
+
+		material->mesh->bBox = bbox;
+
+		if (material->mesh->hasVertexColors)							// bake from the world-space normals
+		{
+			QD3D_BakeVertexLighting(&gGameViewInfoPtr->lights, &material->mesh->diffuseColor,
+									material->mesh->numPoints, material->mesh->vertexNormals, material->mesh->vertexColors);
+		}
+
+		Render_UploadStaticMesh(material->mesh);
+	}
+
+	batch->center.x = (bbox.min.x + bbox.max.x) * .5f;
+	batch->center.y = (bbox.min.y + bbox.max.y) * .5f;
+	batch->center.z = (bbox.min.z + bbox.max.z) * .5f;
+	batch->radius = Q3Point3D_Distance(&bbox.min, &bbox.max) * .5f;
+	batch->propRadius = radiusSum / batch->numNodes;
+}
@@ -173,7 +173,7 @@ float	y;
 			gNewObjectDefinition.coord.y = theNode->Coord.y + 15;
 		
 		gNewObjectDefinition.coord.z = theNode->Coord.z;
-		gNewObjectDefinition.flags = STATUS_BIT_KEEPBACKFACES;
+		gNewObjectDefinition.flags = STATUS_BIT_KEEPBACKFACES | STATUS_BIT_PARALLELMOVE;
 		gNewObjectDefinition.slot = SLOT_OF_DUMB;
 		gNewObjectDefinition.moveCall = MoveTimePortalRing;
 		gNewObjectDefinition.rot = 0;
@@ -248,7 +248,7 @@ float	fps = gFramesPerSecondFrac;
 					theNode->Health -= fps * .6f;
 					if (theNode->Health <= 0.0f)
 					{
-						DeleteObject(theNode);
+						DeferDeleteObject(theNode);
 						return;
 					}
 						
@@ -263,7 +263,7 @@ float	fps = gFramesPerSecondFrac;
 					theNode->Health -= fps * 0.3f;						// decay it
 					if (theNode->Health <= 0.0f)
 					{
-						DeleteObject(theNode);
+						DeferDeleteObject(theNode);
 						return;
 					}		
 				}
@@ -298,7 +298,7 @@ float	fps = gFramesPerSecondFrac;
 					theNode->Health -= fps * 0.6f;						// decay it
 					if (theNode->Health <= 0.0f)
 					{
-						DeleteObject(theNode);
+						DeferDeleteObject(theNode);
 						return;
 					}		
 				}
@@ -331,7 +331,7 @@ float	fps = gFramesPerSecondFrac;
 					theNode->Health -= fps * 0.3f;						// decay it
 					if (theNode->Health <= 0.0f)
 					{
-						DeleteObject(theNode);
+						DeferDeleteObject(theNode);
 						return;
 					}		
 				}
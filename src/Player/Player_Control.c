@@ -42,6 +42,7 @@ static void MoveJetPackFlame(ObjNode *theNode);
 
 short			gJetSoundChannel = -1;
 KeyControlType	gMyControlBits;
+float			gMyTurnSlugFactor;					// turn rate scale applied to gMyControlBits this frame (0 if the player couldn't turn)
 
 
 short	gCurrentSelectedTextEditItem;
@@ -64,6 +65,7 @@ float	gMySpeedPuffCounter;
 void CalcPlayerKeyControls(void)
 {
 	gMyControlBits = KeysToControlBits();		// calc control bits for me
+	gMyTurnSlugFactor = 0;						// set by DoPlayerControl/DoPlayerJetControl if they run
 }
 
 
@@ -130,6 +132,7 @@ Byte		currentAnim;
 	currentAnim = theNode->Skeleton->AnimNum;
 
 	bits = gMyControlBits;					// get player control bits
+	gMyTurnSlugFactor = slugFactor;
 
 
 			/******************************/
@@ -298,6 +301,7 @@ void DoPlayerJetControl(ObjNode *theNode)
 KeyControlType	bits; 
 
 	bits = gMyControlBits;											// get player control bits
+	gMyTurnSlugFactor = 1;
 
 			/* SEE IF ROTATE PLAYER LEFT  */
 				
@@ -793,6 +797,7 @@ static void MoveJetPackFlame(ObjNode *theNode)
 ObjNode	*playerObj,*leftObj;
 TQ3Matrix4x4	mat,transMat,scaleMat,jointMat;
 static const TQ3Point3D pt = {0,39,55};
+static const TQ3ColorRGB flameLightColor = {1.2f, .7f, .3f};
 ObjNode	*dustObj;
 TQ3Point3D	pt2;
 
@@ -807,6 +812,7 @@ TQ3Point3D	pt2;
 	FindJointFullMatrix(playerObj, MYGUY_LIMB_BODY, &jointMat);				// get transform matrix for joint
 	Q3Matrix4x4_Multiply(&scaleMat,&transMat,&mat);							// concat the matrices
 	Q3Matrix4x4_Multiply(&mat,&jointMat,&theNode->BaseTransformMatrix);		// concat the matrices
+	theNode->XformRotOrder = XFORM_NEEDS_REBUILD;							// matrix was set by hand
 
 
 				/* HANDLE LEFT FLAME */
@@ -815,6 +821,13 @@ TQ3Point3D	pt2;
 	transMat.value[3][0] = -10;												// modify trans matrix
 	Q3Matrix4x4_Multiply(&scaleMat,&transMat,&mat);							// concat the matrices
 	Q3Matrix4x4_Multiply(&mat,&jointMat,&leftObj->BaseTransformMatrix);		// concat the matrices
+	leftObj->XformRotOrder = XFORM_NEEDS_REBUILD;
+
+
+				/* LIGHT UP THE GROUND UNDER THE NOZZLES */
+
+	Q3Point3D_Transform(&pt, &jointMat, &pt2);							// also where the exhaust goes
+	AddDynamicLight(&pt2, &flameLightColor, 350);
 
 
 				/* MAKE EXHAUST */
@@ -823,8 +836,6 @@ TQ3Point3D	pt2;
 	if (theNode->ExhaustTimer > .05)
 	{
 		theNode->ExhaustTimer = 0;
-		
-		Q3Point3D_Transform(&pt, &jointMat, &pt2);							// calc coord to put exhaust
 
 		dustObj = MakeDustPuff(pt2.x, pt2.y, pt2.z, .15);					// make exhaust
 		if (dustObj)
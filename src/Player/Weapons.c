@@ -50,6 +50,7 @@ extern const float	NUKE_RATE;
 
 #define	BLASTER_SPEED		1100
 #define	BLASTER_DAMAGE		.4
+static const TQ3ColorRGB kBlasterLightColor = {1.2f, .4f, .3f};
 
 #define	HEATSEEK_SPEED		700
 #define	HEATSEEK_DAMAGE		.8
@@ -322,7 +323,7 @@ ObjNode *newObj;
 	gNewObjectDefinition.coord = *coord;
 	gNewObjectDefinition.group = GLOBAL_MGroupNum_Explosion;	
 	gNewObjectDefinition.type = GLOBAL_MObjType_Explosion;	
-	gNewObjectDefinition.flags = 0;
+	gNewObjectDefinition.flags = STATUS_BIT_PARALLELMOVE;
 	gNewObjectDefinition.slot = SLOT_OF_DUMB;	
 	gNewObjectDefinition.moveCall = MoveExplosion;
 	gNewObjectDefinition.rot = 0;
@@ -341,17 +342,21 @@ ObjNode *newObj;
 static void MoveExplosion(ObjNode *theNode)
 {
 float	fps = gFramesPerSecondFrac;
+TQ3ColorRGB	lightColor;
 
 	theNode->Health -= 3.0 * fps;								// decay it
 	if (theNode->Health <= 0)
 	{
-		DeleteObject(theNode);
+		DeferDeleteObject(theNode);
 		return;
 	}
 	
 	MakeObjectTransparent(theNode, theNode->Health);
 	theNode->Scale.x = theNode->Scale.y = theNode->Scale.z += fps * 20;
 	UpdateObjectTransforms(theNode);
+
+	lightColor = (TQ3ColorRGB) { 2.0f * theNode->Health, 1.2f * theNode->Health, .4f * theNode->Health };	// flash fades with the fireball
+	AddDynamicLight(&theNode->Coord, &lightColor, 500);
 }
 
 
@@ -570,6 +575,8 @@ float	x,y,z,fps;
 		return;
 
 	UpdateObject(theNode);
+
+	AddDynamicLight(&theNode->Coord, &kBlasterLightColor, 300);
 }
 
 
@@ -741,7 +748,7 @@ static void MoveHeatSeek(ObjNode *theNode)
 				.coord		= {x,y,z},
 				.group		= GLOBAL_MGroupNum_HeatSeekEcho,
 				.type		= GLOBAL_MObjType_HeatSeekEcho,
-				.flags		= 0,
+				.flags		= STATUS_BIT_PARALLELMOVE,
 				.slot		= SLOT_OF_DUMB,
 				.moveCall	= MoveHeatSeekEcho,
 				.rot		= 0,
@@ -773,7 +780,7 @@ static void MoveHeatSeekEcho(ObjNode *theNode)
 	theNode->Health -= 3.0 * gFramesPerSecondFrac;			// decay it
 	if (theNode->Health <= 0)
 	{
-		DeleteObject(theNode);
+		DeferDeleteObject(theNode);
 		return;
 	}
 	
@@ -1083,6 +1090,7 @@ static void MoveNukeShockwave(ObjNode *theNode)
 {
 float	fps = gFramesPerSecondFrac;
 float	s;
+TQ3ColorRGB	lightColor;
 
 			/* DECAY IT */
 			
@@ -1107,4 +1115,7 @@ float	s;
 			/* UPATE */
 			
 	UpdateObjectTransforms(theNode);
+
+	lightColor = (TQ3ColorRGB) { 2.5f * theNode->Health, 2.0f * theNode->Health, 1.2f * theNode->Health };
+	AddDynamicLight(&theNode->Coord, &lightColor, s * 10 + 600);	// lights up a bit past the shockwave
 }
@@ -31,6 +31,7 @@ GLuint*						gObjectGroupTextures[MAX_3DMF_GROUPS];
 TQ3TriMeshFlatGroup			gObjectGroupList[MAX_3DMF_GROUPS][MAX_OBJECTS_IN_GROUP];
 float			gObjectGroupRadiusList[MAX_3DMF_GROUPS][MAX_OBJECTS_IN_GROUP];
 TQ3BoundingBox 	gObjectGroupBBoxList[MAX_3DMF_GROUPS][MAX_OBJECTS_IN_GROUP];
+MeshLODSet*		gObjectGroupLODList[MAX_3DMF_GROUPS][MAX_OBJECTS_IN_GROUP];
 short			gNumObjectsInGroupList[MAX_3DMF_GROUPS] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
 
 
@@ -78,6 +79,11 @@ void LoadGrouped3DMF(FSSpec *spec, Byte groupNum)
 
 	Render_Load3DMFTextures(the3DMFFile, gObjectGroupTextures[groupNum]);
 
+			/* UPLOAD PACKED VERTEX DATA TO GPU */
+
+	for (int i = 0; i < the3DMFFile->numMeshes; i++)
+		Render_UploadStaticMesh(the3DMFFile->meshes[i]);
+
 			/* BUILD OBJECT LIST */
 
 	int nObjects = the3DMFFile->numTopLevelGroups;
@@ -93,6 +99,9 @@ void LoadGrouped3DMF(FSSpec *spec, Byte groupNum)
 
 		gObjectGroupRadiusList[groupNum][i] = QD3D_CalcObjectRadius(meshList.numMeshes, meshList.meshes);	// save radius of it
 		QD3D_CalcObjectBoundingBox(meshList.numMeshes, meshList.meshes, &gObjectGroupBBoxList[groupNum][i]); // save bbox
+
+		gObjectGroupLODList[groupNum][i] = MeshLOD_Build(meshList.numMeshes, meshList.meshes,	// build reduced-detail levels
+											nil, gObjectGroupRadiusList[groupNum][i]);
 	}
 
 	gNumObjectsInGroupList[groupNum] = nObjects;					// set # objects.
@@ -117,10 +126,21 @@ void Free3DMFGroup(Byte groupNum)
 
 	if (gObjectGroupFile[groupNum] != nil)
 	{
+		for (int i = 0; i < gObjectGroupFile[groupNum]->numMeshes; i++)
+			Render_ReleaseStaticMesh(gObjectGroupFile[groupNum]->meshes[i]);
+
 		Q3MetaFile_Dispose(gObjectGroupFile[groupNum]);
 		gObjectGroupFile[groupNum] = nil;
 	}
 
+			/* DISPOSE LODS */
+
+	for (int i = 0; i < MAX_OBJECTS_IN_GROUP; i++)
+	{
+		MeshLOD_Dispose(gObjectGroupLODList[groupNum][i]);
+		gObjectGroupLODList[groupNum][i] = nil;
+	}
+
 	SDL_memset(gObjectGroupList[groupNum], 0, sizeof(gObjectGroupList[groupNum]));
 
 	gNumObjectsInGroupList[groupNum] = 0;
@@ -290,6 +290,111 @@ float	sx,cx,sy,sz,cy,cz,sxsy,cxsy;
 
 
 
+/******************** SET SCALE ROTATE TRANSLATE MATRIX ***********************/
+//
+// Builds scale * rotate * translate in closed form.  Gives the same matrix as
+// Q3Matrix4x4_SetScale, the per-axis rotations in the given order and Q3Matrix4x4_SetTranslate
+// concatenated with Q3Matrix4x4_Multiply, but without any 4x4 multiplies.
+//
+// rotOrder is STATUS_BIT_ROTZYX, STATUS_BIT_ROTXZY or 0 for X->Y->Z (see SetQuickRotationMatrix_XYZ).
+//
+
+void SetScaleRotateTranslateMatrix(TQ3Matrix4x4 *m, const TQ3Vector3D *scale, const TQ3Vector3D *rot,
+								const TQ3Point3D *coord, uint32_t rotOrder)
+{
+float	sx,cx,sy,sz,cy,cz;
+float	r[3][3];
+int		i;
+
+	sx = sinf(rot->x);											// float versions: the double ones cost as much as the rest of this function
+	sy = sinf(rot->y);
+	sz = sinf(rot->z);
+	cx = cosf(rot->x);
+	cy = cosf(rot->y);
+	cz = cosf(rot->z);
+
+				/* ROTATION PART */
+
+	if (rotOrder & STATUS_BIT_ROTZYX)								// Z->Y->X
+	{
+		r[0][0] = cz*cy;	r[0][1] = (sz*cx)+(cz*sy*sx);	r[0][2] = (sz*sx)-(cz*sy*cx);
+		r[1][0] = -sz*cy;	r[1][1] = (cz*cx)-(sz*sy*sx);	r[1][2] = (cz*sx)+(sz*sy*cx);
+		r[2][0] = sy;		r[2][1] = -cy*sx;				r[2][2] = cy*cx;
+	}
+	else
+	if (rotOrder & STATUS_BIT_ROTXZY)								// X->Z->Y
+	{
+		r[0][0] = cz*cy;				r[0][1] = sz;		r[0][2] = -cz*sy;
+		r[1][0] = (sx*sy)-(cx*sz*cy);	r[1][1] = cx*cz;	r[1][2] = (cx*sz*sy)+(sx*cy);
+		r[2][0] = (sx*sz*cy)+(cx*sy);	r[2][1] = -sx*cz;	r[2][2] = (cx*cy)-(sx*sz*sy);
+	}
+	else															// X->Y->Z
+	{
+		r[0][0] = cy*cz;				r[0][1] = cy*sz; 				r[0][2] = -sy;
+		r[1][0] = (sx*sy*cz)-(cx*sz);	r[1][1] = (sx*sy*sz)+(cx*cz);	r[1][2] = sx*cy;
+		r[2][0] = (cx*sy*cz)+(sx*sz);	r[2][1] = (cx*sy*sz)-(sx*cz);	r[2][2] = cx*cy;
+	}
+
+				/* SCALE PRE-MULTIPLIES, SO IT JUST SCALES EACH ROW */
+
+	for (i = 0; i < 3; i++)
+	{
+		float	s = (&scale->x)[i];
+
+		m->value[i][0] = r[i][0] * s;
+		m->value[i][1] = r[i][1] * s;
+		m->value[i][2] = r[i][2] * s;
+		m->value[i][3] = 0;
+	}
+
+				/* TRANSLATE POST-MULTIPLIES, SO IT JUST FILLS IN THE BOTTOM ROW */
+
+	m->value[3][0] = coord->x;
+	m->value[3][1] = coord->y;
+	m->value[3][2] = coord->z;
+	m->value[3][3] = 1;
+}
+
+
+/******************** MULTIPLY AFFINE MATRICES ***********************/
+//
+// result = a * b for matrices whose right column is 0,0,0,1, which is every transform the game builds.
+// Each result row is a0*b[0] + a1*b[1] + a2*b[2] (+ b[3] for the bottom row), written out as four
+// independent lanes so the compiler turns each row into one 4-wide SIMD multiply-add chain
+// (SSE, NEON, AltiVec or wasm SIMD, whichever the target has).  b's right column takes care of
+// the result's right column, so no special case is needed for it.
+//
+// result may point to a or b.
+//
+
+void MultiplyAffineMatrices(const TQ3Matrix4x4 *a, const TQ3Matrix4x4 *b, TQ3Matrix4x4 *result)
+{
+const float		(*bv)[4] = b->value;
+TQ3Matrix4x4	out;
+int				i;
+
+	for (i = 0; i < 4; i++)
+	{
+		float	a0 = a->value[i][0];
+		float	a1 = a->value[i][1];
+		float	a2 = a->value[i][2];
+
+		out.value[i][0] = (a0 * bv[0][0]) + (a1 * bv[1][0]) + (a2 * bv[2][0]);
+		out.value[i][1] = (a0 * bv[0][1]) + (a1 * bv[1][1]) + (a2 * bv[2][1]);
+		out.value[i][2] = (a0 * bv[0][2]) + (a1 * bv[1][2]) + (a2 * bv[2][2]);
+		out.value[i][3] = (a0 * bv[0][3]) + (a1 * bv[1][3]) + (a2 * bv[2][3]);
+	}
+
+	out.value[3][0] += bv[3][0];										// bottom row of a has w = 1, so add b's translation
+	out.value[3][1] += bv[3][1];
+	out.value[3][2] += bv[3][2];
+	out.value[3][3] += bv[3][3];
+
+	*result = out;
+}
+
+
+
 /******************* CALC PLANE EQUATION OF TRIANGLE ********************/
 //
 // input points should be clockwise!
@@ -19,6 +19,7 @@
 
 static void MoveCamera_Manual(void);
 static void MoveCamera_FirstPerson(void);
+static void GetSteadyCameraFromTo(TQ3Point3D *from, TQ3Point3D *lookAt);
 
 
 /****************************/
@@ -213,6 +214,104 @@ float	fps = gFramesPerSecondFrac;
 }
 
 
+/******************** LATE-LATCH CAMERA *************************/
+//
+// Low-latency mode: QD3D_DrawScene calls this after the scene has been queued,
+// right before it's flushed to the GPU.  We re-read the controls, and if a turn or
+// camera swivel was started or stopped since UpdateInput, the view is re-aimed as if
+// the frame had already seen it.  Only the view matrices change, so the queued scene
+// stays valid as-is.
+//
+// Gameplay state is left alone: the player's Rot.y, gCameraViewYAngle and the camera
+// placement that MoveCamera integrates from are all as MoveCamera left them.  The game
+// sees the same input next frame and catches up for real.
+//
+
+void LateLatchCamera(void)
+{
+float				earlyTurn,lateTurn,earlySwivel,lateSwivel,extraYaw,rotY,move,s,c;
+TQ3Point3D			from,lookAt;
+TQ3CameraPlacement	placement;
+
+	if (!gPlayerObj || !gCameraNode || gGamePaused || gPlayerGotKilledFlag)
+		return;
+
+	LateLatchInput();
+
+	earlyTurn	= (gMyControlBits & KEYCONTROL_ROTLEFT) ? 1 : (gMyControlBits & KEYCONTROL_ROTRIGHT) ? -1 : 0;
+	lateTurn	= GetLateNeedState(kNeed_TurnLeft) ? 1 : GetLateNeedState(kNeed_TurnRight) ? -1 : 0;
+
+	extraYaw = 0;
+	if (gMyTurnSlugFactor != 0)													// 0 if the player couldn't turn this frame
+		extraYaw = (lateTurn - earlyTurn) * 2.0f * gMyTurnSlugFactor * gFramesPerSecondFrac;	// same rate as DoPlayerControl
+
+	switch (gCameraMode)
+	{
+				/* FIRST PERSON: SWING THE CAMERA AROUND THE PLAYER BY THE MISSING TURN */
+				//
+				// The player is hidden in this view, so nothing else in the queue has to turn with it.
+				//
+
+		case	CAMERA_MODE_FIRSTPERSON:
+				if (extraYaw == 0 || !IsFirstPersonSteadyCamera())				// head-tracking view can't be fixed up this late
+					return;
+
+				s = sin(extraYaw);
+				c = cos(extraYaw);
+
+				GetSteadyCameraFromTo(&from, &lookAt);
+
+				for (int i = 0; i < 2; i++)
+				{
+					TQ3Point3D* p = i ? &lookAt : &from;
+					float dx = p->x - gPlayerObj->Coord.x;
+					float dz = p->z - gPlayerObj->Coord.z;
+
+					p->x = gPlayerObj->Coord.x + (dx * c) + (dz * s);				// same as Q3Matrix4x4_SetRotate_Y
+					p->z = gPlayerObj->Coord.z - (dx * s) + (dz * c);
+				}
+				break;
+
+				/* MANUAL: MOVE THE CAMERA AS FAR AS MOVECAMERA_MANUAL WOULD HAVE */
+				//
+				// The camera chases a point circling the player at Rot.y + gCameraViewYAngle,
+				// closing gCameraFromAccel * fps of the gap each frame.  A late turn or swivel
+				// moves that point, so the camera gets the same fraction of the point's move.
+				//
+
+		case	CAMERA_MODE_MANUAL:
+				earlySwivel	= GetNeedState(kNeed_CameraLeft) ? -1 : GetNeedState(kNeed_CameraRight) ? 1 : 0;
+				lateSwivel	= GetLateNeedState(kNeed_CameraLeft) ? -1 : GetLateNeedState(kNeed_CameraRight) ? 1 : 0;
+
+				extraYaw += (lateSwivel - earlySwivel) * 2.0f * gFramesPerSecondFrac;	// same rate as MoveCamera
+				if (extraYaw == 0)
+					return;
+
+				rotY = gPlayerObj->Rot.y + gCameraViewYAngle;				// where MoveCamera_Manual aimed this frame
+				move = gFramesPerSecondFrac * gCameraFromAccel * gCameraDistFromMe;
+
+				from	= gGameViewInfoPtr->cameraPlacement.cameraLocation;
+				lookAt	= gGameViewInfoPtr->cameraPlacement.pointOfInterest;
+				from.x += move * (sin(rotY + extraYaw) - sin(rotY));
+				from.z += move * (cos(rotY + extraYaw) - cos(rotY));
+				break;
+
+		default:
+				return;
+	}
+
+			/* RELOAD THE VIEW MATRICES, BUT KEEP THE CAMERA WHERE THE GAME PUT IT */
+
+	placement = gGameViewInfoPtr->cameraPlacement;
+
+	QD3D_UpdateCameraFromTo(gGameViewInfoPtr, &from, &lookAt);					// also reloads the GL matrices
+
+	gGameViewInfoPtr->cameraPlacement = placement;								// next frame's camera moves on from here
+
+	UseLateInputSample();														// this frame now reflects the late sample
+}
+
+
 /********************** FILL PROJECTION MATRIX ************************/
 //
 // Equivalent to gluPerspective
@@ -497,12 +596,20 @@ static void MoveCamera_FirstPerson(void)
 	{
 			/* OTHERWISE STEADY CAM AT FIXED OFFSET FROM OBJNODE'S CENTER POINT */
 
-		from	= (TQ3Point3D) {0, 60, -50};
-		lookAt	= (TQ3Point3D) {0, 60, -100};
-		Q3Point3D_Transform(&from, &gPlayerObj->BaseTransformMatrix, &from);
-		Q3Point3D_Transform(&lookAt, &gPlayerObj->BaseTransformMatrix, &lookAt);
+		GetSteadyCameraFromTo(&from, &lookAt);
 	}
 
 	QD3D_UpdateCameraFromTo(gGameViewInfoPtr, &from, &lookAt);
 }
 
+
+/************************ GET STEADY CAMERA FROM/TO *********************************/
+
+static void GetSteadyCameraFromTo(TQ3Point3D *from, TQ3Point3D *lookAt)
+{
+	*from	= (TQ3Point3D) {0, 60, -50};
+	*lookAt	= (TQ3Point3D) {0, 60, -100};
+	Q3Point3D_Transform(from, &gPlayerObj->BaseTransformMatrix, from);
+	Q3Point3D_Transform(lookAt, &gPlayerObj->BaseTransformMatrix, lookAt);
+}
+
@@ -0,0 +1,220 @@
+/****************************/
+/*   	DYNAMIC LIGHTS.C    */
+/****************************/
+//
+// Short-lived point lights for explosions, shots, fireballs and the jetpack flame.
+//
+// Game code calls AddDynamicLight on every frame that it wants a light (usually from a
+// move routine), and the list is emptied once the frame has been drawn.
+//
+// Fixed-function GL only has 8 lights and the level's fill lights take the first
+// MAX_FILL_LIGHTS, so the renderer gives each mesh queue entry the nearest few lights
+// that reach its bounding sphere.  Lighting is per-vertex like the fill lights, so a
+// light much smaller than a terrain polygon barely shows on the ground.
+//
+// Meshes drawn with STATUS_BIT_NULLSHADER (which includes baked lighting) aren't lit.
+//
+
+
+/****************************/
+/*    EXTERNALS             */
+/****************************/
+
+#include "game.h"
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	FIRST_DYNAMIC_GL_LIGHT		(GL_LIGHT0 + MAX_FILL_LIGHTS)
+#define	EDGE_ATTENUATION			25.0f					// a light is this many times dimmer at its radius
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+typedef struct
+{
+	TQ3Point3D		where;
+	TQ3ColorRGB		color;
+	float			radius;
+}DynamicLight;
+
+static	DynamicLight	gDynamicLights[MAX_DYNAMIC_LIGHTS];
+static	int				gNumDynamicLights = 0;
+static	int				gBoundLights[MAX_DYNAMIC_LIGHTS_PER_MESH] = {-1,-1,-1,-1};	// light in each GL slot, -1 = off
+static	int				gNumBoundLights = 0;
+
+SDL_COMPILE_TIME_ASSERT(boundLightsInit, MAX_DYNAMIC_LIGHTS_PER_MESH == 4);		// keep gBoundLights' initializer in sync
+
+
+/******************** ADD DYNAMIC LIGHT ***********************/
+//
+// Lights the area around a point for this frame only.
+// Extra lights past MAX_DYNAMIC_LIGHTS are ignored.
+//
+// Parallel move routines may call this: on a worker thread, the light is added
+// at the object's turn in MoveObjects like a deferred spawn (see DeferObjectSpawn).
+//
+
+static void AddDynamicLightNow(const void* params)
+{
+	const DynamicLight* newLight = (const DynamicLight*) params;
+
+	if (gNumDynamicLights >= MAX_DYNAMIC_LIGHTS)
+		return;
+
+	gDynamicLights[gNumDynamicLights++] = *newLight;
+}
+
+void AddDynamicLight(const TQ3Point3D* where, const TQ3ColorRGB* color, float radius)
+{
+	if (radius <= 0)
+		return;
+
+	DynamicLight light = { .where = *where, .color = *color, .radius = radius };
+	DeferObjectSpawn(AddDynamicLightNow, &light, sizeof(light));
+}
+
+
+int DynamicLights_Count(void)
+{
+	return gNumDynamicLights;
+}
+
+
+/******************** DYNAMIC LIGHTS: BIND ***********************/
+//
+// Turns on the (up to) MAX_DYNAMIC_LIGHTS_PER_MESH lights nearest to a bounding sphere,
+// and turns off the rest.  Lights that are already in a GL slot stay there.
+//
+// The renderer calls this for each lit mesh queue entry, while the modelview matrix
+// is still the camera's (GL transforms light positions by it).
+//
+
+void DynamicLights_Bind(const TQ3Point3D* center, float radius)
+{
+int		chosen[MAX_DYNAMIC_LIGHTS_PER_MESH];
+float	chosenDist2[MAX_DYNAMIC_LIGHTS_PER_MESH];
+int		numChosen = 0;
+Uint64	startTime;
+
+	if (gNumDynamicLights == 0 && gNumBoundLights == 0)
+		return;
+
+	startTime = SDL_GetPerformanceCounter();
+
+			/* PICK THE NEAREST LIGHTS THAT REACH THE SPHERE */
+
+	for (int i = 0; i < gNumDynamicLights; i++)
+	{
+		const DynamicLight* light = &gDynamicLights[i];
+		float dx = light->where.x - center->x;
+		float dy = light->where.y - center->y;
+		float dz = light->where.z - center->z;
+		float dist2 = dx*dx + dy*dy + dz*dz;
+		float reach = light->radius + radius;
+
+		if (dist2 >= reach*reach)
+			continue;
+
+		int slot = numChosen < MAX_DYNAMIC_LIGHTS_PER_MESH ? numChosen++ : MAX_DYNAMIC_LIGHTS_PER_MESH;
+		while (slot > 0 && chosenDist2[slot-1] > dist2)				// insertion sort, nearest first
+		{
+			if (slot < MAX_DYNAMIC_LIGHTS_PER_MESH)
+			{
+				chosen[slot] = chosen[slot-1];
+				chosenDist2[slot] = chosenDist2[slot-1];
+			}
+			slot--;
+		}
+		if (slot < MAX_DYNAMIC_LIGHTS_PER_MESH)
+		{
+			chosen[slot] = i;
+			chosenDist2[slot] = dist2;
+		}
+	}
+
+			/* FREE THE GL SLOTS OF LIGHTS THAT WEREN'T CHOSEN */
+
+	for (int s = 0; s < MAX_DYNAMIC_LIGHTS_PER_MESH; s++)
+	{
+		if (gBoundLights[s] < 0)
+			continue;
+
+		bool keep = false;
+		for (int c = 0; c < numChosen; c++)
+		{
+			if (chosen[c] == gBoundLights[s])
+			{
+				chosen[c] = -1;											// already in place
+				keep = true;
+				break;
+			}
+		}
+
+		if (!keep)
+		{
+			glDisable(FIRST_DYNAMIC_GL_LIGHT + s);
+			gBoundLights[s] = -1;
+			gNumBoundLights--;
+		}
+	}
+
+			/* PUT THE NEW ONES IN THE FREE SLOTS */
+
+	int s = 0;
+	for (int c = 0; c < numChosen; c++)
+	{
+		if (chosen[c] < 0)
+			continue;
+
+		while (gBoundLights[s] >= 0)
+			s++;
+
+		const DynamicLight* light = &gDynamicLights[chosen[c]];
+		GLenum glLight = FIRST_DYNAMIC_GL_LIGHT + s;
+		GLfloat position[4] = { light->where.x, light->where.y, light->where.z, 1 };		// w=1: point light
+		GLfloat diffuse[4] = { light->color.r, light->color.g, light->color.b, 1 };
+
+		glLightfv(glLight, GL_POSITION, position);
+		glLightfv(glLight, GL_DIFFUSE, diffuse);
+		glLightf(glLight, GL_CONSTANT_ATTENUATION, 1);
+		glLightf(glLight, GL_LINEAR_ATTENUATION, 0);
+		glLightf(glLight, GL_QUADRATIC_ATTENUATION, (EDGE_ATTENUATION - 1) / (light->radius * light->radius));
+		glEnable(glLight);
+
+		gBoundLights[s] = chosen[c];
+		gNumBoundLights++;
+		gRenderStats.dynamicLightBinds++;
+	}
+
+	gRenderStats.dynamicLightMilliseconds += (SDL_GetPerformanceCounter() - startTime) * 1000.0f / SDL_GetPerformanceFrequency();
+}
+
+
+/******************** DYNAMIC LIGHTS: END FRAME ***********************/
+//
+// Turns the GL lights off and empties the list for the next frame.
+// While the game is paused, nothing moves, so the lights are kept for the next paused frame.
+//
+
+void DynamicLights_EndFrame(void)
+{
+	gRenderStats.dynamicLights = gNumDynamicLights;
+
+	for (int s = 0; s < MAX_DYNAMIC_LIGHTS_PER_MESH; s++)
+	{
+		if (gBoundLights[s] >= 0)
+		{
+			glDisable(FIRST_DYNAMIC_GL_LIGHT + s);
+			gBoundLights[s] = -1;
+		}
+	}
+	gNumBoundLights = 0;
+
+	if (!gGamePaused)
+		gNumDynamicLights = 0;
+}
@@ -0,0 +1,616 @@
+/****************************/
+/*   	MESH LOD.C		    */
+/****************************/
+//
+// Load-time mesh simplifier.
+//
+// Reduced levels are built with quadric error metric (QEM) half-edge collapses:
+// a vertex is always collapsed ONTO one of its neighbors, never moved to a new position.
+// The reduced levels are therefore just alternate triangle lists over the original
+// vertex arrays -- no attribute interpolation, and skinned meshes keep working as-is.
+//
+
+
+/****************************/
+/*    EXTERNALS             */
+/****************************/
+
+#include "game.h"
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+typedef struct
+{
+	double	q[10];						// symmetric 4x4: aa ab ac ad bb bc bd cc cd dd
+}Quadric;
+
+typedef struct
+{
+	int		from;
+	int		to;
+	double	cost;
+}CollapseCandidate;
+
+static void Quadric_AddPlane(Quadric* quadric, double a, double b, double c, double d);
+static double Quadric_Error(const Quadric* q1, const Quadric* q2, const TQ3Point3D* p);
+static int CompareCollapseCandidates(const void* a, const void* b);
+static int CompareEdgeKeys(const void* a, const void* b);
+static bool CollapseFlipsTriangles(int from, int to, const TQ3Point3D* points, const uint32_t* tris, const Byte* triDead,
+									const int* vertFirstCorner, const int* cornerNext);
+static int SimplifyTriMesh(const TQ3TriMeshData* mesh, const int* vertexGroups, int targetTriangles, float maxError,
+							TQ3TriMeshTriangleData* outTriangles);
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	LOD_MIN_TRIANGLES		64				// objects with fewer triangles than this aren't worth simplifying
+#define	LOD_MIN_SAVINGS			.8f				// keep a level only if it has at most 80% of the previous level's triangles
+#define	LOD_MAX_PASSES			40
+#define	LOD_MIN_FLIP_DOT		.2f				// reject collapses that rotate a face normal by more than ~78 degrees
+
+static const float kLODTriangleRatio[MESHLOD_MAX_LEVELS]	= { 1.0f, .50f, .25f };
+static const float kLODMaxError[MESHLOD_MAX_LEVELS]			= { 0.0f, .02f, .05f };		// max geometric error (fraction of object radius)
+static const float kLODMaxScreenSize[MESHLOD_MAX_LEVELS]	= { 0.0f, .12f, .05f };		// fraction of the view's half-height
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+
+
+/******************** MESH LOD: BUILD ***********************/
+//
+// Builds reduced-detail triangle lists for an object made of several trimeshes.
+//
+// INPUT:	vertexGroups = optional. If non-nil, vertexGroups[meshNum][pointNum] is a group id
+//						   (e.g. the bone a vertex is attached to), and vertices are only ever
+//						   collapsed onto vertices in the same group.
+//			radius = radius of the object, used to scale the error bounds.
+//
+// OUTPUT:	nil if the object doesn't benefit from reduced levels.
+//
+
+MeshLODSet* MeshLOD_Build(int numMeshes, TQ3TriMeshData** meshList, int** vertexGroups, float radius)
+{
+int		totalTriangles = 0;
+
+	GAME_ASSERT(numMeshes <= MAX_DECOMPOSED_TRIMESHES);
+
+	for (int i = 0; i < numMeshes; i++)
+		totalTriangles += meshList[i]->numTriangles;
+
+	if (totalTriangles < LOD_MIN_TRIANGLES || radius <= 0)
+		return nil;
+
+	MeshLODSet* lodSet = (MeshLODSet*) NewPtrClear(sizeof(MeshLODSet));
+	GAME_ASSERT(lodSet);
+
+	lodSet->numMeshes = numMeshes;
+	lodSet->numLevels = 1;
+	lodSet->numTriangles[0] = totalTriangles;
+
+	lodSet->sourceMeshes = (const TQ3TriMeshData**) AllocPtr(sizeof(TQ3TriMeshData*) * numMeshes);
+	GAME_ASSERT(lodSet->sourceMeshes);
+
+	for (int i = 0; i < numMeshes; i++)
+		lodSet->sourceMeshes[i] = meshList[i];
+
+	int prevTotal = totalTriangles;
+
+	for (int level = 1; level < MESHLOD_MAX_LEVELS; level++)
+	{
+		MeshLODTriangleList* lists = (MeshLODTriangleList*) NewPtrClear(sizeof(MeshLODTriangleList) * numMeshes);
+		GAME_ASSERT(lists);
+
+		int levelTotal = 0;
+
+		for (int i = 0; i < numMeshes; i++)
+		{
+			const TQ3TriMeshData* mesh = meshList[i];
+
+			lists[i].triangles = (TQ3TriMeshTriangleData*) AllocPtr(sizeof(TQ3TriMeshTriangleData) * (mesh->numTriangles + 1));
+			GAME_ASSERT(lists[i].triangles);
+
+			int target = (int)(mesh->numTriangles * kLODTriangleRatio[level]);
+
+			lists[i].numTriangles = SimplifyTriMesh(mesh, vertexGroups ? vertexGroups[i] : nil,
+													target, kLODMaxError[level] * radius, lists[i].triangles);
+			levelTotal += lists[i].numTriangles;
+		}
+
+				/* SEE IF THIS LEVEL IS WORTH KEEPING */
+
+		if (levelTotal > prevTotal * LOD_MIN_SAVINGS)
+		{
+			for (int i = 0; i < numMeshes; i++)
+				DisposePtr((Ptr) lists[i].triangles);
+			DisposePtr((Ptr) lists);
+			break;									// coarser levels wouldn't do any better
+		}
+
+		lodSet->levels[level] = lists;
+		lodSet->numTriangles[level] = levelTotal;
+		lodSet->maxScreenSize[level] = kLODMaxScreenSize[level];
+		lodSet->numLevels++;
+
+		prevTotal = levelTotal;
+	}
+
+	if (lodSet->numLevels == 1)						// nothing could be reduced
+	{
+		MeshLOD_Dispose(lodSet);
+		return nil;
+	}
+
+	return lodSet;
+}
+
+
+/******************** MESH LOD: DISPOSE ***********************/
+
+void MeshLOD_Dispose(MeshLODSet* lodSet)
+{
+	if (!lodSet)
+		return;
+
+	for (int level = 1; level < MESHLOD_MAX_LEVELS; level++)
+	{
+		if (!lodSet->levels[level])
+			continue;
+
+		for (int i = 0; i < lodSet->numMeshes; i++)
+			DisposePtr((Ptr) lodSet->levels[level][i].triangles);
+
+		DisposePtr((Ptr) lodSet->levels[level]);
+		lodSet->levels[level] = nil;
+	}
+
+	if (lodSet->sourceMeshes)
+		DisposePtr((Ptr) lodSet->sourceMeshes);
+
+	DisposePtr((Ptr) lodSet);
+}
+
+
+/******************** MESH LOD: MATCHES MESHES ***********************/
+//
+// See if a set was built from exactly these meshes. The reduced triangle lists reference
+// the source meshes' vertices, so they are only valid for the meshes they were built from.
+//
+
+Boolean MeshLOD_MatchesMeshes(const MeshLODSet* lodSet, int numMeshes, TQ3TriMeshData** meshList)
+{
+	if (lodSet->numMeshes != numMeshes)
+		return false;
+
+	for (int i = 0; i < numMeshes; i++)
+	{
+		if (lodSet->sourceMeshes[i] != meshList[i])
+			return false;
+	}
+
+	return true;
+}
+
+
+/******************** MESH LOD: SELECT LEVEL ***********************/
+//
+// Picks a level based on how much of the view the object's bounding sphere covers.
+//
+// INPUT:	radius = world-space radius of the object
+//			distance = distance from camera to object's center
+//			tanHalfFOV = tan(fov/2) of the current camera
+//
+
+int MeshLOD_SelectLevel(const MeshLODSet* lodSet, float radius, float distance, float tanHalfFOV)
+{
+	if (!lodSet || !gGamePrefs.meshLOD)
+		return 0;
+
+	if (distance <= radius)							// camera is inside the object
+		return 0;
+
+	float screenSize = radius / (distance * tanHalfFOV);
+
+	int level = 0;
+	for (int i = 1; i < lodSet->numLevels; i++)
+	{
+		if (screenSize < lodSet->maxScreenSize[i])
+			level = i;
+	}
+
+	return level;
+}
+
+
+#pragma mark -
+
+/******************** QUADRIC: ADD PLANE ***********************/
+//
+// Accumulates the fundamental error quadric of plane ax+by+cz+d=0.
+//
+
+static void Quadric_AddPlane(Quadric* quadric, double a, double b, double c, double d)
+{
+double	*q = quadric->q;
+
+	q[0] += a*a;	q[1] += a*b;	q[2] += a*c;	q[3] += a*d;
+					q[4] += b*b;	q[5] += b*c;	q[6] += b*d;
+									q[7] += c*c;	q[8] += c*d;
+													q[9] += d*d;
+}
+
+
+/******************** QUADRIC: ERROR ***********************/
+//
+// Returns v^T (Q1+Q2) v, i.e. the sum of squared distances from p to the planes of both quadrics.
+//
+
+static double Quadric_Error(const Quadric* q1, const Quadric* q2, const TQ3Point3D* p)
+{
+double	q[10];
+double	x = p->x, y = p->y, z = p->z;
+
+	for (int i = 0; i < 10; i++)
+		q[i] = q1->q[i] + q2->q[i];
+
+	double e =	  q[0]*x*x + 2*q[1]*x*y + 2*q[2]*x*z + 2*q[3]*x
+				+ q[4]*y*y + 2*q[5]*y*z + 2*q[6]*y
+				+ q[7]*z*z + 2*q[8]*z
+				+ q[9];
+
+	return e < 0 ? 0 : e;								// guard against rounding
+}
+
+
+/******************** COMPARE COLLAPSE CANDIDATES ***********************/
+
+static int CompareCollapseCandidates(const void* a, const void* b)
+{
+	double ca = ((const CollapseCandidate*) a)->cost;
+	double cb = ((const CollapseCandidate*) b)->cost;
+
+	if (ca < cb) return -1;
+	if (ca > cb) return 1;
+	return 0;
+}
+
+
+/******************** COMPARE EDGE KEYS ***********************/
+
+static int CompareEdgeKeys(const void* a, const void* b)
+{
+	uint64_t ka = *(const uint64_t*) a;
+	uint64_t kb = *(const uint64_t*) b;
+
+	if (ka < kb) return -1;
+	if (ka > kb) return 1;
+	return 0;
+}
+
+
+/******************** COLLAPSE FLIPS TRIANGLES ***********************/
+//
+// Returns true if moving vertex "from" onto vertex "to" would fold over
+// (or degenerate) any of the triangles around "from" that survive the collapse.
+//
+
+static bool CollapseFlipsTriangles(int from, int to, const TQ3Point3D* points, const uint32_t* tris, const Byte* triDead,
+									const int* vertFirstCorner, const int* cornerNext)
+{
+	for (int corner = vertFirstCorner[from]; corner >= 0; corner = cornerNext[corner])
+	{
+		int t = corner / 3;
+		if (triDead[t])
+			continue;
+
+		const uint32_t* tri = &tris[t*3];
+		if (tri[0] == (uint32_t)to || tri[1] == (uint32_t)to || tri[2] == (uint32_t)to)
+			continue;											// this one will disappear
+
+		int k = corner % 3;
+		const TQ3Point3D* p0 = &points[tri[(k+1)%3]];
+		const TQ3Point3D* p1 = &points[tri[(k+2)%3]];
+		const TQ3Point3D* pOld = &points[from];
+		const TQ3Point3D* pNew = &points[to];
+
+		TQ3Vector3D e0 = { p0->x - pOld->x, p0->y - pOld->y, p0->z - pOld->z };
+		TQ3Vector3D e1 = { p1->x - pOld->x, p1->y - pOld->y, p1->z - pOld->z };
+		TQ3Vector3D f0 = { p0->x - pNew->x, p0->y - pNew->y, p0->z - pNew->z };
+		TQ3Vector3D f1 = { p1->x - pNew->x, p1->y - pNew->y, p1->z - pNew->z };
+		TQ3Vector3D nOld, nNew;
+
+		Q3Vector3D_Cross(&e0, &e1, &nOld);
+		Q3Vector3D_Cross(&f0, &f1, &nNew);
+
+		float dot = Q3Vector3D_Dot(&nOld, &nNew);
+		float lenSq = Q3Vector3D_Dot(&nOld, &nOld) * Q3Vector3D_Dot(&nNew, &nNew);
+
+		if (dot <= 0 || dot*dot < LOD_MIN_FLIP_DOT*LOD_MIN_FLIP_DOT * lenSq)
+			return true;
+	}
+
+	return false;
+}
+
+
+/******************** SIMPLIFY TRIMESH ***********************/
+//
+// Greedy QEM simplification: each pass sorts all legal collapses by error and performs
+// as many as possible without touching the same neighborhood twice, until the target
+// triangle count or the error bound is reached.
+//
+// Vertices on open edges (holes, UV seams, hard-edge splits) are never collapsed so that
+// seams stay watertight and texture coordinates stay put.
+//
+// OUTPUT:	# triangles written to outTriangles (at most mesh->numTriangles)
+//
+
+static int SimplifyTriMesh(const TQ3TriMeshData* mesh, const int* vertexGroups, int targetTriangles, float maxError,
+							TQ3TriMeshTriangleData* outTriangles)
+{
+const int			numPoints		= mesh->numPoints;
+const int			numTriangles	= mesh->numTriangles;
+const int			numCorners		= numTriangles * 3;
+const TQ3Point3D	*points			= mesh->points;
+const double		maxErrorSq		= (double)maxError * (double)maxError;
+
+	if (numTriangles == 0)
+		return 0;
+
+			/* ALLOC WORK BUFFERS */
+
+	Quadric*			quadrics		= (Quadric*) NewPtrClear(sizeof(Quadric) * numPoints);
+	uint32_t*			tris			= (uint32_t*) AllocPtr(sizeof(uint32_t) * numCorners);
+	Byte*				triDead			= (Byte*) NewPtrClear(numTriangles);
+	Byte*				vertLocked		= (Byte*) NewPtrClear(numPoints);
+	Byte*				vertBorder		= (Byte*) NewPtrClear(numPoints);
+	int*				vertFirstCorner	= (int*) AllocPtr(sizeof(int) * numPoints);
+	int*				vertLastCorner	= (int*) AllocPtr(sizeof(int) * numPoints);
+	int*				cornerNext		= (int*) AllocPtr(sizeof(int) * numCorners);
+	uint64_t*			edgeKeys		= (uint64_t*) AllocPtr(sizeof(uint64_t) * numCorners);
+	CollapseCandidate*	candidates		= (CollapseCandidate*) AllocPtr(sizeof(CollapseCandidate) * numCorners * 2);
+
+	GAME_ASSERT(quadrics && tris && triDead && vertLocked && vertBorder && vertFirstCorner
+				&& vertLastCorner && cornerNext && edgeKeys && candidates);
+
+	for (int c = 0; c < numCorners; c++)
+		tris[c] = mesh->triangles[c/3].pointIndices[c%3];
+
+
+			/* BUILD VERTEX -> CORNER LISTS */
+			//
+			// Invariant: every corner in vertex v's list satisfies tris[corner] == v.
+			//
+
+	for (int v = 0; v < numPoints; v++)
+		vertFirstCorner[v] = vertLastCorner[v] = -1;
+
+	for (int c = 0; c < numCorners; c++)
+	{
+		int v = tris[c];
+		cornerNext[c] = -1;
+		if (vertLastCorner[v] < 0)
+			vertFirstCorner[v] = c;
+		else
+			cornerNext[vertLastCorner[v]] = c;
+		vertLastCorner[v] = c;
+	}
+
+
+			/* ACCUMULATE FACE QUADRICS */
+
+	for (int t = 0; t < numTriangles; t++)
+	{
+		const TQ3Point3D* p0 = &points[tris[t*3+0]];
+		const TQ3Point3D* p1 = &points[tris[t*3+1]];
+		const TQ3Point3D* p2 = &points[tris[t*3+2]];
+		TQ3Vector3D	e0 = { p1->x - p0->x, p1->y - p0->y, p1->z - p0->z };
+		TQ3Vector3D	e1 = { p2->x - p0->x, p2->y - p0->y, p2->z - p0->z };
+		TQ3Vector3D	n;
+
+		Q3Vector3D_Cross(&e0, &e1, &n);
+		float len = Q3Vector3D_Length(&n);
+		if (len < 1e-8f)
+			continue;												// degenerate input triangle
+		n.x /= len;
+		n.y /= len;
+		n.z /= len;
+		double d = -(n.x*p0->x + n.y*p0->y + n.z*p0->z);
+
+		for (int k = 0; k < 3; k++)
+			Quadric_AddPlane(&quadrics[tris[t*3+k]], n.x, n.y, n.z, d);
+	}
+
+
+			/* FIND OPEN EDGES */
+			//
+			// An edge referenced by a single triangle is an open edge.
+			// Sort the undirected edge keys and look for keys that appear once.
+			//
+
+	for (int c = 0; c < numCorners; c++)
+	{
+		uint32_t a = tris[c];
+		uint32_t b = tris[(c/3)*3 + (c+1)%3];
+		uint32_t lo = a < b ? a : b;
+		uint32_t hi = a < b ? b : a;
+		edgeKeys[c] = ((uint64_t)lo << 32) | hi;
+	}
+
+	SDL_qsort(edgeKeys, numCorners, sizeof(uint64_t), CompareEdgeKeys);
+
+	for (int c = 0; c < numCorners; )
+	{
+		int run = 1;
+		while (c + run < numCorners && edgeKeys[c + run] == edgeKeys[c])
+			run++;
+
+		if (run == 1)
+		{
+			vertBorder[edgeKeys[c] >> 32] = true;
+			vertBorder[edgeKeys[c] & 0xffffffff] = true;
+		}
+
+		c += run;
+	}
+
+
+			/***********************/
+			/* COLLAPSE EDGES      */
+			/***********************/
+
+	int liveTriangles = numTriangles;
+
+	for (int pass = 0; pass < LOD_MAX_PASSES && liveTriangles > targetTriangles; pass++)
+	{
+				/* GATHER LEGAL COLLAPSES FROM LIVE TRIANGLES */
+
+		int numCandidates = 0;
+
+		for (int t = 0; t < numTriangles; t++)
+		{
+			if (triDead[t])
+				continue;
+
+			for (int k = 0; k < 3; k++)
+			{
+				int a = tris[t*3 + k];
+				int b = tris[t*3 + (k+1)%3];
+
+				for (int dir = 0; dir < 2; dir++)
+				{
+					int from = dir ? b : a;
+					int to = dir ? a : b;
+
+					if (from == to || vertBorder[from])
+						continue;
+					if (vertexGroups && vertexGroups[from] != vertexGroups[to])
+						continue;
+
+					double cost = Quadric_Error(&quadrics[from], &quadrics[to], &points[to]);
+					if (cost > maxErrorSq)
+						continue;
+
+					candidates[numCandidates].from = from;
+					candidates[numCandidates].to = to;
+					candidates[numCandidates].cost = cost;
+					numCandidates++;
+				}
+			}
+		}
+
+		if (numCandidates == 0)
+			break;
+
+		SDL_qsort(candidates, numCandidates, sizeof(CollapseCandidate), CompareCollapseCandidates);
+		SDL_memset(vertLocked, 0, numPoints);
+
+
+				/* DO AS MANY NON-OVERLAPPING COLLAPSES AS POSSIBLE */
+
+		int numCollapses = 0;
+
+		for (int i = 0; i < numCandidates && liveTriangles > targetTriangles; i++)
+		{
+			int from = candidates[i].from;
+			int to = candidates[i].to;
+
+			if (vertLocked[from] || vertLocked[to])
+				continue;
+
+			if (vertFirstCorner[from] < 0)								// already collapsed
+				continue;
+
+			if (CollapseFlipsTriangles(from, to, points, tris, triDead, vertFirstCorner, cornerNext))
+				continue;
+
+					/* REWIRE TRIANGLES FROM -> TO */
+
+			for (int corner = vertFirstCorner[from]; corner >= 0; corner = cornerNext[corner])
+			{
+				int t = corner / 3;
+				if (triDead[t])
+					continue;
+
+				uint32_t* tri = &tris[t*3];
+				if (tri[0] == (uint32_t)to || tri[1] == (uint32_t)to || tri[2] == (uint32_t)to)
+				{
+					triDead[t] = true;									// edge from-to is gone, so is this triangle
+					liveTriangles--;
+				}
+
+				tris[corner] = to;
+			}
+
+					/* MERGE CORNER LISTS & QUADRICS */
+
+			if (vertLastCorner[to] < 0)
+				vertFirstCorner[to] = vertFirstCorner[from];
+			else
+				cornerNext[vertLastCorner[to]] = vertFirstCorner[from];
+			vertLastCorner[to] = vertLastCorner[from];
+			vertFirstCorner[from] = vertLastCorner[from] = -1;
+
+			for (int k = 0; k < 10; k++)
+				quadrics[to].q[k] += quadrics[from].q[k];
+
+					/* LOCK THE NEIGHBORHOOD FOR THE REST OF THIS PASS */
+
+			for (int corner = vertFirstCorner[to]; corner >= 0; corner = cornerNext[corner])
+			{
+				int t = corner / 3;
+				if (triDead[t])
+					continue;
+				vertLocked[tris[t*3+0]] = true;
+				vertLocked[tris[t*3+1]] = true;
+				vertLocked[tris[t*3+2]] = true;
+			}
+			vertLocked[from] = true;
+			vertLocked[to] = true;
+
+			numCollapses++;
+		}
+
+		if (numCollapses == 0)
+			break;
+	}
+
+
+			/* WRITE OUT SURVIVING TRIANGLES */
+
+	int numOut = 0;
+
+	for (int t = 0; t < numTriangles; t++)
+	{
+		if (triDead[t])
+			continue;
+
+		outTriangles[numOut].pointIndices[0] = tris[t*3+0];
+		outTriangles[numOut].pointIndices[1] = tris[t*3+1];
+		outTriangles[numOut].pointIndices[2] = tris[t*3+2];
+		numOut++;
+	}
+
+
+			/* FREE WORK BUFFERS */
+
+	DisposePtr((Ptr) quadrics);
+	DisposePtr((Ptr) tris);
+	DisposePtr((Ptr) triDead);
+	DisposePtr((Ptr) vertLocked);
+	DisposePtr((Ptr) vertBorder);
+	DisposePtr((Ptr) vertFirstCorner);
+	DisposePtr((Ptr) vertLastCorner);
+	DisposePtr((Ptr) cornerNext);
+	DisposePtr((Ptr) edgeKeys);
+	DisposePtr((Ptr) candidates);
+
+	return numOut;
+}
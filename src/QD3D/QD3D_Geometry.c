@@ -441,6 +441,8 @@ void QD3D_ScrollUVs(int numMeshes, TQ3TriMeshData** meshList, float rawDeltaU, f
 
 		GAME_ASSERT(mesh->vertexUVs);
 
+		Render_ReleaseStaticMesh(mesh);							// UVs change every frame, so stream them instead
+
 		for (int j = 0; j < mesh->numPoints; j++)
 		{
 			mesh->vertexUVs[j].u += rawDeltaU;
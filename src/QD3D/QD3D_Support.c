@@ -74,6 +74,16 @@ void QD3D_Boot(void)
 		if (typeof Browser !== 'undefined') Browser.useWebGL = true;
 	});
 #endif
+
+#if RENDER_VULKAN
+	// Mirror the 3D view into Vulkan too. Textures & static meshes are copied as GL gets them,
+	// so this must happen before any are loaded.
+	if (gVulkanMode && !VkRender_Init())
+	{
+		SDL_Log("Couldn't start the Vulkan backend; drawing with OpenGL only.");
+		gVulkanMode = false;
+	}
+#endif
 }
 
 
@@ -81,6 +91,10 @@ void QD3D_Boot(void)
 
 void QD3D_Shutdown(void)
 {
+#if RENDER_VULKAN
+	VkRender_Shutdown();
+#endif
+
 	if (gGLContext)
 	{
 		SDL_GL_DestroyContext(gGLContext);
@@ -181,6 +195,7 @@ QD3DSetupOutputType	*outputPtr;
 	outputPtr->cameraPlacement.cameraLocation		= setupDefPtr->camera.from;
 
 	outputPtr->lights = setupDefPtr->lights;
+	outputPtr->lateLatchRoutine = nil;
 
 	outputPtr->isActive = true;							// it's now an active structure
 
@@ -317,6 +332,73 @@ static void CreateLights(QD3DLightDefType *lightDefPtr)
 }
 
 
+/******************* QD3D: BAKE VERTEX LIGHTING ***********************/
+//
+// Works out what the fixed-function lighting set up by CreateLights would give each vertex,
+// so that geometry that never moves can be drawn with lighting off (STATUS_BIT_NULLSHADER)
+// and look the same.
+//
+// The renderer tracks ambient & diffuse with glColor (GL_COLOR_MATERIAL) and the fill lights
+// have no ambient or specular part, so a lit vertex is just:
+//		diffuse * (global ambient + sum of max(N.L, 0) * light color), clamped to 1
+//
+// INPUT:	normals = world-space, normalized
+//			diffuse = the mesh's diffuse color (vertex colors replace glColor, so it's baked in too)
+//
+
+void QD3D_BakeVertexLighting(const QD3DLightDefType* lights, const TQ3ColorRGBA* diffuse,
+							 int numVertices, const TQ3Vector3D* normals, TQ3ColorRGBA* outColors)
+{
+TQ3ColorRGB		ambient;
+TQ3Vector3D		toLight[MAX_FILL_LIGHTS];
+TQ3ColorRGB		lightColor[MAX_FILL_LIGHTS];
+
+	if (lights->ambientBrightness != 0)
+	{
+		ambient.r = lights->ambientBrightness * lights->ambientColor.r;
+		ambient.g = lights->ambientBrightness * lights->ambientColor.g;
+		ambient.b = lights->ambientBrightness * lights->ambientColor.b;
+	}
+	else
+	{
+		ambient.r = ambient.g = ambient.b = .2f;				// CreateLights leaves GL's default global ambient alone
+	}
+
+	for (int i = 0; i < lights->numFillLights; i++)
+	{
+		Q3Vector3D_Normalize(&lights->fillDirection[i], &toLight[i]);
+		toLight[i].x = -toLight[i].x;							// fill direction points away from the light
+		toLight[i].y = -toLight[i].y;
+		toLight[i].z = -toLight[i].z;
+
+		lightColor[i].r = lights->fillColor[i].r * lights->fillBrightness[i];
+		lightColor[i].g = lights->fillColor[i].g * lights->fillBrightness[i];
+		lightColor[i].b = lights->fillColor[i].b * lights->fillBrightness[i];
+	}
+
+	for (int v = 0; v < numVertices; v++)
+	{
+		TQ3ColorRGB lit = ambient;
+
+		for (int i = 0; i < lights->numFillLights; i++)
+		{
+			float dot = Q3Vector3D_Dot(&normals[v], &toLight[i]);
+			if (dot > 0)
+			{
+				lit.r += dot * lightColor[i].r;
+				lit.g += dot * lightColor[i].g;
+				lit.b += dot * lightColor[i].b;
+			}
+		}
+
+		outColors[v].r = SDL_min(1.0f, lit.r * diffuse->r);
+		outColors[v].g = SDL_min(1.0f, lit.g * diffuse->g);
+		outColors[v].b = SDL_min(1.0f, lit.b * diffuse->b);
+		outColors[v].a = diffuse->a;
+	}
+}
+
+
 
 
 
@@ -369,11 +451,22 @@ void QD3D_DrawScene(QD3DSetupOutputType *setupInfo, void (*drawRoutine)(QD3DSetu
 	if (drawRoutine)
 		drawRoutine(setupInfo);
 
+			/* LATE-LATCH INPUT */
+			//
+			// Everything is still sitting in the mesh queue, so re-aiming the camera
+			// here changes what gets drawn by Render_EndFrame.
+			//
+
+	if (gGamePrefs.lowLatencyInput && setupInfo->lateLatchRoutine)
+		setupInfo->lateLatchRoutine();
+
 			/* DONE RENDERING */
 
 	Render_EndFrame();
 
 	SDL_GL_SwapWindow(gSDLWindow);
+
+	MeasureInputLatency();
 }
 
 
@@ -429,6 +522,26 @@ void QD3D_OnWindowResized(void)
 	SDL_GetWindowSizeInPixels(gSDLWindow, &gWindowWidth, &gWindowHeight);
 }
 
+/****************** QD3D SET YON ***********************/
+//
+// Moves the far clip plane of an existing view.
+// The projection matrix picks up setupInfo->yon on the next frame;
+// fog is set relative to hither/yon, so redo it to match.
+//
+
+void QD3D_SetYon(QD3DSetupOutputType *setupInfo, float yon)
+{
+	setupInfo->yon = yon;
+
+	if (setupInfo->lights.useFog && gGamePrefs.canDoFog)
+	{
+		float camHither = setupInfo->hither;
+		glFogf(GL_FOG_START,	camHither + setupInfo->lights.fogHither * (yon - camHither));
+		glFogf(GL_FOG_END,		camHither + setupInfo->lights.fogYon    * (yon - camHither));
+	}
+}
+
+
 /************** QD3D CALC FRAMES PER SECOND *****************/
 
 void QD3D_CalcFramesPerSecond(void)
@@ -481,6 +594,9 @@ void QD3D_CalcFramesPerSecond(void)
 
 	gFramesPerSecondFrac = 1.0f / gFramesPerSecond;		// calc fractional for multiplication
 
+	if (prevTime != 0)
+		Metrics_EndFrame(deltaTime * 1000.0 / performanceFrequency);
+
 	prevTime = currTime;								// reset for next time interval
 
 
@@ -488,6 +604,7 @@ void QD3D_CalcFramesPerSecond(void)
 
 	if (gGamePrefs.debugInfoInTitleBar)
 	{
+		static const char* kAntialiasingNames[5] = { "noAA", "MSAA2x", "MSAA4x", "MSAA8x", "FXAA" };
 		uint32_t ticksNow = SDL_GetTicks();
 		uint32_t ticksElapsed = ticksNow - gDebugTextLastUpdatedAt;
 		if (ticksElapsed >= gDebugTextUpdateInterval)
@@ -495,12 +612,17 @@ void QD3D_CalcFramesPerSecond(void)
 			float fps = 1000 * gDebugTextFrameAccumulator / (float)ticksElapsed;
 			SDL_snprintf(
 					gDebugTextBuffer, sizeof(gDebugTextBuffer),
-					"%s%s %s - %dfps %dt %dm %dn %dp %dK x:%.0f z:%.0f",
+					"%s%s %s - %dfps %.2fgpu %.1flat %.2fod %s %dt (-%dlod) %dm %dn %dp %dK x:%.0f z:%.0f",
 					GAME_FULL_NAME,
 					PRO_MODE ? " Extreme" : "",
 					GAME_VERSION,
 					(int)round(fps),
+					gRenderStats.gpuFrameMilliseconds,
+					gRenderStats.inputLatencyMilliseconds,
+					gRenderStats.overdrawAverage,
+					kAntialiasingNames[gGamePrefs.antialiasingLevel == ANTIALIASING_LEVEL_FXAA ? ANTIALIASING_LEVEL_FXAA : gCurrentAntialiasingLevel],
 					gRenderStats.trianglesDrawn,
+					gRenderStats.trianglesSavedByLOD,
 					gRenderStats.meshQueueSize,
 					gObjNodePool? Pool_Size(gObjNodePool): 0,
 					(int)Pomme_GetNumAllocs(),
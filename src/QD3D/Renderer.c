@@ -53,6 +53,14 @@ typedef struct RendererState
 	bool		hasState_GL_LIGHTING;
 	bool		hasState_GL_FOG;
 	bool		hasFlag_glDepthMask;
+	GLuint		boundArrayBuffer;
+	GLuint		boundElementBuffer;
+	bool		textureMatrixIsIdentity;
+	bool		has3DViewport;				// Render_SetViewport was called this frame
+	int			viewportX;
+	int			viewportY;
+	int			viewportWidth;
+	int			viewportHeight;
 	TQ3ColorRGBA	viewportClearColor;
 	TQ3ColorRGBA	backdropClearColor;
 } RendererState;
@@ -65,6 +73,7 @@ typedef struct MeshQueueEntry
 	const TQ3Matrix4x4*		transform;
 	const RenderModifiers*	mods;
 	float					depthSortZ;
+	TQ3Point3D				center;					// world coords, for picking dynamic lights
 } MeshQueueEntry;
 
 #define MESHQUEUE_MAX_SIZE 4096
@@ -73,9 +82,86 @@ static MeshQueueEntry		gMeshQueueBuffer[MESHQUEUE_MAX_SIZE];
 static MeshQueueEntry*		gMeshQueuePtrs[MESHQUEUE_MAX_SIZE];
 static int					gMeshQueueSize = 0;
 
+		/* PACKED STATIC MESH ON THE GPU */
+		//
+		// Interleaved copy of a static mesh's vertex data in a GL buffer object.
+		// Each attribute is stored in the narrowest format that stays within a fixed error bound,
+		// so the format is chosen per mesh. The CPU-side TQ3TriMeshData is left untouched
+		// (collision, explosions and env mapping still read it).
+		//
+
+typedef struct StaticMeshBuffer
+{
+	const TQ3TriMeshData*	mesh;					// hash key; nil = free slot
+	GLuint					vertexBuffer;
+	GLuint					indexBuffer;
+	GLenum					indexType;				// GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+	GLsizei					stride;
+	GLenum					positionType;			// GL_FLOAT, or GL_SHORT (dequantized by the modelview matrix)
+	GLenum					normalType;				// GL_INT_2_10_10_10_REV or GL_BYTE; 0 if no normals
+	GLenum					uvType;					// GL_FLOAT, or GL_SHORT (dequantized by the texture matrix); 0 if no UVs
+	GLenum					colorType;				// GL_UNSIGNED_BYTE, or GL_FLOAT in the mesh pool; 0 if no colors
+	uint8_t					normalOffset;
+	uint8_t					uvOffset;
+	uint8_t					colorOffset;
+	TQ3Point3D				positionBias;			// decoded position = bias + quantized * scale
+	float					positionScale;			// (uniform on all axes so normals aren't skewed)
+	TQ3Param2D				uvBias;
+	TQ3Param2D				uvScale;
+	bool					pooled;					// buffers are shared with the rest of the mesh pool
+	int						poolSlot;
+	GLintptr				indexOffset;			// where the triangles start in the index buffer
+#if RENDER_VULKAN
+	int						vulkanMesh;				// VkRender_UploadStaticMesh handle, -1 if none
+#endif
+} StaticMeshBuffer;
+
+#define STATIC_MESH_TABLE_SIZE		2048			// must be a power of 2
+
+		/* STREAMING VERTEX BUFFER */
+		//
+		// Everything that isn't a packed static mesh (skinned skeletons, env-mapped UVs,
+		// terrain supertiles, shards, reduced LOD triangle lists...) is copied into one ring
+		// buffer as it's drawn, instead of being handed to GL as client arrays that the driver
+		// has to copy behind our back on every draw call.
+		//
+		// The buffer has a region per frame in flight. With ARB_buffer_storage it stays mapped
+		// for good and a fence per region tells us when the GPU is done reading it. Otherwise
+		// there's a single region that is orphaned at the start of each frame.
+		//
+
+#define STREAM_FRAMES				3
+#define STREAM_REGION_SIZE			(2*1024*1024)
+#define STREAM_ALIGNMENT			16
+
+typedef struct StreamedArrays
+{
+	GLintptr				points;
+	GLintptr				normals;
+	GLintptr				uvs;
+	GLintptr				colors;
+} StreamedArrays;
+
 static int DepthSortCompare(void const* a_void, void const* b_void);
 static void DrawMeshList(int renderPass, const MeshQueueEntry* entry);
+static bool IsMeshTransparent(const MeshQueueEntry* entry, const TQ3TriMeshData* mesh);
+static int CalcPipelineState(const MeshQueueEntry* entry, const TQ3TriMeshData* mesh, bool meshIsTransparent, bool hasNormals);
+#if RENDER_VULKAN
+static void QueueVulkanDraws(int renderPass, const MeshQueueEntry* entry);
+#endif
+static void ApplyFXAA(void);
+static void DrawOverdrawHeatmap(void);
+static const StaticMeshBuffer* FindStaticMesh(const TQ3TriMeshData* mesh);
+static void BindArrayBuffer(GLuint buffer);
+static void BindElementBuffer(GLuint buffer);
+static void InitStreamBuffer(void);
+static void BeginStreamFrame(void);
+static void EndStreamFrame(void);
+static bool StreamMeshArrays(const TQ3TriMeshData* mesh, const TQ3Param2D* uvs, bool hasNormals, StreamedArrays* out);
+static GLintptr StreamData(GLenum target, const void* data, size_t size);
+static void RegisterStaticMesh(const StaticMeshBuffer* sm);
 static void DrawFadeOverlay(float opacity);
+static float CalcEntryRadius(const MeshQueueEntry* entry);
 
 #pragma mark -
 
@@ -91,6 +177,57 @@ static const RenderModifiers kDefaultRenderMods =
 
 static const float kFreezeFrameFadeOutDuration = .33f;
 
+#if !OSXPPC
+static const char* kFXAAVertexShader =
+	"#version 110\n"
+	"varying vec2 vUV;\n"
+	"void main()\n"
+	"{\n"
+	"	gl_Position = gl_Vertex;\n"
+	"	vUV = gl_MultiTexCoord0.xy;\n"
+	"}\n";
+
+// FXAA 3.11 "console" variant: one luma-weighted edge direction, two blur taps along it.
+// Cheap enough for software rasterizers, and doesn't need a luma-in-alpha prepass.
+static const char* kFXAAFragmentShader =
+	"#version 110\n"
+	"uniform sampler2D uTexture;\n"
+	"uniform vec2 uTexelSize;\n"
+	"varying vec2 vUV;\n"
+	"#define FXAA_REDUCE_MIN (1.0/128.0)\n"
+	"#define FXAA_REDUCE_MUL (1.0/8.0)\n"
+	"#define FXAA_SPAN_MAX 8.0\n"
+	"void main()\n"
+	"{\n"
+	"	vec3 rgbNW = texture2D(uTexture, vUV + vec2(-1.0, -1.0) * uTexelSize).rgb;\n"
+	"	vec3 rgbNE = texture2D(uTexture, vUV + vec2( 1.0, -1.0) * uTexelSize).rgb;\n"
+	"	vec3 rgbSW = texture2D(uTexture, vUV + vec2(-1.0,  1.0) * uTexelSize).rgb;\n"
+	"	vec3 rgbSE = texture2D(uTexture, vUV + vec2( 1.0,  1.0) * uTexelSize).rgb;\n"
+	"	vec3 rgbM  = texture2D(uTexture, vUV).rgb;\n"
+	"	vec3 toLuma = vec3(0.299, 0.587, 0.114);\n"
+	"	float lumaNW = dot(rgbNW, toLuma);\n"
+	"	float lumaNE = dot(rgbNE, toLuma);\n"
+	"	float lumaSW = dot(rgbSW, toLuma);\n"
+	"	float lumaSE = dot(rgbSE, toLuma);\n"
+	"	float lumaM  = dot(rgbM,  toLuma);\n"
+	"	float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));\n"
+	"	float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));\n"
+	"	vec2 dir = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)), (lumaNW + lumaSW) - (lumaNE + lumaSE));\n"
+	"	float dirReduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * (0.25 * FXAA_REDUCE_MUL), FXAA_REDUCE_MIN);\n"
+	"	float rcpDirMin = 1.0 / (min(abs(dir.x), abs(dir.y)) + dirReduce);\n"
+	"	dir = clamp(dir * rcpDirMin, vec2(-FXAA_SPAN_MAX), vec2(FXAA_SPAN_MAX)) * uTexelSize;\n"
+	"	vec3 rgbA = 0.5 * (texture2D(uTexture, vUV + dir * (1.0/3.0 - 0.5)).rgb\n"
+	"					 + texture2D(uTexture, vUV + dir * (2.0/3.0 - 0.5)).rgb);\n"
+	"	vec3 rgbB = rgbA * 0.5 + 0.25 * (texture2D(uTexture, vUV - dir * 0.5).rgb\n"
+	"								   + texture2D(uTexture, vUV + dir * 0.5).rgb);\n"
+	"	float lumaB = dot(rgbB, toLuma);\n"
+	"	gl_FragColor = vec4((lumaB < lumaMin || lumaB > lumaMax) ? rgbA : rgbB, 1.0);\n"
+	"}\n";
+#endif
+
+static const float kStaticMeshMaxPositionError	= .02f;			// world units, before the object's own scale
+static const float kStaticMeshMaxUVError		= 1.0f / 4096.0f;
+
 //		2----3
 //		| \  |
 //		|  \ |
@@ -136,6 +273,87 @@ static	GLuint			gBackdropHeight = 0;
 
 float					gFadeOverlayOpacity = 0;
 
+#if !OSXPPC
+static	PFNGLGENBUFFERSPROC		pglGenBuffers		= nil;
+static	PFNGLDELETEBUFFERSPROC	pglDeleteBuffers	= nil;
+static	PFNGLBINDBUFFERPROC		pglBindBuffer		= nil;
+static	PFNGLBUFFERDATAPROC		pglBufferData		= nil;
+static	PFNGLBUFFERSUBDATAPROC	pglBufferSubData	= nil;
+static	PFNGLBUFFERSTORAGEPROC	pglBufferStorage	= nil;
+static	PFNGLMAPBUFFERRANGEPROC	pglMapBufferRange	= nil;
+static	PFNGLFENCESYNCPROC		pglFenceSync		= nil;
+static	PFNGLCLIENTWAITSYNCPROC	pglClientWaitSync	= nil;
+static	PFNGLDELETESYNCPROC		pglDeleteSync		= nil;
+#endif
+#if !OSXPPC
+static	PFNGLCREATESHADERPROC		pglCreateShader		= nil;
+static	PFNGLSHADERSOURCEPROC		pglShaderSource		= nil;
+static	PFNGLCOMPILESHADERPROC		pglCompileShader	= nil;
+static	PFNGLGETSHADERIVPROC		pglGetShaderiv		= nil;
+static	PFNGLGETSHADERINFOLOGPROC	pglGetShaderInfoLog	= nil;
+static	PFNGLDELETESHADERPROC		pglDeleteShader		= nil;
+static	PFNGLCREATEPROGRAMPROC		pglCreateProgram	= nil;
+static	PFNGLATTACHSHADERPROC		pglAttachShader		= nil;
+static	PFNGLLINKPROGRAMPROC		pglLinkProgram		= nil;
+static	PFNGLGETPROGRAMIVPROC		pglGetProgramiv		= nil;
+static	PFNGLUSEPROGRAMPROC			pglUseProgram		= nil;
+static	PFNGLGETUNIFORMLOCATIONPROC	pglGetUniformLocation = nil;
+static	PFNGLUNIFORM1IPROC			pglUniform1i		= nil;
+static	PFNGLUNIFORM2FPROC			pglUniform2f		= nil;
+static	PFNGLGENQUERIESPROC			pglGenQueries		= nil;
+static	PFNGLBEGINQUERYPROC			pglBeginQuery		= nil;
+static	PFNGLENDQUERYPROC			pglEndQuery			= nil;
+static	PFNGLGETQUERYOBJECTIVPROC	pglGetQueryObjectiv	= nil;
+static	PFNGLGETQUERYOBJECTUI64VPROC pglGetQueryObjectui64v = nil;
+#endif
+static	bool			gCanUseBufferObjects = false;
+static	bool			gCanUsePackedNormals = false;
+static	bool			gCanUseShaders = false;
+static	bool			gCanUseTimerQueries = false;
+static	bool			gCanStreamVertices = false;
+static	bool			gCanMapStreamPersistently = false;
+
+static	GLuint			gFXAAProgram = 0;
+static	GLint			gFXAAUniformTexelSize = -1;
+static	GLuint			gFXAATexture = 0;
+static	int				gFXAATextureWidth = 0;
+static	int				gFXAATextureHeight = 0;
+static	bool			gFXAAFailed = false;
+
+static	GLuint			gOverdrawTexture = 0;
+static	int				gOverdrawTextureWidth = 0;
+static	int				gOverdrawTextureHeight = 0;
+static	uint8_t*		gOverdrawCounts = nil;				// stencil readback, one byte per pixel
+static	uint8_t*		gOverdrawPixels = nil;				// heatmap, RGBA
+
+Boolean					gOverdrawMode = false;
+
+static	GLuint			gFrameTimerQueries[2] = {0,0};		// ping-pong so we never wait on the GPU
+static	int				gFrameTimerQueryIndex = 0;
+static	bool			gFrameTimerQueryPending[2] = {false,false};
+static	float			gLastGPUFrameMilliseconds = 0;
+
+static	bool			gPipelineStatesSeen[kPipelineState_NumKeys];	// this frame
+static	int				gLastPipelineState = -1;
+
+static	StaticMeshBuffer	gStaticMeshTable[STATIC_MESH_TABLE_SIZE];
+static	int					gNumStaticMeshes = 0;
+
+static	GLuint			gMeshPoolVertexBuffer = 0;
+static	GLuint			gMeshPoolIndexBuffer = 0;
+static	const TQ3TriMeshData**	gMeshPoolMeshes = nil;
+static	int				gMeshPoolSize = 0;
+static	int				gMeshPoolPointsPerSlot = 0;
+static	int				gMeshPoolTrianglesPerSlot = 0;
+static	uint8_t*		gMeshPoolScratch = nil;				// one slot's worth of vertices or indices, for uploading
+
+static	GLuint			gStreamBuffer = 0;
+static	uint8_t*		gStreamMapping = nil;				// persistent mapping of the whole buffer; nil when orphaning
+static	GLsync			gStreamFences[STREAM_FRAMES];
+static	int				gStreamRegion = 0;
+static	size_t			gStreamOffset = 0;					// bytes used in the current region
+static	bool			gStreamFull = false;				// ran out of room this frame, back to client arrays
+
 #pragma mark -
 
 /****************************/
@@ -239,8 +457,85 @@ void Render_SetDefaultModifiers(RenderModifiers* dest)
 	SDL_memcpy(dest, &kDefaultRenderMods, sizeof(RenderModifiers));
 }
 
+/****************** LOAD GL EXTENSIONS ********************/
+//
+// Buffer objects are core since GL 1.5 but must still be fetched at runtime on some platforms.
+// If anything is missing, static meshes are simply drawn from client arrays as before.
+//
+
+static void LoadGLExtensions(void)
+{
+static bool loaded = false;
+
+	if (loaded)
+		return;
+	loaded = true;
+
+#if !OSXPPC && !defined(__EMSCRIPTEN__)		// LEGACY_GL_EMULATION doesn't handle quantized vertex formats
+	pglGenBuffers		= (PFNGLGENBUFFERSPROC)		SDL_GL_GetProcAddress("glGenBuffers");
+	pglDeleteBuffers	= (PFNGLDELETEBUFFERSPROC)	SDL_GL_GetProcAddress("glDeleteBuffers");
+	pglBindBuffer		= (PFNGLBINDBUFFERPROC)		SDL_GL_GetProcAddress("glBindBuffer");
+	pglBufferData		= (PFNGLBUFFERDATAPROC)		SDL_GL_GetProcAddress("glBufferData");
+
+	gCanUseBufferObjects = pglGenBuffers && pglDeleteBuffers && pglBindBuffer && pglBufferData;
+	gCanUsePackedNormals = gCanUseBufferObjects && SDL_GL_ExtensionSupported("GL_ARB_vertex_type_2_10_10_10_rev");
+
+	pglCreateShader			= (PFNGLCREATESHADERPROC)		SDL_GL_GetProcAddress("glCreateShader");
+	pglShaderSource			= (PFNGLSHADERSOURCEPROC)		SDL_GL_GetProcAddress("glShaderSource");
+	pglCompileShader		= (PFNGLCOMPILESHADERPROC)		SDL_GL_GetProcAddress("glCompileShader");
+	pglGetShaderiv			= (PFNGLGETSHADERIVPROC)		SDL_GL_GetProcAddress("glGetShaderiv");
+	pglGetShaderInfoLog		= (PFNGLGETSHADERINFOLOGPROC)	SDL_GL_GetProcAddress("glGetShaderInfoLog");
+	pglDeleteShader			= (PFNGLDELETESHADERPROC)		SDL_GL_GetProcAddress("glDeleteShader");
+	pglCreateProgram		= (PFNGLCREATEPROGRAMPROC)		SDL_GL_GetProcAddress("glCreateProgram");
+	pglAttachShader			= (PFNGLATTACHSHADERPROC)		SDL_GL_GetProcAddress("glAttachShader");
+	pglLinkProgram			= (PFNGLLINKPROGRAMPROC)		SDL_GL_GetProcAddress("glLinkProgram");
+	pglGetProgramiv			= (PFNGLGETPROGRAMIVPROC)		SDL_GL_GetProcAddress("glGetProgramiv");
+	pglUseProgram			= (PFNGLUSEPROGRAMPROC)			SDL_GL_GetProcAddress("glUseProgram");
+	pglGetUniformLocation	= (PFNGLGETUNIFORMLOCATIONPROC)	SDL_GL_GetProcAddress("glGetUniformLocation");
+	pglUniform1i			= (PFNGLUNIFORM1IPROC)			SDL_GL_GetProcAddress("glUniform1i");
+	pglUniform2f			= (PFNGLUNIFORM2FPROC)			SDL_GL_GetProcAddress("glUniform2f");
+
+	gCanUseShaders = pglCreateShader && pglShaderSource && pglCompileShader && pglGetShaderiv && pglGetShaderInfoLog
+			&& pglDeleteShader && pglCreateProgram && pglAttachShader && pglLinkProgram && pglGetProgramiv
+			&& pglUseProgram && pglGetUniformLocation && pglUniform1i && pglUniform2f;
+
+	pglGenQueries			= (PFNGLGENQUERIESPROC)			SDL_GL_GetProcAddress("glGenQueries");
+	pglBeginQuery			= (PFNGLBEGINQUERYPROC)			SDL_GL_GetProcAddress("glBeginQuery");
+	pglEndQuery				= (PFNGLENDQUERYPROC)			SDL_GL_GetProcAddress("glEndQuery");
+	pglGetQueryObjectiv		= (PFNGLGETQUERYOBJECTIVPROC)	SDL_GL_GetProcAddress("glGetQueryObjectiv");
+	pglGetQueryObjectui64v	= (PFNGLGETQUERYOBJECTUI64VPROC) SDL_GL_GetProcAddress("glGetQueryObjectui64v");
+
+	gCanUseTimerQueries = pglGenQueries && pglBeginQuery && pglEndQuery && pglGetQueryObjectiv && pglGetQueryObjectui64v
+			&& SDL_GL_ExtensionSupported("GL_ARB_timer_query");
+
+	pglBufferSubData		= (PFNGLBUFFERSUBDATAPROC)		SDL_GL_GetProcAddress("glBufferSubData");
+	pglBufferStorage		= (PFNGLBUFFERSTORAGEPROC)		SDL_GL_GetProcAddress("glBufferStorage");
+	pglMapBufferRange		= (PFNGLMAPBUFFERRANGEPROC)		SDL_GL_GetProcAddress("glMapBufferRange");
+	pglFenceSync			= (PFNGLFENCESYNCPROC)			SDL_GL_GetProcAddress("glFenceSync");
+	pglClientWaitSync		= (PFNGLCLIENTWAITSYNCPROC)		SDL_GL_GetProcAddress("glClientWaitSync");
+	pglDeleteSync			= (PFNGLDELETESYNCPROC)			SDL_GL_GetProcAddress("glDeleteSync");
+
+	gCanStreamVertices = gCanUseBufferObjects && pglBufferSubData;
+	gCanMapStreamPersistently = gCanStreamVertices
+			&& pglBufferStorage && pglMapBufferRange && pglFenceSync && pglClientWaitSync && pglDeleteSync
+			&& SDL_GL_ExtensionSupported("GL_ARB_buffer_storage") && SDL_GL_ExtensionSupported("GL_ARB_sync");
+
+	if (gCanUseTimerQueries)
+		pglGenQueries(2, gFrameTimerQueries);
+#endif
+
+	SDL_Log("Static mesh buffers: %s, packed normals: %s, shaders: %s, timer queries: %s, vertex streaming: %s",
+			gCanUseBufferObjects ? "yes" : "no",
+			gCanUsePackedNormals ? "10:10:10:2" : "8:8:8",
+			gCanUseShaders ? "yes" : "no",
+			gCanUseTimerQueries ? "yes" : "no",
+			gCanMapStreamPersistently ? "persistent" : gCanStreamVertices ? "orphaned" : "no");
+}
+
 void Render_InitState(void)
 {
+	LoadGLExtensions();
+
 	SetInitialClientState(GL_VERTEX_ARRAY,				true);
 	SetInitialClientState(GL_NORMAL_ARRAY,				true);
 	SetInitialClientState(GL_COLOR_ARRAY,				false);
@@ -271,6 +566,20 @@ void Render_InitState(void)
 	ClearColorRGBA(gState.backdropClearColor);
 
 	gState.boundTexture = 0;
+	gState.boundArrayBuffer = 0;
+	gState.boundElementBuffer = 0;
+	gState.textureMatrixIsIdentity = true;
+#if !OSXPPC
+	if (gCanUseBufferObjects)
+	{
+		pglBindBuffer(GL_ARRAY_BUFFER, 0);
+		pglBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+#endif
+	InitStreamBuffer();
+	glMatrixMode(GL_TEXTURE);
+	glLoadIdentity();
+	glMatrixMode(GL_MODELVIEW);
 //	gState.sceneHasFog = false;
 //	gState.currentTransform = NULL;
 
@@ -280,6 +589,21 @@ void Render_InitState(void)
 	glFrontFace(GL_CCW);
 	glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
 
+	// Overdraw mode counts fragments in the stencil buffer, which was requested along with the window
+	if (gOverdrawMode)
+	{
+		GLint stencilBits = 0;
+		glGetIntegerv(GL_STENCIL_BITS, &stencilBits);
+		if (stencilBits < 8)
+		{
+			SDL_Log("Overdraw mode needs an 8-bit stencil buffer, got %d bits; turning it off.", (int) stencilBits);
+			gOverdrawMode = false;
+		}
+		glStencilFunc(GL_ALWAYS, 0, 0xFF);
+		glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);						// count every fragment that gets written
+		glClearStencil(0);
+	}
+
 	// Set up mesh queue
 	gMeshQueueSize = 0;
 	for (int i = 0; i < MESHQUEUE_MAX_SIZE; i++)
@@ -354,9 +678,41 @@ GLuint Render_LoadTexture(
 			pixels);				// pointer to the actual texture pixels
 	CHECK_GL_ERROR();
 
+#if RENDER_VULKAN
+	if (VkRender_IsActive())
+		VkRender_LoadTexture(textureName, internalFormat, width, height, bufferFormat, bufferType, pixels, flags);
+#endif
+
 	return textureName;
 }
 
+void Render_UpdateTexture(
+		GLuint textureName,
+		int width,
+		int height,
+		GLenum bufferFormat,
+		GLenum bufferType,
+		const GLvoid* pixels)
+{
+	Render_BindTexture(textureName);
+	glTexSubImage2D(
+			GL_TEXTURE_2D,
+			0,						// mipmap level
+			0,						// x offset
+			0,						// y offset
+			width,
+			height,
+			bufferFormat,
+			bufferType,
+			pixels);
+	CHECK_GL_ERROR();
+
+#if RENDER_VULKAN
+	if (VkRender_IsActive())
+		VkRender_UpdateTexture(textureName, width, height, bufferFormat, bufferType, pixels);
+#endif
+}
+
 void Render_Load3DMFTextures(TQ3MetaFile* metaFile, GLuint* outTextureNames)
 {
 	for (int i = 0; i < metaFile->numTextures; i++)
@@ -418,6 +774,39 @@ void Render_StartFrame(void)
 
 	// Clear transparent queue
 	gMeshQueueSize = 0;
+
+	SDL_memset(gPipelineStatesSeen, 0, sizeof(gPipelineStatesSeen));
+	gLastPipelineState = -1;
+
+	gState.has3DViewport = false;
+
+	BeginStreamFrame();
+
+#if !OSXPPC
+	// Pick up the GPU time of an earlier frame if it's ready, then start timing this one
+	if (gCanUseTimerQueries)
+	{
+		gFrameTimerQueryIndex ^= 1;
+
+		GLuint query = gFrameTimerQueries[gFrameTimerQueryIndex];
+		if (gFrameTimerQueryPending[gFrameTimerQueryIndex])
+		{
+			GLint available = 0;
+			pglGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+			if (available)
+			{
+				GLuint64 nanoseconds = 0;
+				pglGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+				gLastGPUFrameMilliseconds = nanoseconds / 1e6f;
+			}
+		}
+
+		pglBeginQuery(GL_TIME_ELAPSED, query);
+		gFrameTimerQueryPending[gFrameTimerQueryIndex] = true;
+	}
+#endif
+
+	gRenderStats.gpuFrameMilliseconds = gLastGPUFrameMilliseconds;
 }
 
 void Render_SetViewport(TQ3Area pane)
@@ -440,10 +829,30 @@ void Render_SetViewport(TQ3Area pane)
 
 	glViewport(x,y,w,h);
 
+	gState.has3DViewport = true;
+	gState.viewportX = x;
+	gState.viewportY = y;
+	gState.viewportWidth = w;
+	gState.viewportHeight = h;
+
 	// Clear color & depth buffers
 	ClearColorRGBA(gState.viewportClearColor);
 	EnableFlag(glDepthMask);	// The depth mask must be re-enabled so we can clear the depth buffer.
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	if (gOverdrawMode)
+	{
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+		glEnable(GL_STENCIL_TEST);									// until the mesh queue is flushed
+	}
+	else
+	{
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	}
+
+#if RENDER_VULKAN
+	if (VkRender_IsActive())
+		VkRender_BeginFrame(w, h, gState.viewportClearColor);
+#endif
 }
 
 void Render_EndFrame(void)
@@ -454,13 +863,10 @@ void Render_EndFrame(void)
 	// Flush mesh draw queue
 	if (gMeshQueueSize != 0)
 	{
+		Uint64 submitStart = SDL_GetPerformanceCounter();
+
 		// Sort mesh draw queue, front to back
-		SDL_qsort(
-				gMeshQueuePtrs,
-				gMeshQueueSize,
-				sizeof(gMeshQueuePtrs[0]),
-				DepthSortCompare
-		);
+		Render_SortMeshQueue();
 
 		// PASS 1: draw opaque meshes, front to back
 		for (int i = 0; i < gMeshQueueSize; i++)
@@ -474,8 +880,40 @@ void Render_EndFrame(void)
 			DrawMeshList(kRenderPass_Transparent, gMeshQueuePtrs[i]);
 		}
 
-		// Clear mesh draw queue
-		gMeshQueueSize = 0;
+		gRenderStats.submitMilliseconds = (SDL_GetPerformanceCounter() - submitStart) * 1000.0f / SDL_GetPerformanceFrequency();
+	}
+
+#if RENDER_VULKAN
+	// Replay the same sorted queue through the Vulkan backend
+	if (gState.has3DViewport && VkRender_IsActive())
+	{
+		Uint64 vulkanStart = SDL_GetPerformanceCounter();
+
+		for (int i = 0; i < gMeshQueueSize; i++)
+			QueueVulkanDraws(kRenderPass_Opaque, gMeshQueuePtrs[i]);
+
+		for (int i = gMeshQueueSize-1; i >= 0; i--)
+			QueueVulkanDraws(kRenderPass_Transparent, gMeshQueuePtrs[i]);
+
+		VkRender_EndFrame();
+
+		gRenderStats.vulkanSubmitMilliseconds = (SDL_GetPerformanceCounter() - vulkanStart) * 1000.0f / SDL_GetPerformanceFrequency();
+	}
+#endif
+
+	// Clear mesh draw queue
+	gMeshQueueSize = 0;
+
+	// Replace the 3D viewport with its overdraw heatmap
+	if (gState.has3DViewport && gOverdrawMode)
+	{
+		glDisable(GL_STENCIL_TEST);
+		DrawOverdrawHeatmap();
+	}
+	// Post-process antialiasing of the 3D viewport (the 2D backdrop around it is left alone)
+	else if (gState.has3DViewport && gGamePrefs.antialiasingLevel == ANTIALIASING_LEVEL_FXAA)
+	{
+		ApplyFXAA();
 	}
 
 	if (gState.hasState_GL_SCISSOR_TEST)
@@ -490,6 +928,16 @@ void Render_EndFrame(void)
 		DrawFadeOverlay(gFadeOverlayOpacity);
 	}
 #endif
+
+#if !OSXPPC
+	if (gCanUseTimerQueries)
+	{
+		pglEndQuery(GL_TIME_ELAPSED);
+	}
+#endif
+
+	DynamicLights_EndFrame();
+	EndStreamFrame();
 }
 
 #pragma mark -
@@ -513,6 +961,7 @@ void Render_SubmitMeshList(
 	entry->transform		= transform;
 	entry->mods				= mods ? mods : &kDefaultRenderMods;
 	entry->depthSortZ		= coordInFrustum.z;
+	entry->center			= *centerCoord;
 }
 
 void Render_SubmitMesh(
@@ -533,6 +982,22 @@ void Render_SubmitMesh(
 	entry->transform		= transform;
 	entry->mods				= mods ? mods : &kDefaultRenderMods;
 	entry->depthSortZ		= coordInFrustum.z;
+	entry->center			= *centerCoord;
+}
+
+void Render_SortMeshQueue(void)
+{
+	SDL_qsort(
+			gMeshQueuePtrs,
+			gMeshQueueSize,
+			sizeof(gMeshQueuePtrs[0]),
+			DepthSortCompare
+	);
+}
+
+void Render_DiscardMeshQueue(void)
+{
+	gMeshQueueSize = 0;
 }
 
 #pragma mark -
@@ -569,13 +1034,17 @@ static void DrawMeshList(int renderPass, const MeshQueueEntry* entry)
 
 	bool matrixPushedYet = false;
 
+	// Light the entry with the nearest dynamic lights (the modelview is still the camera's here)
+	if (!(entry->mods->statusBits & STATUS_BIT_NULLSHADER) && DynamicLights_Count() > 0)
+	{
+		DynamicLights_Bind(&entry->center, CalcEntryRadius(entry));
+	}
+
 	for (int i = 0; i < entry->numMeshes; i++)
 	{
 		const TQ3TriMeshData* mesh = entry->meshPtrList[i];
 
-		bool meshIsTransparent = mesh->texturingMode == kQ3TexturingModeAlphaBlend
-				|| mesh->diffuseColor.a < .999f
-				|| entry->mods->diffuseColor.a < .999f;
+		bool meshIsTransparent = IsMeshTransparent(entry, mesh);
 
 		// Decide whether or not to draw this mesh in this pass, depending on which pass we're in
 		// (opaque or transparent), and whether the mesh has transparency.
@@ -649,6 +1118,24 @@ static void DrawMeshList(int renderPass, const MeshQueueEntry* entry)
 			EnableFlag(glDepthMask);
 		}
 
+		// Use the packed GPU copy of the mesh if there is one.
+		// Env-mapped meshes need per-frame UVs, so they are always streamed.
+		const StaticMeshBuffer* packed = applyEnvironmentMap ? nil : FindStaticMesh(mesh);
+
+		// Game code may turn on texturing or vertex colors after the mesh was packed (e.g. shadows)
+		if (packed && mesh->texturingMode != kQ3TexturingModeOff && !packed->uvType)
+			packed = nil;
+		if (packed && mesh->hasVertexColors && !packed->colorType)
+			packed = nil;
+		bool hasNormals = mesh->hasVertexNormals && !(entry->mods->statusBits & STATUS_BIT_NULLSHADER);
+
+		// Otherwise copy this frame's vertex data into the streaming buffer
+		const TQ3Param2D* uvs = mesh->texturingMode == kQ3TexturingModeOff ? nil : applyEnvironmentMap ? gEnvMapUVs : mesh->vertexUVs;
+		StreamedArrays streamed;
+		bool isStreamed = !packed && StreamMeshArrays(mesh, uvs, hasNormals, &streamed);
+
+		BindArrayBuffer(packed ? packed->vertexBuffer : isStreamed ? gStreamBuffer : 0);
+
 		// Texture mapping
 		if (mesh->texturingMode != kQ3TexturingModeOff)
 		{
@@ -656,8 +1143,33 @@ static void DrawMeshList(int renderPass, const MeshQueueEntry* entry)
 			EnableClientState(GL_TEXTURE_COORD_ARRAY);
 			Render_BindTexture(mesh->glTextureName);
 
-			glTexCoordPointer(2, GL_FLOAT, 0, applyEnvironmentMap ? gEnvMapUVs : mesh->vertexUVs);
+			if (packed)
+			{
+				glTexCoordPointer(2, packed->uvType, packed->stride, (const GLvoid*) (uintptr_t) packed->uvOffset);
+			}
+			else
+			{
+				glTexCoordPointer(2, GL_FLOAT, 0, isStreamed ? (const GLvoid*) (uintptr_t) streamed.uvs : uvs);
+			}
 			CHECK_GL_ERROR();
+
+			// Quantized UVs are expanded back to their original range by the texture matrix
+			if (packed && packed->uvType == GL_SHORT)
+			{
+				glMatrixMode(GL_TEXTURE);
+				glLoadIdentity();
+				glTranslatef(packed->uvBias.u, packed->uvBias.v, 0);
+				glScalef(packed->uvScale.u, packed->uvScale.v, 1);
+				glMatrixMode(GL_MODELVIEW);
+				gState.textureMatrixIsIdentity = false;
+			}
+			else if (!gState.textureMatrixIsIdentity)
+			{
+				glMatrixMode(GL_TEXTURE);
+				glLoadIdentity();
+				glMatrixMode(GL_MODELVIEW);
+				gState.textureMatrixIsIdentity = true;
+			}
 		}
 		else
 		{
@@ -670,7 +1182,10 @@ static void DrawMeshList(int renderPass, const MeshQueueEntry* entry)
 		if (mesh->hasVertexColors)
 		{
 			EnableClientState(GL_COLOR_ARRAY);
-			glColorPointer(4, GL_FLOAT, 0, mesh->vertexColors);
+			if (packed)
+				glColorPointer(4, packed->colorType, packed->stride, (const GLvoid*) (uintptr_t) packed->colorOffset);
+			else
+				glColorPointer(4, GL_FLOAT, 0, isStreamed ? (const GLvoid*) (uintptr_t) streamed.colors : mesh->vertexColors);
 		}
 		else
 		{
@@ -693,23 +1208,92 @@ static void DrawMeshList(int renderPass, const MeshQueueEntry* entry)
 			matrixPushedYet = true;
 		}
 
+		// Quantized positions are expanded back to world units by the modelview matrix.
+		// The scale is uniform so GL_NORMALIZE keeps lighting correct.
+		bool dequantMatrixPushed = false;
+		if (packed && packed->positionType == GL_SHORT)
+		{
+			glPushMatrix();
+			glTranslatef(packed->positionBias.x, packed->positionBias.y, packed->positionBias.z);
+			glScalef(packed->positionScale, packed->positionScale, packed->positionScale);
+			dequantMatrixPushed = true;
+		}
+
 		// Submit vertex data
-		glVertexPointer(3, GL_FLOAT, 0, mesh->points);
+		if (packed)
+			glVertexPointer(3, packed->positionType, packed->stride, (const GLvoid*) 0);
+		else
+			glVertexPointer(3, GL_FLOAT, 0, isStreamed ? (const GLvoid*) (uintptr_t) streamed.points : mesh->points);
 		CHECK_GL_ERROR();
 
 		// Submit normal data if any
-		if (mesh->hasVertexNormals && !(entry->mods->statusBits & STATUS_BIT_NULLSHADER))
+		if (hasNormals && (!packed || packed->normalType))
 		{
 			EnableClientState(GL_NORMAL_ARRAY);
-			glNormalPointer(GL_FLOAT, 0, mesh->vertexNormals);
+			if (packed)
+				glNormalPointer(packed->normalType, packed->stride, (const GLvoid*) (uintptr_t) packed->normalOffset);
+			else
+				glNormalPointer(GL_FLOAT, 0, isStreamed ? (const GLvoid*) (uintptr_t) streamed.normals : mesh->vertexNormals);
 		}
 		else
 		{
 			DisableClientState(GL_NORMAL_ARRAY);
 		}
 
+		// Pick full-detail or reduced triangle list
+		int numTriangles = mesh->numTriangles;
+		const TQ3TriMeshTriangleData* triangles = mesh->triangles;
+		GLenum indexType = GL_UNSIGNED_INT;
+		bool trianglesOnGPU = false;
+
+		if (entry->mods->lodLevel > 0
+			&& entry->mods->lodSet
+			&& i < entry->mods->lodSet->numMeshes)
+		{
+			const MeshLODTriangleList* lod = &entry->mods->lodSet->levels[entry->mods->lodLevel][i];
+			numTriangles = lod->numTriangles;
+			triangles = lod->triangles;
+			gRenderStats.trianglesSavedByLOD += mesh->numTriangles - numTriangles;
+		}
+		else if (packed)
+		{
+			triangles = (const TQ3TriMeshTriangleData*) (uintptr_t) packed->indexOffset;
+			indexType = packed->indexType;
+			trianglesOnGPU = true;
+			BindElementBuffer(packed->indexBuffer);
+		}
+
+		// Client-side triangle lists (reduced LODs, unpacked meshes) are streamed too
+		if (!trianglesOnGPU)
+		{
+			GLintptr offset = StreamData(GL_ELEMENT_ARRAY_BUFFER, triangles, numTriangles * sizeof(TQ3TriMeshTriangleData));
+			if (offset >= 0)
+			{
+				BindElementBuffer(gStreamBuffer);
+				triangles = (const TQ3TriMeshTriangleData*) (uintptr_t) offset;
+			}
+			else
+			{
+				BindElementBuffer(0);
+			}
+		}
+
+		// Keep track of the pipeline states this frame needs
+		int pipelineState = CalcPipelineState(entry, mesh, meshIsTransparent, hasNormals);
+
+		if (!gPipelineStatesSeen[pipelineState])
+		{
+			gPipelineStatesSeen[pipelineState] = true;
+			gRenderStats.pipelineStates++;
+		}
+		if (pipelineState != gLastPipelineState)
+		{
+			gRenderStats.pipelineSwitches++;
+			gLastPipelineState = pipelineState;
+		}
+
 		// Draw the mesh
-		glDrawElements(GL_TRIANGLES, mesh->numTriangles * 3, GL_UNSIGNED_INT, mesh->triangles);
+		glDrawElements(GL_TRIANGLES, numTriangles * 3, indexType, triangles);
 		CHECK_GL_ERROR();
 
 		// Pass 2 to draw transparent meshes without face culling (see above for an explanation)
@@ -719,18 +1303,1113 @@ static void DrawMeshList(int renderPass, const MeshQueueEntry* entry)
 			// We've restored glCullFace to GL_BACK, which is the default for all other meshes.
 			
 			// Draw the mesh again
-			glDrawElements(GL_TRIANGLES, mesh->numTriangles * 3, GL_UNSIGNED_INT, mesh->triangles);
+			glDrawElements(GL_TRIANGLES, numTriangles * 3, indexType, triangles);
 			CHECK_GL_ERROR();
 		}
 
+		if (dequantMatrixPushed)
+		{
+			glPopMatrix();
+		}
+
 		// Update stats
-		gRenderStats.trianglesDrawn += mesh->numTriangles;
+		gRenderStats.trianglesDrawn += numTriangles;
 	}
 
 	if (matrixPushedYet)
 	{
 		glPopMatrix();
 	}
+
+	// Leave client-array mode for everyone else (2D, fade overlay...)
+	BindArrayBuffer(0);
+	BindElementBuffer(0);
+
+	if (!gState.textureMatrixIsIdentity)
+	{
+		glMatrixMode(GL_TEXTURE);
+		glLoadIdentity();
+		glMatrixMode(GL_MODELVIEW);
+		gState.textureMatrixIsIdentity = true;
+	}
+}
+
+/****************** IS MESH TRANSPARENT ********************/
+//
+// Transparent meshes are drawn in the second pass, back to front, with blending on.
+//
+
+static bool IsMeshTransparent(const MeshQueueEntry* entry, const TQ3TriMeshData* mesh)
+{
+	return mesh->texturingMode == kQ3TexturingModeAlphaBlend
+			|| mesh->diffuseColor.a < .999f
+			|| entry->mods->diffuseColor.a < .999f;
+}
+
+/****************** CALC PIPELINE STATE ********************/
+//
+// Sums up the fixed-function state DrawMeshList sets up for a mesh as kPipelineState_* bits.
+//
+
+static int CalcPipelineState(const MeshQueueEntry* entry, const TQ3TriMeshData* mesh, bool meshIsTransparent, bool hasNormals)
+{
+	int pipelineState = 0;
+
+	if (meshIsTransparent)
+		pipelineState |= kPipelineState_Blend;
+	if (entry->mods->statusBits & STATUS_BIT_KEEPBACKFACES)
+		pipelineState |= meshIsTransparent ? kPipelineState_TwoSidedBlend : kPipelineState_NoCull;
+	if (!(entry->mods->statusBits & STATUS_BIT_NULLSHADER))
+		pipelineState |= kPipelineState_Lighting;
+	if (mesh->texturingMode != kQ3TexturingModeOff)
+		pipelineState |= kPipelineState_Texture;
+	if (entry->mods->statusBits & STATUS_BIT_REFLECTIONMAP)
+		pipelineState |= kPipelineState_EnvMap;
+	if (!(meshIsTransparent || entry->mods->statusBits & STATUS_BIT_NOZWRITE))
+		pipelineState |= kPipelineState_DepthWrite;
+	if (mesh->hasVertexColors)
+		pipelineState |= kPipelineState_VertexColors;
+	if (hasNormals)
+		pipelineState |= kPipelineState_Normals;
+
+	return pipelineState;
+}
+
+#if RENDER_VULKAN
+/****************** QUEUE VULKAN DRAWS ********************/
+//
+// Makes the same per-mesh choices as DrawMeshList (pass, env map, LOD, pipeline state)
+// and hands the meshes to the Vulkan backend instead of GL.
+//
+// Point lights aren't passed on, so only the level's fill lights light the Vulkan frame.
+//
+
+static void QueueVulkanDraws(int renderPass, const MeshQueueEntry* entry)
+{
+	bool applyEnvironmentMap = entry->mods->statusBits & STATUS_BIT_REFLECTIONMAP;
+
+	for (int i = 0; i < entry->numMeshes; i++)
+	{
+		const TQ3TriMeshData* mesh = entry->meshPtrList[i];
+
+		bool meshIsTransparent = IsMeshTransparent(entry, mesh);
+
+		if ((renderPass == kRenderPass_Opaque		&& meshIsTransparent) ||
+			(renderPass == kRenderPass_Transparent	&& !meshIsTransparent))
+		{
+			continue;
+		}
+
+		// VkRender_AddDraw copies gEnvMapUVs right away, so the next mesh can reuse them
+		if (applyEnvironmentMap)
+		{
+			EnvironmentMapTriMesh(mesh, entry->transform);
+		}
+
+		const StaticMeshBuffer* packed = FindStaticMesh(mesh);
+		bool hasNormals = mesh->hasVertexNormals && !(entry->mods->statusBits & STATUS_BIT_NULLSHADER);
+
+		VulkanDraw draw;
+		draw.mesh			= mesh;
+		draw.transform		= entry->transform;
+		draw.uvs			= mesh->texturingMode == kQ3TexturingModeOff ? nil : applyEnvironmentMap ? gEnvMapUVs : mesh->vertexUVs;
+		draw.triangles		= mesh->triangles;
+		draw.numTriangles	= mesh->numTriangles;
+		draw.staticMesh		= (packed && !packed->pooled) ? packed->vulkanMesh : -1;
+		draw.diffuseColor.r	= mesh->diffuseColor.r * entry->mods->diffuseColor.r;
+		draw.diffuseColor.g	= mesh->diffuseColor.g * entry->mods->diffuseColor.g;
+		draw.diffuseColor.b	= mesh->diffuseColor.b * entry->mods->diffuseColor.b;
+		draw.diffuseColor.a	= mesh->diffuseColor.a * entry->mods->diffuseColor.a;
+		draw.pipelineState	= CalcPipelineState(entry, mesh, meshIsTransparent, hasNormals);
+		draw.isTerrain		= packed && packed->pooled;
+
+		if (entry->mods->lodLevel > 0
+			&& entry->mods->lodSet
+			&& i < entry->mods->lodSet->numMeshes)
+		{
+			const MeshLODTriangleList* lod = &entry->mods->lodSet->levels[entry->mods->lodLevel][i];
+			draw.triangles		= lod->triangles;
+			draw.numTriangles	= lod->numTriangles;
+		}
+
+		VkRender_AddDraw(&draw);
+	}
+}
+#endif
+
+/****************** CALC ENTRY RADIUS ********************/
+//
+// Radius of a sphere around the entry's center coord that holds all of the entry's meshes.
+// The center needn't be the middle of the meshes' bounding boxes, so this is the farthest
+// bounding box corner (in world space) from the center.
+//
+
+static float CalcEntryRadius(const MeshQueueEntry* entry)
+{
+	float radius2 = 0;
+
+	for (int i = 0; i < entry->numMeshes; i++)
+	{
+		const TQ3BoundingBox* bBox = &entry->meshPtrList[i]->bBox;
+		if (bBox->isEmpty)
+			continue;
+
+		for (int corner = 0; corner < 8; corner++)
+		{
+			TQ3Point3D p =
+			{
+				(corner & 1) ? bBox->max.x : bBox->min.x,
+				(corner & 2) ? bBox->max.y : bBox->min.y,
+				(corner & 4) ? bBox->max.z : bBox->min.z,
+			};
+
+			if (entry->transform)									// else the mesh is already in world space
+				Q3Point3D_Transform(&p, entry->transform, &p);
+
+			float dx = p.x - entry->center.x;
+			float dy = p.y - entry->center.y;
+			float dz = p.z - entry->center.z;
+			radius2 = SDL_max(radius2, dx*dx + dy*dy + dz*dz);
+		}
+	}
+
+	return SDL_sqrtf(radius2);
+}
+
+#pragma mark -
+
+//=======================================================================================================
+
+/****************************/
+/*    STATIC MESH BUFFERS   */
+/****************************/
+
+static void BindArrayBuffer(GLuint buffer)
+{
+	if (gState.boundArrayBuffer == buffer)
+		return;
+
+#if !OSXPPC
+	pglBindBuffer(GL_ARRAY_BUFFER, buffer);
+#endif
+	gState.boundArrayBuffer = buffer;
+}
+
+static void BindElementBuffer(GLuint buffer)
+{
+	if (gState.boundElementBuffer == buffer)
+		return;
+
+#if !OSXPPC
+	pglBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+#endif
+	gState.boundElementBuffer = buffer;
+}
+
+static inline uint32_t HashMeshPointer(const TQ3TriMeshData* mesh)
+{
+	uint64_t h = (uint64_t) (uintptr_t) mesh;
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	return (uint32_t) h & (STATIC_MESH_TABLE_SIZE - 1);
+}
+
+static const StaticMeshBuffer* FindStaticMesh(const TQ3TriMeshData* mesh)
+{
+	if (gNumStaticMeshes == 0)
+		return nil;
+
+	for (uint32_t slot = HashMeshPointer(mesh); gStaticMeshTable[slot].mesh; slot = (slot+1) & (STATIC_MESH_TABLE_SIZE-1))
+	{
+		if (gStaticMeshTable[slot].mesh == mesh)
+			return &gStaticMeshTable[slot];
+	}
+
+	return nil;
+}
+
+static inline int16_t QuantizeShort(float value, float bias, float scale)
+{
+	float q = SDL_roundf((value - bias) / scale);
+	if (q < -32767) q = -32767;
+	if (q >  32767) q =  32767;
+	return (int16_t) q;
+}
+
+static inline int32_t QuantizeSNorm(float value, float maxValue)
+{
+	if (value < -1) value = -1;
+	if (value >  1) value =  1;
+	return (int32_t) SDL_roundf(value * maxValue);
+}
+
+/****************** RENDER: UPLOAD STATIC MESH ********************/
+//
+// Packs the vertex data of a mesh that never changes after loading into an interleaved
+// vertex buffer, and its triangles into an index buffer.
+//
+//   positions:	3x int16 + pad if the quantization step stays under kStaticMeshMaxPositionError, else 3x float
+//   normals:	10:10:10:2 if the driver supports it in fixed-function, else 3x int8 + pad
+//   UVs:		2x int16 if the quantization step stays under kStaticMeshMaxUVError, else 2x float
+//   colors:	4x uint8
+//
+
+void Render_UploadStaticMesh(const TQ3TriMeshData* mesh)
+{
+	if (!gCanUseBufferObjects || !mesh || mesh->numPoints == 0 || mesh->numTriangles == 0)
+		return;
+
+	if (gNumStaticMeshes >= STATIC_MESH_TABLE_SIZE / 2)			// keep the table sparse
+		return;
+
+	if (FindStaticMesh(mesh))
+		return;
+
+	if (mesh->texturingMode != kQ3TexturingModeOff && !mesh->vertexUVs)
+		return;
+
+#if !OSXPPC
+	StaticMeshBuffer sm;
+	SDL_memset(&sm, 0, sizeof(sm));
+	sm.mesh = mesh;
+
+			/* CHOOSE POSITION FORMAT */
+
+	TQ3Point3D pmin = mesh->points[0];
+	TQ3Point3D pmax = mesh->points[0];
+	for (int v = 1; v < mesh->numPoints; v++)
+	{
+		const TQ3Point3D* p = &mesh->points[v];
+		if (p->x < pmin.x) pmin.x = p->x;
+		if (p->y < pmin.y) pmin.y = p->y;
+		if (p->z < pmin.z) pmin.z = p->z;
+		if (p->x > pmax.x) pmax.x = p->x;
+		if (p->y > pmax.y) pmax.y = p->y;
+		if (p->z > pmax.z) pmax.z = p->z;
+	}
+
+	float extent = SDL_max(pmax.x - pmin.x, SDL_max(pmax.y - pmin.y, pmax.z - pmin.z));
+	float positionStep = extent > 0 ? extent / 65534.0f : 1.0f;
+
+	sm.positionBias = (TQ3Point3D) { (pmin.x + pmax.x) * .5f, (pmin.y + pmax.y) * .5f, (pmin.z + pmax.z) * .5f };
+	sm.positionScale = positionStep;
+	sm.positionType = (positionStep * .5f <= kStaticMeshMaxPositionError) ? GL_SHORT : GL_FLOAT;
+
+	int positionSize = sm.positionType == GL_SHORT ? 4*sizeof(int16_t) : 3*sizeof(float);
+
+			/* CHOOSE NORMAL FORMAT */
+
+	int normalSize = 0;
+	if (mesh->hasVertexNormals && mesh->vertexNormals)
+	{
+		sm.normalType = gCanUsePackedNormals ? GL_INT_2_10_10_10_REV : GL_BYTE;
+		normalSize = 4;
+	}
+
+			/* CHOOSE UV FORMAT */
+
+	int uvSize = 0;
+	if (mesh->texturingMode != kQ3TexturingModeOff && mesh->vertexUVs)
+	{
+		TQ3Param2D uvmin = mesh->vertexUVs[0];
+		TQ3Param2D uvmax = mesh->vertexUVs[0];
+		for (int v = 1; v < mesh->numPoints; v++)
+		{
+			const TQ3Param2D* uv = &mesh->vertexUVs[v];
+			if (uv->u < uvmin.u) uvmin.u = uv->u;
+			if (uv->v < uvmin.v) uvmin.v = uv->v;
+			if (uv->u > uvmax.u) uvmax.u = uv->u;
+			if (uv->v > uvmax.v) uvmax.v = uv->v;
+		}
+
+		sm.uvBias	= (TQ3Param2D) { (uvmin.u + uvmax.u) * .5f, (uvmin.v + uvmax.v) * .5f };
+		sm.uvScale	= (TQ3Param2D) { SDL_max(uvmax.u - uvmin.u, 1e-6f) / 65534.0f, SDL_max(uvmax.v - uvmin.v, 1e-6f) / 65534.0f };
+
+		bool uvFits = sm.uvScale.u * .5f <= kStaticMeshMaxUVError && sm.uvScale.v * .5f <= kStaticMeshMaxUVError;
+		sm.uvType = uvFits ? GL_SHORT : GL_FLOAT;
+		uvSize = uvFits ? 2*sizeof(int16_t) : 2*sizeof(float);
+	}
+
+	sm.colorType = (mesh->hasVertexColors && mesh->vertexColors) ? GL_UNSIGNED_BYTE : 0;
+
+			/* LAY OUT THE INTERLEAVED VERTEX */
+
+	sm.normalOffset	= positionSize;
+	sm.uvOffset		= sm.normalOffset + normalSize;
+	sm.colorOffset	= sm.uvOffset + uvSize;
+	sm.stride		= sm.colorOffset + (sm.colorType ? 4 : 0);
+
+	uint8_t* vertexData = (uint8_t*) AllocPtrClear(sm.stride * mesh->numPoints);
+
+	for (int v = 0; v < mesh->numPoints; v++)
+	{
+		uint8_t* out = vertexData + v * sm.stride;
+		const TQ3Point3D* p = &mesh->points[v];
+
+		if (sm.positionType == GL_SHORT)
+		{
+			int16_t* pos = (int16_t*) out;
+			pos[0] = QuantizeShort(p->x, sm.positionBias.x, sm.positionScale);
+			pos[1] = QuantizeShort(p->y, sm.positionBias.y, sm.positionScale);
+			pos[2] = QuantizeShort(p->z, sm.positionBias.z, sm.positionScale);
+		}
+		else
+		{
+			SDL_memcpy(out, p, sizeof(TQ3Point3D));
+		}
+
+		if (sm.normalType == GL_INT_2_10_10_10_REV)
+		{
+			const TQ3Vector3D* n = &mesh->vertexNormals[v];
+			uint32_t packedNormal = ((uint32_t) QuantizeSNorm(n->x, 511) & 0x3FF)
+								| (((uint32_t) QuantizeSNorm(n->y, 511) & 0x3FF) << 10)
+								| (((uint32_t) QuantizeSNorm(n->z, 511) & 0x3FF) << 20);
+			SDL_memcpy(out + sm.normalOffset, &packedNormal, 4);
+		}
+		else if (sm.normalType == GL_BYTE)
+		{
+			const TQ3Vector3D* n = &mesh->vertexNormals[v];
+			int8_t* nrm = (int8_t*) (out + sm.normalOffset);
+			nrm[0] = (int8_t) QuantizeSNorm(n->x, 127);
+			nrm[1] = (int8_t) QuantizeSNorm(n->y, 127);
+			nrm[2] = (int8_t) QuantizeSNorm(n->z, 127);
+		}
+
+		if (sm.uvType == GL_SHORT)
+		{
+			int16_t* uv = (int16_t*) (out + sm.uvOffset);
+			uv[0] = QuantizeShort(mesh->vertexUVs[v].u, sm.uvBias.u, sm.uvScale.u);
+			uv[1] = QuantizeShort(mesh->vertexUVs[v].v, sm.uvBias.v, sm.uvScale.v);
+		}
+		else if (sm.uvType == GL_FLOAT)
+		{
+			SDL_memcpy(out + sm.uvOffset, &mesh->vertexUVs[v], sizeof(TQ3Param2D));
+		}
+
+		if (sm.colorType)
+		{
+			const TQ3ColorRGBA* c = &mesh->vertexColors[v];
+			uint8_t* rgba = out + sm.colorOffset;
+			rgba[0] = (uint8_t) SDL_roundf(SDL_clamp(c->r, 0, 1) * 255.0f);
+			rgba[1] = (uint8_t) SDL_roundf(SDL_clamp(c->g, 0, 1) * 255.0f);
+			rgba[2] = (uint8_t) SDL_roundf(SDL_clamp(c->b, 0, 1) * 255.0f);
+			rgba[3] = (uint8_t) SDL_roundf(SDL_clamp(c->a, 0, 1) * 255.0f);
+		}
+	}
+
+			/* PACK INDICES */
+
+	int numIndices = mesh->numTriangles * 3;
+	const void* indexData = mesh->triangles;
+	uint16_t* shortIndices = nil;
+	int indexSize = sizeof(uint32_t);
+
+	sm.indexType = GL_UNSIGNED_INT;
+	if (mesh->numPoints <= 0xFFFF)
+	{
+		shortIndices = (uint16_t*) AllocPtr(numIndices * sizeof(uint16_t));
+		const uint32_t* src = &mesh->triangles[0].pointIndices[0];
+		for (int j = 0; j < numIndices; j++)
+			shortIndices[j] = (uint16_t) src[j];
+		indexData = shortIndices;
+		indexSize = sizeof(uint16_t);
+		sm.indexType = GL_UNSIGNED_SHORT;
+	}
+
+			/* UPLOAD */
+
+	pglGenBuffers(1, &sm.vertexBuffer);
+	pglGenBuffers(1, &sm.indexBuffer);
+
+	BindArrayBuffer(sm.vertexBuffer);
+	pglBufferData(GL_ARRAY_BUFFER, sm.stride * mesh->numPoints, vertexData, GL_STATIC_DRAW);
+	BindElementBuffer(sm.indexBuffer);
+	pglBufferData(GL_ELEMENT_ARRAY_BUFFER, indexSize * numIndices, indexData, GL_STATIC_DRAW);
+	BindArrayBuffer(0);
+	BindElementBuffer(0);
+	CHECK_GL_ERROR();
+
+	DisposePtr((Ptr) vertexData);
+	if (shortIndices)
+		DisposePtr((Ptr) shortIndices);
+
+#if RENDER_VULKAN
+	sm.vulkanMesh = VkRender_IsActive() ? VkRender_UploadStaticMesh(mesh) : -1;
+#endif
+
+	RegisterStaticMesh(&sm);
+#endif
+}
+
+static void RegisterStaticMesh(const StaticMeshBuffer* sm)
+{
+	uint32_t slot = HashMeshPointer(sm->mesh);
+	while (gStaticMeshTable[slot].mesh)
+		slot = (slot+1) & (STATIC_MESH_TABLE_SIZE-1);
+
+	gStaticMeshTable[slot] = *sm;
+	gNumStaticMeshes++;
+}
+
+/****************** RENDER: RELEASE STATIC MESH ********************/
+//
+// Frees the GPU copy of a mesh (if any). The mesh goes back to being drawn from client arrays.
+// Call this before disposing of the mesh, or before modifying its vertex data at runtime.
+//
+
+void Render_ReleaseStaticMesh(const TQ3TriMeshData* mesh)
+{
+	if (gNumStaticMeshes == 0)
+		return;
+
+	uint32_t slot = HashMeshPointer(mesh);
+	while (gStaticMeshTable[slot].mesh && gStaticMeshTable[slot].mesh != mesh)
+		slot = (slot+1) & (STATIC_MESH_TABLE_SIZE-1);
+
+	if (!gStaticMeshTable[slot].mesh)
+		return;
+
+#if !OSXPPC
+	if (!gStaticMeshTable[slot].pooled)						// pool buffers go in Render_DisposeMeshPool
+	{
+		BindArrayBuffer(0);
+		BindElementBuffer(0);
+		pglDeleteBuffers(1, &gStaticMeshTable[slot].vertexBuffer);
+		pglDeleteBuffers(1, &gStaticMeshTable[slot].indexBuffer);
+	}
+#endif
+#if RENDER_VULKAN
+	if (gStaticMeshTable[slot].vulkanMesh >= 0)
+		VkRender_ReleaseStaticMesh(gStaticMeshTable[slot].vulkanMesh);
+#endif
+	gNumStaticMeshes--;
+
+			/* CLOSE THE GAP (BACKWARD-SHIFT DELETION) */
+
+	uint32_t hole = slot;
+	uint32_t next = slot;
+	for (;;)
+	{
+		gStaticMeshTable[hole].mesh = nil;
+
+		for (;;)
+		{
+			next = (next+1) & (STATIC_MESH_TABLE_SIZE-1);
+			if (!gStaticMeshTable[next].mesh)
+				return;
+
+			uint32_t home = HashMeshPointer(gStaticMeshTable[next].mesh);
+
+			// Entry can stay put if its home slot lies cyclically in (hole, next]
+			bool stays = (hole <= next)
+					? (hole < home && home <= next)
+					: (hole < home || home <= next);
+			if (!stays)
+				break;
+		}
+
+		gStaticMeshTable[hole] = gStaticMeshTable[next];
+		hole = next;
+	}
+}
+
+#pragma mark -
+
+/****************************/
+/*    MESH POOL             */
+/****************************/
+
+/****************** RENDER: CREATE MESH POOL ********************/
+//
+// Gives a set of meshes with identical vertex & triangle counts (the terrain supertiles)
+// a fixed slot each in one shared vertex buffer and one shared index buffer.
+// Their vertex data changes over time, so unlike Render_UploadStaticMesh nothing is quantized
+// (colors included -- they're the baked lighting, and bytes would band it)
+// and each slot is refilled by Render_UpdatePooledMesh.
+//
+// Each slot's indices are offset by the slot's first vertex, so every pooled mesh is drawn
+// with the same vertex pointers; only the texture and the offset into the index buffer change.
+//
+
+void Render_CreateMeshPool(TQ3TriMeshData** meshes, int numMeshes)
+{
+	GAME_ASSERT_MESSAGE(!gMeshPoolMeshes, "Only one mesh pool at a time");
+
+	if (!gCanUseBufferObjects || !pglBufferSubData || numMeshes <= 0)
+		return;
+
+	if (gNumStaticMeshes + numMeshes > STATIC_MESH_TABLE_SIZE / 2)		// keep the table sparse
+	{
+		SDL_LogWarn(SDL_LOG_CATEGORY_RENDER, "No room for a pool of %d meshes; they'll be streamed instead.", numMeshes);
+		return;
+	}
+
+#if !OSXPPC
+	const int pointsPerSlot = meshes[0]->numPoints;
+	const int trianglesPerSlot = meshes[0]->numTriangles;
+	const GLsizei stride = sizeof(TQ3Point3D) + sizeof(TQ3Vector3D) + sizeof(TQ3Param2D) + sizeof(TQ3ColorRGBA);
+	const GLenum indexType = (numMeshes * pointsPerSlot <= 0xFFFF) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	const int indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+
+	gMeshPoolMeshes = (const TQ3TriMeshData**) AllocPtr(sizeof(TQ3TriMeshData*) * numMeshes);
+	gMeshPoolScratch = (uint8_t*) AllocPtr(SDL_max(stride * pointsPerSlot, indexSize * 3 * trianglesPerSlot));
+	GAME_ASSERT(gMeshPoolMeshes && gMeshPoolScratch);
+
+	gMeshPoolSize = numMeshes;
+	gMeshPoolPointsPerSlot = pointsPerSlot;
+	gMeshPoolTrianglesPerSlot = trianglesPerSlot;
+
+	pglGenBuffers(1, &gMeshPoolVertexBuffer);
+	pglGenBuffers(1, &gMeshPoolIndexBuffer);
+	BindArrayBuffer(gMeshPoolVertexBuffer);
+	pglBufferData(GL_ARRAY_BUFFER, numMeshes * pointsPerSlot * stride, nil, GL_DYNAMIC_DRAW);
+	BindElementBuffer(gMeshPoolIndexBuffer);
+	pglBufferData(GL_ELEMENT_ARRAY_BUFFER, numMeshes * trianglesPerSlot * 3 * indexSize, nil, GL_DYNAMIC_DRAW);
+	BindArrayBuffer(0);
+	BindElementBuffer(0);
+	CHECK_GL_ERROR();
+
+	for (int i = 0; i < numMeshes; i++)
+	{
+		const TQ3TriMeshData* mesh = meshes[i];
+
+		GAME_ASSERT(mesh->numPoints == pointsPerSlot && mesh->numTriangles == trianglesPerSlot);
+		GAME_ASSERT(mesh->vertexNormals && mesh->vertexUVs && mesh->vertexColors);
+
+		StaticMeshBuffer sm;
+		SDL_memset(&sm, 0, sizeof(sm));
+		sm.mesh			= mesh;
+		sm.vertexBuffer	= gMeshPoolVertexBuffer;
+		sm.indexBuffer	= gMeshPoolIndexBuffer;
+		sm.indexType	= indexType;
+		sm.stride		= stride;
+		sm.positionType	= GL_FLOAT;
+		sm.normalType	= GL_FLOAT;
+		sm.uvType		= GL_FLOAT;
+		sm.colorType	= GL_FLOAT;
+		sm.normalOffset	= sizeof(TQ3Point3D);
+		sm.uvOffset		= sm.normalOffset + sizeof(TQ3Vector3D);
+		sm.colorOffset	= sm.uvOffset + sizeof(TQ3Param2D);
+		sm.pooled		= true;
+		sm.poolSlot		= i;
+		sm.indexOffset	= (GLintptr) i * trianglesPerSlot * 3 * indexSize;
+#if RENDER_VULKAN
+		sm.vulkanMesh	= -1;								// pooled meshes are streamed to Vulkan every frame
+#endif
+
+		gMeshPoolMeshes[i] = mesh;
+		RegisterStaticMesh(&sm);
+		Render_UpdatePooledMesh(mesh);
+	}
+#endif
+}
+
+/****************** RENDER: UPDATE POOLED MESH ********************/
+//
+// Copies a pooled mesh's current vertices & triangles into its slot.
+// Call this from the main thread whenever the mesh has been rebuilt.
+//
+
+void Render_UpdatePooledMesh(const TQ3TriMeshData* mesh)
+{
+	const StaticMeshBuffer* sm = FindStaticMesh(mesh);
+	if (!sm || !sm->pooled)
+		return;
+
+#if !OSXPPC
+	const int n = gMeshPoolPointsPerSlot;
+	const int numIndices = gMeshPoolTrianglesPerSlot * 3;
+	const uint32_t firstVertex = sm->poolSlot * n;
+
+			/* VERTICES */
+
+	for (int v = 0; v < n; v++)
+	{
+		uint8_t* out = gMeshPoolScratch + v * sm->stride;
+
+		SDL_memcpy(out, &mesh->points[v], sizeof(TQ3Point3D));
+		SDL_memcpy(out + sm->normalOffset, &mesh->vertexNormals[v], sizeof(TQ3Vector3D));
+		SDL_memcpy(out + sm->uvOffset, &mesh->vertexUVs[v], sizeof(TQ3Param2D));
+
+		SDL_memcpy(out + sm->colorOffset, &mesh->vertexColors[v], sizeof(TQ3ColorRGBA));	// only read when the mesh has vertex colors
+	}
+
+	BindArrayBuffer(gMeshPoolVertexBuffer);
+	pglBufferSubData(GL_ARRAY_BUFFER, (GLintptr) firstVertex * sm->stride, n * sm->stride, gMeshPoolScratch);
+	BindArrayBuffer(0);
+
+			/* TRIANGLES, OFFSET TO THIS SLOT'S VERTICES */
+
+	const uint32_t* src = &mesh->triangles[0].pointIndices[0];
+
+	if (sm->indexType == GL_UNSIGNED_SHORT)
+	{
+		uint16_t* dst = (uint16_t*) gMeshPoolScratch;
+		for (int j = 0; j < numIndices; j++)
+			dst[j] = (uint16_t) (firstVertex + src[j]);
+		BindElementBuffer(gMeshPoolIndexBuffer);
+		pglBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sm->indexOffset, numIndices * sizeof(uint16_t), gMeshPoolScratch);
+	}
+	else
+	{
+		uint32_t* dst = (uint32_t*) gMeshPoolScratch;
+		for (int j = 0; j < numIndices; j++)
+			dst[j] = firstVertex + src[j];
+		BindElementBuffer(gMeshPoolIndexBuffer);
+		pglBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sm->indexOffset, numIndices * sizeof(uint32_t), gMeshPoolScratch);
+	}
+	BindElementBuffer(0);
+	CHECK_GL_ERROR();
+#endif
+}
+
+/****************** RENDER: DISPOSE MESH POOL ********************/
+
+void Render_DisposeMeshPool(void)
+{
+	if (!gMeshPoolMeshes)
+		return;
+
+	for (int i = 0; i < gMeshPoolSize; i++)
+		Render_ReleaseStaticMesh(gMeshPoolMeshes[i]);
+
+#if !OSXPPC
+	BindArrayBuffer(0);
+	BindElementBuffer(0);
+	pglDeleteBuffers(1, &gMeshPoolVertexBuffer);
+	pglDeleteBuffers(1, &gMeshPoolIndexBuffer);
+#endif
+	gMeshPoolVertexBuffer = 0;
+	gMeshPoolIndexBuffer = 0;
+
+	DisposePtr((Ptr) gMeshPoolMeshes);
+	DisposePtr((Ptr) gMeshPoolScratch);
+	gMeshPoolMeshes = nil;
+	gMeshPoolScratch = nil;
+	gMeshPoolSize = 0;
+}
+
+#pragma mark -
+
+/****************************/
+/*    STREAMING BUFFER      */
+/****************************/
+
+static void InitStreamBuffer(void)
+{
+	if (!gCanStreamVertices || gStreamBuffer)
+		return;
+
+#if !OSXPPC
+	pglGenBuffers(1, &gStreamBuffer);
+	BindArrayBuffer(gStreamBuffer);
+
+	if (gCanMapStreamPersistently)
+	{
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+		pglBufferStorage(GL_ARRAY_BUFFER, STREAM_FRAMES * STREAM_REGION_SIZE, nil, flags);
+		gStreamMapping = (uint8_t*) pglMapBufferRange(GL_ARRAY_BUFFER, 0, STREAM_FRAMES * STREAM_REGION_SIZE, flags);
+
+		if (!gStreamMapping)
+		{
+			SDL_LogWarn(SDL_LOG_CATEGORY_RENDER, "Couldn't map the streaming buffer; orphaning it every frame instead.");
+			pglDeleteBuffers(1, &gStreamBuffer);					// immutable storage can't be respecified
+			pglGenBuffers(1, &gStreamBuffer);
+			gState.boundArrayBuffer = 0;
+			BindArrayBuffer(gStreamBuffer);
+			gCanMapStreamPersistently = false;
+		}
+	}
+
+	if (!gCanMapStreamPersistently)
+	{
+		pglBufferData(GL_ARRAY_BUFFER, STREAM_REGION_SIZE, nil, GL_STREAM_DRAW);
+	}
+
+	BindArrayBuffer(0);
+	CHECK_GL_ERROR();
+#endif
+
+	gStreamRegion = 0;
+	gStreamOffset = 0;
+}
+
+static void BeginStreamFrame(void)
+{
+	if (!gStreamBuffer)
+		return;
+
+#if !OSXPPC
+	if (gStreamMapping)
+	{
+		// Move on to the next region, waiting for the GPU to be done with it if need be
+		gStreamRegion = (gStreamRegion + 1) % STREAM_FRAMES;
+
+		GLsync fence = gStreamFences[gStreamRegion];
+		if (fence)
+		{
+			pglClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);		// 1 second, in ns
+			pglDeleteSync(fence);
+			gStreamFences[gStreamRegion] = nil;
+		}
+	}
+	else if (gStreamOffset != 0)
+	{
+		// Give the driver fresh storage; the old one lives on until the GPU is done with it
+		BindArrayBuffer(gStreamBuffer);
+		pglBufferData(GL_ARRAY_BUFFER, STREAM_REGION_SIZE, nil, GL_STREAM_DRAW);
+		BindArrayBuffer(0);
+	}
+#endif
+
+	gStreamOffset = 0;
+	gStreamFull = false;
+}
+
+static void EndStreamFrame(void)
+{
+	gRenderStats.streamedBytes = (int) gStreamOffset;
+
+#if !OSXPPC
+	if (gStreamMapping && gStreamOffset != 0)
+	{
+		gStreamFences[gStreamRegion] = pglFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+#endif
+}
+
+static inline size_t StreamAlign(size_t size)
+{
+	return (size + STREAM_ALIGNMENT-1) & ~(size_t)(STREAM_ALIGNMENT-1);
+}
+
+static bool StreamHasRoom(size_t size)
+{
+	static bool warned = false;
+
+	if (gStreamOffset + size <= STREAM_REGION_SIZE)
+		return true;
+
+	if (!warned)
+	{
+		SDL_LogWarn(SDL_LOG_CATEGORY_RENDER, "Streaming buffer full (%d KB); drawing the rest of the frame from client arrays.",
+				STREAM_REGION_SIZE / 1024);
+		warned = true;
+	}
+	gStreamFull = true;
+	return false;
+}
+
+/****************** STREAM DATA ********************/
+//
+// Copies data into the current region of the streaming buffer.
+// In orphaning mode, the buffer is left bound to the given target.
+//
+// OUTPUT: offset to pass to gl*Pointer/glDrawElements, or -1 if it doesn't fit
+//
+
+static GLintptr StreamData(GLenum target, const void* data, size_t size)
+{
+	if (!gStreamBuffer || gStreamFull)
+		return -1;
+
+	if (!StreamHasRoom(size))
+		return -1;
+
+	GLintptr offset = gStreamOffset;
+
+#if !OSXPPC
+	if (gStreamMapping)
+	{
+		offset += gStreamRegion * STREAM_REGION_SIZE;
+		SDL_memcpy(gStreamMapping + offset, data, size);
+	}
+	else
+	{
+		if (target == GL_ELEMENT_ARRAY_BUFFER)
+			BindElementBuffer(gStreamBuffer);
+		else
+			BindArrayBuffer(gStreamBuffer);
+		pglBufferSubData(target, offset, size, data);
+	}
+#endif
+
+	gStreamOffset += StreamAlign(size);
+	return offset;
+}
+
+/****************** STREAM MESH ARRAYS ********************/
+//
+// Copies the vertex arrays that a mesh will be drawn with into the streaming buffer.
+// Either all of them make it in, or none do.
+//
+
+static bool StreamMeshArrays(const TQ3TriMeshData* mesh, const TQ3Param2D* uvs, bool hasNormals, StreamedArrays* out)
+{
+	const size_t n = mesh->numPoints;
+
+	if (!gStreamBuffer || gStreamFull || n == 0)
+		return false;
+
+	size_t needed = StreamAlign(n * sizeof(TQ3Point3D));
+	if (hasNormals)
+		needed += StreamAlign(n * sizeof(TQ3Vector3D));
+	if (uvs)
+		needed += StreamAlign(n * sizeof(TQ3Param2D));
+	if (mesh->hasVertexColors)
+		needed += StreamAlign(n * sizeof(TQ3ColorRGBA));
+
+	if (!StreamHasRoom(needed))
+		return false;
+
+	out->points		= StreamData(GL_ARRAY_BUFFER, mesh->points, n * sizeof(TQ3Point3D));
+	out->normals	= hasNormals ? StreamData(GL_ARRAY_BUFFER, mesh->vertexNormals, n * sizeof(TQ3Vector3D)) : -1;
+	out->uvs		= uvs ? StreamData(GL_ARRAY_BUFFER, uvs, n * sizeof(TQ3Param2D)) : -1;
+	out->colors		= mesh->hasVertexColors ? StreamData(GL_ARRAY_BUFFER, mesh->vertexColors, n * sizeof(TQ3ColorRGBA)) : -1;
+	return true;
+}
+
+#pragma mark -
+
+/****************************/
+/*    FXAA POST-PROCESS     */
+/****************************/
+
+#if !OSXPPC
+static GLuint CompileFXAAShader(GLenum type, const char* source)
+{
+	GLuint shader = pglCreateShader(type);
+	pglShaderSource(shader, 1, &source, nil);
+	pglCompileShader(shader);
+
+	GLint status = GL_FALSE;
+	pglGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+	if (status != GL_TRUE)
+	{
+		char log[1024];
+		pglGetShaderInfoLog(shader, sizeof(log), nil, log);
+		SDL_Log("FXAA shader didn't compile: %s", log);
+		pglDeleteShader(shader);
+		return 0;
+	}
+
+	return shader;
+}
+
+static bool PrepareFXAA(void)
+{
+	if (gFXAAFailed || !gCanUseShaders)
+		return false;
+
+			/* BUILD THE PROGRAM ONCE */
+
+	if (!gFXAAProgram)
+	{
+		GLuint vs = CompileFXAAShader(GL_VERTEX_SHADER, kFXAAVertexShader);
+		GLuint fs = CompileFXAAShader(GL_FRAGMENT_SHADER, kFXAAFragmentShader);
+
+		GLint linked = GL_FALSE;
+		if (vs && fs)
+		{
+			gFXAAProgram = pglCreateProgram();
+			pglAttachShader(gFXAAProgram, vs);
+			pglAttachShader(gFXAAProgram, fs);
+			pglLinkProgram(gFXAAProgram);
+			pglGetProgramiv(gFXAAProgram, GL_LINK_STATUS, &linked);
+		}
+
+		if (vs) pglDeleteShader(vs);			// flagged for deletion; they live on with the program
+		if (fs) pglDeleteShader(fs);
+
+		if (linked != GL_TRUE)
+		{
+			SDL_Log("FXAA unavailable; drawing without antialiasing.");
+			gFXAAFailed = true;
+			return false;
+		}
+
+		pglUseProgram(gFXAAProgram);
+		pglUniform1i(pglGetUniformLocation(gFXAAProgram, "uTexture"), 0);
+		gFXAAUniformTexelSize = pglGetUniformLocation(gFXAAProgram, "uTexelSize");
+		pglUseProgram(0);
+		CHECK_GL_ERROR();
+	}
+
+			/* (RE)ALLOCATE THE COPY OF THE VIEWPORT */
+
+	if (gFXAATextureWidth != gState.viewportWidth || gFXAATextureHeight != gState.viewportHeight)
+	{
+		if (gFXAATexture)
+		{
+			glDeleteTextures(1, &gFXAATexture);
+			if (gState.boundTexture == gFXAATexture)
+				gState.boundTexture = 0;
+		}
+
+		gFXAATexture = Render_LoadTexture(GL_RGB, gState.viewportWidth, gState.viewportHeight,
+				GL_RGB, GL_UNSIGNED_BYTE, nil, kRendererTextureFlags_ClampBoth);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);		// FXAA relies on bilinear taps
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+		gFXAATextureWidth = gState.viewportWidth;
+		gFXAATextureHeight = gState.viewportHeight;
+	}
+
+	return true;
+}
+#endif
+
+/****************** APPLY FXAA ********************/
+//
+// Copies the finished 3D viewport out of the back buffer, then draws it back over itself
+// through the FXAA shader. No FBO needed, so it works on any GL 2.0 context,
+// and the window never has to be recreated like it does when switching MSAA levels.
+//
+
+static void ApplyFXAA(void)
+{
+#if !OSXPPC
+	if (gState.viewportWidth <= 0 || gState.viewportHeight <= 0)
+		return;
+
+	if (!PrepareFXAA())
+		return;
+
+	Render_BindTexture(gFXAATexture);
+	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
+			gState.viewportX, gState.viewportY, gState.viewportWidth, gState.viewportHeight);
+	CHECK_GL_ERROR();
+
+	glViewport(gState.viewportX, gState.viewportY, gState.viewportWidth, gState.viewportHeight);
+
+	Render_Enter2D();
+	DisableState(GL_BLEND);
+	EnableState(GL_TEXTURE_2D);
+	EnableClientState(GL_TEXTURE_COORD_ARRAY);
+
+	pglUseProgram(gFXAAProgram);
+	pglUniform2f(gFXAAUniformTexelSize, 1.0f / gFXAATextureWidth, 1.0f / gFXAATextureHeight);
+
+	static const TQ3Param2D kViewportCopyUVs[4] = { {0,0}, {1,0}, {0,1}, {1,1} };		// GL origin is bottom-left, like the copy
+	glVertexPointer(2, GL_FLOAT, 0, kFullscreenQuadPointsNDC);
+	glTexCoordPointer(2, GL_FLOAT, 0, kViewportCopyUVs);
+	glDrawElements(GL_TRIANGLES, 3*2, GL_UNSIGNED_BYTE, kFullscreenQuadTriangles);
+
+	pglUseProgram(0);
+	Render_Exit2D();
+	CHECK_GL_ERROR();
+#endif
+}
+
+#pragma mark -
+
+/****************************/
+/*    OVERDRAW HEATMAP      */
+/****************************/
+
+/****************** DRAW OVERDRAW HEATMAP ********************/
+//
+// In overdraw mode every fragment written to the 3D viewport increments the stencil buffer.
+// Read the counts back, fill in the stats, and draw them over the viewport as a heatmap:
+// black = nothing drawn, blue = drawn once, then green, yellow, orange, red, magenta, white = 7+.
+//
+// The readback stalls the GPU, so this is strictly a debugging aid.
+//
+
+static void DrawOverdrawHeatmap(void)
+{
+#if !OSXPPC
+static const uint8_t kHeatColors[8][3] =
+{
+	{  0,   0,   0},
+	{  0,  32, 160},
+	{  0, 160,  64},
+	{224, 224,   0},
+	{255, 128,   0},
+	{255,   0,   0},
+	{255,   0, 255},
+	{255, 255, 255},
+};
+const int	w = gState.viewportWidth;
+const int	h = gState.viewportHeight;
+uint64_t	sum = 0;
+int			max = 0;
+
+	if (w <= 0 || h <= 0)
+		return;
+
+			/* (RE)ALLOCATE BUFFERS & TEXTURE FOR THIS VIEWPORT SIZE */
+
+	if (gOverdrawTextureWidth != w || gOverdrawTextureHeight != h)
+	{
+		if (gOverdrawTexture)
+		{
+			glDeleteTextures(1, &gOverdrawTexture);
+			if (gState.boundTexture == gOverdrawTexture)
+				gState.boundTexture = 0;
+		}
+		if (gOverdrawCounts)
+			DisposePtr((Ptr) gOverdrawCounts);
+		if (gOverdrawPixels)
+			DisposePtr((Ptr) gOverdrawPixels);
+
+		gOverdrawCounts = (uint8_t*) AllocPtr(w * h);
+		gOverdrawPixels = (uint8_t*) AllocPtr(w * h * 4);
+		GAME_ASSERT(gOverdrawCounts && gOverdrawPixels);
+
+		gOverdrawTexture = Render_LoadTexture(GL_RGBA, w, h, GL_RGBA, GL_UNSIGNED_BYTE, nil, kRendererTextureFlags_ClampBoth);
+		gOverdrawTextureWidth = w;
+		gOverdrawTextureHeight = h;
+	}
+
+			/* READ BACK THE COUNTS */
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(gState.viewportX, gState.viewportY, w, h, GL_STENCIL_INDEX, GL_UNSIGNED_BYTE, gOverdrawCounts);
+	CHECK_GL_ERROR();
+
+	for (int i = 0; i < w * h; i++)
+	{
+		int count = gOverdrawCounts[i];
+		const uint8_t* color = kHeatColors[SDL_min(count, 7)];
+
+		sum += count;
+		if (count > max)
+			max = count;
+
+		gOverdrawPixels[i*4 + 0] = color[0];
+		gOverdrawPixels[i*4 + 1] = color[1];
+		gOverdrawPixels[i*4 + 2] = color[2];
+		gOverdrawPixels[i*4 + 3] = 0xFF;
+	}
+
+	gRenderStats.overdrawAverage = (float) sum / (w * h);
+	gRenderStats.overdrawMax = max;
+
+			/* DRAW THE HEATMAP OVER THE VIEWPORT */
+
+	Render_BindTexture(gOverdrawTexture);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, gOverdrawPixels);
+	CHECK_GL_ERROR();
+
+	glViewport(gState.viewportX, gState.viewportY, w, h);
+
+	Render_Enter2D();
+	DisableState(GL_BLEND);
+	EnableState(GL_TEXTURE_2D);
+	EnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glColor4f(1, 1, 1, 1);
+
+	static const TQ3Param2D kViewportCopyUVs[4] = { {0,0}, {1,0}, {0,1}, {1,1} };		// GL origin is bottom-left, like the readback
+	glVertexPointer(2, GL_FLOAT, 0, kFullscreenQuadPointsNDC);
+	glTexCoordPointer(2, GL_FLOAT, 0, kViewportCopyUVs);
+	glDrawElements(GL_TRIANGLES, 3*2, GL_UNSIGNED_BYTE, kFullscreenQuadTriangles);
+
+	Render_Exit2D();
+	CHECK_GL_ERROR();
+#endif
 }
 
 #pragma mark -
@@ -0,0 +1,48 @@
+// VULKANMESH.FRAG
+// Fixed-function GL fragment stage as Renderer.c sets it up for the mesh queue:
+// GL_MODULATE texturing, alpha test (GL_GREATER .4999) on opaque meshes, linear fog.
+// Compiled to SPIR-V at build time (NANOSAUR_VULKAN); see VulkanRenderer.c.
+
+#version 450
+
+layout(constant_id = 3) const bool kTexture			= false;
+layout(constant_id = 4) const bool kAlphaTest		= true;
+
+layout(set = 0, binding = 0) uniform Frame
+{
+	mat4	worldToView;
+	mat4	viewToFrustum;
+	vec4	ambient;
+	vec4	toLight[4];
+	vec4	lightColor[4];
+	vec4	fogColor;
+	vec4	fogRange;
+	int		numLights;
+} frame;
+
+layout(set = 1, binding = 0) uniform sampler2D meshTexture;
+
+layout(location = 0) in vec4 inColor;
+layout(location = 1) in vec2 inUV;
+layout(location = 2) in float inEyeDepth;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+	vec4 color = inColor;
+
+	if (kTexture)
+		color *= texture(meshTexture, inUV);
+
+	if (kAlphaTest && color.a <= 0.4999)
+		discard;
+
+	if (frame.fogRange.z != 0.0)
+	{
+		float visibility = clamp((frame.fogRange.y - inEyeDepth) / (frame.fogRange.y - frame.fogRange.x), 0.0, 1.0);
+		color.rgb = mix(frame.fogColor.rgb, color.rgb, visibility);
+	}
+
+	outColor = color;
+}
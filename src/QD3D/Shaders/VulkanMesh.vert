@@ -0,0 +1,67 @@
+// VULKANMESH.VERT
+// Fixed-function GL vertex stage as Renderer.c sets it up for the mesh queue:
+// per-vertex (Gouraud) lighting with GL_COLOR_MATERIAL on ambient & diffuse, directional fill lights.
+// Compiled to SPIR-V at build time (NANOSAUR_VULKAN); see VulkanRenderer.c.
+
+#version 450
+
+layout(constant_id = 0) const bool kLighting		= true;
+layout(constant_id = 1) const bool kNormals			= true;		// else GL's current normal, (0,0,1)
+layout(constant_id = 2) const bool kVertexColors	= false;	// else the diffuse color (glColor)
+
+layout(set = 0, binding = 0) uniform Frame
+{
+	mat4	worldToView;
+	mat4	viewToFrustum;
+	vec4	ambient;					// rgb
+	vec4	toLight[4];					// xyz: world-space direction towards each fill light
+	vec4	lightColor[4];				// rgb
+	vec4	fogColor;					// rgb
+	vec4	fogRange;					// x: start, y: end, z: 1 if fog is on
+	int		numLights;
+} frame;
+
+layout(push_constant) uniform Draw
+{
+	mat4	localToWorld;
+	vec4	diffuseColor;
+} draw;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec2 inUV;
+layout(location = 3) in vec4 inColor;
+
+layout(location = 0) out vec4 outColor;
+layout(location = 1) out vec2 outUV;
+layout(location = 2) out float outEyeDepth;
+
+void main()
+{
+	vec4 worldPos = draw.localToWorld * vec4(inPosition, 1.0);
+	vec4 viewPos = frame.worldToView * worldPos;
+	vec4 clipPos = frame.viewToFrustum * viewPos;
+
+	// GL clip space to Vulkan: y points down, z goes from 0 to 1
+	clipPos.y = -clipPos.y;
+	clipPos.z = (clipPos.z + clipPos.w) * 0.5;
+	gl_Position = clipPos;
+
+	vec4 color = kVertexColors ? inColor : draw.diffuseColor;
+
+	if (kLighting)
+	{
+		// GL_NORMALIZE; the game only scales uniformly, so no inverse transpose is needed
+		vec3 normal = normalize(mat3(draw.localToWorld) * (kNormals ? inNormal : vec3(0.0, 0.0, 1.0)));
+
+		vec3 lit = frame.ambient.rgb;
+		for (int i = 0; i < frame.numLights; i++)
+			lit += max(dot(normal, frame.toLight[i].xyz), 0.0) * frame.lightColor[i].rgb;
+
+		color.rgb = min(color.rgb * lit, vec3(1.0));
+	}
+
+	outColor = color;
+	outUV = inUV;
+	outEyeDepth = -viewPos.z;
+}
@@ -0,0 +1,2327 @@
+/****************************/
+/*   	VULKAN RENDERER.C   */
+/****************************/
+//
+// Vulkan backend for the 3D mesh queue. Built with -DNANOSAUR_VULKAN=ON, turned on with --vulkan.
+//
+// GL still draws and presents everything. With this backend on, Render_EndFrame also replays
+// the frame's sorted mesh queue here (see QueueVulkanDraws in Renderer.c) into an offscreen
+// color & depth target the size of the 3D viewport. Both backends draw the same frames, so
+// their CPU submission cost (nanosaur_submit_ms vs nanosaur_vulkan_submit_ms) and their output
+// (VkRender_ReadPixels vs glReadPixels) can be compared. NanosaurBench --vulkan does both,
+// and CI runs it on Mesa's software Vulkan driver (lavapipe).
+//
+//	- Every state combination DrawMeshList can use (kPipelineState_*) gets its pipeline when
+//	  the backend starts, so nothing is compiled mid-frame.
+//	- Static meshes are copied once (VkRender_UploadStaticMesh). Everything else, including
+//	  the pooled terrain supertiles, is streamed into a per-frame buffer like GL's stream buffer.
+//	- The opaque terrain and the objects are recorded into two secondary command buffers at once,
+//	  the terrain on a helper thread, then run in one render pass.
+//
+// GL-only: 2D (backdrop, infobar, fades), FXAA, overdraw mode and point lights (DynamicLights.c).
+//
+
+
+/****************************/
+/*    EXTERNALS             */
+/****************************/
+
+#if RENDER_VULKAN
+
+#include <vulkan/vulkan.h>
+#include "game.h"
+
+extern	TQ3Matrix4x4			gCameraWorldToViewMatrix;
+extern	TQ3Matrix4x4			gCameraViewToFrustumMatrix;
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+typedef struct
+{
+	VkBuffer				buffer;
+	VkDeviceMemory			memory;
+	uint8_t*				mapped;
+	VkDeviceSize			size;
+}VulkanBuffer;
+
+typedef struct
+{
+	VkImage					image;
+	VkImageView				view;
+	VkDeviceMemory			memory;
+	VkDescriptorSet			descriptorSet;
+	int						width;
+	int						height;
+	GLenum					internalFormat;			// GL_RGB: updates drop their alpha too
+}VulkanTexture;
+
+		/* STATIC MESH COPY */
+		//
+		// Sub-allocated from a VulkanStaticBlock. Arrays the mesh didn't have are VK_WHOLE_SIZE.
+		//
+
+typedef struct
+{
+	bool					inUse;
+	int						block;
+	VkDeviceSize			points;
+	VkDeviceSize			normals;
+	VkDeviceSize			uvs;
+	VkDeviceSize			colors;
+	VkDeviceSize			triangles;
+	int						numTriangles;
+}VulkanStaticMesh;
+
+typedef struct
+{
+	VulkanBuffer			buffer;
+	VkDeviceSize			used;
+	int						liveMeshes;
+}VulkanStaticBlock;
+
+		/* FRAME UNIFORMS (std140, see Shaders/VulkanMesh.vert) */
+
+typedef struct
+{
+	float					worldToView[16];
+	float					viewToFrustum[16];
+	float					ambient[4];
+	float					toLight[MAX_FILL_LIGHTS][4];
+	float					lightColor[MAX_FILL_LIGHTS][4];
+	float					fogColor[4];
+	float					fogRange[4];
+	int32_t					numLights;
+	int32_t					pad[3];
+}VulkanFrameUniforms;
+
+typedef struct
+{
+	TQ3Matrix4x4			localToWorld;
+	TQ3ColorRGBA			diffuseColor;
+}VulkanPushConstants;
+
+		/* ONE RECORDED DRAW */
+
+typedef struct
+{
+	VkPipeline				pipeline;
+	VkPipeline				frontCullPipeline;		// two-sided blend: backfaces first with this, then pipeline
+	VkDescriptorSet			textureSet;
+	VkBuffer				vertexBuffers[4];		// points, normals, UVs, colors
+	VkDeviceSize			vertexOffsets[4];
+	VkBuffer				indexBuffer;
+	VkDeviceSize			indexOffset;
+	uint32_t				numIndices;
+	VulkanPushConstants		push;
+	bool					isTerrain;
+}VulkanDrawCommand;
+
+		/* SOMETHING TO DESTROY ONCE THE GPU IS DONE WITH IT */
+
+typedef struct
+{
+	uint64_t				frameSerial;			// destroy once this frame has finished
+	VkBuffer				buffer;
+	VkImage					image;
+	VkImageView				view;
+	VkDeviceMemory			memory;
+	VkDescriptorSet			descriptorSet;
+}VulkanGarbage;
+
+typedef struct
+{
+	GLuint					textureName;
+	VulkanBuffer			staging;
+	int						width;
+	int						height;
+	bool					isNew;					// image is still in VK_IMAGE_LAYOUT_UNDEFINED
+}VulkanTextureUpload;
+
+typedef struct
+{
+	VkCommandPool			commandPool;			// primary & object command buffers (main thread)
+	VkCommandPool			terrainCommandPool;		// terrain command buffer (helper thread)
+	VkCommandBuffer			primary;
+	VkCommandBuffer			objects;
+	VkCommandBuffer			terrain;
+	VkFence					fence;
+	VkQueryPool				timestamps;
+	VulkanBuffer			stream;
+	VkDeviceSize			streamUsed;
+	VulkanBuffer			uniforms;
+	VkDescriptorSet			frameSet;
+	uint64_t				serial;					// 0 = never submitted
+	bool					hasTimestamps;
+}VulkanFrame;
+
+static bool CreateInstance(void);
+static bool PickPhysicalDevice(void);
+static bool CreateDevice(void);
+static bool CreateSharedObjects(void);
+static bool CreatePipelines(void);
+static bool CreateFrames(void);
+static bool StartRecordThread(void);
+static void StopRecordThread(void);
+static bool CreateRenderTarget(int width, int height);
+static void DisposeRenderTarget(void);
+static bool CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VulkanBuffer* out);
+static void DisposeBuffer(VulkanBuffer* buffer);
+static void DisposeLater(VkBuffer buffer, VkImage image, VkImageView view, VkDeviceMemory memory, VkDescriptorSet descriptorSet);
+static void CollectGarbage(bool everything);
+static VulkanTexture* GetTextureSlot(GLuint textureName);
+static void QueueTextureUpload(GLuint textureName, int width, int height, GLenum internalFormat,
+							   GLenum bufferFormat, GLenum bufferType, const void* pixels, bool isNew);
+static bool StreamArray(const void* data, VkDeviceSize size, VkDeviceSize* outOffset);
+static void FillFrameUniforms(VulkanFrameUniforms* u);
+static void RecordDraws(VkCommandBuffer cb, bool terrain);
+static void RecordPrimary(VulkanFrame* frame);
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	VK_FRAMES_IN_FLIGHT			2
+#define	VK_STREAM_SIZE				(4*1024*1024)		// per frame; doubled whenever a frame runs out
+#define	VK_STREAM_ALIGNMENT			16
+#define	VK_STATIC_BLOCK_SIZE		(4*1024*1024)
+#define	VK_MAX_TEXTURES				4096				// descriptor sets for mesh textures
+#define	VK_NUM_SAMPLERS				8					// linear/nearest x clamp U x clamp V
+
+#define	CHECK_VK(result)																\
+	do {																				\
+		VkResult _vkResult = (result);													\
+		if (_vkResult != VK_SUCCESS)													\
+			DoFatalVulkanError(_vkResult, __func__, __LINE__);							\
+	} while(0)
+
+static const uint32_t kVulkanMeshVertSPIRV[] =
+{
+#include "VulkanMesh.vert.spv.inc"
+};
+
+static const uint32_t kVulkanMeshFragSPIRV[] =
+{
+#include "VulkanMesh.frag.spv.inc"
+};
+
+		/* DEFAULT VERTEX ATTRIBUTES */
+		//
+		// Bound with a stride of 0 when a pipeline doesn't read an attribute,
+		// so every pipeline has the same vertex inputs.
+		//
+
+static const float kDefaultAttributes[12] =
+{
+	0, 0, 1, 0,									// normal (GL's current normal)
+	0, 0, 0, 0,									// UV
+	1, 1, 1, 1,									// color
+};
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+Boolean							gVulkanMode = false;
+
+static	VkInstance				gInstance = VK_NULL_HANDLE;
+static	VkPhysicalDevice		gPhysicalDevice = VK_NULL_HANDLE;
+static	VkPhysicalDeviceProperties	gDeviceProperties;
+static	VkPhysicalDeviceMemoryProperties	gMemoryProperties;
+static	uint32_t				gQueueFamily = 0;
+static	bool					gCanTimestamp = false;
+static	VkDevice				gDevice = VK_NULL_HANDLE;
+static	VkQueue					gQueue = VK_NULL_HANDLE;
+
+static	VkFormat				gDepthFormat = VK_FORMAT_UNDEFINED;
+static	VkRenderPass			gRenderPass = VK_NULL_HANDLE;
+static	VkDescriptorSetLayout	gFrameSetLayout = VK_NULL_HANDLE;
+static	VkDescriptorSetLayout	gTextureSetLayout = VK_NULL_HANDLE;
+static	VkPipelineLayout		gPipelineLayout = VK_NULL_HANDLE;
+static	VkDescriptorPool		gDescriptorPool = VK_NULL_HANDLE;
+static	VkSampler				gSamplers[VK_NUM_SAMPLERS];
+static	VkPipelineCache			gPipelineCache = VK_NULL_HANDLE;
+static	VkShaderModule			gVertexShader = VK_NULL_HANDLE;
+static	VkShaderModule			gFragmentShader = VK_NULL_HANDLE;
+static	VkPipeline				gPipelines[kPipelineState_NumKeys];
+static	VkPipeline				gFrontCullPipelines[kPipelineState_NumKeys];
+static	int						gNumPipelines = 0;
+
+static	VulkanBuffer			gDefaultAttributes;
+static	VulkanTexture			gWhiteTexture;				// bound for untextured meshes
+
+		/* OFFSCREEN TARGET */
+
+static	VkImage					gColorImage = VK_NULL_HANDLE;
+static	VkImageView				gColorView = VK_NULL_HANDLE;
+static	VkDeviceMemory			gColorMemory = VK_NULL_HANDLE;
+static	VkImage					gDepthImage = VK_NULL_HANDLE;
+static	VkImageView				gDepthView = VK_NULL_HANDLE;
+static	VkDeviceMemory			gDepthMemory = VK_NULL_HANDLE;
+static	VkFramebuffer			gFramebuffer = VK_NULL_HANDLE;
+static	VulkanBuffer			gReadbackBuffer;
+static	int						gTargetWidth = 0;
+static	int						gTargetHeight = 0;
+
+		/* FRAMES */
+
+static	VulkanFrame				gFrames[VK_FRAMES_IN_FLIGHT];
+static	int						gFrameSlot = 0;				// next frame to record
+static	uint64_t				gSubmittedFrames = 0;
+static	uint64_t				gFinishedFrames = 0;
+static	bool					gInFrame = false;
+static	VkDeviceSize			gStreamSize = VK_STREAM_SIZE;	// doubled when a frame runs out
+static	VkClearColorValue		gClearColor;
+static	bool					gReadbackRequested = false;
+static	int						gReadbackSlot = -1;			// frame whose color buffer is in gReadbackBuffer
+static	float					gLastGPUMilliseconds = 0;
+
+static	VulkanDrawCommand*		gDrawCommands = nil;
+static	int						gNumDrawCommands = 0;
+static	int						gDrawCommandCapacity = 0;
+
+		/* RESOURCES */
+
+static	VulkanTexture*			gTextures = nil;			// indexed by GL texture name
+static	int						gNumTextureSlots = 0;
+static	VulkanTextureUpload*	gTextureUploads = nil;
+static	int						gNumTextureUploads = 0;
+static	int						gTextureUploadCapacity = 0;
+
+static	VulkanStaticMesh*		gStaticMeshes = nil;
+static	int						gStaticMeshCapacity = 0;
+static	VulkanStaticBlock*		gStaticBlocks = nil;
+static	int						gNumStaticBlocks = 0;
+static	int						gCurrentStaticBlock = -1;	// block new meshes go in
+
+static	VulkanGarbage*			gGarbage = nil;
+static	int						gNumGarbage = 0;
+static	int						gGarbageCapacity = 0;
+
+		/* TERRAIN RECORDING THREAD */
+
+static	SDL_Thread*				gRecordThread = NULL;
+static	SDL_Semaphore*			gRecordGo = NULL;
+static	SDL_Semaphore*			gRecordDone = NULL;
+static	bool					gQuitRecordThread = false;
+
+#pragma mark -
+
+static void DoFatalVulkanError(VkResult result, const char* function, int line)
+{
+	static char alertbuf[1024];
+	SDL_snprintf(alertbuf, sizeof(alertbuf), "Vulkan error %d\nin %s:%d", (int) result, function, line);
+	DoFatalAlert(alertbuf);
+}
+
+static void* GrowArray(void* array, int* capacity, int needed, size_t elementSize)
+{
+	if (needed <= *capacity)
+		return array;
+
+	int newCapacity = SDL_max(needed, SDL_max(16, *capacity * 2));
+	array = SDL_realloc(array, newCapacity * elementSize);
+	GAME_ASSERT(array);
+	SDL_memset((uint8_t*) array + *capacity * elementSize, 0, (newCapacity - *capacity) * elementSize);
+	*capacity = newCapacity;
+	return array;
+}
+
+#pragma mark -
+
+/****************************/
+/*    STARTUP & SHUTDOWN    */
+/****************************/
+
+/****************** VKRENDER: INIT ********************/
+//
+// Starts the backend on the first Vulkan device with a graphics queue (discrete GPUs first).
+// Returns false, with everything torn down again, if anything is missing.
+//
+
+bool VkRender_Init(void)
+{
+	if (gDevice)
+		return true;
+
+	bool ok = CreateInstance()
+			&& PickPhysicalDevice()
+			&& CreateDevice()
+			&& CreateSharedObjects()
+			&& CreatePipelines()
+			&& CreateFrames();
+
+	if (!ok)
+	{
+		VkRender_Shutdown();
+		return false;
+	}
+
+	if (!StartRecordThread())
+		SDL_Log("Vulkan: no terrain recording thread; recording everything on the main thread.");
+
+	SDL_Log("Vulkan: %s, %d pipelines, timestamps: %s",
+			gDeviceProperties.deviceName, gNumPipelines, gCanTimestamp ? "yes" : "no");
+	return true;
+}
+
+bool VkRender_IsActive(void)
+{
+	return gDevice != VK_NULL_HANDLE;
+}
+
+/****************** VKRENDER: SHUTDOWN ********************/
+
+void VkRender_Shutdown(void)
+{
+	StopRecordThread();
+
+	if (gDevice)
+	{
+		vkDeviceWaitIdle(gDevice);
+
+		CollectGarbage(true);
+		DisposeRenderTarget();
+
+		for (int i = 0; i < VK_FRAMES_IN_FLIGHT; i++)
+		{
+			VulkanFrame* frame = &gFrames[i];
+			DisposeBuffer(&frame->stream);
+			DisposeBuffer(&frame->uniforms);
+			if (frame->timestamps)			vkDestroyQueryPool(gDevice, frame->timestamps, NULL);
+			if (frame->fence)				vkDestroyFence(gDevice, frame->fence, NULL);
+			if (frame->commandPool)			vkDestroyCommandPool(gDevice, frame->commandPool, NULL);
+			if (frame->terrainCommandPool)	vkDestroyCommandPool(gDevice, frame->terrainCommandPool, NULL);
+		}
+
+		for (int i = 0; i < gNumTextureUploads; i++)
+			DisposeBuffer(&gTextureUploads[i].staging);
+
+		for (int i = 0; i < gNumTextureSlots; i++)
+		{
+			if (gTextures[i].view)		vkDestroyImageView(gDevice, gTextures[i].view, NULL);
+			if (gTextures[i].image)		vkDestroyImage(gDevice, gTextures[i].image, NULL);
+			if (gTextures[i].memory)	vkFreeMemory(gDevice, gTextures[i].memory, NULL);
+		}
+
+		if (gWhiteTexture.view)		vkDestroyImageView(gDevice, gWhiteTexture.view, NULL);
+		if (gWhiteTexture.image)	vkDestroyImage(gDevice, gWhiteTexture.image, NULL);
+		if (gWhiteTexture.memory)	vkFreeMemory(gDevice, gWhiteTexture.memory, NULL);
+
+		for (int i = 0; i < gNumStaticBlocks; i++)
+			DisposeBuffer(&gStaticBlocks[i].buffer);
+
+		DisposeBuffer(&gDefaultAttributes);
+
+		for (int i = 0; i < kPipelineState_NumKeys; i++)
+		{
+			if (gPipelines[i])			vkDestroyPipeline(gDevice, gPipelines[i], NULL);
+			if (gFrontCullPipelines[i])	vkDestroyPipeline(gDevice, gFrontCullPipelines[i], NULL);
+		}
+
+		for (int i = 0; i < VK_NUM_SAMPLERS; i++)
+		{
+			if (gSamplers[i])
+				vkDestroySampler(gDevice, gSamplers[i], NULL);
+		}
+
+		if (gVertexShader)		vkDestroyShaderModule(gDevice, gVertexShader, NULL);
+		if (gFragmentShader)	vkDestroyShaderModule(gDevice, gFragmentShader, NULL);
+		if (gPipelineCache)		vkDestroyPipelineCache(gDevice, gPipelineCache, NULL);
+		if (gDescriptorPool)	vkDestroyDescriptorPool(gDevice, gDescriptorPool, NULL);
+		if (gPipelineLayout)	vkDestroyPipelineLayout(gDevice, gPipelineLayout, NULL);
+		if (gFrameSetLayout)	vkDestroyDescriptorSetLayout(gDevice, gFrameSetLayout, NULL);
+		if (gTextureSetLayout)	vkDestroyDescriptorSetLayout(gDevice, gTextureSetLayout, NULL);
+		if (gRenderPass)		vkDestroyRenderPass(gDevice, gRenderPass, NULL);
+
+		vkDestroyDevice(gDevice, NULL);
+	}
+
+	if (gInstance)
+		vkDestroyInstance(gInstance, NULL);
+
+	SDL_free(gDrawCommands);
+	SDL_free(gTextures);
+	SDL_free(gTextureUploads);
+	SDL_free(gStaticMeshes);
+	SDL_free(gStaticBlocks);
+	SDL_free(gGarbage);
+
+	gInstance = VK_NULL_HANDLE;
+	gPhysicalDevice = VK_NULL_HANDLE;
+	gDevice = VK_NULL_HANDLE;
+	gQueue = VK_NULL_HANDLE;
+	gRenderPass = VK_NULL_HANDLE;
+	gFrameSetLayout = VK_NULL_HANDLE;
+	gTextureSetLayout = VK_NULL_HANDLE;
+	gPipelineLayout = VK_NULL_HANDLE;
+	gDescriptorPool = VK_NULL_HANDLE;
+	gPipelineCache = VK_NULL_HANDLE;
+	gVertexShader = VK_NULL_HANDLE;
+	gFragmentShader = VK_NULL_HANDLE;
+	SDL_memset(gSamplers, 0, sizeof(gSamplers));
+	SDL_memset(gPipelines, 0, sizeof(gPipelines));
+	SDL_memset(gFrontCullPipelines, 0, sizeof(gFrontCullPipelines));
+	SDL_memset(gFrames, 0, sizeof(gFrames));
+	SDL_memset(&gWhiteTexture, 0, sizeof(gWhiteTexture));
+	gNumPipelines = 0;
+	gDrawCommands = nil;
+	gNumDrawCommands = gDrawCommandCapacity = 0;
+	gTextures = nil;
+	gNumTextureSlots = 0;
+	gTextureUploads = nil;
+	gNumTextureUploads = gTextureUploadCapacity = 0;
+	gStaticMeshes = nil;
+	gStaticMeshCapacity = 0;
+	gStaticBlocks = nil;
+	gNumStaticBlocks = 0;
+	gCurrentStaticBlock = -1;
+	gGarbage = nil;
+	gNumGarbage = gGarbageCapacity = 0;
+	gFrameSlot = 0;
+	gSubmittedFrames = gFinishedFrames = 0;
+	gStreamSize = VK_STREAM_SIZE;
+	gInFrame = false;
+	gReadbackSlot = -1;
+}
+
+/****************** CREATE INSTANCE ********************/
+
+static bool CreateInstance(void)
+{
+	VkApplicationInfo appInfo =
+	{
+		.sType				= VK_STRUCTURE_TYPE_APPLICATION_INFO,
+		.pApplicationName	= "Nanosaur",
+		.applicationVersion	= VK_MAKE_VERSION(GAME_VERSION_MAJOR, GAME_VERSION_MINOR, GAME_VERSION_PATCH),
+		.pEngineName		= "Nanosaur",
+		.apiVersion			= VK_API_VERSION_1_0,
+	};
+
+	VkInstanceCreateInfo createInfo =
+	{
+		.sType				= VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+		.pApplicationInfo	= &appInfo,
+	};
+
+	VkResult result = vkCreateInstance(&createInfo, NULL, &gInstance);
+	if (result != VK_SUCCESS)
+	{
+		SDL_Log("Vulkan: vkCreateInstance failed (%d)", (int) result);
+		gInstance = VK_NULL_HANDLE;
+		return false;
+	}
+
+	return true;
+}
+
+/****************** PICK PHYSICAL DEVICE ********************/
+
+static bool PickPhysicalDevice(void)
+{
+	static const VkPhysicalDeviceType kPreference[] =
+	{
+		VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU,
+		VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU,
+		VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU,
+		VK_PHYSICAL_DEVICE_TYPE_CPU,				// lavapipe
+		VK_PHYSICAL_DEVICE_TYPE_OTHER,
+	};
+
+	VkPhysicalDevice devices[16];
+	uint32_t numDevices = SDL_arraysize(devices);
+	VkResult result = vkEnumeratePhysicalDevices(gInstance, &numDevices, devices);
+	if ((result != VK_SUCCESS && result != VK_INCOMPLETE) || numDevices == 0)
+	{
+		SDL_Log("Vulkan: no devices");
+		return false;
+	}
+
+	for (size_t pref = 0; pref < SDL_arraysize(kPreference); pref++)
+	{
+		for (uint32_t d = 0; d < numDevices; d++)
+		{
+			VkPhysicalDeviceProperties props;
+			vkGetPhysicalDeviceProperties(devices[d], &props);
+			if (props.deviceType != kPreference[pref])
+				continue;
+
+			VkQueueFamilyProperties families[16];
+			uint32_t numFamilies = SDL_arraysize(families);
+			vkGetPhysicalDeviceQueueFamilyProperties(devices[d], &numFamilies, families);
+
+			for (uint32_t f = 0; f < numFamilies; f++)
+			{
+				if (families[f].queueFlags & VK_QUEUE_GRAPHICS_BIT)
+				{
+					gPhysicalDevice = devices[d];
+					gDeviceProperties = props;
+					gQueueFamily = f;
+					gCanTimestamp = families[f].timestampValidBits > 0 && props.limits.timestampPeriod > 0;
+					vkGetPhysicalDeviceMemoryProperties(gPhysicalDevice, &gMemoryProperties);
+					return true;
+				}
+			}
+		}
+	}
+
+	SDL_Log("Vulkan: no device with a graphics queue");
+	return false;
+}
+
+/****************** CREATE DEVICE ********************/
+
+static bool CreateDevice(void)
+{
+	float priority = 1.0f;
+
+	VkDeviceQueueCreateInfo queueInfo =
+	{
+		.sType				= VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+		.queueFamilyIndex	= gQueueFamily,
+		.queueCount			= 1,
+		.pQueuePriorities	= &priority,
+	};
+
+	VkDeviceCreateInfo createInfo =
+	{
+		.sType					= VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+		.queueCreateInfoCount	= 1,
+		.pQueueCreateInfos		= &queueInfo,
+	};
+
+	VkResult result = vkCreateDevice(gPhysicalDevice, &createInfo, NULL, &gDevice);
+	if (result != VK_SUCCESS)
+	{
+		SDL_Log("Vulkan: vkCreateDevice failed (%d)", (int) result);
+		gDevice = VK_NULL_HANDLE;
+		return false;
+	}
+
+	vkGetDeviceQueue(gDevice, gQueueFamily, 0, &gQueue);
+	return true;
+}
+
+#pragma mark -
+
+/****************************/
+/*    MEMORY                */
+/****************************/
+
+static int FindMemoryType(uint32_t typeBits, VkMemoryPropertyFlags wanted)
+{
+	for (uint32_t i = 0; i < gMemoryProperties.memoryTypeCount; i++)
+	{
+		if ((typeBits & (1u << i)) && (gMemoryProperties.memoryTypes[i].propertyFlags & wanted) == wanted)
+			return (int) i;
+	}
+	return -1;
+}
+
+/****************** CREATE BUFFER ********************/
+//
+// All buffers are host-visible & coherent and stay mapped: the backend only ever writes
+// them from the CPU (the vertex data is streamed, static meshes are written once).
+//
+
+static bool CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VulkanBuffer* out)
+{
+	SDL_memset(out, 0, sizeof(*out));
+
+	VkBufferCreateInfo bufferInfo =
+	{
+		.sType			= VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+		.size			= size,
+		.usage			= usage,
+		.sharingMode	= VK_SHARING_MODE_EXCLUSIVE,
+	};
+	if (vkCreateBuffer(gDevice, &bufferInfo, NULL, &out->buffer) != VK_SUCCESS)
+		return false;
+
+	VkMemoryRequirements req;
+	vkGetBufferMemoryRequirements(gDevice, out->buffer, &req);
+
+	int memoryType = FindMemoryType(req.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	VkMemoryAllocateInfo allocInfo =
+	{
+		.sType				= VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+		.allocationSize		= req.size,
+		.memoryTypeIndex	= (uint32_t) memoryType,
+	};
+
+	void* mapped = NULL;
+	if (memoryType < 0
+		|| vkAllocateMemory(gDevice, &allocInfo, NULL, &out->memory) != VK_SUCCESS
+		|| vkBindBufferMemory(gDevice, out->buffer, out->memory, 0) != VK_SUCCESS
+		|| vkMapMemory(gDevice, out->memory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS)
+	{
+		DisposeBuffer(out);
+		return false;
+	}
+
+	out->mapped = (uint8_t*) mapped;
+	out->size = size;
+	return true;
+}
+
+static void DisposeBuffer(VulkanBuffer* buffer)
+{
+	if (buffer->buffer)
+		vkDestroyBuffer(gDevice, buffer->buffer, NULL);
+	if (buffer->memory)
+		vkFreeMemory(gDevice, buffer->memory, NULL);		// also unmaps it
+	SDL_memset(buffer, 0, sizeof(*buffer));
+}
+
+/****************** CREATE IMAGE ********************/
+
+static bool CreateImage(int width, int height, VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect,
+						VkImage* outImage, VkImageView* outView, VkDeviceMemory* outMemory)
+{
+	VkImageCreateInfo imageInfo =
+	{
+		.sType			= VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+		.imageType		= VK_IMAGE_TYPE_2D,
+		.format			= format,
+		.extent			= { (uint32_t) width, (uint32_t) height, 1 },
+		.mipLevels		= 1,
+		.arrayLayers	= 1,
+		.samples		= VK_SAMPLE_COUNT_1_BIT,
+		.tiling			= VK_IMAGE_TILING_OPTIMAL,
+		.usage			= usage,
+		.sharingMode	= VK_SHARING_MODE_EXCLUSIVE,
+		.initialLayout	= VK_IMAGE_LAYOUT_UNDEFINED,
+	};
+	if (vkCreateImage(gDevice, &imageInfo, NULL, outImage) != VK_SUCCESS)
+		return false;
+
+	VkMemoryRequirements req;
+	vkGetImageMemoryRequirements(gDevice, *outImage, &req);
+
+	int memoryType = FindMemoryType(req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	if (memoryType < 0)
+		memoryType = FindMemoryType(req.memoryTypeBits, 0);
+
+	VkMemoryAllocateInfo allocInfo =
+	{
+		.sType				= VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+		.allocationSize		= req.size,
+		.memoryTypeIndex	= (uint32_t) memoryType,
+	};
+	if (memoryType < 0
+		|| vkAllocateMemory(gDevice, &allocInfo, NULL, outMemory) != VK_SUCCESS
+		|| vkBindImageMemory(gDevice, *outImage, *outMemory, 0) != VK_SUCCESS)
+	{
+		return false;
+	}
+
+	VkImageViewCreateInfo viewInfo =
+	{
+		.sType				= VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+		.image				= *outImage,
+		.viewType			= VK_IMAGE_VIEW_TYPE_2D,
+		.format				= format,
+		.subresourceRange	= { aspect, 0, 1, 0, 1 },
+	};
+	return vkCreateImageView(gDevice, &viewInfo, NULL, outView) == VK_SUCCESS;
+}
+
+/****************** DISPOSE LATER ********************/
+//
+// Queues Vulkan objects that frames already submitted (or the one being built) may still use.
+//
+
+static void DisposeLater(VkBuffer buffer, VkImage image, VkImageView view, VkDeviceMemory memory, VkDescriptorSet descriptorSet)
+{
+	gGarbage = GrowArray(gGarbage, &gGarbageCapacity, gNumGarbage + 1, sizeof(VulkanGarbage));
+
+	VulkanGarbage* g = &gGarbage[gNumGarbage++];
+	g->frameSerial		= gSubmittedFrames + 1;
+	g->buffer			= buffer;
+	g->image			= image;
+	g->view				= view;
+	g->memory			= memory;
+	g->descriptorSet	= descriptorSet;
+}
+
+static void CollectGarbage(bool everything)
+{
+	int kept = 0;
+
+	for (int i = 0; i < gNumGarbage; i++)
+	{
+		VulkanGarbage* g = &gGarbage[i];
+
+		if (!everything && g->frameSerial > gFinishedFrames)
+		{
+			gGarbage[kept++] = *g;
+			continue;
+		}
+
+		if (g->descriptorSet)	vkFreeDescriptorSets(gDevice, gDescriptorPool, 1, &g->descriptorSet);
+		if (g->view)			vkDestroyImageView(gDevice, g->view, NULL);
+		if (g->image)			vkDestroyImage(gDevice, g->image, NULL);
+		if (g->buffer)			vkDestroyBuffer(gDevice, g->buffer, NULL);
+		if (g->memory)			vkFreeMemory(gDevice, g->memory, NULL);
+	}
+
+	gNumGarbage = kept;
+}
+
+#pragma mark -
+
+/****************************/
+/*    SHARED OBJECTS        */
+/****************************/
+
+/****************** CREATE SHARED OBJECTS ********************/
+//
+// Render pass, descriptor & pipeline layouts, samplers, shaders, default vertex attributes.
+//
+
+static bool CreateSharedObjects(void)
+{
+			/* PICK A DEPTH FORMAT */
+
+	static const VkFormat kDepthFormats[] = { VK_FORMAT_D32_SFLOAT, VK_FORMAT_X8_D24_UNORM_PACK32, VK_FORMAT_D24_UNORM_S8_UINT, VK_FORMAT_D16_UNORM };
+
+	for (size_t i = 0; i < SDL_arraysize(kDepthFormats) && gDepthFormat == VK_FORMAT_UNDEFINED; i++)
+	{
+		VkFormatProperties props;
+		vkGetPhysicalDeviceFormatProperties(gPhysicalDevice, kDepthFormats[i], &props);
+		if (props.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
+			gDepthFormat = kDepthFormats[i];
+	}
+
+	if (gDepthFormat == VK_FORMAT_UNDEFINED)
+	{
+		SDL_Log("Vulkan: no depth format");
+		return false;
+	}
+
+			/* RENDER PASS */
+			//
+			// The color buffer ends up ready to be copied out (VkRender_ReadPixels).
+			// The previous frame's copy & depth writes must be done before this frame clears.
+			//
+
+	VkAttachmentDescription attachments[2] =
+	{
+		{
+			.format			= VK_FORMAT_R8G8B8A8_UNORM,
+			.samples		= VK_SAMPLE_COUNT_1_BIT,
+			.loadOp			= VK_ATTACHMENT_LOAD_OP_CLEAR,
+			.storeOp		= VK_ATTACHMENT_STORE_OP_STORE,
+			.stencilLoadOp	= VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+			.stencilStoreOp	= VK_ATTACHMENT_STORE_OP_DONT_CARE,
+			.initialLayout	= VK_IMAGE_LAYOUT_UNDEFINED,
+			.finalLayout	= VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		},
+		{
+			.format			= gDepthFormat,
+			.samples		= VK_SAMPLE_COUNT_1_BIT,
+			.loadOp			= VK_ATTACHMENT_LOAD_OP_CLEAR,
+			.storeOp		= VK_ATTACHMENT_STORE_OP_DONT_CARE,
+			.stencilLoadOp	= VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+			.stencilStoreOp	= VK_ATTACHMENT_STORE_OP_DONT_CARE,
+			.initialLayout	= VK_IMAGE_LAYOUT_UNDEFINED,
+			.finalLayout	= VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+		},
+	};
+
+	VkAttachmentReference colorRef = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+	VkAttachmentReference depthRef = { 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+
+	VkSubpassDescription subpass =
+	{
+		.pipelineBindPoint			= VK_PIPELINE_BIND_POINT_GRAPHICS,
+		.colorAttachmentCount		= 1,
+		.pColorAttachments			= &colorRef,
+		.pDepthStencilAttachment	= &depthRef,
+	};
+
+	VkSubpassDependency dependencies[2] =
+	{
+		{
+			.srcSubpass		= VK_SUBPASS_EXTERNAL,
+			.dstSubpass		= 0,
+			.srcStageMask	= VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+			.dstStageMask	= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+			.srcAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+			.dstAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+		},
+		{
+			.srcSubpass		= 0,
+			.dstSubpass		= VK_SUBPASS_EXTERNAL,
+			.srcStageMask	= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			.dstStageMask	= VK_PIPELINE_STAGE_TRANSFER_BIT,
+			.srcAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+			.dstAccessMask	= VK_ACCESS_TRANSFER_READ_BIT,
+		},
+	};
+
+	VkRenderPassCreateInfo renderPassInfo =
+	{
+		.sType				= VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+		.attachmentCount	= 2,
+		.pAttachments		= attachments,
+		.subpassCount		= 1,
+		.pSubpasses			= &subpass,
+		.dependencyCount	= 2,
+		.pDependencies		= dependencies,
+	};
+	if (vkCreateRenderPass(gDevice, &renderPassInfo, NULL, &gRenderPass) != VK_SUCCESS)
+		return false;
+
+			/* DESCRIPTOR SET LAYOUTS: 0 = FRAME UNIFORMS, 1 = MESH TEXTURE */
+
+	VkDescriptorSetLayoutBinding frameBinding =
+	{
+		.binding			= 0,
+		.descriptorType		= VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+		.descriptorCount	= 1,
+		.stageFlags			= VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+	};
+	VkDescriptorSetLayoutBinding textureBinding =
+	{
+		.binding			= 0,
+		.descriptorType		= VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		.descriptorCount	= 1,
+		.stageFlags			= VK_SHADER_STAGE_FRAGMENT_BIT,
+	};
+
+	VkDescriptorSetLayoutCreateInfo frameLayoutInfo =
+	{
+		.sType			= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		.bindingCount	= 1,
+		.pBindings		= &frameBinding,
+	};
+	VkDescriptorSetLayoutCreateInfo textureLayoutInfo =
+	{
+		.sType			= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		.bindingCount	= 1,
+		.pBindings		= &textureBinding,
+	};
+	if (vkCreateDescriptorSetLayout(gDevice, &frameLayoutInfo, NULL, &gFrameSetLayout) != VK_SUCCESS
+		|| vkCreateDescriptorSetLayout(gDevice, &textureLayoutInfo, NULL, &gTextureSetLayout) != VK_SUCCESS)
+	{
+		return false;
+	}
+
+	VkDescriptorSetLayout setLayouts[2] = { gFrameSetLayout, gTextureSetLayout };
+	VkPushConstantRange pushRange = { VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(VulkanPushConstants) };
+
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo =
+	{
+		.sType					= VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		.setLayoutCount			= 2,
+		.pSetLayouts			= setLayouts,
+		.pushConstantRangeCount	= 1,
+		.pPushConstantRanges	= &pushRange,
+	};
+	if (vkCreatePipelineLayout(gDevice, &pipelineLayoutInfo, NULL, &gPipelineLayout) != VK_SUCCESS)
+		return false;
+
+			/* DESCRIPTOR POOL */
+
+	VkDescriptorPoolSize poolSizes[2] =
+	{
+		{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,			VK_FRAMES_IN_FLIGHT },
+		{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,	VK_MAX_TEXTURES + 1 },		// + the white texture
+	};
+	VkDescriptorPoolCreateInfo poolInfo =
+	{
+		.sType			= VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		.flags			= VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
+		.maxSets		= VK_FRAMES_IN_FLIGHT + VK_MAX_TEXTURES + 1,
+		.poolSizeCount	= 2,
+		.pPoolSizes		= poolSizes,
+	};
+	if (vkCreateDescriptorPool(gDevice, &poolInfo, NULL, &gDescriptorPool) != VK_SUCCESS)
+		return false;
+
+			/* SAMPLERS (SAME FILTERING & WRAPPING CHOICES AS RENDER_LOADTEXTURE) */
+
+	for (int i = 0; i < VK_NUM_SAMPLERS; i++)
+	{
+		VkFilter filter = (i & 4) ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+		VkSamplerCreateInfo samplerInfo =
+		{
+			.sType			= VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+			.magFilter		= filter,
+			.minFilter		= filter,
+			.mipmapMode		= VK_SAMPLER_MIPMAP_MODE_NEAREST,
+			.addressModeU	= (i & 1) ? VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE : VK_SAMPLER_ADDRESS_MODE_REPEAT,
+			.addressModeV	= (i & 2) ? VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE : VK_SAMPLER_ADDRESS_MODE_REPEAT,
+			.addressModeW	= VK_SAMPLER_ADDRESS_MODE_REPEAT,
+			.maxLod			= 0,
+		};
+		if (vkCreateSampler(gDevice, &samplerInfo, NULL, &gSamplers[i]) != VK_SUCCESS)
+			return false;
+	}
+
+			/* SHADERS */
+
+	VkShaderModuleCreateInfo vertexInfo =
+	{
+		.sType		= VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+		.codeSize	= sizeof(kVulkanMeshVertSPIRV),
+		.pCode		= kVulkanMeshVertSPIRV,
+	};
+	VkShaderModuleCreateInfo fragmentInfo =
+	{
+		.sType		= VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+		.codeSize	= sizeof(kVulkanMeshFragSPIRV),
+		.pCode		= kVulkanMeshFragSPIRV,
+	};
+	if (vkCreateShaderModule(gDevice, &vertexInfo, NULL, &gVertexShader) != VK_SUCCESS
+		|| vkCreateShaderModule(gDevice, &fragmentInfo, NULL, &gFragmentShader) != VK_SUCCESS)
+	{
+		return false;
+	}
+
+			/* DEFAULT VERTEX ATTRIBUTES */
+
+	if (!CreateBuffer(sizeof(kDefaultAttributes), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, &gDefaultAttributes))
+		return false;
+	SDL_memcpy(gDefaultAttributes.mapped, kDefaultAttributes, sizeof(kDefaultAttributes));
+
+	return true;
+}
+
+#pragma mark -
+
+/****************************/
+/*    PIPELINES             */
+/****************************/
+
+/****************** IS PIPELINE STATE USED ********************/
+//
+// Weeds out the kPipelineState_* combinations that DrawMeshList can't produce
+// (see CalcPipelineState in Renderer.c).
+//
+// Env mapping only changes where the UVs come from, so env-mapped meshes use the
+// pipeline of the same state without kPipelineState_EnvMap.
+//
+
+static bool IsPipelineStateUsed(int key)
+{
+	if (key & kPipelineState_EnvMap)
+		return false;
+
+	if (key & kPipelineState_Blend)
+	{
+		if (key & (kPipelineState_NoCull | kPipelineState_DepthWrite))		// blended meshes never write depth
+			return false;
+	}
+	else if (key & kPipelineState_TwoSidedBlend)
+	{
+		return false;
+	}
+
+	if ((key & kPipelineState_Normals) && !(key & kPipelineState_Lighting))	// normals are dropped when unlit
+		return false;
+
+	return true;
+}
+
+/****************** CREATE PIPELINE ********************/
+
+static VkPipeline CreatePipeline(int key, VkCullModeFlags cullMode)
+{
+	VkPipeline pipeline = VK_NULL_HANDLE;
+
+			/* SPECIALIZE THE SHADERS */
+
+	VkBool32 constants[5] =
+	{
+		(key & kPipelineState_Lighting) != 0,
+		(key & kPipelineState_Normals) != 0,
+		(key & kPipelineState_VertexColors) != 0,
+		(key & kPipelineState_Texture) != 0,
+		!(key & kPipelineState_Blend),						// alpha test on opaque meshes only
+	};
+	VkSpecializationMapEntry mapEntries[5];
+	for (int i = 0; i < 5; i++)
+	{
+		mapEntries[i].constantID	= i;
+		mapEntries[i].offset		= i * sizeof(VkBool32);
+		mapEntries[i].size			= sizeof(VkBool32);
+	}
+	VkSpecializationInfo specialization =
+	{
+		.mapEntryCount	= 5,
+		.pMapEntries	= mapEntries,
+		.dataSize		= sizeof(constants),
+		.pData			= constants,
+	};
+
+	VkPipelineShaderStageCreateInfo stages[2] =
+	{
+		{
+			.sType					= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage					= VK_SHADER_STAGE_VERTEX_BIT,
+			.module					= gVertexShader,
+			.pName					= "main",
+			.pSpecializationInfo	= &specialization,
+		},
+		{
+			.sType					= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage					= VK_SHADER_STAGE_FRAGMENT_BIT,
+			.module					= gFragmentShader,
+			.pName					= "main",
+			.pSpecializationInfo	= &specialization,
+		},
+	};
+
+			/* ONE BINDING PER ARRAY OF TQ3TRIMESHDATA; UNUSED ONES READ kDefaultAttributes */
+
+	VkVertexInputBindingDescription bindings[4] =
+	{
+		{ 0, sizeof(TQ3Point3D),													VK_VERTEX_INPUT_RATE_VERTEX },
+		{ 1, (key & kPipelineState_Normals) ? sizeof(TQ3Vector3D) : 0,				VK_VERTEX_INPUT_RATE_VERTEX },
+		{ 2, (key & kPipelineState_Texture) ? sizeof(TQ3Param2D) : 0,				VK_VERTEX_INPUT_RATE_VERTEX },
+		{ 3, (key & kPipelineState_VertexColors) ? sizeof(TQ3ColorRGBA) : 0,		VK_VERTEX_INPUT_RATE_VERTEX },
+	};
+	VkVertexInputAttributeDescription attributes[4] =
+	{
+		{ 0, 0, VK_FORMAT_R32G32B32_SFLOAT,		0 },
+		{ 1, 1, VK_FORMAT_R32G32B32_SFLOAT,		0 },
+		{ 2, 2, VK_FORMAT_R32G32_SFLOAT,		0 },
+		{ 3, 3, VK_FORMAT_R32G32B32A32_SFLOAT,	0 },
+	};
+	VkPipelineVertexInputStateCreateInfo vertexInput =
+	{
+		.sType								= VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+		.vertexBindingDescriptionCount		= 4,
+		.pVertexBindingDescriptions			= bindings,
+		.vertexAttributeDescriptionCount	= 4,
+		.pVertexAttributeDescriptions		= attributes,
+	};
+
+	VkPipelineInputAssemblyStateCreateInfo inputAssembly =
+	{
+		.sType		= VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+		.topology	= VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+	};
+
+	VkPipelineViewportStateCreateInfo viewportState =
+	{
+		.sType			= VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+		.viewportCount	= 1,
+		.scissorCount	= 1,
+	};
+
+			/* RASTER STATE: GL_CCW IS FRONT, BUT THE VERTEX SHADER FLIPS Y */
+
+	VkPipelineRasterizationStateCreateInfo raster =
+	{
+		.sType			= VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+		.polygonMode	= VK_POLYGON_MODE_FILL,
+		.cullMode		= cullMode,
+		.frontFace		= VK_FRONT_FACE_CLOCKWISE,
+		.lineWidth		= 1.0f,
+	};
+
+	VkPipelineMultisampleStateCreateInfo multisample =
+	{
+		.sType					= VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+		.rasterizationSamples	= VK_SAMPLE_COUNT_1_BIT,
+	};
+
+	VkPipelineDepthStencilStateCreateInfo depthStencil =
+	{
+		.sType				= VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+		.depthTestEnable	= VK_TRUE,
+		.depthWriteEnable	= (key & kPipelineState_DepthWrite) ? VK_TRUE : VK_FALSE,
+		.depthCompareOp		= VK_COMPARE_OP_LESS,								// GL's default glDepthFunc
+	};
+
+	VkPipelineColorBlendAttachmentState blendAttachment =
+	{
+		.blendEnable			= (key & kPipelineState_Blend) ? VK_TRUE : VK_FALSE,
+		.srcColorBlendFactor	= VK_BLEND_FACTOR_SRC_ALPHA,						// glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA)
+		.dstColorBlendFactor	= VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+		.colorBlendOp			= VK_BLEND_OP_ADD,
+		.srcAlphaBlendFactor	= VK_BLEND_FACTOR_SRC_ALPHA,
+		.dstAlphaBlendFactor	= VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+		.alphaBlendOp			= VK_BLEND_OP_ADD,
+		.colorWriteMask			= VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
+	};
+	VkPipelineColorBlendStateCreateInfo colorBlend =
+	{
+		.sType				= VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+		.attachmentCount	= 1,
+		.pAttachments		= &blendAttachment,
+	};
+
+	VkDynamicState dynamicStates[2] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+	VkPipelineDynamicStateCreateInfo dynamicState =
+	{
+		.sType				= VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+		.dynamicStateCount	= 2,
+		.pDynamicStates		= dynamicStates,
+	};
+
+	VkGraphicsPipelineCreateInfo pipelineInfo =
+	{
+		.sType					= VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+		.stageCount				= 2,
+		.pStages				= stages,
+		.pVertexInputState		= &vertexInput,
+		.pInputAssemblyState	= &inputAssembly,
+		.pViewportState			= &viewportState,
+		.pRasterizationState	= &raster,
+		.pMultisampleState		= &multisample,
+		.pDepthStencilState		= &depthStencil,
+		.pColorBlendState		= &colorBlend,
+		.pDynamicState			= &dynamicState,
+		.layout					= gPipelineLayout,
+		.renderPass				= gRenderPass,
+		.subpass				= 0,
+	};
+
+	if (vkCreateGraphicsPipelines(gDevice, gPipelineCache, 1, &pipelineInfo, NULL, &pipeline) != VK_SUCCESS)
+		return VK_NULL_HANDLE;
+
+	gNumPipelines++;
+	return pipeline;
+}
+
+/****************** CREATE PIPELINES ********************/
+//
+// Builds every pipeline up front. Two-sided blended meshes are drawn twice, like in
+// DrawMeshList: backfaces first (gFrontCullPipelines), then frontfaces.
+//
+
+static bool CreatePipelines(void)
+{
+	VkPipelineCacheCreateInfo cacheInfo = { .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+	if (vkCreatePipelineCache(gDevice, &cacheInfo, NULL, &gPipelineCache) != VK_SUCCESS)
+		return false;
+
+	for (int key = 0; key < kPipelineState_NumKeys; key++)
+	{
+		if (!IsPipelineStateUsed(key))
+			continue;
+
+		gPipelines[key] = CreatePipeline(key, (key & kPipelineState_NoCull) ? VK_CULL_MODE_NONE : VK_CULL_MODE_BACK_BIT);
+		if (!gPipelines[key])
+			return false;
+
+		if (key & kPipelineState_TwoSidedBlend)
+		{
+			gFrontCullPipelines[key] = CreatePipeline(key, VK_CULL_MODE_FRONT_BIT);
+			if (!gFrontCullPipelines[key])
+				return false;
+		}
+	}
+
+	return true;
+}
+
+#pragma mark -
+
+/****************************/
+/*    FRAMES                */
+/****************************/
+
+/****************** CREATE FRAMES ********************/
+//
+// Command pools, fences, stream & uniform buffers for each frame in flight,
+// plus the white texture that untextured meshes sample.
+//
+
+static bool CreateFrames(void)
+{
+	for (int i = 0; i < VK_FRAMES_IN_FLIGHT; i++)
+	{
+		VulkanFrame* frame = &gFrames[i];
+
+		VkCommandPoolCreateInfo poolInfo =
+		{
+			.sType				= VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+			.flags				= VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+			.queueFamilyIndex	= gQueueFamily,
+		};
+		if (vkCreateCommandPool(gDevice, &poolInfo, NULL, &frame->commandPool) != VK_SUCCESS
+			|| vkCreateCommandPool(gDevice, &poolInfo, NULL, &frame->terrainCommandPool) != VK_SUCCESS)
+		{
+			return false;
+		}
+
+		VkCommandBufferAllocateInfo primaryInfo =
+		{
+			.sType				= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.commandPool		= frame->commandPool,
+			.level				= VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+			.commandBufferCount	= 1,
+		};
+		VkCommandBufferAllocateInfo objectsInfo =
+		{
+			.sType				= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.commandPool		= frame->commandPool,
+			.level				= VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+			.commandBufferCount	= 1,
+		};
+		VkCommandBufferAllocateInfo terrainInfo =
+		{
+			.sType				= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.commandPool		= frame->terrainCommandPool,
+			.level				= VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+			.commandBufferCount	= 1,
+		};
+		if (vkAllocateCommandBuffers(gDevice, &primaryInfo, &frame->primary) != VK_SUCCESS
+			|| vkAllocateCommandBuffers(gDevice, &objectsInfo, &frame->objects) != VK_SUCCESS
+			|| vkAllocateCommandBuffers(gDevice, &terrainInfo, &frame->terrain) != VK_SUCCESS)
+		{
+			return false;
+		}
+
+		VkFenceCreateInfo fenceInfo = { .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+		if (vkCreateFence(gDevice, &fenceInfo, NULL, &frame->fence) != VK_SUCCESS)
+			return false;
+
+		if (gCanTimestamp)
+		{
+			VkQueryPoolCreateInfo queryInfo =
+			{
+				.sType		= VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+				.queryType	= VK_QUERY_TYPE_TIMESTAMP,
+				.queryCount	= 2,
+			};
+			if (vkCreateQueryPool(gDevice, &queryInfo, NULL, &frame->timestamps) != VK_SUCCESS)
+				return false;
+		}
+
+		if (!CreateBuffer(VK_STREAM_SIZE, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, &frame->stream)
+			|| !CreateBuffer(sizeof(VulkanFrameUniforms), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, &frame->uniforms))
+		{
+			return false;
+		}
+
+		VkDescriptorSetAllocateInfo setInfo =
+		{
+			.sType				= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+			.descriptorPool		= gDescriptorPool,
+			.descriptorSetCount	= 1,
+			.pSetLayouts		= &gFrameSetLayout,
+		};
+		if (vkAllocateDescriptorSets(gDevice, &setInfo, &frame->frameSet) != VK_SUCCESS)
+			return false;
+
+		VkDescriptorBufferInfo bufferInfo = { frame->uniforms.buffer, 0, sizeof(VulkanFrameUniforms) };
+		VkWriteDescriptorSet write =
+		{
+			.sType				= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstSet				= frame->frameSet,
+			.dstBinding			= 0,
+			.descriptorCount	= 1,
+			.descriptorType		= VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+			.pBufferInfo		= &bufferInfo,
+		};
+		vkUpdateDescriptorSets(gDevice, 1, &write, 0, NULL);
+	}
+
+			/* WHITE TEXTURE (TEXTURE NAME 0) */
+
+	static const uint32_t kWhite = 0xFFFFFFFF;
+	VkRender_LoadTexture(0, GL_RGBA, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, &kWhite, kRendererTextureFlags_None);
+	gWhiteTexture = gTextures[0];
+	SDL_memset(&gTextures[0], 0, sizeof(gTextures[0]));
+
+	return gWhiteTexture.descriptorSet != VK_NULL_HANDLE;
+}
+
+/****************** CREATE RENDER TARGET ********************/
+//
+// Offscreen color & depth buffers the size of the 3D viewport,
+// and a buffer to copy the color buffer into for VkRender_ReadPixels.
+//
+
+static bool CreateRenderTarget(int width, int height)
+{
+	if (!CreateImage(width, height, VK_FORMAT_R8G8B8A8_UNORM,
+					 VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_IMAGE_ASPECT_COLOR_BIT,
+					 &gColorImage, &gColorView, &gColorMemory))
+	{
+		return false;
+	}
+
+	if (!CreateImage(width, height, gDepthFormat,
+					 VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_IMAGE_ASPECT_DEPTH_BIT,
+					 &gDepthImage, &gDepthView, &gDepthMemory))
+	{
+		return false;
+	}
+
+	VkImageView views[2] = { gColorView, gDepthView };
+	VkFramebufferCreateInfo framebufferInfo =
+	{
+		.sType				= VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+		.renderPass			= gRenderPass,
+		.attachmentCount	= 2,
+		.pAttachments		= views,
+		.width				= (uint32_t) width,
+		.height				= (uint32_t) height,
+		.layers				= 1,
+	};
+	if (vkCreateFramebuffer(gDevice, &framebufferInfo, NULL, &gFramebuffer) != VK_SUCCESS)
+		return false;
+
+	if (!CreateBuffer((VkDeviceSize) width * height * 4, VK_BUFFER_USAGE_TRANSFER_DST_BIT, &gReadbackBuffer))
+		return false;
+
+	gTargetWidth = width;
+	gTargetHeight = height;
+	gReadbackSlot = -1;
+	return true;
+}
+
+static void DisposeRenderTarget(void)
+{
+	if (gFramebuffer)	vkDestroyFramebuffer(gDevice, gFramebuffer, NULL);
+	if (gColorView)		vkDestroyImageView(gDevice, gColorView, NULL);
+	if (gColorImage)	vkDestroyImage(gDevice, gColorImage, NULL);
+	if (gColorMemory)	vkFreeMemory(gDevice, gColorMemory, NULL);
+	if (gDepthView)		vkDestroyImageView(gDevice, gDepthView, NULL);
+	if (gDepthImage)	vkDestroyImage(gDevice, gDepthImage, NULL);
+	if (gDepthMemory)	vkFreeMemory(gDevice, gDepthMemory, NULL);
+	DisposeBuffer(&gReadbackBuffer);
+
+	gFramebuffer = VK_NULL_HANDLE;
+	gColorView = VK_NULL_HANDLE;
+	gColorImage = VK_NULL_HANDLE;
+	gColorMemory = VK_NULL_HANDLE;
+	gDepthView = VK_NULL_HANDLE;
+	gDepthImage = VK_NULL_HANDLE;
+	gDepthMemory = VK_NULL_HANDLE;
+	gTargetWidth = 0;
+	gTargetHeight = 0;
+	gReadbackSlot = -1;
+}
+
+#pragma mark -
+
+/****************************/
+/*    TEXTURES              */
+/****************************/
+
+static VulkanTexture* GetTextureSlot(GLuint textureName)
+{
+	if ((int) textureName >= gNumTextureSlots)
+	{
+		int capacity = gNumTextureSlots;
+		gTextures = GrowArray(gTextures, &capacity, (int) textureName + 1, sizeof(VulkanTexture));
+		gNumTextureSlots = capacity;
+	}
+
+	return &gTextures[textureName];
+}
+
+/****************** VKRENDER: LOAD TEXTURE ********************/
+//
+// Mirrors a texture made by Render_LoadTexture, under the same GL texture name.
+// GL reuses the names of deleted textures, so an older copy under this name is replaced.
+//
+
+void VkRender_LoadTexture(
+		GLuint textureName,
+		GLenum internalFormat,
+		int width,
+		int height,
+		GLenum bufferFormat,
+		GLenum bufferType,
+		const void* pixels,
+		RendererTextureFlags flags)
+{
+	VulkanTexture* texture = GetTextureSlot(textureName);
+
+	if (texture->image)
+	{
+		DisposeLater(VK_NULL_HANDLE, texture->image, texture->view, texture->memory, texture->descriptorSet);
+		SDL_memset(texture, 0, sizeof(*texture));
+
+		// Uploads still waiting for the old texture would land in the new one
+		int kept = 0;
+		for (int i = 0; i < gNumTextureUploads; i++)
+		{
+			if (gTextureUploads[i].textureName == textureName)
+				DisposeBuffer(&gTextureUploads[i].staging);
+			else
+				gTextureUploads[kept++] = gTextureUploads[i];
+		}
+		gNumTextureUploads = kept;
+	}
+
+	if (!CreateImage(width, height, VK_FORMAT_R8G8B8A8_UNORM,
+					 VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VK_IMAGE_ASPECT_COLOR_BIT,
+					 &texture->image, &texture->view, &texture->memory))
+	{
+		GAME_ASSERT_MESSAGE(false, "Vulkan: couldn't create texture");
+	}
+
+	texture->width = width;
+	texture->height = height;
+	texture->internalFormat = internalFormat;
+
+	VkDescriptorSetAllocateInfo setInfo =
+	{
+		.sType				= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		.descriptorPool		= gDescriptorPool,
+		.descriptorSetCount	= 1,
+		.pSetLayouts		= &gTextureSetLayout,
+	};
+	CHECK_VK(vkAllocateDescriptorSets(gDevice, &setInfo, &texture->descriptorSet));
+
+	int sampler = (gGamePrefs.highQualityTextures ? 4 : 0)
+			| ((flags & kRendererTextureFlags_ClampU) ? 1 : 0)
+			| ((flags & kRendererTextureFlags_ClampV) ? 2 : 0);
+
+	VkDescriptorImageInfo imageInfo = { gSamplers[sampler], texture->view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+	VkWriteDescriptorSet write =
+	{
+		.sType				= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.dstSet				= texture->descriptorSet,
+		.dstBinding			= 0,
+		.descriptorCount	= 1,
+		.descriptorType		= VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		.pImageInfo			= &imageInfo,
+	};
+	vkUpdateDescriptorSets(gDevice, 1, &write, 0, NULL);
+
+	QueueTextureUpload(textureName, width, height, internalFormat, bufferFormat, bufferType, pixels, true);
+}
+
+/****************** VKRENDER: UPDATE TEXTURE ********************/
+
+void VkRender_UpdateTexture(GLuint textureName, int width, int height, GLenum bufferFormat, GLenum bufferType, const void* pixels)
+{
+	if ((int) textureName >= gNumTextureSlots || !gTextures[textureName].image)
+		return;
+
+	GAME_ASSERT(width == gTextures[textureName].width && height == gTextures[textureName].height);
+
+	QueueTextureUpload(textureName, width, height, gTextures[textureName].internalFormat, bufferFormat, bufferType, pixels, false);
+}
+
+/****************** QUEUE TEXTURE UPLOAD ********************/
+//
+// Converts the pixels to RGBA8 in a staging buffer. The copy to the image is recorded
+// at the start of the next frame (see RecordPrimary), so it's ordered after any frame
+// still reading the old pixels.
+//
+// INPUT:	internalFormat = GL_RGB drops the alpha channel, like GL
+//
+
+static void QueueTextureUpload(GLuint textureName, int width, int height, GLenum internalFormat,
+							   GLenum bufferFormat, GLenum bufferType, const void* pixels, bool isNew)
+{
+	VulkanTextureUpload upload;
+	int numPixels = width * height;
+
+	upload.textureName	= textureName;
+	upload.width		= width;
+	upload.height		= height;
+	upload.isNew		= isNew;
+
+	if (!CreateBuffer((VkDeviceSize) numPixels * 4, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, &upload.staging))
+		GAME_ASSERT_MESSAGE(false, "Vulkan: couldn't create texture staging buffer");
+
+	uint8_t* out = upload.staging.mapped;
+
+	if (!pixels)
+	{
+		SDL_memset(out, 0, numPixels * 4);
+	}
+	else if (bufferFormat == GL_BGRA && bufferType == GL_UNSIGNED_SHORT_1_5_5_5_REV)
+	{
+		const uint16_t* in = (const uint16_t*) pixels;
+		for (int i = 0; i < numPixels; i++, out += 4)
+		{
+			uint16_t p = in[i];
+			uint8_t r = (p >> 10) & 31;
+			uint8_t g = (p >> 5) & 31;
+			uint8_t b = p & 31;
+			out[0] = (r << 3) | (r >> 2);
+			out[1] = (g << 3) | (g >> 2);
+			out[2] = (b << 3) | (b >> 2);
+			out[3] = (p & 0x8000) ? 255 : 0;
+		}
+	}
+	else if (bufferFormat == GL_BGRA && (bufferType == GL_UNSIGNED_INT_8_8_8_8 || bufferType == GL_UNSIGNED_INT_8_8_8_8_REV))
+	{
+		const uint32_t* in = (const uint32_t*) pixels;
+		for (int i = 0; i < numPixels; i++, out += 4)
+		{
+			uint32_t p = in[i];
+			if (bufferType == GL_UNSIGNED_INT_8_8_8_8)		// B,G,R,A from the most significant byte down
+			{
+				out[0] = (p >> 8) & 0xFF;
+				out[1] = (p >> 16) & 0xFF;
+				out[2] = (p >> 24) & 0xFF;
+				out[3] = p & 0xFF;
+			}
+			else											// B,G,R,A from the least significant byte up
+			{
+				out[0] = (p >> 16) & 0xFF;
+				out[1] = (p >> 8) & 0xFF;
+				out[2] = p & 0xFF;
+				out[3] = (p >> 24) & 0xFF;
+			}
+		}
+	}
+	else if ((bufferFormat == GL_RGBA || bufferFormat == GL_RGB) && bufferType == GL_UNSIGNED_BYTE)
+	{
+		const uint8_t* in = (const uint8_t*) pixels;
+		int inStride = bufferFormat == GL_RGBA ? 4 : 3;
+		for (int i = 0; i < numPixels; i++, out += 4, in += inStride)
+		{
+			out[0] = in[0];
+			out[1] = in[1];
+			out[2] = in[2];
+			out[3] = inStride == 4 ? in[3] : 255;
+		}
+	}
+	else
+	{
+		DisposeBuffer(&upload.staging);
+		GAME_ASSERT_MESSAGE(false, "Vulkan: unsupported texture pixel format");
+		return;
+	}
+
+	if (internalFormat == GL_RGB)
+	{
+		out = upload.staging.mapped;
+		for (int i = 0; i < numPixels; i++)
+			out[i*4 + 3] = 255;
+	}
+
+	gTextureUploads = GrowArray(gTextureUploads, &gTextureUploadCapacity, gNumTextureUploads + 1, sizeof(VulkanTextureUpload));
+	gTextureUploads[gNumTextureUploads++] = upload;
+}
+
+#pragma mark -
+
+/****************************/
+/*    STATIC MESHES         */
+/****************************/
+
+/****************** VKRENDER: UPLOAD STATIC MESH ********************/
+//
+// Copies all of a mesh's arrays & triangles, as floats, into the current static block.
+// Render_UploadStaticMesh calls this, so the same meshes as on the GL side are static.
+//
+
+int VkRender_UploadStaticMesh(const TQ3TriMeshData* mesh)
+{
+	VkDeviceSize size = 0;
+	VulkanStaticMesh sm;
+	int handle;
+
+			/* LAY OUT THE ARRAYS */
+
+	#define VK_STATIC_ARRAY(field, present, bytes)									\
+		do {																		\
+			if (present)															\
+			{																		\
+				sm.field = size;													\
+				size += ((VkDeviceSize) (bytes) + VK_STREAM_ALIGNMENT - 1) & ~(VkDeviceSize) (VK_STREAM_ALIGNMENT - 1);	\
+			}																		\
+			else																	\
+			{																		\
+				sm.field = VK_WHOLE_SIZE;											\
+			}																		\
+		} while(0)
+
+	VK_STATIC_ARRAY(points,		true,										mesh->numPoints * sizeof(TQ3Point3D));
+	VK_STATIC_ARRAY(normals,	mesh->vertexNormals != nil,					mesh->numPoints * sizeof(TQ3Vector3D));
+	VK_STATIC_ARRAY(uvs,		mesh->vertexUVs != nil,						mesh->numPoints * sizeof(TQ3Param2D));
+	VK_STATIC_ARRAY(colors,		mesh->hasVertexColors && mesh->vertexColors,	mesh->numPoints * sizeof(TQ3ColorRGBA));
+	VK_STATIC_ARRAY(triangles,	true,										mesh->numTriangles * sizeof(TQ3TriMeshTriangleData));
+
+	#undef VK_STATIC_ARRAY
+
+			/* FIND ROOM */
+
+	if (gCurrentStaticBlock < 0 || gStaticBlocks[gCurrentStaticBlock].used + size > gStaticBlocks[gCurrentStaticBlock].buffer.size)
+	{
+		int capacity = gNumStaticBlocks;
+		gStaticBlocks = GrowArray(gStaticBlocks, &capacity, gNumStaticBlocks + 1, sizeof(VulkanStaticBlock));
+
+		VulkanStaticBlock* block = &gStaticBlocks[gNumStaticBlocks];
+		if (!CreateBuffer(SDL_max(size, VK_STATIC_BLOCK_SIZE), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, &block->buffer))
+			return -1;
+		block->used = 0;
+		block->liveMeshes = 0;
+
+		gCurrentStaticBlock = gNumStaticBlocks++;
+	}
+
+	VulkanStaticBlock* block = &gStaticBlocks[gCurrentStaticBlock];
+
+	sm.inUse		= true;
+	sm.block		= gCurrentStaticBlock;
+	sm.numTriangles	= mesh->numTriangles;
+	sm.points		+= block->used;
+	sm.triangles	+= block->used;
+	if (sm.normals != VK_WHOLE_SIZE)	sm.normals += block->used;
+	if (sm.uvs != VK_WHOLE_SIZE)		sm.uvs += block->used;
+	if (sm.colors != VK_WHOLE_SIZE)		sm.colors += block->used;
+
+			/* COPY */
+
+	uint8_t* base = block->buffer.mapped;
+	SDL_memcpy(base + sm.points, mesh->points, mesh->numPoints * sizeof(TQ3Point3D));
+	SDL_memcpy(base + sm.triangles, mesh->triangles, mesh->numTriangles * sizeof(TQ3TriMeshTriangleData));
+	if (sm.normals != VK_WHOLE_SIZE)	SDL_memcpy(base + sm.normals, mesh->vertexNormals, mesh->numPoints * sizeof(TQ3Vector3D));
+	if (sm.uvs != VK_WHOLE_SIZE)		SDL_memcpy(base + sm.uvs, mesh->vertexUVs, mesh->numPoints * sizeof(TQ3Param2D));
+	if (sm.colors != VK_WHOLE_SIZE)		SDL_memcpy(base + sm.colors, mesh->vertexColors, mesh->numPoints * sizeof(TQ3ColorRGBA));
+
+	block->used += size;
+	block->liveMeshes++;
+
+			/* TAKE A FREE HANDLE */
+
+	for (handle = 0; handle < gStaticMeshCapacity && gStaticMeshes[handle].inUse; handle++)
+		;
+	gStaticMeshes = GrowArray(gStaticMeshes, &gStaticMeshCapacity, handle + 1, sizeof(VulkanStaticMesh));
+	gStaticMeshes[handle] = sm;
+
+	return handle;
+}
+
+/****************** VKRENDER: RELEASE STATIC MESH ********************/
+//
+// A block's space isn't reused piecemeal: the whole block goes once its last mesh is released
+// (the game releases its static meshes a level's worth at a time).
+//
+
+void VkRender_ReleaseStaticMesh(int handle)
+{
+	if (handle < 0 || handle >= gStaticMeshCapacity || !gStaticMeshes[handle].inUse)
+		return;
+
+	int blockNum = gStaticMeshes[handle].block;
+	VulkanStaticBlock* block = &gStaticBlocks[blockNum];
+
+	gStaticMeshes[handle].inUse = false;
+
+	block->liveMeshes--;
+	if (block->liveMeshes > 0)
+		return;
+
+	if (blockNum == gCurrentStaticBlock)
+		gCurrentStaticBlock = -1;
+
+	DisposeLater(block->buffer.buffer, VK_NULL_HANDLE, VK_NULL_HANDLE, block->buffer.memory, VK_NULL_HANDLE);
+	SDL_memset(&block->buffer, 0, sizeof(block->buffer));
+	block->used = 0;
+}
+
+#pragma mark -
+
+/****************************/
+/*    DRAWING               */
+/****************************/
+
+/****************** VKRENDER: BEGIN FRAME ********************/
+//
+// Called by Render_SetViewport. Waits until the GPU is done with the frame that last
+// used this slot, so its stream buffer can be refilled.
+//
+
+void VkRender_BeginFrame(int width, int height, TQ3ColorRGBA clearColor)
+{
+	VulkanFrame* frame = &gFrames[gFrameSlot];
+
+	if (!gDevice || width <= 0 || height <= 0)
+		return;
+
+			/* RESIZE THE TARGET */
+
+	if (width != gTargetWidth || height != gTargetHeight)
+	{
+		vkDeviceWaitIdle(gDevice);
+		gFinishedFrames = gSubmittedFrames;
+		DisposeRenderTarget();
+		if (!CreateRenderTarget(width, height))
+			GAME_ASSERT_MESSAGE(false, "Vulkan: couldn't create the render target");
+	}
+
+			/* WAIT FOR THIS SLOT'S LAST FRAME */
+
+	if (frame->serial != 0)
+	{
+		CHECK_VK(vkWaitForFences(gDevice, 1, &frame->fence, VK_TRUE, UINT64_MAX));
+		gFinishedFrames = SDL_max(gFinishedFrames, frame->serial);
+
+		if (frame->hasTimestamps)
+		{
+			uint64_t ticks[2];
+			if (VK_SUCCESS == vkGetQueryPoolResults(gDevice, frame->timestamps, 0, 2, sizeof(ticks), ticks, sizeof(ticks[0]), VK_QUERY_RESULT_64_BIT))
+				gLastGPUMilliseconds = (float) ((ticks[1] - ticks[0]) * (double) gDeviceProperties.limits.timestampPeriod / 1e6);
+		}
+	}
+
+	CollectGarbage(false);
+
+			/* GROW THE STREAM BUFFER IF THE LAST FRAME RAN OUT */
+
+	if (frame->stream.size < gStreamSize)
+	{
+		DisposeBuffer(&frame->stream);
+		if (!CreateBuffer(gStreamSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, &frame->stream))
+			GAME_ASSERT_MESSAGE(false, "Vulkan: couldn't grow the stream buffer");
+	}
+
+	frame->streamUsed = 0;
+
+	gClearColor.float32[0] = clearColor.r;
+	gClearColor.float32[1] = clearColor.g;
+	gClearColor.float32[2] = clearColor.b;
+	gClearColor.float32[3] = clearColor.a;
+
+	gNumDrawCommands = 0;
+	gInFrame = true;
+}
+
+static bool StreamArray(const void* data, VkDeviceSize size, VkDeviceSize* outOffset)
+{
+	VulkanFrame* frame = &gFrames[gFrameSlot];
+
+	VkDeviceSize offset = (frame->streamUsed + VK_STREAM_ALIGNMENT - 1) & ~(VkDeviceSize) (VK_STREAM_ALIGNMENT - 1);
+	if (offset + size > frame->stream.size)
+	{
+		gStreamSize = SDL_max(gStreamSize, frame->stream.size * 2);		// drop the draw; the buffer grows next time round
+		return false;
+	}
+
+	SDL_memcpy(frame->stream.mapped + offset, data, size);
+	frame->streamUsed = offset + size;
+	*outOffset = offset;
+	return true;
+}
+
+/****************** VKRENDER: ADD DRAW ********************/
+//
+// Turns one mesh draw into a VulkanDrawCommand: pipeline, texture, and where each vertex
+// array comes from. Streamed arrays are copied now, so the caller may reuse them (gEnvMapUVs).
+//
+
+void VkRender_AddDraw(const VulkanDraw* draw)
+{
+	const TQ3TriMeshData* mesh = draw->mesh;
+	const VulkanStaticMesh* sm = nil;
+	VkBuffer streamBuffer = gFrames[gFrameSlot].stream.buffer;
+	int key = draw->pipelineState;
+	bool ok = true;
+
+	if (!gInFrame || draw->numTriangles == 0 || mesh->numPoints == 0)
+		return;
+
+	if (draw->staticMesh >= 0 && draw->staticMesh < gStaticMeshCapacity && gStaticMeshes[draw->staticMesh].inUse)
+		sm = &gStaticMeshes[draw->staticMesh];
+
+	gDrawCommands = GrowArray(gDrawCommands, &gDrawCommandCapacity, gNumDrawCommands + 1, sizeof(VulkanDrawCommand));
+	VulkanDrawCommand* cmd = &gDrawCommands[gNumDrawCommands];
+	VkBuffer staticBuffer = sm ? gStaticBlocks[sm->block].buffer.buffer : VK_NULL_HANDLE;
+	size_t n = mesh->numPoints;
+
+			/* VERTEX ARRAYS */
+
+	for (int i = 0; i < 4; i++)
+	{
+		cmd->vertexBuffers[i] = gDefaultAttributes.buffer;
+		cmd->vertexOffsets[i] = i > 0 ? (i - 1) * 4 * sizeof(float) : 0;
+	}
+
+	if (sm)
+	{
+		cmd->vertexBuffers[0] = staticBuffer;
+		cmd->vertexOffsets[0] = sm->points;
+	}
+	else
+	{
+		cmd->vertexBuffers[0] = streamBuffer;
+		ok &= StreamArray(mesh->points, n * sizeof(TQ3Point3D), &cmd->vertexOffsets[0]);
+	}
+
+	if (key & kPipelineState_Normals)
+	{
+		if (sm && sm->normals != VK_WHOLE_SIZE)
+		{
+			cmd->vertexBuffers[1] = staticBuffer;
+			cmd->vertexOffsets[1] = sm->normals;
+		}
+		else
+		{
+			cmd->vertexBuffers[1] = streamBuffer;
+			ok &= StreamArray(mesh->vertexNormals, n * sizeof(TQ3Vector3D), &cmd->vertexOffsets[1]);
+		}
+	}
+
+	if (key & kPipelineState_Texture)
+	{
+		GAME_ASSERT(draw->uvs);
+
+		if (sm && sm->uvs != VK_WHOLE_SIZE && draw->uvs == mesh->vertexUVs)
+		{
+			cmd->vertexBuffers[2] = staticBuffer;
+			cmd->vertexOffsets[2] = sm->uvs;
+		}
+		else
+		{
+			cmd->vertexBuffers[2] = streamBuffer;
+			ok &= StreamArray(draw->uvs, n * sizeof(TQ3Param2D), &cmd->vertexOffsets[2]);
+		}
+	}
+
+	if (key & kPipelineState_VertexColors)
+	{
+		if (sm && sm->colors != VK_WHOLE_SIZE)
+		{
+			cmd->vertexBuffers[3] = staticBuffer;
+			cmd->vertexOffsets[3] = sm->colors;
+		}
+		else
+		{
+			cmd->vertexBuffers[3] = streamBuffer;
+			ok &= StreamArray(mesh->vertexColors, n * sizeof(TQ3ColorRGBA), &cmd->vertexOffsets[3]);
+		}
+	}
+
+			/* TRIANGLES (REDUCED LODS ARE STREAMED) */
+
+	if (sm && draw->triangles == mesh->triangles)
+	{
+		cmd->indexBuffer = staticBuffer;
+		cmd->indexOffset = sm->triangles;
+	}
+	else
+	{
+		cmd->indexBuffer = streamBuffer;
+		ok &= StreamArray(draw->triangles, draw->numTriangles * sizeof(TQ3TriMeshTriangleData), &cmd->indexOffset);
+	}
+
+	if (!ok)
+		return;
+
+	cmd->numIndices = draw->numTriangles * 3;
+
+			/* STATE */
+
+	int pipelineKey = key & ~kPipelineState_EnvMap;
+	cmd->pipeline = gPipelines[pipelineKey];
+	cmd->frontCullPipeline = gFrontCullPipelines[pipelineKey];
+	GAME_ASSERT(cmd->pipeline);
+
+	cmd->textureSet = gWhiteTexture.descriptorSet;
+	if ((key & kPipelineState_Texture)
+		&& (int) mesh->glTextureName < gNumTextureSlots
+		&& gTextures[mesh->glTextureName].descriptorSet)
+	{
+		cmd->textureSet = gTextures[mesh->glTextureName].descriptorSet;
+	}
+
+	if (draw->transform)
+		cmd->push.localToWorld = *draw->transform;
+	else
+		Q3Matrix4x4_SetIdentity(&cmd->push.localToWorld);
+	cmd->push.diffuseColor = draw->diffuseColor;
+
+	// Opaque terrain can be drawn before the opaque objects; anything blended keeps its place
+	cmd->isTerrain = draw->isTerrain && !(key & kPipelineState_Blend);
+
+	gNumDrawCommands++;
+}
+
+/****************** FILL FRAME UNIFORMS ********************/
+//
+// Camera, fill lights & fog, the same way QD3D_Support.c sets them up in GL.
+//
+
+static void FillFrameUniforms(VulkanFrameUniforms* u)
+{
+	const QD3DSetupOutputType* setup = gGameViewInfoPtr;
+
+	SDL_memset(u, 0, sizeof(*u));
+	SDL_memcpy(u->worldToView, &gCameraWorldToViewMatrix.value[0][0], sizeof(u->worldToView));
+	SDL_memcpy(u->viewToFrustum, &gCameraViewToFrustumMatrix.value[0][0], sizeof(u->viewToFrustum));
+
+	u->ambient[0] = u->ambient[1] = u->ambient[2] = .2f;			// GL's default global ambient
+
+	if (!setup)
+		return;
+
+	const QD3DLightDefType* lights = &setup->lights;
+
+	if (lights->ambientBrightness != 0)
+	{
+		u->ambient[0] = lights->ambientBrightness * lights->ambientColor.r;
+		u->ambient[1] = lights->ambientBrightness * lights->ambientColor.g;
+		u->ambient[2] = lights->ambientBrightness * lights->ambientColor.b;
+	}
+
+	u->numLights = lights->numFillLights;
+	for (int i = 0; i < lights->numFillLights; i++)
+	{
+		TQ3Vector3D toLight;
+		Q3Vector3D_Normalize(&lights->fillDirection[i], &toLight);
+		u->toLight[i][0] = -toLight.x;								// fill direction points away from the light
+		u->toLight[i][1] = -toLight.y;
+		u->toLight[i][2] = -toLight.z;
+		u->lightColor[i][0] = lights->fillColor[i].r * lights->fillBrightness[i];
+		u->lightColor[i][1] = lights->fillColor[i].g * lights->fillBrightness[i];
+		u->lightColor[i][2] = lights->fillColor[i].b * lights->fillBrightness[i];
+	}
+
+	if (lights->useFog && gGamePrefs.canDoFog)
+	{
+		u->fogRange[0] = setup->hither + lights->fogHither * (setup->yon - setup->hither);
+		u->fogRange[1] = setup->hither + lights->fogYon    * (setup->yon - setup->hither);
+		u->fogRange[2] = 1;
+		u->fogColor[0] = setup->clearColor.r;
+		u->fogColor[1] = setup->clearColor.g;
+		u->fogColor[2] = setup->clearColor.b;
+		u->fogColor[3] = setup->clearColor.a;
+	}
+}
+
+/****************** RECORD DRAWS ********************/
+//
+// Records either the opaque terrain or everything else, in queue order,
+// into this frame's secondary command buffer for it.
+//
+
+static void RecordDraws(VkCommandBuffer cb, bool terrain)
+{
+	VulkanFrame* frame = &gFrames[gFrameSlot];
+	VkPipeline boundPipeline = VK_NULL_HANDLE;
+	VkDescriptorSet boundTexture = VK_NULL_HANDLE;
+
+	VkCommandBufferInheritanceInfo inheritance =
+	{
+		.sType			= VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+		.renderPass		= gRenderPass,
+		.subpass		= 0,
+		.framebuffer	= gFramebuffer,
+	};
+	VkCommandBufferBeginInfo beginInfo =
+	{
+		.sType				= VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.flags				= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+		.pInheritanceInfo	= &inheritance,
+	};
+	CHECK_VK(vkBeginCommandBuffer(cb, &beginInfo));
+
+	VkViewport viewport = { 0, 0, (float) gTargetWidth, (float) gTargetHeight, 0, 1 };
+	VkRect2D scissor = { {0, 0}, {(uint32_t) gTargetWidth, (uint32_t) gTargetHeight} };
+	vkCmdSetViewport(cb, 0, 1, &viewport);
+	vkCmdSetScissor(cb, 0, 1, &scissor);
+
+	vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, gPipelineLayout, 0, 1, &frame->frameSet, 0, NULL);
+
+	for (int i = 0; i < gNumDrawCommands; i++)
+	{
+		const VulkanDrawCommand* cmd = &gDrawCommands[i];
+
+		if (cmd->isTerrain != terrain)
+			continue;
+
+		if (cmd->textureSet != boundTexture)
+		{
+			vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, gPipelineLayout, 1, 1, &cmd->textureSet, 0, NULL);
+			boundTexture = cmd->textureSet;
+		}
+
+		vkCmdBindVertexBuffers(cb, 0, 4, cmd->vertexBuffers, cmd->vertexOffsets);
+		vkCmdBindIndexBuffer(cb, cmd->indexBuffer, cmd->indexOffset, VK_INDEX_TYPE_UINT32);
+		vkCmdPushConstants(cb, gPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(cmd->push), &cmd->push);
+
+		if (cmd->frontCullPipeline)					// pass 1: backfaces
+		{
+			vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, cmd->frontCullPipeline);
+			vkCmdDrawIndexed(cb, cmd->numIndices, 1, 0, 0, 0);
+			boundPipeline = cmd->frontCullPipeline;
+		}
+
+		if (cmd->pipeline != boundPipeline)
+		{
+			vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, cmd->pipeline);
+			boundPipeline = cmd->pipeline;
+		}
+
+		vkCmdDrawIndexed(cb, cmd->numIndices, 1, 0, 0, 0);
+	}
+
+	CHECK_VK(vkEndCommandBuffer(cb));
+}
+
+/****************** RECORD PRIMARY ********************/
+//
+// Texture uploads, then the render pass running both secondary command buffers,
+// then the readback copy if one was asked for.
+//
+
+static void RecordPrimary(VulkanFrame* frame)
+{
+	VkCommandBuffer cb = frame->primary;
+
+	VkCommandBufferBeginInfo beginInfo =
+	{
+		.sType	= VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.flags	= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+	};
+	CHECK_VK(vkBeginCommandBuffer(cb, &beginInfo));
+
+	frame->hasTimestamps = frame->timestamps != VK_NULL_HANDLE;
+	if (frame->hasTimestamps)
+	{
+		vkCmdResetQueryPool(cb, frame->timestamps, 0, 2);
+		vkCmdWriteTimestamp(cb, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame->timestamps, 0);
+	}
+
+			/* TEXTURE UPLOADS */
+
+	for (int i = 0; i < gNumTextureUploads; i++)
+	{
+		VulkanTextureUpload* upload = &gTextureUploads[i];
+		const VulkanTexture* texture = upload->textureName == 0 && !gTextures[0].image ? &gWhiteTexture : &gTextures[upload->textureName];
+
+		VkImageMemoryBarrier toTransfer =
+		{
+			.sType					= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			.srcAccessMask			= 0,
+			.dstAccessMask			= VK_ACCESS_TRANSFER_WRITE_BIT,
+			.oldLayout				= upload->isNew ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			.newLayout				= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			.srcQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED,
+			.image					= texture->image,
+			.subresourceRange		= { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 },
+		};
+		vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+							 0, 0, NULL, 0, NULL, 1, &toTransfer);
+
+		VkBufferImageCopy region =
+		{
+			.imageSubresource	= { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },
+			.imageExtent		= { (uint32_t) upload->width, (uint32_t) upload->height, 1 },
+		};
+		vkCmdCopyBufferToImage(cb, upload->staging.buffer, texture->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+		VkImageMemoryBarrier toShader = toTransfer;
+		toShader.srcAccessMask	= VK_ACCESS_TRANSFER_WRITE_BIT;
+		toShader.dstAccessMask	= VK_ACCESS_SHADER_READ_BIT;
+		toShader.oldLayout		= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		toShader.newLayout		= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+							 0, 0, NULL, 0, NULL, 1, &toShader);
+
+		DisposeLater(upload->staging.buffer, VK_NULL_HANDLE, VK_NULL_HANDLE, upload->staging.memory, VK_NULL_HANDLE);
+	}
+	gNumTextureUploads = 0;
+
+			/* DRAW */
+
+	VkClearValue clearValues[2];
+	clearValues[0].color = gClearColor;
+	clearValues[1].depthStencil.depth = 1.0f;
+	clearValues[1].depthStencil.stencil = 0;
+
+	VkRenderPassBeginInfo passInfo =
+	{
+		.sType				= VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+		.renderPass			= gRenderPass,
+		.framebuffer		= gFramebuffer,
+		.renderArea			= { {0, 0}, {(uint32_t) gTargetWidth, (uint32_t) gTargetHeight} },
+		.clearValueCount	= 2,
+		.pClearValues		= clearValues,
+	};
+	vkCmdBeginRenderPass(cb, &passInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+	VkCommandBuffer secondaries[2] = { frame->terrain, frame->objects };
+	vkCmdExecuteCommands(cb, 2, secondaries);
+
+	vkCmdEndRenderPass(cb);
+
+			/* READBACK */
+
+	if (gReadbackRequested)
+	{
+		VkBufferImageCopy region =
+		{
+			.imageSubresource	= { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },
+			.imageExtent		= { (uint32_t) gTargetWidth, (uint32_t) gTargetHeight, 1 },
+		};
+		vkCmdCopyImageToBuffer(cb, gColorImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, gReadbackBuffer.buffer, 1, &region);
+
+		VkMemoryBarrier toHost =
+		{
+			.sType			= VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+			.srcAccessMask	= VK_ACCESS_TRANSFER_WRITE_BIT,
+			.dstAccessMask	= VK_ACCESS_HOST_READ_BIT,
+		};
+		vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &toHost, 0, NULL, 0, NULL);
+
+		gReadbackSlot = gFrameSlot;
+		gReadbackRequested = false;
+	}
+
+	if (frame->hasTimestamps)
+		vkCmdWriteTimestamp(cb, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame->timestamps, 1);
+
+	CHECK_VK(vkEndCommandBuffer(cb));
+}
+
+/****************** TERRAIN RECORDING THREAD ********************/
+
+static int SDLCALL RecordThread(void* data)
+{
+	(void) data;
+
+	while (1)
+	{
+		SDL_WaitSemaphore(gRecordGo);
+		if (gQuitRecordThread)
+			break;
+
+		RecordDraws(gFrames[gFrameSlot].terrain, true);
+		SDL_SignalSemaphore(gRecordDone);
+	}
+
+	return 0;
+}
+
+static bool StartRecordThread(void)
+{
+	gQuitRecordThread = false;
+
+	gRecordGo = SDL_CreateSemaphore(0);
+	gRecordDone = SDL_CreateSemaphore(0);
+	if (gRecordGo && gRecordDone)
+		gRecordThread = SDL_CreateThread(RecordThread, "VulkanRecord", NULL);
+
+	if (!gRecordThread)
+	{
+		StopRecordThread();
+		return false;
+	}
+
+	return true;
+}
+
+static void StopRecordThread(void)
+{
+	if (gRecordThread)
+	{
+		gQuitRecordThread = true;
+		SDL_SignalSemaphore(gRecordGo);
+		SDL_WaitThread(gRecordThread, NULL);
+		gRecordThread = NULL;
+	}
+
+	if (gRecordGo)
+	{
+		SDL_DestroySemaphore(gRecordGo);
+		gRecordGo = NULL;
+	}
+
+	if (gRecordDone)
+	{
+		SDL_DestroySemaphore(gRecordDone);
+		gRecordDone = NULL;
+	}
+}
+
+/****************** VKRENDER: END FRAME ********************/
+//
+// Records the terrain on the helper thread while this thread records the objects,
+// then submits the frame. Doesn't wait for the GPU.
+//
+
+void VkRender_EndFrame(void)
+{
+	VulkanFrame* frame = &gFrames[gFrameSlot];
+
+	if (!gInFrame)
+		return;
+
+	gInFrame = false;
+
+	FillFrameUniforms((VulkanFrameUniforms*) frame->uniforms.mapped);
+
+	CHECK_VK(vkResetCommandPool(gDevice, frame->commandPool, 0));
+	CHECK_VK(vkResetCommandPool(gDevice, frame->terrainCommandPool, 0));
+
+	if (gRecordThread)
+	{
+		SDL_SignalSemaphore(gRecordGo);
+		RecordDraws(frame->objects, false);
+		SDL_WaitSemaphore(gRecordDone);
+	}
+	else
+	{
+		RecordDraws(frame->terrain, true);
+		RecordDraws(frame->objects, false);
+	}
+
+	RecordPrimary(frame);
+
+	VkSubmitInfo submitInfo =
+	{
+		.sType				= VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		.commandBufferCount	= 1,
+		.pCommandBuffers	= &frame->primary,
+	};
+	CHECK_VK(vkResetFences(gDevice, 1, &frame->fence));
+	CHECK_VK(vkQueueSubmit(gQueue, 1, &submitInfo, frame->fence));
+
+	frame->serial = ++gSubmittedFrames;
+	gFrameSlot = (gFrameSlot + 1) % VK_FRAMES_IN_FLIGHT;
+}
+
+#pragma mark -
+
+/****************************/
+/*    READBACK & INFO       */
+/****************************/
+
+void VkRender_RequestReadback(void)
+{
+	gReadbackRequested = true;
+}
+
+/****************** VKRENDER: READ PIXELS ********************/
+//
+// Waits for the frame that copied its color buffer out, then returns it as RGBA, top row first.
+//
+
+bool VkRender_ReadPixels(uint8_t* rgba, int width, int height)
+{
+	if (!gDevice || gReadbackSlot < 0 || width != gTargetWidth || height != gTargetHeight)
+		return false;
+
+	CHECK_VK(vkWaitForFences(gDevice, 1, &gFrames[gReadbackSlot].fence, VK_TRUE, UINT64_MAX));
+	SDL_memcpy(rgba, gReadbackBuffer.mapped, (size_t) width * height * 4);
+	return true;
+}
+
+void VkRender_GetFrameInfo(VulkanFrameInfo* info)
+{
+	SDL_memset(info, 0, sizeof(*info));
+	if (!gDevice)
+		return;
+
+	SDL_strlcpy(info->deviceName, gDeviceProperties.deviceName, sizeof(info->deviceName));
+	info->width				= gTargetWidth;
+	info->height			= gTargetHeight;
+	info->gpuMilliseconds	= gLastGPUMilliseconds;
+}
+
+#endif // RENDER_VULKAN
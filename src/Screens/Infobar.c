@@ -359,6 +359,7 @@ TQ3Matrix4x4	matrix,matrix2,matrix3;
 			/* TRANSFORM TO WORLD COORDINATES */
 
 	Q3Matrix4x4_Multiply(&matrix,&gCameraAdjustMatrix,&theNode->BaseTransformMatrix);
+	theNode->XformRotOrder = XFORM_NEEDS_REBUILD;						// matrix was set by hand
 }
 
 
@@ -771,12 +772,8 @@ Boolean					forceUpdate = false;
 				/* UPDATE THE TEXTURE */
 				/**********************/
 
-		Render_BindTexture(gGPSObj->MeshList[0]->glTextureName);
-		glTexSubImage2D(
-				GL_TEXTURE_2D,
-				0,
-				0,
-				0,
+		Render_UpdateTexture(
+				gGPSObj->MeshList[0]->glTextureName,
 				GPS_MAP_TEXTURE_SIZE,
 				GPS_MAP_TEXTURE_SIZE,
 				GL_BGRA,
@@ -786,7 +783,6 @@ Boolean					forceUpdate = false;
 				GL_UNSIGNED_INT_8_8_8_8_REV,
 #endif
 				GetPixBaseAddr(GetGWorldPixMap(gGPSGWorld)));
-		CHECK_GL_ERROR();
 
 
 		gOldGPSCoordX = x;
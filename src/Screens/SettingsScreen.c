@@ -56,6 +56,7 @@ static char gDisplayNameBuffers[MAX_CHOICES][64];
 static SettingEntry gSettingEntries[] =
 {
 	{nil							, "Configure Controls"	, Callback_EnterControls,	0,	{ NULL } },
+	{&gGamePrefs.lowLatencyInput	, "Input Latency"		, nil,						2,	{ "NORMAL", "LOW" }, },
 	{nil							, nil					, nil,						0,  { NULL } },
 	{&gGamePrefs.extreme			, "Game Difficulty"		, Callback_Difficulty,		2,	{ "EASY", "EXTREME!" } },
 	{nil							, nil					, nil,						0,  { NULL } },
@@ -66,10 +67,13 @@ static SettingEntry gSettingEntries[] =
 	{&gGamePrefs.vsync				, "V-Sync"				, Callback_VSync,			2,	{ "NO", "YES" }, },
 	{&gGamePrefs.force4x3			, "Aspect Ratio"		, NULL,						2,	{ "FILL SCREEN", "FORCE 4:3" }, },
 	{&gGamePrefs.displayNum			, "Preferred Display"	, Callback_Fullscreen,		1,	{ "DEFAULT" }, },
-	{&gGamePrefs.antialiasingLevel	, "Antialiasing"		, Callback_Antialiasing,	4,	{ "NO", "MSAA 2x", "MSAA 4x", "MSAA 8x" }, },
+	{&gGamePrefs.antialiasingLevel	, "Antialiasing"		, Callback_Antialiasing,	5,	{ "NO", "MSAA 2x", "MSAA 4x", "MSAA 8x", "FXAA" }, },
 	{nil							, nil					, nil,						0,  { NULL } },
 	{&gGamePrefs.highQualityTextures, "Texture Filtering"	, nil,						2,	{ "NO", "YES" }, },
 	{&gGamePrefs.canDoFog			, "Fog"					, nil,						2,	{ "NO", "YES" }, },
+	{&gGamePrefs.meshLOD			, "Distant Model Detail", nil,						2,	{ "FULL", "REDUCED" }, },
+	{&gGamePrefs.bakedLighting		, "Scenery Lighting"	, nil,						2,	{ "DYNAMIC", "BAKED" }, },
+	{&gGamePrefs.adaptiveDrawDistance, "Draw Distance"	, nil,						2,	{ "FIXED", "ADAPTIVE" }, },
 	{&gGamePrefs.whiteSky			, "Sky Color"			, nil,						2,	{ "BLACK", "WHITE" } },
 	{&gGamePrefs.nanosaurTeethFix	, "Nano's Dentist Is"	, nil,						2,	{ "EXTINCT", "ALIVE" } },
 //	{&gGamePrefs.shadows			, "Shadow Decals"		, nil,						2,	{ "NO", "YES" }, },
@@ -163,7 +167,9 @@ static void Callback_VSync(void)
 
 static void Callback_Antialiasing(void)
 {
-	gShowAntialiasingWarning = true;
+	// FXAA is a post-process, so only a change in MSAA level needs a new window
+	int msaaLevel = gGamePrefs.antialiasingLevel == ANTIALIASING_LEVEL_FXAA ? 0 : gGamePrefs.antialiasingLevel;
+	gShowAntialiasingWarning = msaaLevel != gCurrentAntialiasingLevel;
 }
 
 static void Callback_DebugInfo(void)
@@ -272,13 +278,19 @@ static void DrawSettingsPage(void)
 		}
 	}
 
+	int y = 75;
+
 	for (int i = 0; i < numSettingEntries; i++)
 	{
+		SettingEntry* entry = &gSettingEntries[i];
+		int rowY = y;
+
+		y += entry->label ? 16 : 8;								// spacers are half-height so the whole page fits in 480
+
 		bool isSelectedRow = (int) i == selectedEntry;
 		if (!isSelectedRow && !needFullRender)
 			continue;
 
-		SettingEntry* entry = &gSettingEntries[i];
 		if (!entry->label)
 			continue;
 
@@ -297,7 +309,7 @@ static void DrawSettingsPage(void)
 		}
 
 		DrawRow(
-				75 + i*16,
+				rowY,
 				isSelectedRow,
 				fluc,
 				entry->valuePtr? 2: 1,
@@ -335,6 +335,12 @@ struct SlideshowEntry
 	void (*postDrawCallback)(void);
 };
 
+static void MakeSlideSpec(const char* imagePath, FSSpec* spec)
+{
+	OSErr result = FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, imagePath, spec);
+	GAME_ASSERT(result == noErr);
+}
+
 static void Slideshow(const struct SlideshowEntry* slides)
 {
 	FSSpec spec;
@@ -346,16 +352,23 @@ static void Slideshow(const struct SlideshowEntry* slides)
 	{
 		const struct SlideshowEntry* slide = &slides[i];
 		
-		OSErr result = FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, slide->imagePath, &spec);
-		GAME_ASSERT(result == noErr);
+		MakeSlideSpec(slide->imagePath, &spec);
 
-		PicHandle picHandle = GetPictureFromTGA(&spec);
+		PicHandle picHandle = GetPreloadedPictureFromTGA(&spec);
 		GAME_ASSERT(picHandle);
 		GAME_ASSERT(*picHandle);
 
 		DrawPicture(picHandle, &(**picHandle).picFrame);
 		DisposeHandle((Handle)picHandle);
 
+			/* DECODE NEXT SLIDE WHILE THIS ONE IS UP */
+
+		if (slides[i+1].imagePath != NULL)
+		{
+			MakeSlideSpec(slides[i+1].imagePath, &spec);
+			PreloadPictureFromTGA(&spec);
+		}
+
 		if (slide->postDrawCallback)
 		{
 			slide->postDrawCallback();
@@ -436,12 +449,15 @@ static void ShowCharity_SourcePortVersionOverlay(void)
 	DrawStringC("Version " GAME_VERSION);
 }
 
-void ShowCharity(void)
+static const char* GetCharityFirstImage(void)
 {
-	const char* firstImage = PRO_MODE ? ":Images:Boot1Pro.tga" : ":Images:Boot1.tga";
+	return gGamePrefs.extreme ? ":Images:Boot1Pro.tga" : ":Images:Boot1.tga";	// PRO_MODE isn't set yet when we preload
+}
 
+void ShowCharity(void)
+{
 	const struct SlideshowEntry slides[] = {
-			{ firstImage, ShowCharity_SourcePortVersionOverlay },
+			{ GetCharityFirstImage(), ShowCharity_SourcePortVersionOverlay },
 			{ ":Images:Boot2.tga", NULL },
 			{ NULL, NULL },
 	};
@@ -449,6 +465,24 @@ void ShowCharity(void)
 }
 
 
+/*************** PRELOAD CHARITY **********************/
+//
+// Called at boot, as soon as the prefs are loaded, so the boot screens
+// get decoded while SDL, OpenGL & the sound system start up.
+//
+
+void PreloadCharity(void)
+{
+	FSSpec spec;
+
+	MakeSlideSpec(GetCharityFirstImage(), &spec);
+	PreloadPictureFromTGA(&spec);
+
+	MakeSlideSpec(":Images:Boot2.tga", &spec);
+	PreloadPictureFromTGA(&spec);
+}
+
+
 /*************** SHOW HELP **********************/
 
 static void ShowHelp_TechInfoOverlay(void)
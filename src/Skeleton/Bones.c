@@ -18,6 +18,7 @@
 
 static void DecomposeATriMesh(SkeletonDefType* gCurrentSkeleton, TQ3TriMeshData* triMeshData);
 static void UpdateSkinnedGeometry_Recurse(ObjNode* skelNode, short joint);
+static void BuildSkeletonLODs(SkeletonDefType *skeleton);
 
 
 /****************************/
@@ -34,6 +35,7 @@ static void UpdateSkinnedGeometry_Recurse(ObjNode* skelNode, short joint);
 static	TQ3Matrix4x4		gMatrix;
 
 static	TQ3BoundingBox		gBBox = {{0,0,0}, {0,0,0}, kQ3False};
+static	int					gNumJointWorldMatrices;							// # joints whose world matrix was cached by the current UpdateSkinnedGeometry pass
 
 static	TQ3Vector3D			gTransformedNormals[MAX_DECOMPOSED_NORMALS];	// temporary buffer for holding transformed normals before they're applied to their trimeshes
 
@@ -60,13 +62,25 @@ void LoadBonesReferenceModel(FSSpec	*inSpec, SkeletonDefType *skeleton)
 
 			/* DECOMPOSE REFERENCE MODEL */
 
+	DecomposeReferenceModel(skeleton);
+}
+
+
+/******************** DECOMPOSE REFERENCE MODEL *********************/
+//
+// Builds the skeleton's lists of unique points & normals from the meshes in its 3DMF.
+// Running it again on the same skeleton rebuilds identical lists.
+//
+
+void DecomposeReferenceModel(SkeletonDefType *skeleton)
+{
 	skeleton->numDecomposedTriMeshes	= 0;
 	skeleton->numDecomposedPoints		= 0;
 	skeleton->numDecomposedNormals		= 0;
 
-	for (int i = 0; i < the3DMFFile->numMeshes; i++)
+	for (int i = 0; i < skeleton->associated3DMF->numMeshes; i++)
 	{
-		DecomposeATriMesh(skeleton, the3DMFFile->meshes[i]);
+		DecomposeATriMesh(skeleton, skeleton->associated3DMF->meshes[i]);
 	}
 }
 
@@ -203,8 +217,18 @@ void UpdateSkinnedGeometry(ObjNode *theNode)
 			/* RECURSIVELY UPDATE GEOMETRY STARTING FROM BASE JOINT */
 
 	GAME_ASSERT_MESSAGE(skeletonDef->Bones[0].parentBone == NO_PREVIOUS_JOINT, "joint 0 isnt base - fix code Brian!");
+	gNumJointWorldMatrices = 0;
 	UpdateSkinnedGeometry_Recurse(theNode, 0);											// start @ base
 
+			/* WORLD MATRICES OF ALL JOINTS ARE NOW CURRENT FOR THIS POSE */
+			//
+			// Only stamp the cache if the recursion reached every bone,
+			// otherwise FindJointFullMatrix will rebuild it on demand.
+			//
+
+	if (gNumJointWorldMatrices == skeletonDef->NumBones)
+		theNode->Skeleton->jointWorldStamp = theNode->Skeleton->poseStamp;
+
 			/* UPDATE ALL TRIMESH BBOXES */
 			
 	for (int i = 0; i < theNode->NumMeshes; i++)
@@ -271,6 +295,9 @@ TQ3TriMeshData		**localTriMeshPtrs = skelNode->MeshList;
 	matPtr[6] = y;
 	matPtr[10]= z;
 
+	currentSkelObjData->jointWorldMatrix[joint] = gMatrix;						// keep joint's world matrix for FindJointFullMatrix
+	gNumJointWorldMatrices++;
+
 
 			/* DO INV-TRANSP FOR VECTOR MULTIPLIES */
 			//
@@ -485,5 +512,54 @@ long	i,b,j;
 			}
 		}
 	}
+
+			/* BUILD REDUCED-DETAIL LEVELS */
+
+	BuildSkeletonLODs(skeleton);
+}
+
+
+/******************* BUILD SKELETON LODS *********************/
+//
+// Simplifies the reference model's trimeshes. Every vertex is tagged with the bone
+// it's attached to so that the simplifier never merges vertices across bones --
+// otherwise a joint would drag part of a neighboring limb along with it.
+//
+
+static void BuildSkeletonLODs(SkeletonDefType *skeleton)
+{
+int		*vertexGroups[MAX_DECOMPOSED_TRIMESHES];
+int		numMeshes = skeleton->numDecomposedTriMeshes;
+
+	skeleton->lodSet = nil;
+
+	for (int m = 0; m < numMeshes; m++)
+	{
+		int numPoints = skeleton->decomposedTriMeshPtrs[m]->numPoints;
+		vertexGroups[m] = (int*) AllocPtr(sizeof(int) * (numPoints + 1));
+		GAME_ASSERT(vertexGroups[m]);
+		for (int p = 0; p < numPoints; p++)
+			vertexGroups[m][p] = -1;
+	}
+
+	for (int b = 0; b < skeleton->NumBones; b++)
+	{
+		const BoneDefinitionType* bone = &skeleton->Bones[b];
+
+		for (int p = 0; p < bone->numPointsAttachedToBone; p++)
+		{
+			const DecomposedPointType* dp = &skeleton->decomposedPointList[bone->pointList[p]];
+
+			for (int r = 0; r < dp->numRefs; r++)
+				vertexGroups[dp->whichTriMesh[r]][dp->whichPoint[r]] = b;
+		}
+	}
+
+	float radius = QD3D_CalcObjectRadius(numMeshes, skeleton->decomposedTriMeshPtrs);
+
+	skeleton->lodSet = MeshLOD_Build(numMeshes, skeleton->decomposedTriMeshPtrs, vertexGroups, radius);
+
+	for (int m = 0; m < numMeshes; m++)
+		DisposePtr((Ptr) vertexGroups[m]);
 }
 
@@ -16,6 +16,7 @@
 /*    PROTOTYPES            */
 /****************************/
 
+static void CalcJointWorldMatrices(ObjNode *theNode);
 
 
 /****************************/
@@ -42,44 +43,39 @@
 
 void UpdateJointTransforms(SkeletonObjDataType *skeleton, int jointNum)
 {
-TQ3Matrix4x4			matrix1;
-static TQ3Matrix4x4		matrix2 = {{ {0,0,0,0}, {0,0,0,0}, {0,0,0,0}, {0,0,0,1} }};
 TQ3Matrix4x4			*destMatPtr;
 JointKeyframeType		*kfPtr;
+int						i;
 
 	destMatPtr = &skeleton->jointTransformMatrix[jointNum];					// get ptr to joint's xform matrix
+	skeleton->poseStamp++;													// cached joint world matrices are now stale
 
 	kfPtr = &skeleton->JointCurrentPosition[jointNum];													// get ptr to keyframe
 
-	if ((kfPtr->scale.x != 1.0f) || (kfPtr->scale.y != 1.0f) || (kfPtr->scale.z != 1.0f))				// SEE IF CAN IGNORE SCALE
-	{
 						/* ROTATE IT */
-				
-		Q3Matrix4x4_SetRotate_XYZ(&matrix1, kfPtr->rotation.x, kfPtr->rotation.y, kfPtr->rotation.z);	// set matrix for x/y/z rot
-
-
-					/* SCALE & TRANSLATE */
-	
-		matrix2.value[0][0] = kfPtr->scale.x;									
-												matrix2.value[1][1] = kfPtr->scale.y;											
-																						matrix2.value[2][2] = kfPtr->scale.z;
-		matrix2.value[3][0] = kfPtr->coord.x;	matrix2.value[3][1] = kfPtr->coord.y;	matrix2.value[3][2] = kfPtr->coord.z;
-		
-		Q3Matrix4x4_Multiply(&matrix1,&matrix2,destMatPtr);		
-	}
-	else
+
+	SetQuickRotationMatrix_XYZ(destMatPtr, kfPtr->rotation.x, kfPtr->rotation.y, kfPtr->rotation.z);	// set matrix for x/y/z rot
+
+	if ((kfPtr->scale.x != 1.0f) || (kfPtr->scale.y != 1.0f) || (kfPtr->scale.z != 1.0f))				// SEE IF CAN IGNORE SCALE
 	{
-						/* ROTATE IT */
-				
-		Q3Matrix4x4_SetRotate_XYZ(destMatPtr, kfPtr->rotation.x, kfPtr->rotation.y, kfPtr->rotation.z);	// set matrix for x/y/z rot
-	
-						/* NOW TRANSLATE IT */
-	
-		destMatPtr->value[3][0] =  kfPtr->coord.x;
-		destMatPtr->value[3][1] =  kfPtr->coord.y;
-		destMatPtr->value[3][2] =  kfPtr->coord.z;
+					/* SCALE */
+					//
+					// Scale is applied after the rotation, so it just scales each column.
+					//
+
+		for (i = 0; i < 3; i++)
+		{
+			destMatPtr->value[i][0] *= kfPtr->scale.x;
+			destMatPtr->value[i][1] *= kfPtr->scale.y;
+			destMatPtr->value[i][2] *= kfPtr->scale.z;
+		}
 	}
-													
+
+					/* NOW TRANSLATE IT */
+
+	destMatPtr->value[3][0] =  kfPtr->coord.x;
+	destMatPtr->value[3][1] =  kfPtr->coord.y;
+	destMatPtr->value[3][2] =  kfPtr->coord.z;
 }
 
 
@@ -122,33 +118,68 @@ TQ3Matrix4x4	matrix;
 //
 // Returns an accumulated matrix for a joint's coordinates.
 //
+// The world matrices of all joints are cached on the skeleton whenever the pose is evaluated
+// (UpdateSkinnedGeometry fills them in as a side effect of skinning), so this is normally just a copy.
+// If the pose or base transform has changed since, the whole cache is rebuilt here first.
+//
 
 void FindJointFullMatrix(ObjNode *theNode, int jointNum, TQ3Matrix4x4 *outMatrix)
 {
+SkeletonObjDataType	*skeletonPtr;
+
+	skeletonPtr = theNode->Skeleton;									// point to skeleton
+
+	GAME_ASSERT(jointNum >= 0 && jointNum < skeletonPtr->skeletonDefinition->NumBones);	// check for illegal joints
+
+	if (skeletonPtr->jointWorldStamp != skeletonPtr->poseStamp)		// see if cache is stale
+		CalcJointWorldMatrices(theNode);
+
+	*outMatrix = skeletonPtr->jointWorldMatrix[jointNum];
+}
+
+
+/************* CALC JOINT WORLD MATRICES ****************/
+//
+// Accumulates the matrix down the chain for every joint and stores it in the skeleton's cache.
+//
+
+static void CalcJointWorldMatrices(ObjNode *theNode)
+{
 const SkeletonDefType *skeletonDefPtr;
 SkeletonObjDataType	*skeletonPtr;
 BoneDefinitionType	*bonePtr;
-
-			/* ACCUMULATE A MATRIX DOWN THE CHAIN */
-			
-	*outMatrix = theNode->Skeleton->jointTransformMatrix[jointNum];		// init matrix
+TQ3Matrix4x4		*worldMat;
+int					jointNum,parent;
 
 	skeletonPtr =  theNode->Skeleton;									// point to skeleton
 	skeletonDefPtr = skeletonPtr->skeletonDefinition;					// point to skeleton defintion
-
-	GAME_ASSERT(jointNum >= 0 && jointNum < skeletonDefPtr->NumBones);	// check for illegal joints
-
 	bonePtr = skeletonDefPtr->Bones;									// point to bones list
 
-	while(bonePtr[jointNum].parentBone != NO_PREVIOUS_JOINT)
+	for (jointNum = 0; jointNum < skeletonDefPtr->NumBones; jointNum++)
 	{
-		jointNum = bonePtr[jointNum].parentBone;
-		
-  		Q3Matrix4x4_Multiply(outMatrix,&skeletonPtr->jointTransformMatrix[jointNum],outMatrix);				
+		worldMat = &skeletonPtr->jointWorldMatrix[jointNum];
+		parent = bonePtr[jointNum].parentBone;
+
+		if (parent == NO_PREVIOUS_JOINT)								// base joint: just factor in the base matrix
+		{
+			MultiplyAffineMatrices(&skeletonPtr->jointTransformMatrix[jointNum],&theNode->BaseTransformMatrix,worldMat);
+		}
+		else
+		if (parent < jointNum)											// parent already done, so reuse its world matrix
+		{
+			MultiplyAffineMatrices(&skeletonPtr->jointTransformMatrix[jointNum],&skeletonPtr->jointWorldMatrix[parent],worldMat);
+		}
+		else															// out-of-order bone: accumulate a matrix down the chain
+		{
+			*worldMat = skeletonPtr->jointTransformMatrix[jointNum];
+			while(parent != NO_PREVIOUS_JOINT)
+			{
+				MultiplyAffineMatrices(worldMat,&skeletonPtr->jointTransformMatrix[parent],worldMat);
+				parent = bonePtr[parent].parentBone;
+			}
+			MultiplyAffineMatrices(worldMat,&theNode->BaseTransformMatrix,worldMat);
+		}
 	}
-	
-			/* ALSO FACTOR IN THE BASE MATRIX */
 
-	Q3Matrix4x4_Multiply(outMatrix,&theNode->BaseTransformMatrix,outMatrix);
+	skeletonPtr->jointWorldStamp = skeletonPtr->poseStamp;
 }
-
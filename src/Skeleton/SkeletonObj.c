@@ -127,6 +127,8 @@ TQ3BoundingBox *bbox;
 
 	newNode->Skeleton->skeletonDefinition = skeletonDef;						// point to source animation data
 	newNode->Skeleton->AnimSpeed = 1.0;
+	newNode->Skeleton->poseStamp = 1;											// joint world matrix cache starts out stale
+	newNode->Skeleton->jointWorldStamp = 0;
 
 
 			/* MAKE COPY OF TRIMESHES FOR LOCAL USE */
@@ -143,6 +145,8 @@ TQ3BoundingBox *bbox;
 		newNode->OwnsMeshMemory[i] = true;
 	}
 
+	newNode->RenderModifiers.lodSet = skeletonDef->lodSet;		// duplicates share the reference model's topology
+
 
 				/*  SET INITIAL DEFAULT POSITION */
 
@@ -298,6 +302,11 @@ short	i,j,numAnims,numJoints;
 		skeleton->decomposedNormalsList = nil;
 	}
 
+			/* DISPOSE OF LODS */
+
+	MeshLOD_Dispose(skeleton->lodSet);
+	skeleton->lodSet = nil;
+
 			/* DISPOSE OF 3DMF */
 
 	if (skeleton->associated3DMF)
@@ -581,26 +581,57 @@ long		fileSize;
 
 
 
+/****************** READ TERRAIN SECTION ******************/
+//
+// Reads size bytes at fileOffset in the open terrain file into dest.
+//
+
+static void ReadTerrainSection(short refNum, long fileOffset, Ptr dest, long size)
+{
+OSErr	iErr;
+
+	if (size <= 0)
+		return;
+
+	iErr = SetFPos(refNum, fsFromStart, fileOffset);
+	GAME_ASSERT(iErr == noErr);
+
+	iErr = FSRead(refNum, &size, dest);
+	GAME_ASSERT(iErr == noErr);
+}
+
+
 /****************** LOAD TERRAIN ******************/
 //
 //  Assumes old terrain has been purged!
 //
+//  The texture, heightmap & path layers scale with the area of the map, so they aren't loaded here:
+//  the file stays open and TerrainPaging.c reads them in bands around the player.
+//  Everything else (header, tile attributes, heightmap tiles, item list) is read into gTerrainPtr,
+//  laid out back to back, and the header's offsets to those sections are patched to match.
+//
 //  INPUT: 	fileName
 //
 
 void LoadTerrain(FSSpec *fsSpec)
 {
-UInt16		*shortPtr;
+SInt32		header[TERRAIN_HEADER_SIZE / sizeof(SInt32)];
 Ptr			miscPtr;
 int			offset;
 int			dummy1,dummy2;
+short		refNum;
+long		fileSize,count;
+OSErr		iErr;
 
 
-			/* LOAD THE TERRAIN FILE */
-			
-	gTerrainPtr = LoadAFile(fsSpec, nil);
-	if (gTerrainPtr == nil)
-		DoAlert("Error loading Terrain file!");
+			/* OPEN THE TERRAIN FILE */
+
+	iErr = FSpOpenDF(fsSpec, fsRdPerm, &refNum);
+	if (iErr != noErr)
+		DoFatalAlert("Error loading Terrain file!");
+
+	iErr = GetEOF(refNum, &fileSize);
+	GAME_ASSERT(iErr == noErr);
 
 
 	// ---- unpack header ----
@@ -616,81 +647,74 @@ int			dummy1,dummy2;
 	// 32   long    offset to texture attributes
 	// 36   long    [unused] offset to tile anim data
 	//              0  4  8 12 16 20 24 28 32 36
-	UnpackStructs(">l  l  l  l  l  l  l hh  l  l", 40, 1, gTerrainPtr);
+	count = TERRAIN_HEADER_SIZE;
+	iErr = FSRead(refNum, &count, (Ptr) header);
+	GAME_ASSERT(iErr == noErr);
+	UnpackStructs(">l  l  l  l  l  l  l hh  l  l", TERRAIN_HEADER_SIZE, 1, header);
 
+	SInt32 textureLayerOffset	= header[0];
+	SInt32 heightmapLayerOffset	= header[1];
+	SInt32 pathLayerOffset		= header[2];
+	SInt32 itemListOffset		= header[3];
+	SInt32 heightmapTilesOffset	= header[5];
+	SInt32 attribsOffset		= header[8];
+	SInt32 nextChunkOffset		= header[9];
 
-			/*********************/
-			/* INIT LAYER ARRAYS */
-			/*********************/
 
-	gTerrainTileWidth = *((short *)(gTerrainPtr+28));							// get width of terrain (in tiles)
-	gTerrainTileDepth = *((short *)(gTerrainPtr+30));							// get height of terrain (in tiles)
+			/* SIZE UP THE SECTIONS WE KEEP IN MEMORY */
 
-	gTerrainUnitWidth = gTerrainTileWidth*TERRAIN_POLYGON_SIZE;					// calc world unit dimensions of terrain
-	gTerrainUnitDepth = gTerrainTileDepth*TERRAIN_POLYGON_SIZE;
+	long attribsSize = nextChunkOffset - attribsOffset;
+	GAME_ASSERT(attribsSize >= 0);
 
-	gNumSuperTilesDeep = gTerrainTileDepth/SUPERTILE_SIZE;						// calc size in supertiles
-	gNumSuperTilesWide = gTerrainTileWidth/SUPERTILE_SIZE;
+	long heightmapTilesSize = MAX_HEIGHTMAP_TILES * TERRAIN_HMTILE_SIZE * TERRAIN_HMTILE_SIZE;
+	long heightmapTilesInFile = 0;
+	if (heightmapTilesOffset > 0)
+	{
+		heightmapTilesInFile = fileSize - heightmapTilesOffset;
+		if (heightmapTilesInFile > heightmapTilesSize)
+			heightmapTilesInFile = heightmapTilesSize;
+	}
 
+	Byte numItemsBE[4];
+	ReadTerrainSection(refNum, itemListOffset, (Ptr) numItemsBE, 4);
+	long itemListSize = 4 + UnpackI32BE(numItemsBE) * (long) sizeof(TerrainItemEntryType);
 
-			/* INIT TEXTURE_LAYER */
 
-	gTerrainTextureLayer = (UInt16 **)AllocPtr(sizeof(short *)*				// alloc mem for 1st dimension of array (map is 1/2 dimensions of wid/dep values!)
-							gTerrainTileDepth);
+			/* READ THEM INTO ONE BLOCK */
 
-	offset = *((SInt32 *)(gTerrainPtr+0));										// get offset to TEXTURE_LAYER
-	shortPtr = (UInt16 *)(gTerrainPtr + offset);								// calc ptr to TEXTURE_LAYER
-#if !(__BIG_ENDIAN__)
-	ByteswapInts(sizeof(UInt16), gTerrainTileDepth * gTerrainTileWidth, shortPtr);
-#endif
+	long attribsAt			= TERRAIN_HEADER_SIZE;
+	long heightmapTilesAt	= attribsAt + attribsSize;
+	long itemListAt			= heightmapTilesAt + heightmapTilesSize;
 
-	for (int row = 0; row < gTerrainTileDepth; row++)
-	{
-		gTerrainTextureLayer[row] = shortPtr;									// set [row] to point to layer's row(n)
-		shortPtr += gTerrainTileWidth;
-	}
+	gTerrainPtr = NewPtrClear(itemListAt + itemListSize);
+	GAME_ASSERT(gTerrainPtr);
 
+	SDL_memcpy(gTerrainPtr, header, TERRAIN_HEADER_SIZE);
+	ReadTerrainSection(refNum, attribsOffset, gTerrainPtr + attribsAt, attribsSize);
+	ReadTerrainSection(refNum, heightmapTilesOffset, gTerrainPtr + heightmapTilesAt, heightmapTilesInFile);
+	ReadTerrainSection(refNum, itemListOffset, gTerrainPtr + itemListAt, itemListSize);
 
-			/* INIT HEIGHTMAP_LAYER */
+	*((SInt32 *)(gTerrainPtr+12)) = itemListAt;								// offsets are now into gTerrainPtr
+	*((SInt32 *)(gTerrainPtr+20)) = heightmapTilesOffset > 0 ? heightmapTilesAt : 0;
+	*((SInt32 *)(gTerrainPtr+32)) = attribsAt;
+	*((SInt32 *)(gTerrainPtr+36)) = attribsAt + attribsSize;
 
-	gTerrainHeightMapLayer = (UInt16 **)AllocPtr(sizeof(short *)*				// alloc mem for 1st dimension of array (map is 1/2 dimensions of wid/dep values!)
-							gTerrainTileDepth);
-							
-	offset = *((SInt32 *)(gTerrainPtr+4));										// get offset to HEIGHTMAP_LAYER
-	if (offset > 0)
-	{
-		shortPtr = (UInt16 *)(gTerrainPtr + offset);							// calc ptr to HEIGHTMAP_LAYER
-#if !(__BIG_ENDIAN__)
-		ByteswapInts(sizeof(UInt16), gTerrainTileDepth * gTerrainTileWidth, shortPtr);
-#endif
 
-		for (int row = 0; row < gTerrainTileDepth; row++)
-		{
-			gTerrainHeightMapLayer[row] = shortPtr;								// set [row] to point to layer's row(n)
-			shortPtr += gTerrainTileWidth;
-		}
-	}
+			/*********************/
+			/* INIT LAYER ARRAYS */
+			/*********************/
 
+	gTerrainTileWidth = *((short *)(gTerrainPtr+28));							// get width of terrain (in tiles)
+	gTerrainTileDepth = *((short *)(gTerrainPtr+30));							// get height of terrain (in tiles)
+	GAME_ASSERT(gTerrainTileWidth > 0 && gTerrainTileDepth > 0);
 
-			/* INIT PATH_LAYER */
+	gTerrainUnitWidth = gTerrainTileWidth*TERRAIN_POLYGON_SIZE;					// calc world unit dimensions of terrain
+	gTerrainUnitDepth = gTerrainTileDepth*TERRAIN_POLYGON_SIZE;
 
-	gTerrainPathLayer = (UInt16 **)AllocPtr(sizeof(short *)*					// alloc mem for 1st dimension of array (map is 1/2 dimensions of wid/dep values!)
-							gTerrainTileDepth);
-							
-	offset = *((SInt32 *)(gTerrainPtr+8));										// get offset to PATH_LAYER
-	if (offset > 0)
-	{
-		shortPtr = (UInt16 *)(gTerrainPtr + offset);							// calc ptr to PATH_LAYER
-#if !(__BIG_ENDIAN__)
-		ByteswapInts(sizeof(UInt16), gTerrainTileDepth * gTerrainTileWidth, shortPtr);
-#endif
+	gNumSuperTilesDeep = gTerrainTileDepth/SUPERTILE_SIZE;						// calc size in supertiles
+	gNumSuperTilesWide = gTerrainTileWidth/SUPERTILE_SIZE;
 
-		for (int row = 0; row < gTerrainTileDepth; row++)
-		{
-			gTerrainPathLayer[row] = shortPtr;									// set [row] to point to layer's row(n)
-			shortPtr += gTerrainTileWidth;
-		}
-	}
+	InitTerrainPaging(refNum, textureLayerOffset, heightmapLayerOffset, pathLayerOffset);	// all rows start out blank; file is closed by DisposeTerrain
 
 
 			/* GET TEXTURE_ATTRIBUTES */
@@ -734,6 +758,8 @@ int			dummy1,dummy2;
 	long y = gMyStartZ - (SUPERTILE_ACTIVE_RANGE*SUPERTILE_SIZE*TERRAIN_POLYGON_SIZE);
 	GetSuperTileInfo(x, y, &gCurrentSuperTileCol, &gCurrentSuperTileRow, &dummy1, &dummy2);
 
+	PageTerrainAroundScrollWindow();											// player & items get set up before the terrain is primed
+
 
 
 			/* INIT THE SCROLL BUFFER */
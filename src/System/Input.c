@@ -26,6 +26,13 @@ bool				gAnyNewKeysPressed = false;
 char				gTextInput[64];
 
 static KeyState		gNeedStates[NUM_CONTROL_NEEDS];
+static bool			gLateNeedStates[NUM_CONTROL_NEEDS];
+
+static Uint64		gInputSampleTime = 0;				// SDL_GetTicksNS when the input for this frame was last read
+static Uint64		gNewestInputEventTime = 0;			// timestamp of the newest key/button/axis event read so far
+static Uint64		gLastShownInputEventTime = 0;
+static Uint64		gLateInputSampleTime = 0;			// same as the two above, as of the last LateLatchInput,
+static Uint64		gLateNewestInputEventTime = 0;		// ...only counted once UseLateInputSample says the frame used them
 
 
 /****************************/
@@ -124,6 +131,59 @@ static inline void UpdateKeyState(KeyState* state, bool downNow)
 	}
 }
 
+static bool IsBindingDown(const KeyBinding* kb, const bool* keystate, int numkeys, uint32_t mouseButtons, int mouseWheelDelta)
+{
+	bool downNow = false;
+
+	if (keystate)				// nil while typing in a high score name
+	{
+		for (int j = 0; j < KEYBINDING_MAX_KEYS; j++)
+			if (kb->key[j] && kb->key[j] < numkeys)
+				downNow |= keystate[kb->key[j]] && gRawKeyboardState[kb->key[j]] != KEYSTATE_IGNOREHELD;
+	}
+
+	if (kb->mouseButton)
+		downNow |= 0 != (mouseButtons & SDL_BUTTON_MASK(kb->mouseButton));
+
+	if ((kb->mouseWheelDelta > 0 && mouseWheelDelta > 0) || (kb->mouseWheelDelta < 0 && mouseWheelDelta < 0))
+		downNow |= true;
+
+	if (gSDLGamepad)
+	{
+		for (int j = 0; j < KEYBINDING_MAX_GAMEPAD_BUTTONS; j++)
+			if (kb->gamepadButton[j] != SDL_GAMEPAD_BUTTON_INVALID)
+				downNow |= 0 != SDL_GetGamepadButton(gSDLGamepad, kb->gamepadButton[j]);
+
+		if (kb->gamepadAxis != SDL_GAMEPAD_AXIS_INVALID)
+		{
+			int16_t rawValue = SDL_GetGamepadAxis(gSDLGamepad, kb->gamepadAxis);
+			downNow |= (kb->gamepadAxisSign > 0 && rawValue > (int16_t)(JOYSTICK_FAKEDIGITAL_DEAD_ZONE * 32767.0f))
+					|| (kb->gamepadAxisSign < 0 && rawValue < (int16_t)(JOYSTICK_FAKEDIGITAL_DEAD_ZONE * -32768.0f));
+		}
+	}
+
+	return downNow;
+}
+
+static bool IsInputEvent(Uint32 eventType)
+{
+	switch (eventType)
+	{
+		case SDL_EVENT_KEY_DOWN:
+		case SDL_EVENT_KEY_UP:
+		case SDL_EVENT_MOUSE_BUTTON_DOWN:
+		case SDL_EVENT_MOUSE_BUTTON_UP:
+		case SDL_EVENT_MOUSE_WHEEL:
+		case SDL_EVENT_GAMEPAD_AXIS_MOTION:
+		case SDL_EVENT_GAMEPAD_BUTTON_DOWN:
+		case SDL_EVENT_GAMEPAD_BUTTON_UP:
+			return true;
+
+		default:
+			return false;
+	}
+}
+
 /************************* INIT INPUT *********************************/
 
 void InitInput(void)
@@ -204,8 +264,13 @@ void UpdateInput(void)
 				mouseWheelDelta += event.wheel.x;
 				break;
 		}
+
+		if (IsInputEvent(event.type) && event.common.timestamp > gNewestInputEventTime)
+			gNewestInputEventTime = event.common.timestamp;
 	}
 
+	gInputSampleTime = SDL_GetTicksNS();
+
 	int numkeys = 0;
 	const bool* keystate = SDL_GetKeyboardState(&numkeys);
 	uint32_t mouseButtons = SDL_GetMouseState(NULL, NULL);
@@ -252,38 +317,109 @@ void UpdateInput(void)
 
 	for (int i = 0; i < NUM_CONTROL_NEEDS; i++)
 	{
-		const KeyBinding* kb = &gGamePrefs.keys[i];
+		bool downNow = IsBindingDown(&gGamePrefs.keys[i],
+									 isTextInputActive ? NULL : keystate,		// Skip keyboard during high score name input
+									 numkeys, mouseButtons, mouseWheelDelta);
 
-		bool downNow = false;
+		UpdateKeyState(&gNeedStates[i], downNow);
+		gLateNeedStates[i] = 0 != (gNeedStates[i] & KEYSTATE_ACTIVE_BIT);
+	}
+}
 
-		if (!isTextInputActive)		// Skip keyboard during high score name input
-		{
-			for (int j = 0; j < KEYBINDING_MAX_KEYS; j++)
-				if (kb->key[j] && kb->key[j] < numkeys)
-					downNow |= gRawKeyboardState[kb->key[j]] & KEYSTATE_ACTIVE_BIT;
-		}
 
-		if (kb->mouseButton)
-			downNow |= 0 != (mouseButtons & SDL_BUTTON_MASK(kb->mouseButton));
+/******************** LATE-LATCH INPUT *************************/
+//
+// Low-latency mode: re-reads which needs are held, just before the frame is
+// submitted. SDL_PumpEvents refreshes the keyboard, mouse & gamepad state but
+// leaves the events queued, so UpdateInput still sees every press & release
+// next frame and the edge states (GetNewNeedState) are not disturbed.
+// Read the result with GetLateNeedState.
+//
+// The latency stats keep counting from UpdateInput's sample unless the caller
+// changes the frame with what it read and says so with UseLateInputSample.
+//
+
+void LateLatchInput(void)
+{
+static const Uint32 kEventRanges[][2] =
+{
+	{ SDL_EVENT_KEY_DOWN,				SDL_EVENT_KEY_UP				},
+	{ SDL_EVENT_MOUSE_BUTTON_DOWN,		SDL_EVENT_MOUSE_WHEEL			},
+	{ SDL_EVENT_GAMEPAD_AXIS_MOTION,	SDL_EVENT_GAMEPAD_BUTTON_UP		},
+};
+SDL_Event	events[32];
+
+	SDL_PumpEvents();
+
+	int numkeys = 0;
+	const bool* keystate = SDL_GetKeyboardState(&numkeys);
+	uint32_t mouseButtons = SDL_GetMouseState(NULL, NULL);
+	bool isTextInputActive = SDL_TextInputActive(gSDLWindow);
+
+	for (int i = 0; i < NUM_CONTROL_NEEDS; i++)
+	{
+		gLateNeedStates[i] = gNeedStates[i] != KEYSTATE_IGNOREHELD
+							 && IsBindingDown(&gGamePrefs.keys[i], isTextInputActive ? NULL : keystate, numkeys, mouseButtons, 0);
+	}
+
+	gLateInputSampleTime = SDL_GetTicksNS();
+	gLateNewestInputEventTime = gNewestInputEventTime;
 
-		if ((kb->mouseWheelDelta > 0 && mouseWheelDelta > 0) || (kb->mouseWheelDelta < 0 && mouseWheelDelta < 0))
-			downNow |= true;
+			/* NOTE THE NEWEST EVENT WE COULD REACT TO NOW */
+			//
+			// Only the first few queued events of each kind are peeked at,
+			// which is plenty at one latch per frame.
+			//
+
+	for (size_t r = 0; r < SDL_arraysize(kEventRanges); r++)
+	{
+		int numEvents = SDL_PeepEvents(events, (int) SDL_arraysize(events), SDL_PEEKEVENT, kEventRanges[r][0], kEventRanges[r][1]);
 
-		if (gSDLGamepad)
+		for (int i = 0; i < numEvents; i++)
 		{
-			for (int j = 0; j < KEYBINDING_MAX_GAMEPAD_BUTTONS; j++)
-				if (kb->gamepadButton[j] != SDL_GAMEPAD_BUTTON_INVALID)
-					downNow |= 0 != SDL_GetGamepadButton(gSDLGamepad, kb->gamepadButton[j]);
-
-			if (kb->gamepadAxis != SDL_GAMEPAD_AXIS_INVALID)
-			{
-				int16_t rawValue = SDL_GetGamepadAxis(gSDLGamepad, kb->gamepadAxis);
-				downNow |= (kb->gamepadAxisSign > 0 && rawValue > (int16_t)(JOYSTICK_FAKEDIGITAL_DEAD_ZONE * 32767.0f))
-						|| (kb->gamepadAxisSign < 0 && rawValue < (int16_t)(JOYSTICK_FAKEDIGITAL_DEAD_ZONE * -32768.0f));
-			}
+			if (IsInputEvent(events[i].type) && events[i].common.timestamp > gLateNewestInputEventTime)
+				gLateNewestInputEventTime = events[i].common.timestamp;
 		}
+	}
+}
 
-		UpdateKeyState(&gNeedStates[i], downNow);
+
+/******************** USE LATE INPUT SAMPLE *************************/
+//
+// Call after LateLatchInput if the late needs actually changed the frame about to be
+// submitted, so MeasureInputLatency counts from the late sample.
+//
+
+void UseLateInputSample(void)
+{
+	gInputSampleTime = gLateInputSampleTime;
+
+	if (gLateNewestInputEventTime > gNewestInputEventTime)
+		gNewestInputEventTime = gLateNewestInputEventTime;
+}
+
+
+/******************** MEASURE INPUT LATENCY *************************/
+//
+// Call right after the buffer swap. Fills in the latency fields of gRenderStats
+// and feeds the metrics histograms.
+//
+
+void MeasureInputLatency(void)
+{
+	Uint64 now = SDL_GetTicksNS();
+
+	if (gInputSampleTime != 0 && now >= gInputSampleTime)
+	{
+		gRenderStats.inputLatencyMilliseconds = (now - gInputSampleTime) / 1e6f;
+		Metrics_ObserveInputLatency(gRenderStats.inputLatencyMilliseconds, false);
+	}
+
+	if (gNewestInputEventTime > gLastShownInputEventTime && now >= gNewestInputEventTime)
+	{
+		gRenderStats.eventLatencyMilliseconds = (now - gNewestInputEventTime) / 1e6f;
+		Metrics_ObserveInputLatency(gRenderStats.eventLatencyMilliseconds, true);
+		gLastShownInputEventTime = gNewestInputEventTime;
 	}
 }
 
@@ -327,6 +463,12 @@ bool AreAnyNewKeysPressed(void)
 	return gAnyNewKeysPressed;
 }
 
+bool GetLateNeedState(int needID)
+{
+	GAME_ASSERT(needID < NUM_CONTROL_NEEDS);
+	return gLateNeedStates[needID];
+}
+
 bool GetNeedState(int needID)
 {
 	GAME_ASSERT(needID < NUM_CONTROL_NEEDS);
@@ -20,8 +20,6 @@
 /*    PROTOTYPES            */
 /****************************/
 
-static void InitLevel(void);
-static void CleanupLevel(void);
 static void PlayLevel(void);
 #ifdef __EMSCRIPTEN__
 void EmscriptenGameFrameImpl(void* arg);
@@ -47,6 +45,7 @@ Boolean		gPlayerGotKilledFlag,gWonGameFlag;
 Boolean		gSkipToLevel = false;
 int			gStartLevelNum = LEVEL_NUM_0;
 char		gCustomTerrainFile[512] = {0};
+char		gSnapshotFile[512] = {0};
 Boolean		gFenceCollisionsDisabled = false;
 
 #ifdef __EMSCRIPTEN__
@@ -82,6 +81,10 @@ void InitDefaultPrefs(void)
 	gGamePrefs.ambientSounds = true;
 	gGamePrefs.nanosaurTeethFix = true;
 	gGamePrefs.whiteSky = true;
+	gGamePrefs.meshLOD = true;
+	gGamePrefs.adaptiveDrawDistance = true;
+	gGamePrefs.lowLatencyInput = false;
+	gGamePrefs.bakedLighting = false;
 
 	SDL_memcpy(gGamePrefs.keys, kDefaultKeyBindings, sizeof(gGamePrefs.keys));
 	_Static_assert(sizeof(kDefaultKeyBindings) == sizeof(gGamePrefs.keys), "size mismatch: default keybindings / prefs keybinings");
@@ -127,16 +130,19 @@ OSErr		iErr;
 	Init3DMFManager();
 	InitObjectManager();
 	InitSpriteManager();
+	InitMetrics();
 }
 
 
 /***************** INIT LEVEL ************************/
 
-static void InitLevel(void)
+void InitLevel(void)
 {
 QD3DSetupInputType		viewDef;
 TQ3ColorRGB		c1 = { 1.0, 1, 1 };
 TQ3ColorRGB		c2 = { 1, .9, .6 };
+FSSpec			spec;
+Uint64			loadStartTime = SDL_GetTicksNS();
 
 	PlaySong(0,true);
 
@@ -217,21 +223,33 @@ TQ3ColorRGB		c2 = { 1, .9, .6 };
 
 	InitTerrainManager();
 	PrimeInitialTerrain();
+	InitDrawDistance(gGameViewInfoPtr);
 	InitTimePortals();
 	
 	StartAmbientEffect();
+
+			/* SEE IF WARM-STARTING FROM A SNAPSHOT */
+
+	if (gSnapshotFile[0] != '\0')
+	{
+		GetGameSnapshotSpec(&spec);
+		LoadGameSnapshot(&spec);
+	}
+
+	Metrics_SetLevelLoadTime((SDL_GetTicksNS() - loadStartTime) / 1e6);
 }
 
 
 /**************** CLEANUP LEVEL **********************/
 
-static void CleanupLevel(void)
+void CleanupLevel(void)
 {
 	StopAllEffectChannels();
 	Render_FreezeFrameFadeOut();
 	DeleteAllObjects();
 	FreeAllSkeletonFiles(-1);
 	DisposeTerrain();
+	ResetDrawDistance();
 	DisposeSpriteGroup(0);
 	QD3D_DisposeShards();
 	DeleteAll3DMFGroups();
@@ -251,6 +269,7 @@ FSSpec	spec;
 			
 	InitLevel();
 
+	gGameViewInfoPtr->lateLatchRoutine = LateLatchCamera;		// only acts in low-latency mode
 	gGameOverFlag = false;
 
 	MakeFadeEvent(true);
@@ -287,6 +306,7 @@ FSSpec	spec;
 		UpdateInfobar();
 		QD3D_DrawScene(gGameViewInfoPtr,DrawTerrain);
 		QD3D_CalcFramesPerSecond();
+		UpdateDrawDistance(gGameViewInfoPtr);
 
 				
 			/* SEE IF PAUSE GAME */
@@ -319,6 +339,19 @@ FSSpec	spec;
 				gFuel = MAX_FUEL_CAPACITY;
 				gInfobarUpdateBits |= UPDATE_FUEL;
 			}
+			else
+			if (GetNewSDLKeyState(SDL_SCANCODE_F6))				// save snapshot
+			{
+				GetGameSnapshotSpec(&spec);
+				SaveGameSnapshot(&spec);
+			}
+			else
+			if (GetNewSDLKeyState(SDL_SCANCODE_F7))				// restore snapshot
+			{
+				GetGameSnapshotSpec(&spec);
+				if (LoadGameSnapshot(&spec))
+					QD3D_CalcFramesPerSecond();					// don't count the load as frame time
+			}
 				
 		}
 
@@ -0,0 +1,530 @@
+/****************************/
+/*   	METRICS.C		    */
+/****************************/
+//
+// Live counters, gauges & histograms (frame times, render stats, object & sound usage,
+// load times) for watching a running game from the outside, e.g. on kiosk machines.
+//
+// Start the game with --metrics-socket <path>: the game listens on that UNIX-domain socket
+// and, once a second, writes a snapshot to every connected reader in the Prometheus
+// text format, followed by a "# EOF" line.  tools/metrics_reader.py prints them.
+//
+// Without --metrics-socket, nothing is collected.  With it but no reader connected,
+// each frame costs a histogram bucket increment and, every quarter second, one
+// non-blocking accept().  The engine gauges are only sampled when a snapshot goes out.
+//
+// Not available on Windows & WebAssembly builds.
+//
+
+
+/****************************/
+/*    EXTERNALS             */
+/****************************/
+
+#include "game.h"
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+	#define METRICS_HAVE_SOCKETS	1
+	#include <errno.h>
+	#include <fcntl.h>
+	#include <string.h>
+	#include <sys/socket.h>
+	#include <sys/stat.h>
+	#include <sys/un.h>
+	#include <unistd.h>
+#else
+	#define METRICS_HAVE_SOCKETS	0
+#endif
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+static void SampleEngineGauges(void);
+static int FormatMetrics(char *buffer, int bufferSize);
+static void AcceptMetricsReaders(void);
+static void SendToMetricsReaders(const char *text, int length);
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	MAX_METRICS_READERS		4
+
+#define	METRICS_ACCEPT_INTERVAL	250						// ms between checks for new readers
+#define	METRICS_EXPORT_INTERVAL	1000					// ms between snapshots sent to readers
+
+#define	METRICS_TEXT_SIZE		(16*1024)
+
+static const double kHistogramBounds[] = { 4, 8, 12, 16.7, 20, 25, 33.3, 50, 100, 250 };	// ms; +Inf bucket is implied
+
+#define	NUM_HISTOGRAM_BUCKETS	((int)(sizeof(kHistogramBounds) / sizeof(kHistogramBounds[0])) + 1)
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+typedef struct
+{
+	const char		*name;
+	const char		*help;
+	MetricKind		kind;
+	double			value;								// counter total or gauge value
+	double			sum;								// histogram: sum of observations
+	uint64_t		count;								// histogram: # of observations
+	uint64_t		buckets[NUM_HISTOGRAM_BUCKETS];		// histogram: non-cumulative counts
+}MetricType;
+
+char		gMetricsSocketPath[METRICS_SOCKET_PATH_MAX] = "";
+Boolean		gMetricsEnabled = false;
+
+static MetricType	gMetrics[MAX_METRICS];
+static int			gNumMetrics = 0;
+
+static int			gListenSocket = -1;
+static int			gReaderSockets[MAX_METRICS_READERS];
+static int			gNumReaders = 0;
+
+static uint64_t		gLastAcceptTime = 0;
+static uint64_t		gLastExportTime = 0;
+
+static char			gMetricsText[METRICS_TEXT_SIZE];
+
+		/* BUILT-IN METRICS */
+
+static int	gMetricFrames, gMetricFrameTime, gMetricFPS, gMetricGPUTime;
+static int	gMetricTriangles, gMetricTrianglesSavedByLOD, gMetricMeshQueue, gMetricStateChanges;
+static int	gMetricObjNodes, gMetricObjNodePool;
+static int	gMetricHeapAllocs, gMetricHeapKB;
+static int	gMetricSoundChannelsBusy, gMetricSoundChannels;
+static int	gMetricLevelLoadTime, gMetricLevelLoads;
+static int	gMetricInputLatency, gMetricEventLatency;
+static int	gMetricTerrainPrimeTime, gMetricTerrainJumpTime;
+static int	gMetricOverdrawAverage, gMetricOverdrawMax;
+static int	gMetricStreamedKB;
+static int	gMetricPipelineStates, gMetricPipelineSwitches, gMetricSubmitTime;
+static int	gMetricDynamicLights, gMetricDynamicLightBinds, gMetricDynamicLightTime;
+#if RENDER_VULKAN
+static int	gMetricVulkanSubmitTime;
+#endif
+
+
+/******************** INIT METRICS *************************/
+//
+// Call once at boot, after the command line has been parsed.
+//
+
+void InitMetrics(void)
+{
+	if (gMetricsSocketPath[0] == '\0')
+		return;
+
+#if !METRICS_HAVE_SOCKETS
+	SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Metrics export isn't supported on this platform");
+	return;
+#else
+	struct sockaddr_un	addr;
+	struct stat			st;
+
+	gListenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (gListenSocket < 0)
+	{
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Metrics: socket() failed: %s", strerror(errno));
+		return;
+	}
+
+	SDL_zero(addr);
+	addr.sun_family = AF_UNIX;
+	SDL_strlcpy(addr.sun_path, gMetricsSocketPath, sizeof(addr.sun_path));
+
+	if (lstat(gMetricsSocketPath, &st) == 0 && S_ISSOCK(st.st_mode))
+		unlink(gMetricsSocketPath);							// remove stale socket from an earlier run
+
+	if (bind(gListenSocket, (struct sockaddr *) &addr, sizeof(addr)) != 0
+		|| listen(gListenSocket, MAX_METRICS_READERS) != 0)
+	{
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Metrics: can't listen on %s: %s", gMetricsSocketPath, strerror(errno));
+		close(gListenSocket);
+		gListenSocket = -1;
+		return;
+	}
+
+	fcntl(gListenSocket, F_SETFL, fcntl(gListenSocket, F_GETFL) | O_NONBLOCK);
+
+#ifdef SO_NOSIGPIPE
+	int one = 1;
+	setsockopt(gListenSocket, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+	SDL_Log("Metrics: serving on %s", gMetricsSocketPath);
+	gMetricsEnabled = true;
+#endif
+
+			/* REGISTER BUILT-IN METRICS */
+
+	gMetricFrames				= Metrics_Register("nanosaur_frames_total",				METRIC_COUNTER,		"Frames drawn");
+	gMetricFrameTime			= Metrics_Register("nanosaur_frame_ms",					METRIC_HISTOGRAM,	"Wall-clock time between frames");
+	gMetricFPS					= Metrics_Register("nanosaur_fps",						METRIC_GAUGE,		"Frames per second over the last frame");
+	gMetricGPUTime				= Metrics_Register("nanosaur_gpu_frame_ms",				METRIC_GAUGE,		"GPU time of a recent frame (0 if unknown)");
+	gMetricTriangles			= Metrics_Register("nanosaur_triangles_drawn",			METRIC_GAUGE,		"Triangles drawn last frame");
+	gMetricTrianglesSavedByLOD	= Metrics_Register("nanosaur_triangles_saved_by_lod",	METRIC_GAUGE,		"Triangles skipped thanks to mesh LODs last frame");
+	gMetricMeshQueue			= Metrics_Register("nanosaur_mesh_queue_size",			METRIC_GAUGE,		"Meshes submitted last frame");
+	gMetricStateChanges			= Metrics_Register("nanosaur_batched_state_changes",	METRIC_GAUGE,		"GL state changes last frame");
+	gMetricObjNodes				= Metrics_Register("nanosaur_objnodes",					METRIC_GAUGE,		"ObjNodes in the object list, including heap overflow nodes");
+	gMetricObjNodePool			= Metrics_Register("nanosaur_objnode_pool_used",		METRIC_GAUGE,		"ObjNode pool slots in use");
+	gMetricHeapAllocs			= Metrics_Register("nanosaur_heap_allocs",				METRIC_GAUGE,		"Live NewPtr/NewHandle blocks");
+	gMetricHeapKB				= Metrics_Register("nanosaur_heap_kb",					METRIC_GAUGE,		"Size of live NewPtr/NewHandle blocks");
+	gMetricSoundChannelsBusy	= Metrics_Register("nanosaur_sound_channels_busy",		METRIC_GAUGE,		"Sound effect channels playing");
+	gMetricSoundChannels		= Metrics_Register("nanosaur_sound_channels",			METRIC_GAUGE,		"Sound effect channels available");
+	gMetricLevelLoadTime		= Metrics_Register("nanosaur_level_load_ms",			METRIC_GAUGE,		"Time taken by the last level load");
+	gMetricLevelLoads			= Metrics_Register("nanosaur_level_loads_total",		METRIC_COUNTER,		"Levels loaded");
+	gMetricInputLatency			= Metrics_Register("nanosaur_input_latency_ms",			METRIC_HISTOGRAM,	"Time from reading the input a frame was built from to its buffer swap");
+	gMetricEventLatency			= Metrics_Register("nanosaur_input_event_latency_ms",	METRIC_HISTOGRAM,	"Time from a key/button/axis event to the first buffer swap reflecting it");
+	gMetricTerrainPrimeTime		= Metrics_Register("nanosaur_terrain_prime_ms",			METRIC_GAUGE,		"Time taken to build the last full terrain window (level start, recenter)");
+	gMetricTerrainJumpTime		= Metrics_Register("nanosaur_terrain_jump_ms",			METRIC_HISTOGRAM,	"Time taken to move the terrain window by more than one supertile");
+	gMetricOverdrawAverage		= Metrics_Register("nanosaur_overdraw_avg",				METRIC_GAUGE,		"Fragments written per 3D viewport pixel last frame (--overdraw only)");
+	gMetricOverdrawMax			= Metrics_Register("nanosaur_overdraw_max",				METRIC_GAUGE,		"Most fragments written to one pixel last frame (--overdraw only)");
+	gMetricStreamedKB			= Metrics_Register("nanosaur_streamed_kb",				METRIC_GAUGE,		"Dynamic vertex & index data streamed to the GPU last frame");
+	gMetricPipelineStates		= Metrics_Register("nanosaur_pipeline_states",			METRIC_GAUGE,		"Distinct render state combinations used last frame");
+	gMetricPipelineSwitches		= Metrics_Register("nanosaur_pipeline_switches",		METRIC_GAUGE,		"Render state combination changes between draws last frame");
+	gMetricSubmitTime			= Metrics_Register("nanosaur_submit_ms",				METRIC_GAUGE,		"CPU time spent drawing the mesh queue last frame");
+#if RENDER_VULKAN
+	gMetricVulkanSubmitTime		= Metrics_Register("nanosaur_vulkan_submit_ms",			METRIC_GAUGE,		"CPU time spent recording & submitting the mesh queue to Vulkan last frame (--vulkan only)");
+#endif
+	gMetricDynamicLights		= Metrics_Register("nanosaur_dynamic_lights",			METRIC_GAUGE,		"Point lights (explosions, shots...) last frame");
+	gMetricDynamicLightBinds	= Metrics_Register("nanosaur_dynamic_light_binds",		METRIC_GAUGE,		"Point lights loaded into GL light slots last frame");
+	gMetricDynamicLightTime		= Metrics_Register("nanosaur_dynamic_light_ms",			METRIC_GAUGE,		"CPU time spent picking & loading point lights last frame");
+}
+
+
+/******************** SHUTDOWN METRICS *************************/
+
+void ShutdownMetrics(void)
+{
+#if METRICS_HAVE_SOCKETS
+	for (int i = 0; i < gNumReaders; i++)
+		close(gReaderSockets[i]);
+	gNumReaders = 0;
+
+	if (gListenSocket >= 0)
+	{
+		close(gListenSocket);
+		gListenSocket = -1;
+		unlink(gMetricsSocketPath);
+	}
+#endif
+
+	gMetricsEnabled = false;
+}
+
+
+/******************** METRICS: REGISTER *************************/
+//
+// Name & help must be string constants.  Names follow the Prometheus conventions
+// (lowercase, underscores, "_total" for counters, unit suffix).
+//
+// OUTPUT: handle for Metrics_Add/Set/Observe, or -1 if metrics are off or the table is full
+//
+
+int Metrics_Register(const char *name, MetricKind kind, const char *help)
+{
+MetricType	*metric;
+
+	if (!gMetricsEnabled)
+		return(-1);
+
+	if (gNumMetrics >= MAX_METRICS)
+	{
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Metrics: table full, dropping %s", name);
+		return(-1);
+	}
+
+	metric = &gMetrics[gNumMetrics];
+	SDL_zerop(metric);
+	metric->name = name;
+	metric->help = help;
+	metric->kind = kind;
+
+	return(gNumMetrics++);
+}
+
+
+/******************** METRICS: ADD / SET / OBSERVE *************************/
+//
+// All of these ignore metric -1, so callers needn't check whether metrics are on.
+//
+
+void Metrics_Add(int metric, double amount)
+{
+	if (metric < 0)
+		return;
+
+	gMetrics[metric].value += amount;
+}
+
+void Metrics_Set(int metric, double value)
+{
+	if (metric < 0)
+		return;
+
+	gMetrics[metric].value = value;
+}
+
+void Metrics_Observe(int metric, double milliseconds)
+{
+MetricType	*m;
+int			b;
+
+	if (metric < 0)
+		return;
+
+	m = &gMetrics[metric];
+
+	for (b = 0; b < NUM_HISTOGRAM_BUCKETS - 1; b++)
+		if (milliseconds <= kHistogramBounds[b])
+			break;
+
+	m->buckets[b]++;
+	m->count++;
+	m->sum += milliseconds;
+}
+
+
+/******************** METRICS: SET LEVEL LOAD TIME *************************/
+
+void Metrics_SetLevelLoadTime(double milliseconds)
+{
+	if (!gMetricsEnabled)
+		return;
+
+	Metrics_Set(gMetricLevelLoadTime, milliseconds);
+	Metrics_Add(gMetricLevelLoads, 1);
+}
+
+
+/******************** METRICS: OBSERVE INPUT LATENCY *************************/
+//
+// Called by MeasureInputLatency after each buffer swap.
+//
+
+void Metrics_ObserveInputLatency(double milliseconds, Boolean sinceEvent)
+{
+	if (!gMetricsEnabled)
+		return;
+
+	Metrics_Observe(sinceEvent ? gMetricEventLatency : gMetricInputLatency, milliseconds);
+}
+
+
+/******************** METRICS: OBSERVE TERRAIN REBUILD *************************/
+//
+// Called by PrimeInitialTerrain, and when the scroll window jumps more than one supertile.
+//
+
+void Metrics_ObserveTerrainRebuild(double milliseconds, Boolean isJump)
+{
+	if (!gMetricsEnabled)
+		return;
+
+	if (isJump)
+		Metrics_Observe(gMetricTerrainJumpTime, milliseconds);
+	else
+		Metrics_Set(gMetricTerrainPrimeTime, milliseconds);
+}
+
+
+/******************** METRICS: END FRAME *************************/
+//
+// Called by QD3D_CalcFramesPerSecond once per frame, on every screen.
+//
+
+void Metrics_EndFrame(double frameMilliseconds)
+{
+uint64_t	now;
+int			length;
+
+	if (!gMetricsEnabled)
+		return;
+
+	Metrics_Add(gMetricFrames, 1);
+	Metrics_Observe(gMetricFrameTime, frameMilliseconds);
+
+	now = SDL_GetTicks();
+
+			/* LET NEW READERS IN */
+
+	if (now - gLastAcceptTime >= METRICS_ACCEPT_INTERVAL)
+	{
+		gLastAcceptTime = now;
+		AcceptMetricsReaders();
+	}
+
+			/* SEND SNAPSHOT */
+
+	if (gNumReaders == 0 || now - gLastExportTime < METRICS_EXPORT_INTERVAL)
+		return;
+
+	gLastExportTime = now;
+
+	SampleEngineGauges();
+	length = FormatMetrics(gMetricsText, sizeof(gMetricsText));
+	SendToMetricsReaders(gMetricsText, length);
+}
+
+
+/******************** SAMPLE ENGINE GAUGES *************************/
+
+static void SampleEngineGauges(void)
+{
+int		numNodes = 0;
+int		numBusy, numChannels;
+
+	for (ObjNode *node = gFirstNodePtr; node; node = node->NextNode)
+		numNodes++;
+
+	GetSoundChannelUsage(&numBusy, &numChannels);
+
+	Metrics_Set(gMetricFPS,					gFramesPerSecond);
+	Metrics_Set(gMetricGPUTime,				gRenderStats.gpuFrameMilliseconds);
+	Metrics_Set(gMetricTriangles,			gRenderStats.trianglesDrawn);
+	Metrics_Set(gMetricTrianglesSavedByLOD,	gRenderStats.trianglesSavedByLOD);
+	Metrics_Set(gMetricMeshQueue,			gRenderStats.meshQueueSize);
+	Metrics_Set(gMetricStateChanges,		gRenderStats.batchedStateChanges);
+	Metrics_Set(gMetricOverdrawAverage,		gRenderStats.overdrawAverage);
+	Metrics_Set(gMetricOverdrawMax,			gRenderStats.overdrawMax);
+	Metrics_Set(gMetricStreamedKB,			gRenderStats.streamedBytes / 1024.0);
+	Metrics_Set(gMetricPipelineStates,		gRenderStats.pipelineStates);
+	Metrics_Set(gMetricPipelineSwitches,	gRenderStats.pipelineSwitches);
+	Metrics_Set(gMetricSubmitTime,			gRenderStats.submitMilliseconds);
+#if RENDER_VULKAN
+	Metrics_Set(gMetricVulkanSubmitTime,	gRenderStats.vulkanSubmitMilliseconds);
+#endif
+	Metrics_Set(gMetricDynamicLights,		gRenderStats.dynamicLights);
+	Metrics_Set(gMetricDynamicLightBinds,	gRenderStats.dynamicLightBinds);
+	Metrics_Set(gMetricDynamicLightTime,	gRenderStats.dynamicLightMilliseconds);
+	Metrics_Set(gMetricObjNodes,			numNodes);
+	Metrics_Set(gMetricObjNodePool,			gObjNodePool ? Pool_Size(gObjNodePool) : 0);
+	Metrics_Set(gMetricHeapAllocs,			Pomme_GetNumAllocs());
+	Metrics_Set(gMetricHeapKB,				Pomme_GetHeapSize() / 1024);
+	Metrics_Set(gMetricSoundChannelsBusy,	numBusy);
+	Metrics_Set(gMetricSoundChannels,		numChannels);
+}
+
+
+/******************** FORMAT METRICS *************************/
+//
+// Prometheus text exposition format, ending with "# EOF".
+//
+// OUTPUT: # of chars written (truncated at a line boundary if the buffer is too small)
+//
+
+static int FormatMetrics(char *buffer, int bufferSize)
+{
+static const char *kTypeNames[] = { "counter", "gauge", "histogram" };
+int		length = 0;
+int		n;
+
+#define APPEND(...)																\
+	do {																		\
+		n = SDL_snprintf(buffer + length, bufferSize - length, __VA_ARGS__);	\
+		if (n < 0 || n >= bufferSize - length) goto full;						\
+		length += n;															\
+	} while (0)
+
+	for (int i = 0; i < gNumMetrics; i++)
+	{
+		const MetricType *m = &gMetrics[i];
+
+		APPEND("# HELP %s %s\n# TYPE %s %s\n", m->name, m->help, m->name, kTypeNames[m->kind]);
+
+		if (m->kind != METRIC_HISTOGRAM)
+		{
+			APPEND("%s %.17g\n", m->name, m->value);
+			continue;
+		}
+
+		uint64_t cumulative = 0;
+		for (int b = 0; b < NUM_HISTOGRAM_BUCKETS - 1; b++)
+		{
+			cumulative += m->buckets[b];
+			APPEND("%s_bucket{le=\"%g\"} %llu\n", m->name, kHistogramBounds[b], (unsigned long long) cumulative);
+		}
+		APPEND("%s_bucket{le=\"+Inf\"} %llu\n", m->name, (unsigned long long) m->count);
+		APPEND("%s_sum %.17g\n%s_count %llu\n", m->name, m->sum, m->name, (unsigned long long) m->count);
+	}
+
+full:
+	buffer[length] = '\0';
+	n = SDL_snprintf(buffer + length, bufferSize - length, "# EOF\n");
+	if (n > 0 && n < bufferSize - length)
+		length += n;
+
+#undef APPEND
+
+	return(length);
+}
+
+
+/******************** ACCEPT METRICS READERS *************************/
+
+static void AcceptMetricsReaders(void)
+{
+#if METRICS_HAVE_SOCKETS
+	while (gListenSocket >= 0)
+	{
+		int client = accept(gListenSocket, NULL, NULL);
+		if (client < 0)												// EAGAIN: nobody waiting
+			return;
+
+		if (gNumReaders >= MAX_METRICS_READERS)
+		{
+			close(client);
+			continue;
+		}
+
+		fcntl(client, F_SETFL, fcntl(client, F_GETFL) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+		int one = 1;
+		setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+		gReaderSockets[gNumReaders++] = client;
+	}
+#endif
+}
+
+
+/******************** SEND TO METRICS READERS *************************/
+//
+// A reader that has hung up, or that's so far behind that its socket buffer is full,
+// gets dropped rather than blocking the game.
+//
+
+static void SendToMetricsReaders(const char *text, int length)
+{
+#if METRICS_HAVE_SOCKETS
+	#ifdef MSG_NOSIGNAL
+		const int flags = MSG_NOSIGNAL;
+	#else
+		const int flags = 0;										// SO_NOSIGPIPE set on the socket instead
+	#endif
+
+	for (int i = 0; i < gNumReaders; )
+	{
+		ssize_t sent = send(gReaderSockets[i], text, length, flags);
+		if (sent == length)
+		{
+			i++;
+			continue;
+		}
+
+		close(gReaderSockets[i]);
+		gReaderSockets[i] = gReaderSockets[--gNumReaders];			// drop reader
+	}
+#else
+	(void) text;
+	(void) length;
+#endif
+}
@@ -179,6 +179,24 @@ void SetMyRandomSeed(unsigned long seed)
 }
 
 
+/**************** GET/SET MY RANDOM STATE *******************/
+//
+// The full generator state, for game snapshots (see Snapshot.c).
+//
+
+void GetMyRandomState(unsigned long state[6])
+{
+	state[0] = seed0;		state[1] = seed1;		state[2] = seed2;
+	state[3] = seed0_alt;	state[4] = seed1_alt;	state[5] = seed2_alt;
+}
+
+void SetMyRandomState(const unsigned long state[6])
+{
+	seed0 = state[0];		seed1 = state[1];		seed2 = state[2];
+	seed0_alt = state[3];	seed1_alt = state[4];	seed2_alt = state[5];
+}
+
+
 #pragma mark -
 
 /***************** APPLY FICTION TO DELTAS ********************/
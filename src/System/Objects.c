@@ -19,6 +19,12 @@
 
 static void DisposeObjNodeMemory(ObjNode* node);
 static void FlushObjectDeleteQueue(int qid);
+static void DiscardDeferredObjectCommands(void);
+static void CarryOutDeferredObjectCommands(int lastOrder);
+static void SkipDeferredObjectCommands(int lastOrder);
+static Boolean IsParallelMoveNode(const ObjNode* theNode);
+static int MoveParallelRun(ObjNode* firstNode);
+static void FinishParallelRun(int nextParallel);
 
 
 /****************************/
@@ -28,6 +34,13 @@ static void FlushObjectDeleteQueue(int qid);
 #define	OBJ_DEL_Q_SIZE	1024	// number of ObjNodes that can be deleted during any given frame
 #define	OBJ_BUDGET		1024
 
+#define	OBJECT_COMMANDS_PER_BUFFER	256		// room for deferred spawns & deletes a buffer starts with (it grows as needed)
+
+#define	MAX_PARALLEL_MOVES			OBJ_BUDGET	// longest run moved at once (the rest of a longer run is the next run)
+#define	PARALLEL_MOVES_PER_THREAD	64		// don't wake a helper thread for fewer objects than this
+#define	MIN_PARALLEL_RUN			(2*PARALLEL_MOVES_PER_THREAD)	// shorter runs are just moved in the walk
+#define	PARALLEL_MOVE_CHUNK			16		// objects a thread takes at a time
+
 
 /**********************/
 /*     VARIABLES      */
@@ -54,6 +67,48 @@ static int			gNumObjsInDeleteQueue[2];
 static ObjNode*		gObjectDeleteQueue[2][OBJ_DEL_Q_SIZE];
 static int			gObjectDeleteQueueFlipFlop = 0;
 
+// Deferred spawns & deletes queued by threads other than the main thread (see DeferObjectSpawn).
+// Each thread gets its own buffer, so queuing takes no locks.
+typedef struct
+{
+	int					order;						// when the main thread carries it out (see SetDeferredObjectOrder)
+	ObjNode*			deleteNode;					// DeleteObject this node...
+	DeferredSpawnProc	spawnProc;					// ...or call this with params
+	_Alignas(16) Byte	params[DEFERRED_SPAWN_PARAMS_SIZE];
+}ObjectCommand;
+
+typedef struct
+{
+	int					order;						// order given to commands queued from now on
+	int					numCommands;
+	int					maxCommands;
+	ObjectCommand*		commands;					// grown by the thread that owns the buffer, kept between frames
+}ObjectCommandBuffer;
+
+static ObjectCommandBuffer	gObjectCommandBuffers[MAX_OBJECT_COMMAND_BUFFERS];
+static int					gNextObjectCommand[MAX_OBJECT_COMMAND_BUFFERS];	// next command to carry out in each buffer
+static SDL_TLSID			gObjectCommandBufferTLS;		// this thread's ObjectCommandBuffer, or NULL on the main thread
+
+// The run of objects MoveParallelRun moved last, in object list order
+static ObjNode*				gParallelMoveNodes[MAX_PARALLEL_MOVES];
+static int					gNumParallelMoves = 0;
+static SDL_AtomicInt		gParallelMoveNextChunk;
+
+// Helper threads for MoveParallelRun.  They're started the first time there are enough
+// objects to share out, then sleep on their semaphore between frames until ShutdownObjectManager.
+typedef struct
+{
+	SDL_Thread*			thread;
+	SDL_Semaphore*		go;							// signaled when there's a batch to move
+	int					bufferNum;
+}ParallelMoveWorker;
+
+static ParallelMoveWorker	gParallelMoveWorkers[MAX_OBJECT_COMMAND_BUFFERS - 1];	// buffer 0 is the main thread's
+static int					gNumParallelMoveWorkers = 0;
+static bool					gTriedParallelMoveWorkers = false;
+static bool					gQuitParallelMoveWorkers = false;
+static SDL_Semaphore*		gParallelMoveDone = NULL;	// signaled by each worker when it's done with a batch
+
 
 extern RenderStats	gRenderStats;
 
@@ -80,6 +135,8 @@ void InitObjectManager(void)
 		gObjNodePool = Pool_New(OBJ_BUDGET);
 	else
 		Pool_Reset(gObjNodePool);
+
+	DiscardDeferredObjectCommands();
 }
 
 
@@ -131,6 +188,7 @@ ObjNode	*MakeNewObject(NewObjectDefinitionType *newObjDef)
 	newNodePtr->StreamingEffect = -1;					// no streaming sound effect
 	newNodePtr->TerrainItemPtr = nil;					// assume not a terrain item
 	newNodePtr->Skeleton = nil;
+	newNodePtr->XformRotOrder = XFORM_NEEDS_REBUILD;	// BaseTransformMatrix hasn't been built yet
 
 	newNodePtr->RenderModifiers.statusBits = 0;
 	newNodePtr->RenderModifiers.diffuseColor = (TQ3ColorRGBA) { 1,1,1,1 };	// default diffuse color is opaque white
@@ -220,6 +278,8 @@ Byte	group,type;
 	TQ3TriMeshFlatGroup* meshList = &gObjectGroupList[group][type];
 	AttachGeometryToDisplayGroupObject(newObj, meshList->numMeshes, meshList->meshes);
 
+	newObj->RenderModifiers.lodSet = gObjectGroupLODList[group][type];	// reduced-detail levels (if any)
+
 			/* CALC RADIUS */
 			
 	newObj->Radius = gObjectGroupRadiusList[group][type] * newObj->Scale.x;	
@@ -289,6 +349,8 @@ TQ3Matrix4x4			transMatrix,scaleMatrix,rotMatrix;
 	Q3Matrix4x4_Multiply(&theNode->BaseTransformMatrix,							// mult by trans matrix
 						 &transMatrix,
 						 &theNode->BaseTransformMatrix);
+
+	theNode->XformRotOrder = XFORM_NEEDS_REBUILD;								// built by hand, so UpdateObjectTransforms must redo it
 }
 
 
@@ -301,20 +363,67 @@ TQ3Matrix4x4			transMatrix,scaleMatrix,rotMatrix;
 
 
 /*******************************  MOVE OBJECTS **************************/
+//
+// The list is walked in order as usual.  When the walk gets to a long enough run of objects
+// with STATUS_BIT_PARALLELMOVE, the whole run is moved at once (see MoveParallelRun), and
+// the walk goes on through the run carrying out the deletes, spawns & lights each object's
+// move routine queued, at that object's turn.  Everything before the run has been moved
+// and everything after it hasn't, so the results are the same as moving them one by one.
+//
 
 void MoveObjects(void)
 {
 ObjNode		*thisNodePtr;
+int			nextParallel = 0;
+int			serialRunLeft = 0;
 
 	if (gFirstNodePtr == nil)								// see if there are any objects
 		return;
 
+	gNumParallelMoves = 0;
+
 	thisNodePtr = gFirstNodePtr;
 	
 	do
 	{
 		gNextNode = thisNodePtr->NextNode;
 		gCurrentNode = thisNodePtr;						// set current object node
+
+				/* SEE IF IT WAS ALREADY MOVED IN PARALLEL */
+
+		while (nextParallel < gNumParallelMoves
+			&& gParallelMoveNodes[nextParallel]->CType == INVALID_NODE_FLAG)	// deleted by someone else before its turn,
+		{
+			SkipDeferredObjectCommands(nextParallel++);						// so in list order it never got to move
+		}
+
+		if (nextParallel < gNumParallelMoves && thisNodePtr == gParallelMoveNodes[nextParallel])
+		{
+			CarryOutDeferredObjectCommands(nextParallel++);
+			thisNodePtr = gNextNode;					// (may have been changed by a delete)
+			continue;
+		}
+
+				/* SEE IF IT STARTS A RUN OF PARALLEL OBJECTS */
+				//
+				// Not while the last run is still being carried out: an object that shows up
+				// in the middle of it was spawned there, and is moved at its turn like in the serial walk.
+				//
+
+		if (serialRunLeft > 0)
+			serialRunLeft--;
+		else
+		if (nextParallel == gNumParallelMoves && IsParallelMoveNode(thisNodePtr))
+		{
+			FinishParallelRun(nextParallel);
+			nextParallel = 0;
+
+			int runLength = MoveParallelRun(thisNodePtr);
+			if (gNumParallelMoves > 0)
+				continue;								// same node again: its commands are carried out above
+
+			serialRunLeft = runLength - 1;				// too short to be worth it, so the walk moves them
+		}
 		
 		KeepOldCollisionBoxes(thisNodePtr);					// keep old box
 		
@@ -338,6 +447,8 @@ ObjNode		*thisNodePtr;
 	}
 	while (thisNodePtr != nil);
 
+	FinishParallelRun(nextParallel);
+
 			/* CALL SOUND MAINTENANCE HERE FOR CONVENIENCE */
 			
 	DoSoundMaintenance();
@@ -349,6 +460,199 @@ ObjNode		*thisNodePtr;
 }
 
 
+/*******************************  FINISH PARALLEL RUN **************************/
+//
+// Carries out whatever the last parallel run queued that the walk didn't get to
+// (commands of objects that were deleted before their turn are dropped), and empties the buffers.
+//
+
+static void FinishParallelRun(int nextParallel)
+{
+	for ( ; nextParallel < gNumParallelMoves; nextParallel++)
+	{
+		if (gParallelMoveNodes[nextParallel]->CType == INVALID_NODE_FLAG)
+			SkipDeferredObjectCommands(nextParallel);
+		else
+			CarryOutDeferredObjectCommands(nextParallel);
+	}
+
+	FlushDeferredObjectCommands();
+}
+
+
+/*******************************  MOVE PARALLEL RUN **************************/
+//
+// Calls the move routines of a run of STATUS_BIT_PARALLELMOVE objects that follow each other
+// in the list, sharing them out with the helper threads.
+//
+// These routines may only change their own node, must not read anything that another move
+// routine changes, and must use DeferDeleteObject & DeferObjectSpawn instead of DeleteObject
+// & MakeNewObject (AddDynamicLight is deferred too).  So nothing in the run can tell whether
+// the others have moved yet.  Their deferred commands are ordered by the object's place in
+// the run, so which thread moved what doesn't matter either.  The main thread binds a command
+// buffer too, so the objects behave exactly the same whether or not any helpers were woken.
+//
+
+static void MoveParallelChunks(int bufferNum)
+{
+	BindObjectCommandBuffer(bufferNum);
+
+	while (1)
+	{
+		int first = SDL_AddAtomicInt(&gParallelMoveNextChunk, PARALLEL_MOVE_CHUNK);
+		if (first >= gNumParallelMoves)
+			break;
+
+		int last = SDL_min(first + PARALLEL_MOVE_CHUNK, gNumParallelMoves);
+		for (int i = first; i < last; i++)
+		{
+			ObjNode* theNode = gParallelMoveNodes[i];
+
+			SetDeferredObjectOrder(i);
+			KeepOldCollisionBoxes(theNode);
+			theNode->MoveCall(theNode);
+		}
+	}
+
+	BindObjectCommandBuffer(-1);
+}
+
+static int SDLCALL ParallelMoveWorkerThread(void* data)
+{
+	const ParallelMoveWorker* worker = (const ParallelMoveWorker*) data;
+
+	while (1)
+	{
+		SDL_WaitSemaphore(worker->go);
+		if (gQuitParallelMoveWorkers)
+			break;
+
+		MoveParallelChunks(worker->bufferNum);
+		SDL_SignalSemaphore(gParallelMoveDone);
+	}
+
+	return 0;
+}
+
+static void StartParallelMoveWorkers(void)
+{
+int	numWorkers;
+
+	gTriedParallelMoveWorkers = true;							// if we can't get them now, don't try every frame
+
+	numWorkers = SDL_clamp(SDL_GetNumLogicalCPUCores(), 1, MAX_OBJECT_COMMAND_BUFFERS) - 1;
+	if (numWorkers <= 0)
+		return;
+
+	gParallelMoveDone = SDL_CreateSemaphore(0);
+	if (!gParallelMoveDone)
+		return;
+
+	while (gNumParallelMoveWorkers < numWorkers)				// make do with what we can get
+	{
+		ParallelMoveWorker* worker = &gParallelMoveWorkers[gNumParallelMoveWorkers];
+
+		worker->bufferNum = gNumParallelMoveWorkers + 1;
+		worker->go = SDL_CreateSemaphore(0);
+		if (!worker->go)
+			break;
+
+		worker->thread = SDL_CreateThread(ParallelMoveWorkerThread, "ParallelMove", worker);
+		if (!worker->thread)
+		{
+			SDL_DestroySemaphore(worker->go);
+			worker->go = NULL;
+			break;
+		}
+
+		gNumParallelMoveWorkers++;
+	}
+}
+
+static Boolean IsParallelMoveNode(const ObjNode* theNode)
+{
+	return (theNode->StatusBits & (STATUS_BIT_PARALLELMOVE | STATUS_BIT_NOMOVE | STATUS_BIT_ANIM)) == STATUS_BIT_PARALLELMOVE
+			&& theNode->MoveCall != nil;
+}
+
+//
+// OUTPUT:	length of the run starting at firstNode.
+//			If it was long enough to move, gParallelMoveNodes holds it; else gNumParallelMoves is 0.
+//
+
+static int MoveParallelRun(ObjNode* firstNode)
+{
+int	numThreads,numHelpers;
+
+			/* GATHER THE RUN IN LIST ORDER */
+
+	gNumParallelMoves = 0;
+
+	for (ObjNode* node = firstNode; node != nil && gNumParallelMoves < MAX_PARALLEL_MOVES && IsParallelMoveNode(node); node = node->NextNode)
+		gParallelMoveNodes[gNumParallelMoves++] = node;
+
+	if (gNumParallelMoves < MIN_PARALLEL_RUN)				// handing them over would cost more than moving them in the walk
+	{
+		int runLength = gNumParallelMoves;
+		gNumParallelMoves = 0;
+		return runLength;
+	}
+
+			/* MOVE THEM ON THE HELPERS & THIS THREAD */
+
+	numThreads = SDL_clamp(gNumParallelMoves / PARALLEL_MOVES_PER_THREAD, 1, MAX_OBJECT_COMMAND_BUFFERS);
+
+	if (numThreads > 1 && !gTriedParallelMoveWorkers)
+		StartParallelMoveWorkers();
+
+	numHelpers = SDL_min(numThreads - 1, gNumParallelMoveWorkers);
+
+	SDL_SetAtomicInt(&gParallelMoveNextChunk, 0);
+
+	for (int t = 0; t < numHelpers; t++)
+		SDL_SignalSemaphore(gParallelMoveWorkers[t].go);
+
+	MoveParallelChunks(0);
+
+	for (int t = 0; t < numHelpers; t++)
+		SDL_WaitSemaphore(gParallelMoveDone);
+
+	return gNumParallelMoves;
+}
+
+
+/*******************************  SHUTDOWN OBJECT MANAGER **************************/
+//
+// Stops the parallel move helpers.
+//
+
+void ShutdownObjectManager(void)
+{
+	gQuitParallelMoveWorkers = true;
+
+	for (int t = 0; t < gNumParallelMoveWorkers; t++)
+		SDL_SignalSemaphore(gParallelMoveWorkers[t].go);
+
+	for (int t = 0; t < gNumParallelMoveWorkers; t++)
+	{
+		SDL_WaitThread(gParallelMoveWorkers[t].thread, NULL);
+		SDL_DestroySemaphore(gParallelMoveWorkers[t].go);
+		gParallelMoveWorkers[t].thread = NULL;
+		gParallelMoveWorkers[t].go = NULL;
+	}
+
+	if (gParallelMoveDone)
+	{
+		SDL_DestroySemaphore(gParallelMoveDone);
+		gParallelMoveDone = NULL;
+	}
+
+	gNumParallelMoveWorkers = 0;
+	gTriedParallelMoveWorkers = false;
+	gQuitParallelMoveWorkers = false;
+}
+
+
 
 
 /**************************** DRAW OBJECTS ***************************/
@@ -357,11 +661,18 @@ void DrawObjects(QD3DSetupOutputType *setupInfo)
 {
 ObjNode		*theNode;
 
-	(void) setupInfo;
-
 	if (gFirstNodePtr == nil)							// see if there are any objects
 		return;
 
+	const TQ3Point3D cameraCoord = setupInfo->cameraPlacement.cameraLocation;
+	const float tanHalfFOV = tanf(setupInfo->fov * .5f);
+
+				/* DRAW MERGED STATIC PROPS */
+
+	PropBatch_DrawAll(setupInfo);
+
+	BeginShadowBatch();
+
 				/* FIRST DO OUR CULLING */
 				
 	CheckAllObjectsInConeOfVision();
@@ -385,7 +696,36 @@ ObjNode		*theNode;
 		if (theNode->CType == INVALID_NODE_FLAG)				// see if already deleted
 			goto next;		
 
+		if (statusBits & STATUS_BIT_PROPBATCHED)				// see if drawn by its supertile's prop batch
+			goto next;
+
+		if (statusBits & STATUS_BIT_SHADOWDECAL)				// shadows all go out in one batch
+		{
+			AddShadowToBatch(theNode);
+			goto next;
+		}
+
 		theNode->RenderModifiers.statusBits = statusBits;
+		if (theNode->HasBakedLighting)							// lighting is already in the vertex colors
+			theNode->RenderModifiers.statusBits |= STATUS_BIT_NULLSHADER;
+
+				/* PICK LEVEL OF DETAIL */
+
+		theNode->RenderModifiers.lodLevel = 0;
+
+		if (theNode->RenderModifiers.lodSet)
+		{
+			TQ3TriMeshData**	sourceMeshes = theNode->MeshList;
+
+			if (theNode->Genre == SKELETON_GENRE)				// skinned meshes are copies of the skeleton's decomposed meshes
+				sourceMeshes = theNode->Skeleton->skeletonDefinition->decomposedTriMeshPtrs;
+
+			if (MeshLOD_MatchesMeshes(theNode->RenderModifiers.lodSet, theNode->NumMeshes, sourceMeshes))	// geometry may have been swapped after creation
+			{
+				float dist = Q3Point3D_Distance(&cameraCoord, &theNode->Coord);
+				theNode->RenderModifiers.lodLevel = MeshLOD_SelectLevel(theNode->RenderModifiers.lodSet, theNode->Radius, dist, tanHalfFOV);
+			}
+		}
 
 		switch (theNode->Genre)
 		{
@@ -413,6 +753,8 @@ ObjNode		*theNode;
 next:
 		theNode = theNode->NextNode;
 	}while (theNode != nil);
+
+	SubmitShadowBatch();
 }
 
 
@@ -443,6 +785,9 @@ void DeleteAllObjects(void)
 	
 	FlushObjectDeleteQueue(0);
 	FlushObjectDeleteQueue(1);
+	DiscardDeferredObjectCommands();
+
+	PropBatch_DisposeAll();
 }
 
 
@@ -487,6 +832,9 @@ ObjNode *tempNode;
 	if (theNode->CollisionTriangles)				// free collision triangle memory
 		DisposeCollisionTriangleMemory(theNode);
 
+	if (theNode->StatusBits & STATUS_BIT_PROPBATCHED)	// take it out of its supertile's prop batch
+		PropBatch_RemoveNode(theNode);
+
 		/* SEE IF NEED TO DEREFERENCE A QD3D OBJECT */
 
 	for (int i = 0; i < theNode->NumMeshes; i++)
@@ -508,6 +856,7 @@ ObjNode *tempNode;
 		theNode->OwnsMeshMemory[i] = false;
 	}
 	theNode->NumMeshes = 0;
+	theNode->HasBakedLighting = false;
 
 					/* DO NODE SWITCHING */
 
@@ -602,6 +951,244 @@ static void FlushObjectDeleteQueue(int qid)
 
 
 
+//============================================================================================================
+//============================================================================================================
+//============================================================================================================
+
+#pragma mark ----- DEFERRED OBJECT COMMANDS ------
+
+//
+// MakeNewObject & DeleteObject change the object list, so only the main thread may call them.
+// Code that runs on other threads (e.g. move routines in a parallel batch) calls DeferObjectSpawn
+// and DeferDeleteObject instead, and the main thread carries out the commands at a sync point
+// with FlushDeferredObjectCommands.
+//
+// Commands are carried out in order of SetDeferredObjectOrder, then in the order each thread
+// queued them, so the result doesn't depend on which thread got to which object first.
+//
+// On the main thread (no buffer bound), both calls happen right away.
+//
+
+
+/******************* BIND OBJECT COMMAND BUFFER ********************/
+//
+// A thread that's going to queue object commands must claim a buffer for itself.
+// No two threads may use the same buffer at the same time.
+//
+// INPUT: bufferNum = 0..MAX_OBJECT_COMMAND_BUFFERS-1, or -1 to unbind this thread
+//
+
+void BindObjectCommandBuffer(int bufferNum)
+{
+	ObjectCommandBuffer* buffer = NULL;
+
+	if (bufferNum >= 0)
+	{
+		GAME_ASSERT(bufferNum < MAX_OBJECT_COMMAND_BUFFERS);
+		buffer = &gObjectCommandBuffers[bufferNum];
+		buffer->order = 0;
+	}
+
+	SDL_SetTLS(&gObjectCommandBufferTLS, buffer, NULL);
+}
+
+
+/******************* SET DEFERRED OBJECT ORDER ********************/
+//
+// Sets the order of the commands this thread queues from now on.  Callers pass the
+// object's position in the object list, so commands come out as if the objects
+// had been moved one after another.  It may not go down while a buffer is bound.
+//
+
+void SetDeferredObjectOrder(int order)
+{
+	ObjectCommandBuffer* buffer = (ObjectCommandBuffer*) SDL_GetTLS(&gObjectCommandBufferTLS);
+
+	if (buffer)
+	{
+		GAME_ASSERT(order >= buffer->order);
+		buffer->order = order;
+	}
+}
+
+
+/******************* QUEUE OBJECT COMMAND ********************/
+
+//
+// Grows the buffer when it's full (e.g. hundreds of puffs expiring on the same frame).
+// Only the thread that owns the buffer touches it until the sync point, so no lock is needed.
+//
+
+static ObjectCommand* QueueObjectCommand(ObjectCommandBuffer* buffer)
+{
+	if (buffer->numCommands >= buffer->maxCommands)
+	{
+		int newMax = SDL_max(OBJECT_COMMANDS_PER_BUFFER, buffer->maxCommands * 2);
+		ObjectCommand* newCommands = (ObjectCommand*) SDL_aligned_alloc(_Alignof(ObjectCommand), newMax * sizeof(ObjectCommand));
+		GAME_ASSERT_MESSAGE(newCommands, "Out of memory for object commands");
+
+		if (buffer->commands)
+		{
+			SDL_memcpy(newCommands, buffer->commands, buffer->numCommands * sizeof(ObjectCommand));
+			SDL_aligned_free(buffer->commands);
+		}
+
+		buffer->commands = newCommands;
+		buffer->maxCommands = newMax;
+	}
+
+	ObjectCommand* command = &buffer->commands[buffer->numCommands++];
+	command->order = buffer->order;
+	command->deleteNode = nil;
+	command->spawnProc = nil;
+	return command;
+}
+
+
+/******************* DEFER OBJECT SPAWN ********************/
+//
+// Calls proc(params) on the main thread at the next sync point.  proc can make
+// whatever objects it likes there.  params are copied, so they can live on the stack.
+//
+
+void DeferObjectSpawn(DeferredSpawnProc proc, const void* params, int paramsSize)
+{
+	ObjectCommandBuffer* buffer = (ObjectCommandBuffer*) SDL_GetTLS(&gObjectCommandBufferTLS);
+
+	GAME_ASSERT(paramsSize >= 0 && paramsSize <= DEFERRED_SPAWN_PARAMS_SIZE);
+
+	if (!buffer)											// main thread: do it now
+	{
+		proc(params);
+		return;
+	}
+
+	ObjectCommand* command = QueueObjectCommand(buffer);
+	command->spawnProc = proc;
+	SDL_memcpy(command->params, params, paramsSize);
+}
+
+
+/******************* DEFER DELETE OBJECT ********************/
+//
+// Deletes a node on the main thread at the next sync point.  The node stays in the
+// object list until then, so the caller must not touch it again.
+// A node that's queued more than once (or deleted in the meantime) is only deleted once.
+//
+
+void DeferDeleteObject(ObjNode *theNode)
+{
+	ObjectCommandBuffer* buffer = (ObjectCommandBuffer*) SDL_GetTLS(&gObjectCommandBufferTLS);
+
+	if (!buffer)											// main thread: do it now
+	{
+		DeleteObject(theNode);
+		return;
+	}
+
+	if (theNode == nil)
+		return;
+
+	QueueObjectCommand(buffer)->deleteNode = theNode;
+}
+
+
+/******************* CARRY OUT DEFERRED OBJECT COMMANDS ********************/
+//
+// Carries out the queued commands up to & including the given order, merging the
+// threads' buffers.  Commands of the same order come from one thread, in queue order.
+//
+
+static void CarryOutDeferredObjectCommands(int lastOrder)
+{
+	GAME_ASSERT(!SDL_GetTLS(&gObjectCommandBufferTLS));
+
+	while (1)
+	{
+		const ObjectCommand* command = NULL;
+		int bufferNum = -1;
+
+				/* FIND THE LOWEST ORDER AMONG THE BUFFERS' NEXT COMMANDS */
+
+		for (int b = 0; b < MAX_OBJECT_COMMAND_BUFFERS; b++)
+		{
+			const ObjectCommandBuffer* buffer = &gObjectCommandBuffers[b];
+
+			if (gNextObjectCommand[b] >= buffer->numCommands)
+				continue;
+
+			const ObjectCommand* next = &buffer->commands[gNextObjectCommand[b]];
+			if (next->order <= lastOrder && (!command || next->order < command->order))
+			{
+				command = next;
+				bufferNum = b;
+			}
+		}
+
+		if (!command)
+			break;
+
+				/* CARRY IT OUT */
+
+		gNextObjectCommand[bufferNum]++;
+
+		if (command->spawnProc)
+			command->spawnProc(command->params);
+		else if (command->deleteNode->CType != INVALID_NODE_FLAG)	// not already gone
+			DeleteObject(command->deleteNode);
+	}
+}
+
+
+/******************* SKIP DEFERRED OBJECT COMMANDS ********************/
+//
+// Drops the queued commands up to & including the given order without carrying them out.
+//
+
+static void SkipDeferredObjectCommands(int lastOrder)
+{
+	for (int b = 0; b < MAX_OBJECT_COMMAND_BUFFERS; b++)
+	{
+		const ObjectCommandBuffer* buffer = &gObjectCommandBuffers[b];
+
+		while (gNextObjectCommand[b] < buffer->numCommands
+			&& buffer->commands[gNextObjectCommand[b]].order <= lastOrder)
+		{
+			gNextObjectCommand[b]++;
+		}
+	}
+}
+
+
+/******************* FLUSH DEFERRED OBJECT COMMANDS ********************/
+//
+// Carries out every command still queued.
+// Must be called on the main thread once the other threads are done queuing.
+//
+
+void FlushDeferredObjectCommands(void)
+{
+	CarryOutDeferredObjectCommands(SDL_MAX_SINT32);
+	DiscardDeferredObjectCommands();
+}
+
+
+/******************* DISCARD DEFERRED OBJECT COMMANDS ********************/
+
+static void DiscardDeferredObjectCommands(void)
+{
+	for (int b = 0; b < MAX_OBJECT_COMMAND_BUFFERS; b++)
+	{
+		gObjectCommandBuffers[b].numCommands = 0;
+		gObjectCommandBuffers[b].order = 0;
+		gNextObjectCommand[b] = 0;
+	}
+
+	gNumParallelMoves = 0;											// MoveObjects mustn't skip anything it didn't move
+}
+
+
+
 //============================================================================================================
 //============================================================================================================
 //============================================================================================================
@@ -644,75 +1231,41 @@ void UpdateObject(ObjNode *theNode)
 //
 // This updates the skeleton object's base translate & rotate transforms
 //
+// Most objects call this every frame through UpdateObject whether or not they moved,
+// so remember what the matrix was built from and only rebuild it when Coord/Rot/Scale
+// or the rotation order differ.
+//
 
 void UpdateObjectTransforms(ObjNode *theNode)
 {
-TQ3Matrix4x4	matrix;
+uint32_t	rotOrder;
 
 	if (theNode->CType == INVALID_NODE_FLAG)		// see if already deleted
 		return;
 
-						/* INIT MATRIX */
-						
-	Q3Matrix4x4_SetIdentity(&theNode->BaseTransformMatrix);
+	rotOrder = theNode->StatusBits & (STATUS_BIT_ROTZYX | STATUS_BIT_ROTXZY);
 
+			/* SEE IF ANYTHING CHANGED SINCE LAST BUILD */
 
-					/********************/
-					/* SET SCALE MATRIX */
-					/********************/
-
-	if ((theNode->Scale.x != 1) || (theNode->Scale.y != 1) || (theNode->Scale.z != 1))		// see if ignore scale
-	{
-		Q3Matrix4x4_SetScale(&matrix, theNode->Scale.x,	theNode->Scale.y, theNode->Scale.z);
-		Q3Matrix4x4_Multiply(&theNode->BaseTransformMatrix, &matrix, &theNode->BaseTransformMatrix);
-	}
-	
-					/*****************/
-					/* NOW ROTATE IT */
-					/*****************/
-			
-					/* SEE IF DO Z->Y->X */
-					
-	if (theNode->StatusBits & STATUS_BIT_ROTZYX)
+	if ((rotOrder == theNode->XformRotOrder)
+		&& (theNode->Coord.x == theNode->XformCoord.x) && (theNode->Coord.y == theNode->XformCoord.y) && (theNode->Coord.z == theNode->XformCoord.z)
+		&& (theNode->Rot.x == theNode->XformRot.x) && (theNode->Rot.y == theNode->XformRot.y) && (theNode->Rot.z == theNode->XformRot.z)
+		&& (theNode->Scale.x == theNode->XformScale.x) && (theNode->Scale.y == theNode->XformScale.y) && (theNode->Scale.z == theNode->XformScale.z))
 	{
-		Q3Matrix4x4_SetRotate_Z(&matrix, theNode->Rot.z);
-		Q3Matrix4x4_Multiply(&theNode->BaseTransformMatrix,&matrix, &theNode->BaseTransformMatrix);
-		
-		Q3Matrix4x4_SetRotate_Y(&matrix, theNode->Rot.y);
-		Q3Matrix4x4_Multiply(&theNode->BaseTransformMatrix,&matrix, &theNode->BaseTransformMatrix);
-		
-		Q3Matrix4x4_SetRotate_X(&matrix, theNode->Rot.x);
-		Q3Matrix4x4_Multiply(&theNode->BaseTransformMatrix,&matrix, &theNode->BaseTransformMatrix);
-	}
-	else
-					/* SEE IF DO X->Z->Y */
-	
-	if (theNode->StatusBits & STATUS_BIT_ROTXZY)
-	{
-		Q3Matrix4x4_SetRotate_X(&matrix, theNode->Rot.x);
-		Q3Matrix4x4_Multiply(&theNode->BaseTransformMatrix,&matrix, &theNode->BaseTransformMatrix);
-		
-		Q3Matrix4x4_SetRotate_Z(&matrix, theNode->Rot.z);
-		Q3Matrix4x4_Multiply(&theNode->BaseTransformMatrix,&matrix, &theNode->BaseTransformMatrix);
-		
-		Q3Matrix4x4_SetRotate_Y(&matrix, theNode->Rot.y);
-		Q3Matrix4x4_Multiply(&theNode->BaseTransformMatrix,&matrix, &theNode->BaseTransformMatrix);
-	}
-	
-	
-					/* DO X->Y->Z */
-	else
-	{
-		Q3Matrix4x4_SetRotate_XYZ(&matrix, theNode->Rot.x, theNode->Rot.y, theNode->Rot.z);		// init rotation matrix
-		Q3Matrix4x4_Multiply(&theNode->BaseTransformMatrix,&matrix, &theNode->BaseTransformMatrix);
+		return;
 	}
-	
-					/********************/
-					/* NOW TRANSLATE IT */
-					/********************/
 
-	Q3Matrix4x4_SetTranslate(&matrix, theNode->Coord.x, theNode->Coord.y, theNode->Coord.z);	// make translate matrix
-	Q3Matrix4x4_Multiply(&theNode->BaseTransformMatrix,&matrix, &theNode->BaseTransformMatrix);
+			/* BUILD SCALE * ROTATE * TRANSLATE IN ONE GO */
+
+	SetScaleRotateTranslateMatrix(&theNode->BaseTransformMatrix, &theNode->Scale, &theNode->Rot, &theNode->Coord, rotOrder);
+
+	theNode->XformCoord = theNode->Coord;
+	theNode->XformRot = theNode->Rot;
+	theNode->XformScale = theNode->Scale;
+	theNode->XformRotOrder = rotOrder;
+
+	if (theNode->Skeleton)											// skeleton's cached joint world matrices are now stale
+		theNode->Skeleton->poseStamp++;
 }
 
 
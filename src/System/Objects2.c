@@ -22,11 +22,24 @@
 /*    CONSTANTS             */
 /****************************/
 
+#define	MAX_BATCHED_SHADOWS			128
+#define	MAX_SHADOW_POINTS			8						// per shadow model
+#define	MAX_SHADOW_TRIANGLES		8
+
 
 /**********************/
 /*     VARIABLES      */
 /**********************/
 
+static TQ3TriMeshData			gShadowBatchMesh;
+static TQ3Point3D				gShadowBatchPoints[MAX_BATCHED_SHADOWS * MAX_SHADOW_POINTS];
+static TQ3Param2D				gShadowBatchUVs[MAX_BATCHED_SHADOWS * MAX_SHADOW_POINTS];
+static TQ3ColorRGBA				gShadowBatchColors[MAX_BATCHED_SHADOWS * MAX_SHADOW_POINTS];
+static TQ3TriMeshTriangleData	gShadowBatchTriangles[MAX_BATCHED_SHADOWS * MAX_SHADOW_TRIANGLES];
+static RenderModifiers			gShadowBatchRenderMods;
+static TQ3Point3D				gShadowBatchCenter;
+static int						gNumShadowsInBatch = 0;
+
 
 //============================================================================================================
 //============================================================================================================
@@ -168,6 +181,7 @@ ObjNode	*shadowObj;
 	shadowObj->SpecialF[1] = scaleZ;
 
 	shadowObj->RenderModifiers.sortPriority = +9999;			// shadows must be drawn underneath all other transparent meshes
+	shadowObj->StatusBits |= STATUS_BIT_SHADOWDECAL;			// DrawObjects puts it in the shadow batch
 	
 	return(shadowObj);
 }
@@ -259,6 +273,153 @@ update:
 
 
 
+/************************ BEGIN SHADOW BATCH *************************/
+//
+// All visible shadows are drawn as one alpha-blended mesh with the Shadow.tga texture.
+// DrawObjects calls BeginShadowBatch, then AddShadowToBatch for each visible shadow node,
+// then SubmitShadowBatch.  The batch arrays are static, so they stay valid until Render_EndFrame.
+//
+
+void BeginShadowBatch(void)
+{
+	gNumShadowsInBatch = 0;
+	gShadowBatchCenter = (TQ3Point3D) { 0, 0, 0 };
+
+	gShadowBatchMesh.numPoints = 0;
+	gShadowBatchMesh.numTriangles = 0;
+	gShadowBatchMesh.points = gShadowBatchPoints;
+	gShadowBatchMesh.vertexUVs = gShadowBatchUVs;
+	gShadowBatchMesh.vertexColors = gShadowBatchColors;
+	gShadowBatchMesh.triangles = gShadowBatchTriangles;
+	gShadowBatchMesh.vertexNormals = nil;
+	gShadowBatchMesh.hasVertexNormals = false;
+	gShadowBatchMesh.hasVertexColors = true;					// each shadow's transparency is in its vertex colors
+	gShadowBatchMesh.texturingMode = kQ3TexturingModeAlphaBlend;
+	gShadowBatchMesh.glTextureName = gShadowGLTextureName;
+	gShadowBatchMesh.diffuseColor = (TQ3ColorRGBA) { 1, 1, 1, 1 };
+	gShadowBatchMesh.bBox.isEmpty = kQ3True;
+}
+
+
+/************************ ADD SHADOW TO BATCH *************************/
+//
+// Appends a shadow node's geometry to the batch, transformed to world space by its
+// BaseTransformMatrix (UpdateShadow has already placed it).
+// If the batch is full, the node is submitted on its own like any other object.
+//
+
+void AddShadowToBatch(ObjNode *shadowNode)
+{
+int		numPoints = 0, numTriangles = 0;
+Boolean	hasUVs = true;
+
+	for (int i = 0; i < shadowNode->NumMeshes; i++)
+	{
+		numPoints += shadowNode->MeshList[i]->numPoints;
+		numTriangles += shadowNode->MeshList[i]->numTriangles;
+		hasUVs &= shadowNode->MeshList[i]->vertexUVs != nil;
+	}
+
+	if (gNumShadowsInBatch >= MAX_BATCHED_SHADOWS
+		|| numPoints > MAX_SHADOW_POINTS
+		|| numTriangles > MAX_SHADOW_TRIANGLES
+		|| !hasUVs)
+	{
+		shadowNode->RenderModifiers.statusBits = shadowNode->StatusBits;
+		Render_SubmitMeshList(shadowNode->NumMeshes, shadowNode->MeshList, &shadowNode->BaseTransformMatrix,
+							&shadowNode->RenderModifiers, &shadowNode->Coord);
+		return;
+	}
+
+			/* FIRST SHADOW SETS THE BATCH'S RENDER MODS */
+
+	if (gNumShadowsInBatch == 0)
+	{
+		gShadowBatchRenderMods = shadowNode->RenderModifiers;
+		gShadowBatchRenderMods.statusBits = shadowNode->StatusBits | STATUS_BIT_NULLSHADER;	// black either way, so skip lighting
+		gShadowBatchRenderMods.diffuseColor = (TQ3ColorRGBA) { 1, 1, 1, 1 };
+		gShadowBatchRenderMods.lodSet = nil;
+		gShadowBatchRenderMods.lodLevel = 0;
+	}
+
+			/* APPEND EACH MESH */
+
+	for (int i = 0; i < shadowNode->NumMeshes; i++)
+	{
+		const TQ3TriMeshData* mesh = shadowNode->MeshList[i];
+		int firstPoint = gShadowBatchMesh.numPoints;
+
+		TQ3ColorRGBA color =
+		{
+			mesh->diffuseColor.r * shadowNode->RenderModifiers.diffuseColor.r,
+			mesh->diffuseColor.g * shadowNode->RenderModifiers.diffuseColor.g,
+			mesh->diffuseColor.b * shadowNode->RenderModifiers.diffuseColor.b,
+			mesh->diffuseColor.a * shadowNode->RenderModifiers.diffuseColor.a,
+		};
+
+		for (int v = 0; v < mesh->numPoints; v++)
+		{
+			TQ3Point3D* p = &gShadowBatchPoints[firstPoint + v];
+
+			Q3Point3D_Transform(&mesh->points[v], &shadowNode->BaseTransformMatrix, p);
+			gShadowBatchUVs[firstPoint + v] = mesh->vertexUVs[v];
+			gShadowBatchColors[firstPoint + v] = color;
+
+			if (gShadowBatchMesh.bBox.isEmpty)
+			{
+				gShadowBatchMesh.bBox.min = gShadowBatchMesh.bBox.max = *p;
+				gShadowBatchMesh.bBox.isEmpty = kQ3False;
+			}
+			else
+			{
+				gShadowBatchMesh.bBox.min.x = SDL_min(gShadowBatchMesh.bBox.min.x, p->x);
+				gShadowBatchMesh.bBox.min.y = SDL_min(gShadowBatchMesh.bBox.min.y, p->y);
+				gShadowBatchMesh.bBox.min.z = SDL_min(gShadowBatchMesh.bBox.min.z, p->z);
+				gShadowBatchMesh.bBox.max.x = SDL_max(gShadowBatchMesh.bBox.max.x, p->x);
+				gShadowBatchMesh.bBox.max.y = SDL_max(gShadowBatchMesh.bBox.max.y, p->y);
+				gShadowBatchMesh.bBox.max.z = SDL_max(gShadowBatchMesh.bBox.max.z, p->z);
+			}
+		}
+
+		for (int t = 0; t < mesh->numTriangles; t++)
+		{
+			TQ3TriMeshTriangleData* tri = &gShadowBatchTriangles[gShadowBatchMesh.numTriangles + t];
+
+			for (int c = 0; c < 3; c++)
+				tri->pointIndices[c] = firstPoint + mesh->triangles[t].pointIndices[c];
+		}
+
+		gShadowBatchMesh.numPoints += mesh->numPoints;
+		gShadowBatchMesh.numTriangles += mesh->numTriangles;
+	}
+
+	gShadowBatchCenter.x += shadowNode->Coord.x;
+	gShadowBatchCenter.y += shadowNode->Coord.y;
+	gShadowBatchCenter.z += shadowNode->Coord.z;
+	gNumShadowsInBatch++;
+}
+
+
+/************************ SUBMIT SHADOW BATCH *************************/
+//
+// Submits the batch as one mesh.  Its points are already in world space, so there's
+// no transform.  The +9999 sort priority keeps it under all other transparent meshes.
+//
+
+void SubmitShadowBatch(void)
+{
+	if (gNumShadowsInBatch == 0)
+		return;
+
+	gShadowBatchCenter.x /= gNumShadowsInBatch;						// average of the shadows, for depth sorting
+	gShadowBatchCenter.y /= gNumShadowsInBatch;
+	gShadowBatchCenter.z /= gNumShadowsInBatch;
+
+	Render_SubmitMesh(&gShadowBatchMesh, nil, &gShadowBatchRenderMods, &gShadowBatchCenter);
+}
+
+
+
 //============================================================================================================
 //============================================================================================================
 //============================================================================================================
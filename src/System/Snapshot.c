@@ -0,0 +1,904 @@
+/****************************/
+/*   	SNAPSHOT.C		    */
+/****************************/
+//
+// Saves the live game state of the current level to a file and puts it back later,
+// so a benchmark or a bug repro can start straight from a busy mid-level moment
+// instead of having to play its way there.
+//
+// What's in a snapshot:
+//		- every ObjNode in the object list, in list order, with its Skeleton anim state.
+//		  ObjNode links (ChainNode, ShadowNode, SpecialRef, etc.) are stored as list indices
+//		  and MoveCall as an offset into the code, so it's only good for the build that wrote it.
+//		- the terrain item flags (ITEM_FLAGS_INUSE etc.)
+//		- player, weapon, infobar & enemy globals, the camera and the random number generator.
+//
+// What's not: sound channels, shards & other non-ObjNode effects, and input state.
+//
+// The camera and infobar objects are set up by InitLevel and never change, so they're kept
+// as they are rather than being recreated.  Everything else is deleted and rebuilt with the
+// regular MakeNew... routines (which brings back meshes, skeletons & LODs) and then
+// overwritten with the saved fields.
+//
+// The snapshot is raw native-endian structs.  It must be loaded into the same level
+// of the same build: the header check refuses anything else before touching the game.
+//
+
+
+/****************************/
+/*    EXTERNALS             */
+/****************************/
+
+#include "game.h"
+#include <stddef.h>
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	SNAPSHOT_MAGIC			"Nanosaur Snap v1"
+
+#define	SKELETON_SNAPSHOT_SIZE	offsetof(SkeletonObjDataType, jointWorldMatrix)	// the rest is a matrix cache & the def ptr
+
+#define	NO_REF					(-1)
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+typedef struct
+{
+	char		magic[32];
+	uint32_t	objNodeSize;
+	uint32_t	skeletonSize;
+	int64_t		codeFingerprint[3];							// offsets of a few routines, to catch a different build
+	int32_t		levelNum;
+	int32_t		terrainWidth,terrainDepth;
+	int32_t		numTerrainItems;
+	uint32_t	terrainItemHash;							// so a different .ter with the same size is caught too
+	int32_t		numNodes;
+}SnapshotHeader;
+
+typedef struct
+{
+	TQ3Point3D		myCoord;
+	int32_t			myStartX,myStartZ;
+	float			myHealth;
+	float			lavaSmokeCounter;
+	float			shieldTimer;
+	UInt16			latestPathTileNum,latestTileAttribs;
+	Byte			myStartAim;
+	Boolean			playerGotKilled;
+
+	float			floorY,heightOffGround,speedPuffCounter;
+
+	short			weaponInventory[NUM_ATTACK_MODES];
+	Boolean			possibleAttackModes[NUM_ATTACK_MODES];
+	Byte			currentAttackMode;
+	float			autoFireCounter,sonicScreamWave;
+
+	uint32_t		score;
+	short			numLives;
+	float			fuel,timeRemaining;
+	short			recoveredEggs[NUM_EGG_SPECIES];
+
+	short			numEnemies;
+	signed char		numEnemyOfKind[NUM_ENEMY_KINDS];
+	short			itemPatchCounts[3];
+
+	Byte			cameraMode;
+	float			cameraViewYAngle;
+	TQ3Point3D		cameraFrom,cameraTo;
+
+	unsigned long	randomState[6];
+
+	int32_t			playerObj,myTimePortal,myShield;		// node indices
+}SnapshotGlobals;
+
+typedef struct
+{
+	Byte		persistent;									// kept from the running level (camera, infobar), not saved
+	Byte		hasMoveCall;
+	Byte		hadCollisionTriangles;
+	Byte		wasPropBatched;
+	int64_t		moveCall;									// CodeOffset of MoveCall
+	int32_t		chainNode,chainHead,shadowNode,platformNode,carriedObj;
+	int32_t		specialRef[6];
+	int32_t		terrainItem;								// index into gMasterItemList
+	ObjNode		node;										// all pointers cleared
+}SnapshotNode;
+
+typedef struct
+{
+	const ObjNode	*node;
+	int32_t			index;
+}NodeIndexEntry;
+
+static	NodeIndexEntry	*gNodeIndex = nil;					// list nodes sorted by address, for EncodeRef
+static	int				gNodeIndexSize = 0;
+
+
+/******************** CODE OFFSET *************************/
+//
+// Function addresses move with ASLR, but their distance from each other doesn't.
+//
+
+static int64_t CodeOffset(void (*fn)(ObjNode *))
+{
+	return (int64_t)((intptr_t) fn - (intptr_t) &MoveObjects);
+}
+
+static void GetCodeFingerprint(int64_t fingerprint[3])
+{
+	fingerprint[0] = CodeOffset(&DeleteObject);
+	fingerprint[1] = CodeOffset(&MoveCamera);
+	fingerprint[2] = CodeOffset(&UpdateSkinnedGeometry);
+}
+
+
+/******************** IS PERSISTENT NODE *************************/
+
+static Boolean IsPersistentNode(const ObjNode *theNode)
+{
+	return theNode == gCameraNode || theNode->Slot >= INFOBAR_SLOT;
+}
+
+
+/******************** HASH TERRAIN ITEMS *************************/
+
+static uint32_t HashTerrainItems(void)
+{
+uint32_t	hash = 2166136261u;
+
+	for (int i = 0; i < gNumTerrainItems; i++)
+	{
+		const TerrainItemEntryType* item = &gMasterItemList[i];
+		uint32_t v = ((uint32_t)item->x << 16) ^ item->y ^ ((uint32_t)item->type << 8);
+		hash = (hash ^ v) * 16777619u;
+	}
+	return hash;
+}
+
+
+/******************** FILL LEVEL HEADER *************************/
+//
+// Fills in the parts of the header that say which build & level the snapshot is for.
+//
+
+static void FillLevelHeader(SnapshotHeader *header)
+{
+	SDL_memset(header, 0, sizeof(*header));
+	SDL_snprintf(header->magic, sizeof(header->magic), "%s", SNAPSHOT_MAGIC);
+	header->objNodeSize = sizeof(ObjNode);
+	header->skeletonSize = SKELETON_SNAPSHOT_SIZE;
+	GetCodeFingerprint(header->codeFingerprint);
+	header->levelNum = gStartLevelNum;
+	header->terrainWidth = gTerrainTileWidth;
+	header->terrainDepth = gTerrainTileDepth;
+	header->numTerrainItems = gNumTerrainItems;
+	header->terrainItemHash = HashTerrainItems();
+}
+
+
+#pragma mark -
+
+/******************** NODE INDEX *************************/
+
+static int CompareNodeIndexEntries(const void *a, const void *b)
+{
+	uintptr_t pa = (uintptr_t) ((const NodeIndexEntry *) a)->node;
+	uintptr_t pb = (uintptr_t) ((const NodeIndexEntry *) b)->node;
+	return (pa > pb) - (pa < pb);
+}
+
+static void BuildNodeIndex(ObjNode **nodes, int numNodes)
+{
+	gNodeIndex = (NodeIndexEntry *) AllocPtr(sizeof(NodeIndexEntry) * (numNodes > 0 ? numNodes : 1));
+	GAME_ASSERT(gNodeIndex);
+
+	for (int i = 0; i < numNodes; i++)
+		gNodeIndex[i] = (NodeIndexEntry) { nodes[i], i };
+
+	gNodeIndexSize = numNodes;
+	SDL_qsort(gNodeIndex, numNodes, sizeof(NodeIndexEntry), CompareNodeIndexEntries);
+}
+
+static void DisposeNodeIndex(void)
+{
+	if (gNodeIndex)
+		DisposePtr((Ptr) gNodeIndex);
+	gNodeIndex = nil;
+	gNodeIndexSize = 0;
+}
+
+
+/******************** ENCODE REF *************************/
+//
+// Turns an ObjNode ptr into its index in the object list.
+// Refs to deleted nodes (already unlinked, waiting in the delete queue) aren't found and become nil.
+//
+
+static int32_t EncodeRef(const ObjNode *ref)
+{
+	if (ref == nil)
+		return NO_REF;
+
+	NodeIndexEntry key = { ref, 0 };
+	const NodeIndexEntry* found = SDL_bsearch(&key, gNodeIndex, gNodeIndexSize, sizeof(NodeIndexEntry), CompareNodeIndexEntries);
+	return found ? found->index : NO_REF;
+}
+
+static ObjNode *DecodeRef(ObjNode **nodes, int numNodes, int32_t ref)
+{
+	if (ref < 0 || ref >= numNodes)
+		return nil;
+	return nodes[ref];
+}
+
+
+/******************** GATHER OBJECT LIST *************************/
+//
+// Returns a new array of all ObjNodes in list order.
+//
+
+static ObjNode **GatherObjectList(int *outNumNodes)
+{
+ObjNode	*theNode;
+ObjNode	**nodes;
+int		n = 0;
+
+	for (theNode = gFirstNodePtr; theNode; theNode = theNode->NextNode)
+		n++;
+
+	nodes = (ObjNode **) AllocPtr(sizeof(ObjNode *) * (n > 0 ? n : 1));
+	GAME_ASSERT(nodes);
+
+	n = 0;
+	for (theNode = gFirstNodePtr; theNode; theNode = theNode->NextNode)
+		nodes[n++] = theNode;
+
+	*outNumNodes = n;
+	return nodes;
+}
+
+
+#pragma mark -
+
+/******************** GET GAME SNAPSHOT SPEC *************************/
+//
+// The --snapshot file if one was given, otherwise "Snapshot" in the prefs folder.
+//
+
+void GetGameSnapshotSpec(FSSpec *spec)
+{
+	if (gSnapshotFile[0] != '\0')
+		FSMakeCustomSpec(gSnapshotFile, spec);
+	else
+		MakePrefsFSSpec("Snapshot", spec);
+}
+
+
+/******************** SAVE GAME SNAPSHOT *************************/
+
+Boolean SaveGameSnapshot(FSSpec *spec)
+{
+ObjNode			**nodes;
+int				numNodes,numSkeletons = 0;
+long			size,count;
+Ptr				data,out;
+short			refNum;
+OSErr			iErr;
+SnapshotHeader	header;
+SnapshotGlobals	globals;
+
+	nodes = GatherObjectList(&numNodes);
+	BuildNodeIndex(nodes, numNodes);
+
+	for (int i = 0; i < numNodes; i++)
+	{
+		if (!IsPersistentNode(nodes[i]) && nodes[i]->Genre == SKELETON_GENRE)
+			numSkeletons++;
+	}
+
+	size = sizeof(SnapshotHeader) + sizeof(SnapshotGlobals)
+			+ sizeof(UInt16) * gNumTerrainItems
+			+ sizeof(SnapshotNode) * numNodes
+			+ SKELETON_SNAPSHOT_SIZE * numSkeletons;
+
+	data = AllocPtrClear(size);
+	GAME_ASSERT(data);
+	out = data;
+
+			/* HEADER */
+
+	FillLevelHeader(&header);
+	header.numNodes = numNodes;
+	SDL_memcpy(out, &header, sizeof(header));
+	out += sizeof(header);
+
+			/* GLOBALS */
+
+	SDL_memset(&globals, 0, sizeof(globals));
+
+	globals.myCoord				= gMyCoord;
+	globals.myStartX			= gMyStartX;
+	globals.myStartZ			= gMyStartZ;
+	globals.myHealth			= gMyHealth;
+	globals.lavaSmokeCounter	= gLavaSmokeCounter;
+	globals.shieldTimer			= gShieldTimer;
+	globals.latestPathTileNum	= gMyLatestPathTileNum;
+	globals.latestTileAttribs	= gMyLatestTileAttribs;
+	globals.myStartAim			= gMyStartAim;
+	globals.playerGotKilled		= gPlayerGotKilledFlag;
+	globals.floorY				= gMostRecentCharacterFloorY;
+	globals.heightOffGround		= gMyHeightOffGround;
+	globals.speedPuffCounter	= gMySpeedPuffCounter;
+
+	SDL_memcpy(globals.weaponInventory, gWeaponInventory, sizeof(globals.weaponInventory));
+	SDL_memcpy(globals.possibleAttackModes, gPossibleAttackModes, sizeof(globals.possibleAttackModes));
+	globals.currentAttackMode	= gCurrentAttackMode;
+	globals.autoFireCounter		= gAutoFireCounter;
+	globals.sonicScreamWave		= gSonicScreamWave;
+
+	globals.score				= gScore;
+	globals.numLives			= gNumLives;
+	globals.fuel				= gFuel;
+	globals.timeRemaining		= gTimeRemaining;
+	SDL_memcpy(globals.recoveredEggs, gRecoveredEggs, sizeof(globals.recoveredEggs));
+
+	globals.numEnemies			= gNumEnemies;
+	SDL_memcpy(globals.numEnemyOfKind, gNumEnemyOfKind, sizeof(globals.numEnemyOfKind));
+	GetItemPatchCounts(globals.itemPatchCounts);
+
+	globals.cameraMode			= gCameraMode;
+	globals.cameraViewYAngle	= gCameraViewYAngle;
+	globals.cameraFrom			= gGameViewInfoPtr->cameraPlacement.cameraLocation;
+	globals.cameraTo			= gGameViewInfoPtr->cameraPlacement.pointOfInterest;
+
+	GetMyRandomState(globals.randomState);
+
+	globals.playerObj			= EncodeRef(gPlayerObj);
+	globals.myTimePortal		= EncodeRef(gMyTimePortal);
+	globals.myShield			= EncodeRef(gMyShield);
+
+	SDL_memcpy(out, &globals, sizeof(globals));
+	out += sizeof(globals);
+
+			/* TERRAIN ITEM FLAGS */
+
+	for (int i = 0; i < gNumTerrainItems; i++)
+	{
+		SDL_memcpy(out, &gMasterItemList[i].flags, sizeof(UInt16));
+		out += sizeof(UInt16);
+	}
+
+			/* OBJECTS */
+
+	for (int i = 0; i < numNodes; i++)
+	{
+		const ObjNode* theNode = nodes[i];
+		SnapshotNode rec;
+
+		SDL_memset(&rec, 0, sizeof(rec));
+
+		if (IsPersistentNode(theNode))
+		{
+			rec.persistent = true;
+			rec.node.Slot = theNode->Slot;
+		}
+		else
+		{
+			rec.hasMoveCall				= theNode->MoveCall != nil;
+			rec.moveCall				= rec.hasMoveCall ? CodeOffset(theNode->MoveCall) : 0;
+			rec.hadCollisionTriangles	= theNode->CollisionTriangles != nil;
+			rec.wasPropBatched			= (theNode->StatusBits & STATUS_BIT_PROPBATCHED) != 0;
+			rec.chainNode				= EncodeRef(theNode->ChainNode);
+			rec.chainHead				= EncodeRef(theNode->ChainHead);
+			rec.shadowNode				= EncodeRef(theNode->ShadowNode);
+			rec.platformNode			= EncodeRef(theNode->PlatformNode);
+			rec.carriedObj				= EncodeRef(theNode->CarriedObj);
+			for (int j = 0; j < 6; j++)
+				rec.specialRef[j]		= EncodeRef(theNode->SpecialRef[j]);
+			rec.terrainItem				= theNode->TerrainItemPtr ? (int32_t)(theNode->TerrainItemPtr - gMasterItemList) : NO_REF;
+
+					/* COPY THE NODE, MINUS ITS POINTERS */
+
+			rec.node = *theNode;
+			rec.node.PrevNode = rec.node.NextNode = nil;
+			rec.node.ChainNode = rec.node.ChainHead = nil;
+			rec.node.ShadowNode = rec.node.PlatformNode = rec.node.CarriedObj = nil;
+			SDL_memset(rec.node.SpecialRef, 0, sizeof(rec.node.SpecialRef));
+			rec.node.MoveCall = nil;
+			rec.node.CollisionTriangles = nil;
+			rec.node.NumMeshes = 0;
+			SDL_memset(rec.node.MeshList, 0, sizeof(rec.node.MeshList));
+			SDL_memset(rec.node.OwnsMeshTexture, 0, sizeof(rec.node.OwnsMeshTexture));
+			SDL_memset(rec.node.OwnsMeshMemory, 0, sizeof(rec.node.OwnsMeshMemory));
+			rec.node.RenderModifiers.lodSet = nil;
+			rec.node.Skeleton = nil;
+			rec.node.TerrainItemPtr = nil;
+		}
+
+		SDL_memcpy(out, &rec, sizeof(rec));
+		out += sizeof(rec);
+
+		if (!rec.persistent && theNode->Genre == SKELETON_GENRE)
+		{
+			SDL_memcpy(out, theNode->Skeleton, SKELETON_SNAPSHOT_SIZE);
+			out += SKELETON_SNAPSHOT_SIZE;
+		}
+	}
+
+	GAME_ASSERT(out - data == size);
+
+	DisposeNodeIndex();
+	DisposePtr((Ptr) nodes);
+
+			/* WRITE FILE */
+
+	count = 0;
+
+	FSpDelete(spec);															// delete any existing file
+	iErr = FSpCreate(spec, 'NanO', 'Snap', smSystemScript);
+	if (iErr == noErr)
+		iErr = FSpOpenDF(spec, fsRdWrPerm, &refNum);
+	if (iErr == noErr)
+	{
+		count = size;
+		iErr = FSWrite(refNum, &count, data);
+		FSClose(refNum);
+	}
+
+	DisposePtr(data);
+
+	if (iErr || count != size)
+	{
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "SaveGameSnapshot: couldn't write snapshot (%d)", iErr);
+		FSpDelete(spec);
+		return false;
+	}
+
+	SDL_Log("Saved snapshot: %d objects, %d skeletons, %ld bytes", numNodes, numSkeletons, size);
+	return true;
+}
+
+
+#pragma mark -
+
+/******************** READ SNAPSHOT FILE *************************/
+
+static Ptr ReadSnapshotFile(FSSpec *spec, long *outSize)
+{
+short	refNum;
+long	size,count;
+Ptr		data;
+OSErr	iErr;
+
+	iErr = FSpOpenDF(spec, fsRdPerm, &refNum);
+	if (iErr)
+		return nil;
+
+	iErr = GetEOF(refNum, &size);
+	if (iErr || size < (long) (sizeof(SnapshotHeader) + sizeof(SnapshotGlobals)))
+	{
+		FSClose(refNum);
+		return nil;
+	}
+
+	data = AllocPtr(size);
+	GAME_ASSERT(data);
+
+	count = size;
+	iErr = FSRead(refNum, &count, data);
+	FSClose(refNum);
+
+	if (iErr || count != size)
+	{
+		DisposePtr(data);
+		return nil;
+	}
+
+	*outSize = size;
+	return data;
+}
+
+
+/******************** VALIDATE SNAPSHOT *************************/
+//
+// Walks the whole file before anything in the game is touched,
+// so a bad snapshot can't leave the level half-restored.
+//
+
+static Boolean ValidateSnapshot(Ptr data, long size, int numPersistent)
+{
+SnapshotHeader	expected;
+const SnapshotHeader* header = (const SnapshotHeader *) data;
+const char*		in;
+const char*		end = data + size;
+int				persistentSeen = 0;
+
+	FillLevelHeader(&expected);
+
+	if (SDL_memcmp(header->magic, expected.magic, sizeof(expected.magic)) != 0
+		|| header->objNodeSize != expected.objNodeSize
+		|| header->skeletonSize != expected.skeletonSize)
+	{
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "LoadGameSnapshot: not a snapshot from this version");
+		return false;
+	}
+
+	if (SDL_memcmp(header->codeFingerprint, expected.codeFingerprint, sizeof(expected.codeFingerprint)) != 0)
+	{
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "LoadGameSnapshot: snapshot was saved by a different build");
+		return false;
+	}
+
+	if (header->levelNum != expected.levelNum
+		|| header->terrainWidth != expected.terrainWidth
+		|| header->terrainDepth != expected.terrainDepth
+		|| header->numTerrainItems != expected.numTerrainItems
+		|| header->terrainItemHash != expected.terrainItemHash)
+	{
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "LoadGameSnapshot: snapshot is for a different level");
+		return false;
+	}
+
+	in = data + sizeof(SnapshotHeader) + sizeof(SnapshotGlobals) + sizeof(UInt16) * header->numTerrainItems;
+
+	for (int i = 0; i < header->numNodes; i++)
+	{
+		SnapshotNode rec;
+
+		if (in + sizeof(rec) > end)
+			goto truncated;
+		SDL_memcpy(&rec, in, sizeof(rec));
+		in += sizeof(rec);
+
+		if (rec.persistent)
+		{
+			persistentSeen++;
+			continue;
+		}
+
+		switch (rec.node.Genre)
+		{
+			case	SKELETON_GENRE:
+					if (in + SKELETON_SNAPSHOT_SIZE > end)
+						goto truncated;
+					in += SKELETON_SNAPSHOT_SIZE;
+					break;
+
+			case	DISPLAY_GROUP_GENRE:
+					if (rec.node.Group >= MAX_3DMF_GROUPS
+						|| rec.node.Type >= gNumObjectsInGroupList[rec.node.Group])
+					{
+						SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "LoadGameSnapshot: object %d uses a model that isn't loaded", i);
+						return false;
+					}
+					break;
+
+			case	EVENT_GENRE:
+					break;
+
+			default:
+					SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "LoadGameSnapshot: object %d has a bad genre", i);
+					return false;
+		}
+
+		if (rec.terrainItem >= header->numTerrainItems)
+			goto truncated;
+	}
+
+	if (in != end)
+		goto truncated;
+
+	if (persistentSeen != numPersistent)
+	{
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "LoadGameSnapshot: camera/infobar objects don't match");
+		return false;
+	}
+
+	return true;
+
+truncated:
+	SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "LoadGameSnapshot: snapshot is corrupt");
+	return false;
+}
+
+
+/******************** DELETE NON-PERSISTENT OBJECTS *************************/
+
+static void DeleteNonPersistentObjects(void)
+{
+ObjNode	*theNode = gFirstNodePtr;
+
+	while (theNode)
+	{
+		if (IsPersistentNode(theNode))
+		{
+			theNode = theNode->NextNode;
+			continue;
+		}
+
+		StopObjectStreamEffect(theNode);
+		DeleteObject(theNode);							// may take chained & shadow nodes along with it,
+		theNode = gFirstNodePtr;						// so start over from the top
+	}
+}
+
+
+/******************** RECREATE OBJECT *************************/
+//
+// Makes a fresh node of the saved kind (so it gets its own meshes/skeleton)
+// and then copies the saved fields over everything but the node's resources.
+//
+
+static ObjNode *RecreateObject(const SnapshotNode *rec, const char **skeletonData)
+{
+const ObjNode	*saved = &rec->node;
+ObjNode			*newObj;
+ObjNode			keep;
+
+	gNewObjectDefinition.genre		= saved->Genre;
+	gNewObjectDefinition.group		= saved->Group;
+	gNewObjectDefinition.type		= saved->Type;
+	gNewObjectDefinition.animNum	= 0;
+	gNewObjectDefinition.coord		= saved->Coord;
+	gNewObjectDefinition.flags		= saved->StatusBits & ~STATUS_BIT_PROPBATCHED;
+	gNewObjectDefinition.slot		= saved->Slot;
+	gNewObjectDefinition.moveCall	= nil;
+	gNewObjectDefinition.rot		= saved->Rot.y;
+	gNewObjectDefinition.scale		= saved->Scale.x;
+
+	switch (saved->Genre)
+	{
+		case	SKELETON_GENRE:
+				SDL_memcpy(&gNewObjectDefinition.animNum, *skeletonData + offsetof(SkeletonObjDataType, AnimNum), sizeof(Byte));
+				newObj = MakeNewSkeletonObject(&gNewObjectDefinition);
+				break;
+
+		case	DISPLAY_GROUP_GENRE:
+				newObj = MakeNewDisplayGroupObject(&gNewObjectDefinition);
+				break;
+
+		default:
+				newObj = MakeNewObject(&gNewObjectDefinition);
+				break;
+	}
+	GAME_ASSERT(newObj);
+
+			/* OVERWRITE WITH SAVED FIELDS */
+
+	keep = *newObj;
+
+	*newObj = *saved;
+	newObj->PrevNode = keep.PrevNode;
+	newObj->NextNode = keep.NextNode;
+	newObj->NumMeshes = keep.NumMeshes;
+	SDL_memcpy(newObj->MeshList, keep.MeshList, sizeof(keep.MeshList));
+	SDL_memcpy(newObj->OwnsMeshTexture, keep.OwnsMeshTexture, sizeof(keep.OwnsMeshTexture));
+	SDL_memcpy(newObj->OwnsMeshMemory, keep.OwnsMeshMemory, sizeof(keep.OwnsMeshMemory));
+	newObj->RenderModifiers.lodSet = keep.RenderModifiers.lodSet;
+	newObj->HasBakedLighting = keep.HasBakedLighting;				// goes with the meshes
+	newObj->Skeleton = keep.Skeleton;
+
+	newObj->StatusBits &= ~STATUS_BIT_PROPBATCHED;					// re-added once the transform is back
+	newObj->StreamingEffect = -1;									// channels don't survive
+	newObj->XformRotOrder = XFORM_NEEDS_REBUILD;
+
+	if (saved->Genre == SKELETON_GENRE)
+	{
+		const SkeletonDefType* skeletonDef = newObj->Skeleton->skeletonDefinition;
+
+		SDL_memcpy(newObj->Skeleton, *skeletonData, SKELETON_SNAPSHOT_SIZE);
+		*skeletonData += SKELETON_SNAPSHOT_SIZE;
+
+		newObj->Skeleton->skeletonDefinition = skeletonDef;
+		newObj->Skeleton->poseStamp = 1;
+		newObj->Skeleton->jointWorldStamp = 0;
+	}
+
+	return newObj;
+}
+
+
+/******************** LOAD GAME SNAPSHOT *************************/
+//
+// Must be called in the middle of a level (between InitLevel and CleanupLevel),
+// outside of MoveObjects.
+//
+// OUTPUT:	false if the snapshot couldn't be read or doesn't fit this level; the game is left untouched.
+//
+
+Boolean LoadGameSnapshot(FSSpec *spec)
+{
+Ptr				data;
+long			size;
+const char		*in;
+const SnapshotHeader	*header;
+SnapshotGlobals	globals;
+ObjNode			**persistentNodes,**nodes;
+const char		*recordStart;
+int				numCurrent,numPersistent = 0,numNodes;
+int				p = 0;
+
+	data = ReadSnapshotFile(spec, &size);
+	if (!data)
+	{
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "LoadGameSnapshot: couldn't read snapshot");
+		return false;
+	}
+
+			/* GET THE OBJECTS WE KEEP */
+
+	persistentNodes = GatherObjectList(&numCurrent);
+	for (int i = 0; i < numCurrent; i++)
+	{
+		if (IsPersistentNode(persistentNodes[i]))
+			persistentNodes[numPersistent++] = persistentNodes[i];
+	}
+
+	if (!ValidateSnapshot(data, size, numPersistent))
+	{
+		DisposePtr((Ptr) persistentNodes);
+		DisposePtr(data);
+		return false;
+	}
+
+	header = (const SnapshotHeader *) data;
+	numNodes = header->numNodes;
+	in = data + sizeof(SnapshotHeader);
+
+	SDL_memcpy(&globals, in, sizeof(globals));
+	in += sizeof(globals);
+
+			/* CLEAR OUT THE CURRENT GAME */
+
+	DeleteNonPersistentObjects();
+
+			/* MOVE THE TERRAIN TO WHERE THE PLAYER WAS */
+			//
+			// Every item is flagged in-use while priming so that nothing gets added,
+			// then the saved flags go back in.
+			//
+
+	gMyCoord = globals.myCoord;
+
+	for (int i = 0; i < gNumTerrainItems; i++)
+		gMasterItemList[i].flags |= ITEM_FLAGS_INUSE;
+
+	RecenterTerrainOnPlayer();
+
+	for (int i = 0; i < gNumTerrainItems; i++)
+	{
+		SDL_memcpy(&gMasterItemList[i].flags, in, sizeof(UInt16));
+		in += sizeof(UInt16);
+	}
+
+			/* RECREATE THE OBJECTS */
+
+	nodes = (ObjNode **) AllocPtr(sizeof(ObjNode *) * (numNodes > 0 ? numNodes : 1));
+	GAME_ASSERT(nodes);
+
+	recordStart = in;
+
+	for (int i = 0; i < numNodes; i++)
+	{
+		SnapshotNode rec;
+		SDL_memcpy(&rec, in, sizeof(rec));
+		in += sizeof(rec);
+
+		if (rec.persistent)
+			nodes[i] = persistentNodes[p++];
+		else
+			nodes[i] = RecreateObject(&rec, &in);
+	}
+
+			/* HOOK UP THE LINKS */
+
+	in = recordStart;
+	for (int i = 0; i < numNodes; i++)
+	{
+		SnapshotNode rec;
+		SDL_memcpy(&rec, in, sizeof(rec));
+		in += sizeof(rec);
+
+		if (rec.persistent)
+			continue;
+		if (rec.node.Genre == SKELETON_GENRE)
+			in += SKELETON_SNAPSHOT_SIZE;
+
+		ObjNode* theNode = nodes[i];
+
+		theNode->MoveCall		= rec.hasMoveCall ? (void (*)(ObjNode *)) ((intptr_t) &MoveObjects + (intptr_t) rec.moveCall) : nil;
+		theNode->ChainNode		= DecodeRef(nodes, numNodes, rec.chainNode);
+		theNode->ChainHead		= DecodeRef(nodes, numNodes, rec.chainHead);
+		theNode->ShadowNode		= DecodeRef(nodes, numNodes, rec.shadowNode);
+		theNode->PlatformNode	= DecodeRef(nodes, numNodes, rec.platformNode);
+		theNode->CarriedObj		= DecodeRef(nodes, numNodes, rec.carriedObj);
+		for (int j = 0; j < 6; j++)
+			theNode->SpecialRef[j] = DecodeRef(nodes, numNodes, rec.specialRef[j]);
+		theNode->TerrainItemPtr	= rec.terrainItem >= 0 ? &gMasterItemList[rec.terrainItem] : nil;
+
+				/* REBUILD WHAT'S DERIVED FROM THE TRANSFORM */
+
+		UpdateObjectTransforms(theNode);
+
+		if (theNode->Skeleton)
+			UpdateSkinnedGeometry(theNode);
+
+		if (rec.hadCollisionTriangles)
+			CreateCollisionTrianglesForObject(theNode);
+
+		if (rec.wasPropBatched)
+			PropBatch_AddNode(theNode);
+	}
+
+			/* PUT THE LIST BACK IN THE SAVED ORDER */
+
+	numCurrent = 0;
+	for (ObjNode* theNode = gFirstNodePtr; theNode; theNode = theNode->NextNode)
+		numCurrent++;
+	GAME_ASSERT_MESSAGE(numCurrent == numNodes, "LoadGameSnapshot: stray objects were made while restoring");
+
+	for (int i = 0; i < numNodes; i++)
+	{
+		nodes[i]->PrevNode = i > 0 ? nodes[i-1] : nil;
+		nodes[i]->NextNode = i < numNodes-1 ? nodes[i+1] : nil;
+	}
+	gFirstNodePtr = numNodes > 0 ? nodes[0] : nil;
+	gCurrentNode = nil;
+
+			/* RESTORE GLOBALS */
+
+	gMyStartX					= globals.myStartX;
+	gMyStartZ					= globals.myStartZ;
+	gMyHealth					= globals.myHealth;
+	gLavaSmokeCounter			= globals.lavaSmokeCounter;
+	gShieldTimer				= globals.shieldTimer;
+	gMyLatestPathTileNum		= globals.latestPathTileNum;
+	gMyLatestTileAttribs		= globals.latestTileAttribs;
+	gMyStartAim					= globals.myStartAim;
+	gPlayerGotKilledFlag		= globals.playerGotKilled;
+	gMostRecentCharacterFloorY	= globals.floorY;
+	gMyHeightOffGround			= globals.heightOffGround;
+	gMySpeedPuffCounter			= globals.speedPuffCounter;
+
+	SDL_memcpy(gWeaponInventory, globals.weaponInventory, sizeof(globals.weaponInventory));
+	SDL_memcpy(gPossibleAttackModes, globals.possibleAttackModes, sizeof(globals.possibleAttackModes));
+	gCurrentAttackMode			= globals.currentAttackMode;
+	gAutoFireCounter			= globals.autoFireCounter;
+	gSonicScreamWave			= globals.sonicScreamWave;
+
+	gScore						= globals.score;
+	gNumLives					= globals.numLives;
+	gFuel						= globals.fuel;
+	gTimeRemaining				= globals.timeRemaining;
+	SDL_memcpy(gRecoveredEggs, globals.recoveredEggs, sizeof(globals.recoveredEggs));
+
+	gNumEnemies					= globals.numEnemies;
+	SDL_memcpy(gNumEnemyOfKind, globals.numEnemyOfKind, sizeof(globals.numEnemyOfKind));
+	SetItemPatchCounts(globals.itemPatchCounts);
+
+	gCameraMode					= globals.cameraMode;
+	gCameraViewYAngle			= globals.cameraViewYAngle;
+	QD3D_UpdateCameraFromTo(gGameViewInfoPtr, &globals.cameraFrom, &globals.cameraTo);
+
+	gPlayerObj					= DecodeRef(nodes, numNodes, globals.playerObj);
+	gMyTimePortal				= DecodeRef(nodes, numNodes, globals.myTimePortal);
+	gMyShield					= DecodeRef(nodes, numNodes, globals.myShield);
+
+	gInfobarUpdateBits = UPDATE_WEAPONICON | UPDATE_SCORE | UPDATE_FUEL | UPDATE_IMPACTTIME
+						| UPDATE_HEALTH | UPDATE_EGGS | UPDATE_LIVES;
+
+	SetMyRandomState(globals.randomState);							// last, since making the objects rolled some numbers
+
+	SDL_Log("Loaded snapshot: %d objects", numNodes);
+
+	DisposePtr((Ptr) nodes);
+	DisposePtr((Ptr) persistentNodes);
+	DisposePtr(data);
+	return true;
+}
@@ -698,6 +698,29 @@ void DoSoundMaintenance(void)
 
 
 
+/******************** GET SOUND CHANNEL USAGE *************************/
+//
+// For the metrics export: how many effect channels are playing right now, out of how many.
+//
+
+void GetSoundChannelUsage(int *numBusy, int *numChannels)
+{
+SCStatus	theStatus;
+
+	*numBusy = 0;
+	*numChannels = gMaxChannels;
+
+	for (int c = 0; c < gMaxChannels; c++)
+	{
+		if (SndChannelStatus(gSndChannel[c],sizeof(SCStatus),&theStatus) == noErr
+			&& theStatus.scChannelBusy)
+		{
+			(*numBusy)++;
+		}
+	}
+}
+
+
 /******************** FIND SILENT CHANNEL *************************/
 
 static short FindSilentChannel(void)
@@ -325,33 +325,361 @@ OSErr ReadTGA(const FSSpec* spec, uint8_t** outPtr, TGAHeader* outHeader, bool f
 	return noErr;
 }
 
-PicHandle GetPictureFromTGA(const FSSpec* spec)
+#pragma mark -
+
+/****************** DECODE TGA IN MEMORY *********************/
+//
+// Decodes a whole TGA file that's already in memory straight into top-down ARGB32,
+// in one pass (RLE, palette, flip & conversion all at once).
+//
+// Doesn't allocate and doesn't raise fatal alerts -- bad data just returns badFormat --
+// so it's safe to run on a worker thread.  argbOut must hold 4*width*height bytes.
+//
+
+static OSErr ParseTGAHeader(const uint8_t* fileData, long fileLength, TGAHeader* header)
 {
-	uint8_t* pixelData;
-	TGAHeader header;
+	if (fileLength < (long) sizeof(TGAHeader))
+		return badFormat;
 
-	OSErr err = ReadTGA(spec, &pixelData, &header, true);
+	SDL_memcpy(header, fileData, sizeof(TGAHeader));
+	UnpackStructs("<8B4H2B", sizeof(TGAHeader), 1, header);
 
-	if (err)
+	switch (header->imageType)
+	{
+		case TGA_IMAGETYPE_RAW_CMAP:
+		case TGA_IMAGETYPE_RLE_CMAP:
+			if (header->bpp != 8 || header->paletteBitsPerColor != 24)
+				return badFormat;
+			break;
+
+		case TGA_IMAGETYPE_RAW_GRAYSCALE:
+		case TGA_IMAGETYPE_RLE_GRAYSCALE:
+			if (header->bpp != 8)
+				return badFormat;
+			break;
+
+		case TGA_IMAGETYPE_RAW_BGR:
+		case TGA_IMAGETYPE_RLE_BGR:
+			if (header->bpp != 16 && header->bpp != 24 && header->bpp != 32)
+				return badFormat;
+			break;
+
+		default:
+			return badFormat;
+	}
+
+	if (header->width == 0 || header->height == 0)
+		return badFormat;
+
+	return noErr;
+}
+
+static inline void PixelToARGB(uint8_t* argb, const uint8_t* in, int bpp)
+{
+	switch (bpp)
+	{
+		case 32:	// BGRA
+			argb[0] = in[3];
+			argb[1] = in[2];
+			argb[2] = in[1];
+			argb[3] = in[0];
+			break;
+
+		case 24:	// BGR
+			argb[0] = 0xFF;
+			argb[1] = in[2];
+			argb[2] = in[1];
+			argb[3] = in[0];
+			break;
+
+		case 16:	// little-endian RGB16
+		{
+			uint16_t inRGB16 = in[0] | (in[1] << 8);
+			argb[0] = 0xFF;
+			argb[1] = (((inRGB16 >> 10) & 0b11111) * 255) / 31;
+			argb[2] = (((inRGB16 >> 5) & 0b11111) * 255) / 31;
+			argb[3] = (((inRGB16 >> 0) & 0b11111) * 255) / 31;
+			break;
+		}
+
+		default:	// grayscale
+			argb[0] = 0xFF;
+			argb[1] = in[0];
+			argb[2] = in[0];
+			argb[3] = in[0];
+			break;
+	}
+}
+
+static OSErr DecodeTGAToARGB(const uint8_t* fileData, long fileLength, const TGAHeader* header, uint8_t* argbOut)
+{
+	const uint8_t*			in				= fileData + sizeof(TGAHeader) + header->idFieldLength;
+	const uint8_t* const	eod				= fileData + fileLength;
+	const uint8_t*			palette			= nil;
+	int						paletteCount	= 0;
+	const Boolean			compressed		= header->imageType & 8;
+	const Boolean			needFlip		= 0 == (header->imageDescriptor & (1u << 5u));
+	const long				width			= header->width;
+	const long				height			= header->height;
+	const long				pixelCount		= width * height;
+	const int				bytesPerPixel	= header->bpp / 8;
+
+	if (header->imageType == TGA_IMAGETYPE_RAW_CMAP || header->imageType == TGA_IMAGETYPE_RLE_CMAP)
 	{
+		paletteCount = header->paletteColorCountLo | ((uint16_t)header->paletteColorCountHi << 8);
+		if (paletteCount > 256 || header->paletteOriginLo != 0 || header->paletteOriginHi != 0)
+			return badFormat;
+
+		palette = in;
+		in += paletteCount * 3;
+	}
+
+	long		x = 0;
+	long		y = 0;
+	uint8_t*	outRow = argbOut + 4 * width * (needFlip ? height - 1 : 0);
+
+	for (long p = 0; p < pixelCount; )
+	{
+		long	packetLength	= pixelCount;				// uncompressed: one big raw "packet"
+		Boolean	isRun			= false;
+
+		if (compressed)
+		{
+			if (in >= eod)
+				return badFormat;
+
+			uint8_t packetHeader = *(in++);
+			packetLength	= 1 + (packetHeader & 0x7F);
+			isRun			= 0 != (packetHeader & 0x80);
+
+			if (p + packetLength > pixelCount)
+				return badFormat;
+		}
+
+		long packetBytes = isRun ? bytesPerPixel : packetLength * bytesPerPixel;
+		if (in > eod || eod - in < packetBytes)
+			return badFormat;
+
+		for (long i = 0; i < packetLength; i++)
+		{
+			const uint8_t* src = isRun ? in : in + i * bytesPerPixel;
+
+			if (palette)
+			{
+				if (*src >= paletteCount)
+					return badFormat;
+				PixelToARGB(outRow + 4 * x, palette + 3 * (*src), 24);
+			}
+			else
+			{
+				PixelToARGB(outRow + 4 * x, src, header->bpp);
+			}
+
+			if (++x == width)								// next row
+			{
+				x = 0;
+				y++;
+				if (y < height)
+					outRow = argbOut + 4 * width * (needFlip ? height - 1 - y : y);
+			}
+		}
+
+		in += packetBytes;
+		p += packetLength;
+	}
+
+	return noErr;
+}
+
+
+/****************** NEW PICTURE FOR TGA *********************/
+//
+// Reads a TGA file into memory and allocates a PicHandle of the right size for it,
+// without decoding the pixels yet.  Returns nil if the file is missing or unsupported.
+//
+
+static PicHandle NewPictureForTGA(const FSSpec* spec, Ptr* outFileData, long* outFileLength, TGAHeader* outHeader)
+{
+	short	refNum;
+	long	fileLength = 0;
+	Ptr		fileData;
+
+	if (noErr != FSpOpenDF(spec, fsRdPerm, &refNum))
+		return nil;
+
+	GetEOF(refNum, &fileLength);
+	fileData = NewPtr(fileLength);
+	OSErr err = FSRead(refNum, &fileLength, fileData);
+	FSClose(refNum);
+
+	if (err != noErr || noErr != ParseTGAHeader((const uint8_t*) fileData, fileLength, outHeader))
+	{
+		DisposePtr(fileData);
 		return nil;
 	}
 
-	int payloadSize = 4 * header.width * header.height;
+	int payloadSize = 4 * outHeader->width * outHeader->height;
 
 	// Tack the data onto the end of the Picture struct,
 	// so that DisposeHandle frees both the Picture and the data.
 	PicHandle picHandle = (PicHandle) NewHandle((int) (sizeof(Picture) + payloadSize));
 
 	PicPtr picPtr = *picHandle;
-	Ptr picPixels = (Ptr)*picHandle + sizeof(Picture);
-
-	picPtr->picFrame = (Rect) { 0, 0, (SInt16) header.height, (SInt16) header.width };
+	picPtr->picFrame = (Rect) { 0, 0, (SInt16) outHeader->height, (SInt16) outHeader->width };
 	picPtr->picSize = -1;
-	picPtr->__pomme_pixelsARGB32 = picPixels;
+	picPtr->__pomme_pixelsARGB32 = (Ptr)*picHandle + sizeof(Picture);
+
+	*outFileData = fileData;
+	*outFileLength = fileLength;
+	return picHandle;
+}
+
+
+/****************** GET PICTURE FROM TGA *********************/
+
+PicHandle GetPictureFromTGA(const FSSpec* spec)
+{
+	Ptr			fileData;
+	long		fileLength;
+	TGAHeader	header;
+
+	PicHandle picHandle = NewPictureForTGA(spec, &fileData, &fileLength, &header);
+	if (!picHandle)
+		return nil;
+
+	OSErr err = DecodeTGAToARGB((const uint8_t*) fileData, fileLength, &header, (uint8_t*) (**picHandle).__pomme_pixelsARGB32);
+	DisposePtr(fileData);
+
+	if (err)
+	{
+		DisposeHandle((Handle) picHandle);
+		return nil;
+	}
+
+	return picHandle;
+}
+
+
+#pragma mark -
+
+/****************** PRELOAD PICTURE FROM TGA *********************/
+//
+// Starts decoding a full-screen picture on a worker thread, so that it's ready by the time
+// GetPreloadedPictureFromTGA asks for it (e.g. the next slide, or the boot screens while
+// SDL & OpenGL start up).  The file is read and the PicHandle allocated on the calling
+// thread; the worker only decodes pixels into it.
+//
+// If there's no free slot, the picture will simply be loaded synchronously later.
+// If threads aren't available, the picture is decoded right away.
+//
+
+#define	MAX_TGA_PRELOADS	4
+
+typedef struct
+{
+	Boolean		inUse;
+	FSSpec		spec;
+	Ptr			fileData;
+	long		fileLength;
+	TGAHeader	header;
+	PicHandle	picture;
+	SDL_Thread*	thread;
+	OSErr		decodeErr;
+}TGAPreloadType;
+
+static TGAPreloadType	gTGAPreloads[MAX_TGA_PRELOADS];
+
+static int SDLCALL TGAPreloadThread(void* data)
+{
+	TGAPreloadType* preload = (TGAPreloadType*) data;
+
+	preload->decodeErr = DecodeTGAToARGB(
+			(const uint8_t*) preload->fileData,
+			preload->fileLength,
+			&preload->header,
+			(uint8_t*) (**preload->picture).__pomme_pixelsARGB32);
+
+	return 0;
+}
+
+static TGAPreloadType* FindTGAPreload(const FSSpec* spec)
+{
+	for (int i = 0; i < MAX_TGA_PRELOADS; i++)
+	{
+		TGAPreloadType* preload = &gTGAPreloads[i];
+
+		if (preload->inUse
+			&& preload->spec.vRefNum == spec->vRefNum
+			&& preload->spec.parID == spec->parID
+			&& 0 == SDL_strcmp(preload->spec.cName, spec->cName))
+		{
+			return preload;
+		}
+	}
+
+	return nil;
+}
+
+void PreloadPictureFromTGA(const FSSpec* spec)
+{
+	TGAPreloadType* preload = nil;
+
+	if (FindTGAPreload(spec))							// already on its way
+		return;
+
+	for (int i = 0; i < MAX_TGA_PRELOADS && !preload; i++)
+	{
+		if (!gTGAPreloads[i].inUse)
+			preload = &gTGAPreloads[i];
+	}
+
+	if (!preload)
+		return;
+
+	SDL_memset(preload, 0, sizeof(*preload));
+
+	preload->picture = NewPictureForTGA(spec, &preload->fileData, &preload->fileLength, &preload->header);
+	if (!preload->picture)								// let GetPictureFromTGA report it later
+		return;
+
+	preload->spec = *spec;
+	preload->inUse = true;
+	preload->thread = SDL_CreateThread(TGAPreloadThread, "TGAPreload", preload);
+
+	if (!preload->thread)
+		TGAPreloadThread(preload);
+}
+
+
+/****************** GET PRELOADED PICTURE FROM TGA *********************/
+//
+// Returns a picture started by PreloadPictureFromTGA, waiting for its decoder to finish
+// if need be.  Pictures that weren't preloaded are loaded synchronously.
+// Either way, the caller owns the returned PicHandle.
+//
+
+PicHandle GetPreloadedPictureFromTGA(const FSSpec* spec)
+{
+	TGAPreloadType* preload = FindTGAPreload(spec);
+
+	if (!preload)
+		return GetPictureFromTGA(spec);
+
+	if (preload->thread)
+		SDL_WaitThread(preload->thread, NULL);
+
+	PicHandle picHandle = preload->picture;
+
+	DisposePtr(preload->fileData);
+
+	if (preload->decodeErr)
+	{
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Couldn't decode %s", spec->cName);
+		DisposeHandle((Handle) picHandle);
+		picHandle = nil;
+	}
 
-	SDL_memcpy(picPixels, pixelData, payloadSize);
-	DisposePtr((Ptr) pixelData);
+	SDL_memset(preload, 0, sizeof(*preload));
 
 	return picHandle;
 }
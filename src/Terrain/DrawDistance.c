@@ -0,0 +1,192 @@
+/****************************/
+/*   	DRAW DISTANCE.C	    */
+/****************************/
+//
+// SetProModeSettings picks one yon distance and one supertile active range per game mode,
+// whatever the machine.  When the "Draw Distance" pref is set to adaptive, this watches
+// the frame time and slides the yon (and the fog with it) between fixed bounds:
+// pull it in quickly when frames run long, push it out slowly while there's headroom.
+//
+// The supertile active range follows along in whole steps.  It only grows once the yon has sat
+// against what the current range can show for a while, and only shrinks once the yon has come
+// well inside what a smaller range covers.  Changing it means re-priming the terrain
+// (see SetSuperTileActiveRange), which is a hitch, so it's rate-limited too.
+//
+
+
+/****************************/
+/*    EXTERNALS             */
+/****************************/
+
+#include "game.h"
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	DRAWDIST_MIN_RANGE			2						// never keep fewer supertiles than this around the player
+#define	DRAWDIST_EXTRA_RANGE		1						// may go this many supertiles past the game mode's default
+#define	DRAWDIST_MIN_YON			1100.0f
+
+#define	DRAWDIST_SLOW_FACTOR		1.25f					// frame time above target * this = too slow
+#define	DRAWDIST_FAST_FACTOR		1.08f					// frame time below target * this = headroom
+#define	DRAWDIST_SHRINK_SPEED		900.0f					// yon units/sec to pull in when too slow
+#define	DRAWDIST_GROW_SPEED			120.0f					// yon units/sec to push out when there's headroom
+#define	DRAWDIST_GROW_HOLD			4.0f					// secs to wait after pulling in before pushing out again
+#define	DRAWDIST_RANGE_UP_DELAY		5.0f					// secs yon must be pinned at the range's limit before growing the range
+#define	DRAWDIST_RANGE_COOLDOWN		10.0f					// min secs between two range changes
+#define	DRAWDIST_MAX_SAMPLE			.25f					// ignore frames longer than this (pauses, loads, our own re-primes)
+
+#define	YonForRange(_r)				((float)(_r) * TERRAIN_SUPERTILE_UNIT_SIZE)		// farthest yon a given active range has terrain for
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+static	int		gDefaultActiveRange;
+static	float	gDefaultYon;
+
+static	float	gCurrentYon;
+static	float	gSmoothedFrameTime;
+static	float	gTargetFrameTime;
+static	float	gGrowHoldTimer;
+static	float	gPinnedTimer;
+static	float	gRangeCooldownTimer;
+
+
+/******************** INIT DRAW DISTANCE *************************/
+//
+// Called at level start, once the terrain has been primed with the game mode's default range.
+//
+
+void InitDrawDistance(QD3DSetupOutputType *setupInfo)
+{
+SDL_DisplayID			display;
+const SDL_DisplayMode	*mode;
+
+	gDefaultActiveRange = SUPERTILE_ACTIVE_RANGE;
+	gDefaultYon = setupInfo->yon;
+
+	gCurrentYon = gDefaultYon;
+	gGrowHoldTimer = 0;
+	gPinnedTimer = 0;
+	gRangeCooldownTimer = DRAWDIST_RANGE_COOLDOWN;
+
+			/* AIM FOR THE DISPLAY'S REFRESH RATE */
+			//
+			// With v-sync on, frames never come in faster than this, so
+			// "at target" has to count as headroom.
+			//
+
+	gTargetFrameTime = 1.0f / 60.0f;
+
+	display = SDL_GetDisplayForWindow(gSDLWindow);
+	mode = display ? SDL_GetCurrentDisplayMode(display) : nil;
+	if (mode && mode->refresh_rate > 0)
+		gTargetFrameTime = 1.0f / mode->refresh_rate;
+
+	gSmoothedFrameTime = gTargetFrameTime;
+}
+
+
+/******************** RESET DRAW DISTANCE *************************/
+//
+// Puts the game mode's active range back, so the next level loads with it.
+// Call after DisposeTerrain (the supertile list was allocated for the current range).
+//
+
+void ResetDrawDistance(void)
+{
+	if (gDefaultActiveRange > 0)
+		SUPERTILE_ACTIVE_RANGE = gDefaultActiveRange;
+}
+
+
+/******************** UPDATE DRAW DISTANCE *************************/
+//
+// Called once per frame after QD3D_CalcFramesPerSecond.
+//
+
+void UpdateDrawDistance(QD3DSetupOutputType *setupInfo)
+{
+float	frameTime = gFramesPerSecondFrac;
+float	yon;
+int		range = SUPERTILE_ACTIVE_RANGE;
+int		maxRange = gDefaultActiveRange + DRAWDIST_EXTRA_RANGE;
+
+			/* SEE IF FIXED */
+
+	if (!gGamePrefs.adaptiveDrawDistance)
+	{
+		if (range != gDefaultActiveRange)
+			SetSuperTileActiveRange(gDefaultActiveRange);
+		if (setupInfo->yon != gDefaultYon)
+			QD3D_SetYon(setupInfo, gDefaultYon);
+		gCurrentYon = gDefaultYon;
+		return;
+	}
+
+	if (gRangeCooldownTimer > 0)
+		gRangeCooldownTimer -= frameTime;
+
+	if (frameTime > DRAWDIST_MAX_SAMPLE)										// not representative
+		return;
+
+	gSmoothedFrameTime += (frameTime - gSmoothedFrameTime) * .1f;
+
+			/* SLIDE THE YON */
+
+	yon = gCurrentYon;
+
+	if (gSmoothedFrameTime > gTargetFrameTime * DRAWDIST_SLOW_FACTOR)			// too slow: pull in
+	{
+		yon -= DRAWDIST_SHRINK_SPEED * frameTime;
+		gGrowHoldTimer = DRAWDIST_GROW_HOLD;
+	}
+	else
+	if (gSmoothedFrameTime < gTargetFrameTime * DRAWDIST_FAST_FACTOR)			// headroom: push out
+	{
+		if (gGrowHoldTimer > 0)
+			gGrowHoldTimer -= frameTime;
+		else
+			yon += DRAWDIST_GROW_SPEED * frameTime;
+	}
+
+	if (yon < DRAWDIST_MIN_YON)
+		yon = DRAWDIST_MIN_YON;
+	if (yon > YonForRange(range))												// can't see past the terrain we have
+		yon = YonForRange(range);
+
+			/* SEE IF ACTIVE RANGE SHOULD FOLLOW */
+
+	if (yon >= YonForRange(range) && gGrowHoldTimer <= 0)						// pinned against this range's limit
+		gPinnedTimer += frameTime;
+	else
+		gPinnedTimer = 0;
+
+	if (gRangeCooldownTimer <= 0)
+	{
+		if (range < maxRange && gPinnedTimer > DRAWDIST_RANGE_UP_DELAY)
+		{
+			range++;
+		}
+		else
+		if (range > DRAWDIST_MIN_RANGE && yon < YonForRange(range-1) * .9f)		// a smaller range covers it with room to spare
+		{
+			range--;
+		}
+
+		if (range != SUPERTILE_ACTIVE_RANGE)
+		{
+			SetSuperTileActiveRange(range);
+			gRangeCooldownTimer = DRAWDIST_RANGE_COOLDOWN;
+			gPinnedTimer = 0;
+		}
+	}
+
+	gCurrentYon = yon;
+	if (setupInfo->yon != yon)
+		QD3D_SetYon(setupInfo, yon);
+}
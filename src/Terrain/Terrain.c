@@ -30,8 +30,22 @@ static inline void ReleaseSuperTileObject(int superTileNum);
 static void CalcNewItemDeleteWindow(void);
 static float GetTerrainHeightAtRowCol(int row, int col);
 static void CreateSuperTileMemoryList(void);
+static void DisposeSuperTileMemoryList(void);
+static void DisposeScrollBuffer(void);
 static int BuildTerrainSuperTile(int startCol, int startRow);
+static int StartSuperTile(int startCol, int startRow);
+static void BuildSuperTileGeometry(SuperTileMemoryType* superTilePtr, TQ3Point3D workGrid[SUPERTILE_SIZE+1][SUPERTILE_SIZE+1]);
+static void SampleSuperTileHeights(int startRow, int startCol, float heights[SUPERTILE_SIZE+3][SUPERTILE_SIZE+3]);
+#if _DEBUG
+static void CheckSuperTileGeometry(const SuperTileMemoryType* superTilePtr);
+#endif
 static void UpdateSuperTileTexture(SuperTileMemoryType* superTilePtr);
+static const UInt16* DrawSuperTileTexture(SuperTileMemoryType* superTilePtr, UInt16* buffer);
+static void UploadSuperTileTexture(const SuperTileMemoryType* superTilePtr, const UInt16* textureData);
+static int FillScrollWindow(void);
+static void BuildSuperTilesInParallel(const int* superTileNums, int count);
+static void AddItemsInItemWindow(void);
+static void JumpScrollWindow(int superRow, int superCol);
 static void DrawTileIntoMipmap(UInt16 tile, int row, int col, UInt16 *buffer);
 
 #if !(HQ_TERRAIN)
@@ -47,6 +61,9 @@ static void ShrinkSuperTileTextureMap(const uint16_t* srcPtr, uint16_t* dstPtr,
 #define	ITEM_WINDOW		1				// # supertiles for item add window
 #define	OUTER_SIZE		0				// size of border out of add window for delete window
 
+#define	MAX_TERRAIN_BUILD_THREADS	8		// threads used when building many supertiles at once (incl. the main thread)
+#define	SUPERTILES_PER_BUILD_THREAD	4		// texture buffers per thread in each batch of a bulk build
+
 enum
 {
 	SPLIT_ARBITRARY,
@@ -61,7 +78,6 @@ enum
 /**********************/
 
 static UInt8	gHiccupEliminator = 0;
-static Boolean	gDisableHiccupTimer = false;
 
 Ptr		gTerrainPtr = nil;								// points to terrain file data
 UInt16	*gTileDataPtr;
@@ -79,7 +95,8 @@ Ptr		gTerrainHeightMapPtrs[MAX_HEIGHTMAP_TILES];
 int		gNumSuperTilesDeep,gNumSuperTilesWide;	  		// dimensions of terrain in terms of supertiles
 int		gCurrentSuperTileRow,gCurrentSuperTileCol;
 
-static int	gTerrainScrollBuffer[MAX_SUPERTILES_DEEP][MAX_SUPERTILES_WIDE];		// 2D array which has index to supertiles for each possible supertile
+static int	**gTerrainScrollBuffer = nil;						// 2D array which has index to supertiles for each supertile on the map (allocated in ClearScrollBuffer)
+static int	gScrollBufferRows = 0, gScrollBufferCols = 0;
 
 static int	gNumFreeSupertiles = 0;
 static	SuperTileMemoryType		*gSuperTileMemoryList = NULL;
@@ -146,6 +163,8 @@ UInt16			*gTempTextureBuffer = nil;
 
 TQ3Vector3D		gRecentTerrainNormal;							// from _Planar
 
+static RenderModifiers	gBakedTerrainRenderMods;				// for supertiles with baked lighting
+
 /****************** INIT TERRAIN MANAGER ************************/
 //
 // Only called at boot!
@@ -155,6 +174,9 @@ void InitTerrainManager(void)
 {
 	CreateSuperTileMemoryList();
 	ClearScrollBuffer();
+
+	Render_SetDefaultModifiers(&gBakedTerrainRenderMods);
+	gBakedTerrainRenderMods.statusBits |= STATUS_BIT_NULLSHADER;
 	
 	
 			/* ALLOC TEMP TEXTURE BUFF */
@@ -165,12 +187,44 @@ void InitTerrainManager(void)
 
 /***************** CLEAR SCROLL BUFFER ************************/
 
+//
+// The scroll buffer covers the whole map, so (re)allocate it whenever the map's size in supertiles changes.
+//
+
 void ClearScrollBuffer(void)
 {
 long	row,col;
 
-	for (row = 0; row < MAX_SUPERTILES_DEEP; row++)
-		for (col = 0; col < MAX_SUPERTILES_WIDE; col++)
+	if (gNumSuperTilesDeep <= 0 || gNumSuperTilesWide <= 0)			// no terrain loaded yet
+	{
+		DisposeScrollBuffer();
+		gHiccupEliminator = 0;
+		return;
+	}
+
+	if (gTerrainScrollBuffer == nil
+		|| gScrollBufferRows != gNumSuperTilesDeep
+		|| gScrollBufferCols != gNumSuperTilesWide)
+	{
+		DisposeScrollBuffer();
+
+		gScrollBufferRows = gNumSuperTilesDeep;
+		gScrollBufferCols = gNumSuperTilesWide;
+
+		gTerrainScrollBuffer = (int **) AllocPtr(sizeof(int *) * gScrollBufferRows				// row pointers...
+												+ sizeof(int) * gScrollBufferRows * gScrollBufferCols);	// ...followed by the rows
+		GAME_ASSERT(gTerrainScrollBuffer);
+
+		int* rowPtr = (int *) (gTerrainScrollBuffer + gScrollBufferRows);
+		for (row = 0; row < gScrollBufferRows; row++)
+		{
+			gTerrainScrollBuffer[row] = rowPtr;
+			rowPtr += gScrollBufferCols;
+		}
+	}
+
+	for (row = 0; row < gScrollBufferRows; row++)
+		for (col = 0; col < gScrollBufferCols; col++)
 			gTerrainScrollBuffer[row][col] = EMPTY_SUPERTILE;
 			
 	gHiccupEliminator = 0;
@@ -180,6 +234,20 @@ long	row,col;
 
 
 
+/***************** DISPOSE SCROLL BUFFER ************************/
+
+static void DisposeScrollBuffer(void)
+{
+	if (gTerrainScrollBuffer)
+	{
+		DisposePtr((Ptr) gTerrainScrollBuffer);
+		gTerrainScrollBuffer = nil;
+	}
+	gScrollBufferRows = gScrollBufferCols = 0;
+}
+
+
+
 /***************** DISPOSE TERRAIN **********************/
 //
 // Deletes any existing terrain data
@@ -223,55 +291,71 @@ void DisposeTerrain(void)
 		gTerrainPtr = nil;
 	}
 
-	if (gSuperTileMemoryList != nil)						// release all supertiles (source port addition)
+	DisposeSuperTileMemoryList();							// release all supertiles (source port addition)
+	DisposeScrollBuffer();
+	DisposeTerrainPaging();									// release layer pages & close terrain file
+
+	if (gTempTextureBuffer != nil)
 	{
-		for (int i = 0; i < MAX_SUPERTILES; i++)
-		{
-			SuperTileMemoryType* superTile = &gSuperTileMemoryList[i];
+		DisposePtr((Ptr) gTempTextureBuffer);
+		gTempTextureBuffer = nil;
+	}
+}
+
+
+
+
+/************** DISPOSE SUPERTILE MEMORY LIST ********************/
+//
+// Frees everything CreateSuperTileMemoryList allocated.
+// The list holds MAX_SUPERTILES entries, so call this before SUPERTILE_ACTIVE_RANGE changes.
+//
+
+static void DisposeSuperTileMemoryList(void)
+{
+	if (gSuperTileMemoryList == nil)
+		return;
+
+	Render_DisposeMeshPool();
+
+	for (int i = 0; i < MAX_SUPERTILES; i++)
+	{
+		SuperTileMemoryType* superTile = &gSuperTileMemoryList[i];
 
 #if !(HQ_TERRAIN)
-			if (superTile->textureData)
-			{
-				DisposePtr((Ptr) superTile->textureData);
-				superTile->textureData = nil;
-			}
+		if (superTile->textureData)
+		{
+			DisposePtr((Ptr) superTile->textureData);
+			superTile->textureData = nil;
+		}
 #endif
 
-			if (superTile->glTextureName)
-			{
-				glDeleteTextures(1, &superTile->glTextureName);
-				superTile->glTextureName = 0;
-			}
+		if (superTile->glTextureName)
+		{
+			glDeleteTextures(1, &superTile->glTextureName);
+			superTile->glTextureName = 0;
+		}
 
-			if (superTile->triMeshPtr)
-			{
-				Q3TriMeshData_Dispose(superTile->triMeshPtr);
-				superTile->triMeshPtr = nil;
-			}
+		if (superTile->triMeshPtr)
+		{
+			Q3TriMeshData_Dispose(superTile->triMeshPtr);
+			superTile->triMeshPtr = nil;
+		}
 
 #if !(HQ_TERRAIN)
-			if (superTile->triMeshPtr2)
-			{
-				Q3TriMeshData_Dispose(superTile->triMeshPtr2);
-				superTile->triMeshPtr2 = nil;
-			}
-#endif
+		if (superTile->triMeshPtr2)
+		{
+			Q3TriMeshData_Dispose(superTile->triMeshPtr2);
+			superTile->triMeshPtr2 = nil;
 		}
-		DisposePtr((Ptr) gSuperTileMemoryList);
-		gSuperTileMemoryList = nil;
+#endif
 	}
+	DisposePtr((Ptr) gSuperTileMemoryList);
+	gSuperTileMemoryList = nil;
 	gNumFreeSupertiles = 0;
-
-	if (gTempTextureBuffer != nil)
-	{
-		DisposePtr((Ptr) gTempTextureBuffer);
-		gTempTextureBuffer = nil;
-	}
 }
 
 
-
-
 /************** CREATE SUPERTILE MEMORY LIST ********************/
 //
 // This preallocates all of the memory that will ever be needed by all of
@@ -397,8 +481,9 @@ TQ3Param2D				uvsFlat[4] = {{0,0}, {1,0}, {0,1}, {1,1}};
 					/* CREATE THE TRIMESH OBJECT */
 
 		TQ3TriMeshData* tmd = Q3TriMeshData_New(NUM_POLYS_IN_SUPERTILE, NUM_VERTICES_IN_SUPERTILE,
-				kQ3TriMeshDataFeatureVertexUVs | kQ3TriMeshDataFeatureVertexNormals);
+				kQ3TriMeshDataFeatureVertexUVs | kQ3TriMeshDataFeatureVertexNormals | kQ3TriMeshDataFeatureVertexColors);
 		GAME_ASSERT(tmd);
+		tmd->hasVertexColors = false;											// only used with baked lighting (see BuildSuperTileGeometry)
 
 		gSuperTileMemoryList[i].triMeshPtr = tmd;
 
@@ -450,8 +535,9 @@ TQ3Param2D				uvsFlat[4] = {{0,0}, {1,0}, {0,1}, {1,1}};
 					/* CREATE THE TRIMESH OBJECT */
 
 		TQ3TriMeshData* tmd = Q3TriMeshData_New(NUM_POLYS_IN_SUPERTILE, NUM_VERTICES_IN_SUPERTILE,
-				kQ3TriMeshDataFeatureVertexUVs | kQ3TriMeshDataFeatureVertexNormals);
+				kQ3TriMeshDataFeatureVertexUVs | kQ3TriMeshDataFeatureVertexNormals | kQ3TriMeshDataFeatureVertexColors);
 		GAME_ASSERT(tmd);
+		tmd->hasVertexColors = false;											// only used with baked lighting (see BuildSuperTileGeometry)
 
 		gSuperTileMemoryList[i].triMeshPtr = tmd;
 
@@ -506,6 +592,23 @@ TQ3Param2D				uvsFlat[4] = {{0,0}, {1,0}, {0,1}, {1,1}};
 	}
 
 #endif
+
+			/*************************************/
+			/* GIVE THE TRIMESHES A GPU BUFFER   */
+			/*************************************/
+			//
+			// All supertile trimeshes share one vertex & index buffer on the GPU, with a slot each
+			// that is refreshed whenever the supertile is rebuilt.
+			//
+
+	TQ3TriMeshData** poolMeshes = (TQ3TriMeshData**) AllocPtr(sizeof(TQ3TriMeshData*) * MAX_SUPERTILES);
+	GAME_ASSERT(poolMeshes);
+
+	for (int i = 0; i < MAX_SUPERTILES; i++)
+		poolMeshes[i] = gSuperTileMemoryList[i].triMeshPtr;
+
+	Render_CreateMeshPool(poolMeshes, MAX_SUPERTILES);
+	DisposePtr((Ptr) poolMeshes);
 }
 
 
@@ -549,22 +652,36 @@ static int GetFreeSuperTileMemory(void)
 static int BuildTerrainSuperTile(int startCol, int startRow)
 {
 int					superTileNum;
-float				miny,maxy;
-TQ3Vector3D			normals[SUPERTILE_SIZE+1][SUPERTILE_SIZE+1];
-TQ3TriMeshData		*triMeshPtr;
-TQ3Vector3D			*vertexNormalList;
-UInt16				tile;
-TQ3Point3D			*pointList;
-TQ3TriMeshTriangleData	*triangleList;
+SuperTileMemoryType	*superTilePtr;
+
+	superTileNum = StartSuperTile(startCol, startRow);
+	superTilePtr = &gSuperTileMemoryList[superTileNum];
+
+	BuildSuperTileGeometry(superTilePtr, gWorkGrid);
+	Render_UpdatePooledMesh(superTilePtr->triMeshPtr);
+	UpdateSuperTileTexture(superTilePtr);
+
+	return(superTileNum);
+}
+
+
+/******************* START SUPERTILE *******************/
+//
+// Claims a supertile memory block for the given map position and fills in
+// where it is.  Its geometry & texture are built separately.
+//
+// OUTPUT: index to supertile
+//
+
+static int StartSuperTile(int startCol, int startRow)
+{
+int					superTileNum;
 SuperTileMemoryType	*superTilePtr;
 
 	superTileNum = GetFreeSuperTileMemory();					// get memory block for the data
 	superTilePtr = &gSuperTileMemoryList[superTileNum];			// get ptr to it
 
-	if (gDisableHiccupTimer)
-		superTilePtr->hiccupTimer = 0;
-	else
-		superTilePtr->hiccupTimer = (gHiccupEliminator++ & 0x7);	// set hiccup timer to alleviate hiccup caused by massive texture uploading
+	superTilePtr->hiccupTimer = (gHiccupEliminator++ & 0x7);	// set hiccup timer to alleviate hiccup caused by massive texture uploading
 
 	superTilePtr->row = startRow;								// remember row/col of data for dereferencing later
 	superTilePtr->col = startCol;
@@ -576,36 +693,65 @@ SuperTileMemoryType	*superTilePtr;
 	superTilePtr->left = (startCol * TERRAIN_POLYGON_SIZE);		// also save left/back coord
 	superTilePtr->back = (startRow * TERRAIN_POLYGON_SIZE);
 
+	return(superTileNum);
+}
+
+
+/******************* BUILD SUPERTILE GEOMETRY *******************/
+//
+// Computes the heights, normals, split angles, plane equations & trimesh of a
+// supertile set up by StartSuperTile.
+//
+// This only reads the map layers and only writes to the supertile & workGrid,
+// so BuildSuperTilesInParallel runs it on several threads at once.
+//
+
+static void BuildSuperTileGeometry(SuperTileMemoryType* superTilePtr, TQ3Point3D workGrid[SUPERTILE_SIZE+1][SUPERTILE_SIZE+1])
+{
+int					startCol = superTilePtr->col;
+int					startRow = superTilePtr->row;
+float				miny,maxy;
+float				heights[SUPERTILE_SIZE+3][SUPERTILE_SIZE+3];			// vertex heights plus a border of the neighbours'
+TQ3TriMeshData		*triMeshPtr;
+TQ3Vector3D			*vertexNormalList;
+UInt16				tile;
+TQ3Point3D			*pointList;
+TQ3TriMeshTriangleData	*triangleList;
+
+			/* GET THE TRIMESH */
+
+	triMeshPtr = superTilePtr->triMeshPtr;					// get the triMesh
+	GAME_ASSERT(triMeshPtr);
+
+	pointList = triMeshPtr->points;												// get ptr to point/vertex list
+	triangleList = triMeshPtr->triangles;										// get ptr to triangle index list
+	vertexNormalList = triMeshPtr->vertexNormals;								// get ptr to vertex normals
+
 			/*********************************/
 			/* CREATE TERRAIN MESH VERTICES  */
 			/*********************************/
 
+	SampleSuperTileHeights(startRow, startCol, heights);
+
 	miny = 1000000;
 	maxy = -miny;
 	
 	for (int row2 = 0; row2 <= SUPERTILE_SIZE; row2++)
 	{
 		int row = row2 + startRow;
+		const float* heightRow = &heights[row2+1][1];
 		
 		for (int col2 = 0; col2 <= SUPERTILE_SIZE; col2++)
 		{
 			int col = col2 + startCol;
+			float height = heightRow[col2];
 
-			float height;
-			if ((row >= gTerrainTileDepth) || (col >= gTerrainTileWidth))			// check for edge vertices (off map array)
-				height = 0;
-			else
-				height = GetTerrainHeightAtRowCol(row,col); 						// get pixel height here
-
-			gWorkGrid[row2][col2].x = (col*TERRAIN_POLYGON_SIZE);
-			gWorkGrid[row2][col2].z = (row*TERRAIN_POLYGON_SIZE);
+			workGrid[row2][col2].x = (col*TERRAIN_POLYGON_SIZE);
+			workGrid[row2][col2].z = (row*TERRAIN_POLYGON_SIZE);
+			workGrid[row2][col2].y = height;										// save height @ this tile's upper left corner
 
-			gWorkGrid[row2][col2].y = height;										// save height @ this tile's upper left corner
-			
-			if (height > maxy)														// keep track of min/max
-				maxy = height;
-			if (height < miny)
-				miny = height;			
+			maxy = SDL_max(maxy, height);											// keep track of min/max
+			miny = SDL_min(miny, height);
 		}
 	}
 
@@ -619,7 +765,7 @@ SuperTileMemoryType	*superTilePtr;
 	{
 		superTilePtr->isFlat = true;
 		BuildTerrainSuperTile_Flat(superTilePtr);
-		return(superTileNum);
+		return;
 	}
 	else
 		superTilePtr->isFlat = false;
@@ -629,57 +775,30 @@ SuperTileMemoryType	*superTilePtr;
 			/******************************/
 			/* CALCULATE VERTEX NORMALS   */
 			/******************************/
+			//
+			// The border of the height grid holds the neighbours' edge heights, so every
+			// vertex is done the same way.  The differences are worked out for a whole row
+			// before normalizing it, which leaves the compiler simple loops to vectorize.
+			// Keep the arithmetic as it is: changing the order or the double-precision .01
+			// would change the normals (CheckSuperTileGeometry catches that in debug builds).
+			//
 
 	for (int row2 = 0; row2 <= SUPERTILE_SIZE; row2++)
 	{
-		int row = row2 + startRow;
+		const float* back	= &heights[row2  ][1];
+		const float* center	= &heights[row2+1][1];
+		const float* front	= &heights[row2+2][1];
+		TQ3Vector3D* normals = &vertexNormalList[row2 * (SUPERTILE_SIZE+1)];
 
 		for (int col2 = 0; col2 <= SUPERTILE_SIZE; col2++)
 		{
-			float	center_h,left_h,right_h,back_h,front_h;
-
-			int col = col2 + startCol;
-
-					/* GET CENTER HEIGHT */
-					
-			center_h = gWorkGrid[row2][col2].y;
-
-					/* GET LEFT HEIGHT */
-					
-			if (col2 == 0)
-				left_h = GetTerrainHeightAtRowCol(row,col-1);
-			else
-				left_h = gWorkGrid[row2][col2-1].y;
-				
-					/* GET RIGHT HEIGHT */
-			
-			if (col2 == SUPERTILE_SIZE)
-				right_h = GetTerrainHeightAtRowCol(row,col+1);
-			else
-				right_h = gWorkGrid[row2][col2+1].y;
-			
-					/* GET BACK HEIGHT */
-			
-			if (row2 == 0)
-				back_h = GetTerrainHeightAtRowCol(row-1,col);
-			else
-				back_h = gWorkGrid[row2-1][col2].y;
-			
-					/* GET FRONT HEIGHT */
-			
-			if (row2 == SUPERTILE_SIZE)
-				front_h = GetTerrainHeightAtRowCol(row+1,col);
-			else
-				front_h = gWorkGrid[row2+1][col2].y;
-			
-			
-			normals[row2][col2].x = ((left_h - center_h) + (center_h - right_h)) * .01;
-			normals[row2][col2].y = 1;
-			normals[row2][col2].z = ((back_h - center_h) + (center_h - front_h)) * .01;
-			
-			Q3Vector3D_Normalize(&normals[row2][col2],&normals[row2][col2]);						// normalize the vertex normal
-			
+			normals[col2].x = ((center[col2-1] - center[col2]) + (center[col2] - center[col2+1])) * .01;
+			normals[col2].y = 1;
+			normals[col2].z = ((back[col2] - center[col2]) + (center[col2] - front[col2])) * .01;
 		}
+
+		for (int col2 = 0; col2 <= SUPERTILE_SIZE; col2++)
+			Q3Vector3D_Normalize(&normals[col2], &normals[col2]);
 	}
 
 				/***************************************/
@@ -690,10 +809,10 @@ SuperTileMemoryType	*superTilePtr;
 	{
 		for (int col = 0; col < SUPERTILE_SIZE; col++)
 		{
-			int h1 = gWorkGrid[row][col].y;											// get height of all 4 vertices (clockwise)
-			int h2 = gWorkGrid[row][col+1].y;
-			int h3 = gWorkGrid[row+1][col+1].y;
-			int h4 = gWorkGrid[row+1][col].y;
+			int h1 = workGrid[row][col].y;											// get height of all 4 vertices (clockwise)
+			int h2 = workGrid[row][col+1].y;
+			int h3 = workGrid[row+1][col+1].y;
+			int h4 = workGrid[row+1][col].y;
 
 
 					/* QUICK CHECK FOR FLAT POLYS */
@@ -701,8 +820,8 @@ SuperTileMemoryType	*superTilePtr;
 			if ((h1 == h2) && (h1 == h3) && (h1 == h4))								// see if all same level
 			{
 				CalcPlaneEquationOfTriangle(&superTilePtr->tilePlanes1[row][col],	// calc plane equation for both triangles
-							 &gWorkGrid[row][col], &gWorkGrid[row][col+1],
-							 &gWorkGrid[row+1][col+1]);
+							 &workGrid[row][col], &workGrid[row][col+1],
+							 &workGrid[row+1][col+1]);
 				superTilePtr->tilePlanes2[row][col] = superTilePtr->tilePlanes1[row][col];
 
 				superTilePtr->splitAngle[row][col] = SPLIT_ARBITRARY;				// split doesnt matter
@@ -737,22 +856,22 @@ SuperTileMemoryType	*superTilePtr;
 			if (superTilePtr->splitAngle[row][col] == SPLIT_BACKWARD)				// if \ split
 			{
 				CalcPlaneEquationOfTriangle(&superTilePtr->tilePlanes1[row][col],	// calc plane equation for left triangle
-							 &gWorkGrid[row][col], &gWorkGrid[row+1][col+1],
-							 &gWorkGrid[row+1][col]);
+							 &workGrid[row][col], &workGrid[row+1][col+1],
+							 &workGrid[row+1][col]);
 
 				CalcPlaneEquationOfTriangle(&superTilePtr->tilePlanes2[row][col],	// calc plane equation for right triangle
-							 &gWorkGrid[row][col], &gWorkGrid[row][col+1],
-							 &gWorkGrid[row+1][col+1]);			
+							 &workGrid[row][col], &workGrid[row][col+1],
+							 &workGrid[row+1][col+1]);			
 			}
 			else																	// otherwise, / split
 			{
 				CalcPlaneEquationOfTriangle(&superTilePtr->tilePlanes1[row][col],	// calc plane equation for left triangle
-							 &gWorkGrid[row][col], &gWorkGrid[row][col+1],
-							 &gWorkGrid[row+1][col]);
+							 &workGrid[row][col], &workGrid[row][col+1],
+							 &workGrid[row+1][col]);
 
 				CalcPlaneEquationOfTriangle(&superTilePtr->tilePlanes2[row][col],	// calc plane equation for right triangle
-							 &gWorkGrid[row][col+1], &gWorkGrid[row+1][col+1],
-							 &gWorkGrid[row+1][col]);			
+							 &workGrid[row][col+1], &workGrid[row+1][col+1],
+							 &workGrid[row+1][col]);			
 			}			
 		}
 	}
@@ -761,23 +880,13 @@ SuperTileMemoryType	*superTilePtr;
 			/* CREATE TERRAIN MESH POLYGONS  */
 			/*********************************/
 
-					/* GET THE TRIMESH */
-
-	triMeshPtr = gSuperTileMemoryList[superTileNum].triMeshPtr;					// get the triMesh
-	GAME_ASSERT(triMeshPtr);
-
-	pointList = triMeshPtr->points;												// get ptr to point/vertex list
-	triangleList = triMeshPtr->triangles;										// get ptr to triangle index list
-	vertexNormalList = triMeshPtr->vertexNormals;								// get ptr to vertex normals
-
-	
 			/* SET BOUNDING BOX */
 			
-	triMeshPtr->bBox.min.x = gWorkGrid[0][0].x;
+	triMeshPtr->bBox.min.x = workGrid[0][0].x;
 	triMeshPtr->bBox.max.x = triMeshPtr->bBox.min.x+TERRAIN_SUPERTILE_UNIT_SIZE;
 	triMeshPtr->bBox.min.y = miny;
 	triMeshPtr->bBox.max.y = maxy;
-	triMeshPtr->bBox.min.z = gWorkGrid[0][0].z;
+	triMeshPtr->bBox.min.z = workGrid[0][0].z;
 	triMeshPtr->bBox.max.z = triMeshPtr->bBox.min.z + TERRAIN_SUPERTILE_UNIT_SIZE;
 
 			/* CALC COORD & RADIUS FOR CULLING SPHERE */
@@ -790,28 +899,34 @@ SuperTileMemoryType	*superTilePtr;
 	// Calc radius of supertile bounding sphere for frustum culling.
 	superTilePtr->radius = 0.5f * Q3Point3D_Distance(&triMeshPtr->bBox.min, &triMeshPtr->bBox.max);
 
-					/* SET VERTEX COORDS & NORMALS */
-	
-	int i = 0;
-	for (int row = 0; row < (SUPERTILE_SIZE+1); row++)
-		for (int col = 0; col < (SUPERTILE_SIZE+1); col++)
-		{
-			pointList[i] = gWorkGrid[row][col];									// copy from other list
-			vertexNormalList[i] = normals[row][col];
-			i++;
-		}
+					/* SET VERTEX COORDS */
+
+	SDL_memcpy(pointList, workGrid, sizeof(TQ3Point3D) * NUM_VERTICES_IN_SUPERTILE);	// same layout as the workGrid
+
+#if _DEBUG
+	CheckSuperTileGeometry(superTilePtr);
+#endif
+
+				/* BAKE LIGHTING INTO VERTEX COLORS */
+
+	triMeshPtr->hasVertexColors = gGamePrefs.bakedLighting && gGameViewInfoPtr;
+	if (triMeshPtr->hasVertexColors)
+	{
+		QD3D_BakeVertexLighting(&gGameViewInfoPtr->lights, &triMeshPtr->diffuseColor,
+								NUM_VERTICES_IN_SUPERTILE, vertexNormalList, triMeshPtr->vertexColors);
+	}
 	
 
 				/* UPDATE TRIMESH DATA WITH NEW INFO */
 
-	i = 0;
+	int i = 0;
 	for (int row2 = 0; row2 < SUPERTILE_SIZE; row2++)
 	{
 		for (int col2 = 0; col2 < SUPERTILE_SIZE; col2++)
 		{
 					/* SET SPLITTING INFO */
 
-			if (gSuperTileMemoryList[superTileNum].splitAngle[row2][col2] == SPLIT_BACKWARD)	// set coords & uv's based on splitting
+			if (superTilePtr->splitAngle[row2][col2] == SPLIT_BACKWARD)	// set coords & uv's based on splitting
 			{
 					/* \ */
 				triangleList[i].pointIndices[0] = gTileTriangles1_B[row2][col2][0];
@@ -837,18 +952,68 @@ SuperTileMemoryType	*superTilePtr;
 			}
 		}
 	}
+}
 
 
-			/******************/
-			/* UPDATE TEXTURE */
-			/******************/
 
-	UpdateSuperTileTexture(superTilePtr);
+/******************* SAMPLE SUPERTILE HEIGHTS *******************/
+//
+// Reads the height of each vertex of a supertile from the map, plus a 1-vertex border
+// so the normals at its edges can be worked out without going back to the map.
+// heights[1][1] is the vertex at startRow/startCol.  Off the map, heights are 0.
+//
 
+static void SampleSuperTileHeights(int startRow, int startCol, float heights[SUPERTILE_SIZE+3][SUPERTILE_SIZE+3])
+{
+	for (int row2 = 0; row2 < SUPERTILE_SIZE+3; row2++)
+	{
+		int row = startRow - 1 + row2;
 
-	return(superTileNum);
+		for (int col2 = 0; col2 < SUPERTILE_SIZE+3; col2++)
+			heights[row2][col2] = GetTerrainHeightAtRowCol(row, startCol - 1 + col2);
+	}
+}
+
+
+#if _DEBUG
+
+/******************* CHECK SUPERTILE GEOMETRY *******************/
+//
+// Debug builds only: redoes a supertile's heights & normals one vertex at a time,
+// fetching each neighbour from the map like the old builder did, and makes sure
+// BuildSuperTileGeometry came up with exactly the same bits.
+//
+
+static void CheckSuperTileGeometry(const SuperTileMemoryType* superTilePtr)
+{
+const TQ3TriMeshData*	triMeshPtr = superTilePtr->triMeshPtr;
+int						i = 0;
+
+	for (int row = superTilePtr->row; row <= superTilePtr->row + SUPERTILE_SIZE; row++)
+	{
+		for (int col = superTilePtr->col; col <= superTilePtr->col + SUPERTILE_SIZE; col++)
+		{
+			float center_h	= GetTerrainHeightAtRowCol(row, col);
+			float left_h	= GetTerrainHeightAtRowCol(row, col-1);
+			float right_h	= GetTerrainHeightAtRowCol(row, col+1);
+			float back_h	= GetTerrainHeightAtRowCol(row-1, col);
+			float front_h	= GetTerrainHeightAtRowCol(row+1, col);
+
+			TQ3Vector3D normal;
+			normal.x = ((left_h - center_h) + (center_h - right_h)) * .01;
+			normal.y = 1;
+			normal.z = ((back_h - center_h) + (center_h - front_h)) * .01;
+			Q3Vector3D_Normalize(&normal, &normal);
+
+			GAME_ASSERT(0 == SDL_memcmp(&triMeshPtr->points[i].y, &center_h, sizeof(float)));
+			GAME_ASSERT(0 == SDL_memcmp(&triMeshPtr->vertexNormals[i], &normal, sizeof(TQ3Vector3D)));
+			i++;
+		}
+	}
 }
 
+#endif // _DEBUG
+
 
 
 #if !(HQ_TERRAIN)
@@ -923,9 +1088,23 @@ TQ3PlaneEquation	planeEq;
 /********************* UPDATE SUPERTILE TEXTURE *************************/
 
 static void UpdateSuperTileTexture(SuperTileMemoryType* superTilePtr)
+{
+	UploadSuperTileTexture(superTilePtr, DrawSuperTileTexture(superTilePtr, gTempTextureBuffer));
+}
+
+
+/********************* DRAW SUPERTILE TEXTURE *************************/
+//
+// Draws the supertile's tiles into a TEMP_TEXTURE_BUFF_SIZE buffer.
+// Like BuildSuperTileGeometry, this is safe to run on a worker thread.
+//
+// OUTPUT: the pixels to upload with UploadSuperTileTexture
+//
+
+static const UInt16* DrawSuperTileTexture(SuperTileMemoryType* superTilePtr, UInt16* buffer)
 {
 #if _DEBUG
-	SDL_memset(gTempTextureBuffer, 0xFF, TEMP_TEXTURE_BUFF_SIZE*TEMP_TEXTURE_BUFF_SIZE*2);
+	SDL_memset(buffer, 0xFF, TEMP_TEXTURE_BUFF_SIZE*TEMP_TEXTURE_BUFF_SIZE*2);
 #endif
 
 			/******************/
@@ -963,38 +1142,39 @@ static void UpdateSuperTileTexture(SuperTileMemoryType* superTilePtr)
 			}
 
 #if HQ_TERRAIN
-			DrawTileIntoMipmap(tile, row2+1, col2+1, gTempTextureBuffer);	// draw into mipmap
+			DrawTileIntoMipmap(tile, row2+1, col2+1, buffer);				// draw into mipmap
 #else
-			DrawTileIntoMipmap(tile, row2, col2, gTempTextureBuffer);		// draw into mipmap
+			DrawTileIntoMipmap(tile, row2, col2, buffer);					// draw into mipmap
 #endif
 		}
 	}
 
 
 #if HQ_TERRAIN
-	UInt16* textureData = gTempTextureBuffer;
+	return buffer;
 #else
 			/* GET MIPMAP BUFFER */
 
 	// store a resized copy of the texture in the supertile's textureData buffer
-	ShrinkSuperTileTextureMap(gTempTextureBuffer, superTilePtr->textureData, SUPERTILE_TEXMAP_SIZE);
-	UInt16* textureData = superTilePtr->textureData;
+	ShrinkSuperTileTextureMap(buffer, superTilePtr->textureData, SUPERTILE_TEXMAP_SIZE);
+	return superTilePtr->textureData;
 #endif
+}
+
 
+/********************* UPLOAD SUPERTILE TEXTURE *************************/
+
+static void UploadSuperTileTexture(const SuperTileMemoryType* superTilePtr, const UInt16* textureData)
+{
 			/* RECREATE TEXTURE */
 
-	Render_BindTexture(superTilePtr->glTextureName);
-	glTexSubImage2D(
-			GL_TEXTURE_2D,
-			0,
-			0,
-			0,
+	Render_UpdateTexture(
+			superTilePtr->glTextureName,
 			SUPERTILE_TEXMAP_SIZE,
 			SUPERTILE_TEXMAP_SIZE,
 			TILE_TEXTURE_FORMAT,
 			TILE_TEXTURE_TYPE,
 			textureData);
-	CHECK_GL_ERROR();
 }
 
 
@@ -1224,6 +1404,41 @@ static void ShrinkSuperTileTextureMap(const uint16_t* srcPtr, uint16_t* dstPtr,
 #endif // !(HQ_TERRAIN)
 
 
+/******************* REBUILD SUPERTILE *******************/
+//
+// Builds an active supertile over again from the map (or only redraws its texture).
+// Nothing changes on screen -- NanosaurBench uses this to time BuildTerrainSuperTile
+// and UpdateSuperTileTexture on real terrain.
+//
+// OUTPUT: false if that supertile memory block isn't in use
+//
+
+Boolean RebuildSuperTile(int superTileNum, Boolean textureOnly)
+{
+SuperTileMemoryType	*superTilePtr;
+int					row,col;
+
+	GAME_ASSERT(superTileNum >= 0 && superTileNum < MAX_SUPERTILES);
+
+	superTilePtr = &gSuperTileMemoryList[superTileNum];
+	if (superTilePtr->mode != SUPERTILE_MODE_USED)
+		return(false);
+
+	if (textureOnly)
+	{
+		UpdateSuperTileTexture(superTilePtr);
+		return(true);
+	}
+
+	row = superTilePtr->row;
+	col = superTilePtr->col;
+
+	ReleaseSuperTileObject(superTileNum);
+	gTerrainScrollBuffer[row/SUPERTILE_SIZE][col/SUPERTILE_SIZE] = BuildTerrainSuperTile(col, row);
+	return(true);
+}
+
+
 /******************* RELEASE SUPERTILE OBJECT *******************/
 //
 // Deactivates the terrain object and releases its memory block
@@ -1267,11 +1482,11 @@ void DrawTerrain(QD3DSetupOutputType *setupInfo)
 			/* DRAW THE TRIMESH IN THIS SUPERTILE */
 
 #if HQ_TERRAIN
-		Render_SubmitMesh(superTile->triMeshPtr, nil, nil, &superTile->coord);
+		TQ3TriMeshData* mesh = superTile->triMeshPtr;
 #else
 		TQ3TriMeshData* mesh = superTile->isFlat ? superTile->triMeshPtr2 : superTile->triMeshPtr;
-		Render_SubmitMesh(mesh, nil, nil, &superTile->coord);
 #endif
+		Render_SubmitMesh(mesh, nil, mesh->hasVertexColors ? &gBakedTerrainRenderMods : nil, &superTile->coord);
 	}
 
 
@@ -1611,14 +1826,22 @@ int	superCol,superRow,tileCol,tileRow;
 	GetSuperTileInfo(x,y,&superCol,&superRow,&tileCol,&tileRow); 		// get supertile coord info
 
 
+			/* SEE IF WE JUMPED MORE THAN ONE SUPERTILE */
+
+	if (SDL_abs(superRow - gCurrentSuperTileRow) > 1
+		|| SDL_abs(superCol - gCurrentSuperTileCol) > 1)
+	{
+		JumpScrollWindow(superRow, superCol);
+		return;
+	}
+
+
 		// NOTE: DO VERTICAL FIRST!!!!
 
 				/* SEE IF SCROLLED UP */
 
 	if (superRow > gCurrentSuperTileRow)
 	{
-		if (superRow > (gCurrentSuperTileRow+1))						// check for overload scroll
-			DoFatalAlert("DoMyTerrainUpdate: scrolled up > 1 tile!");
 		ScrollTerrainUp(superRow,superCol);
 		gCurrentSuperTileRow = superRow;
 	}
@@ -1627,8 +1850,6 @@ int	superCol,superRow,tileCol,tileRow;
 
 	if (superRow < gCurrentSuperTileRow)
 	{
-		if (superRow < (gCurrentSuperTileRow-1))						// check for overload scroll
-			DoFatalAlert("DoMyTerrainUpdate: scrolled down < -1 tile!");
 		ScrollTerrainDown(superRow,superCol);
 		gCurrentSuperTileRow = superRow;
 	}
@@ -1637,8 +1858,6 @@ int	superCol,superRow,tileCol,tileRow;
 
 	if (superCol > gCurrentSuperTileCol)
 	{
-		if (superCol > (gCurrentSuperTileCol+1))						// check for overload scroll
-			DoFatalAlert("DoMyTerrainUpdate: scrolled left > 1 tile!");
 		ScrollTerrainLeft();
 	}
 	else
@@ -1646,14 +1865,12 @@ int	superCol,superRow,tileCol,tileRow;
 
 	if (superCol < gCurrentSuperTileCol)
 	{
-		if (superCol < (gCurrentSuperTileCol-1))						// check for overload scroll
-			DoFatalAlert("DoMyTerrainUpdate: scrolled right < -1 tile!");
 		ScrollTerrainRight(superCol,superRow,tileCol,tileRow);
 		gCurrentSuperTileCol = superCol;
 	}
 
 	CalcNewItemDeleteWindow();							// recalc item delete window
-
+	PageTerrainAroundScrollWindow();					// keep the layers resident around the new window
 }
 
 
@@ -2061,25 +2278,303 @@ check_items:
 
 
 /**************** PRIME INITIAL TERRAIN ***********************/
+//
+// Builds the whole scroll window at gCurrentSuperTileRow/Col and adds the items around it.
+// Called at the start of a level and whenever the terrain is recentered.
+//
 
 void PrimeInitialTerrain(void)
 {
-long	i,w;
+Uint64	startTime = SDL_GetTicksNS();
+
+	PageTerrainAroundScrollWindow();						// make sure the layers are in for the rows we're about to build
+
+	FillScrollWindow();
+	AddItemsInItemWindow();
+	CalcNewItemDeleteWindow();
+
+	Metrics_ObserveTerrainRebuild((SDL_GetTicksNS() - startTime) / 1e6, false);		// recenters happen often, so no log line
+}
+
+
+/**************** JUMP SCROLL WINDOW ***********************/
+//
+// The normal scroll routines only handle moving by one supertile per frame.
+// If the player got further than that in one go (teleporter, very low frame rate...)
+// move the whole window at once instead: the supertiles that are still in view are
+// kept and only the new ones are built.
+//
+
+static void JumpScrollWindow(int superRow, int superCol)
+{
+Uint64	startTime = SDL_GetTicksNS();
+
+	gCurrentSuperTileRow = superRow;
+	gCurrentSuperTileCol = superCol;
+
+	PageTerrainAroundScrollWindow();
 
+	FillScrollWindow();
+	AddItemsInItemWindow();
+	CalcNewItemDeleteWindow();
+
+	Metrics_ObserveTerrainRebuild((SDL_GetTicksNS() - startTime) / 1e6, true);
+}
 
-	w = SUPERTILE_DIST_WIDE+ITEM_WINDOW+1;
 
-	gCurrentSuperTileCol -= w;								// start left and scroll into position
+/**************** FILL SCROLL WINDOW ***********************/
+//
+// Frees every supertile outside the scroll window at gCurrentSuperTileRow/Col
+// and builds all the ones missing inside it.
+//
+// OUTPUT: # of supertiles built
+//
 
-	gDisableHiccupTimer = true;
+static int FillScrollWindow(void)
+{
+int		top,bottom,left,right;
+int		*newSuperTiles;
+int		numNew = 0;
 
-	for (i=0; i < w; i++)
+	top = gCurrentSuperTileRow;
+	left = gCurrentSuperTileCol;
+	bottom = top + SUPERTILE_DIST_DEEP - 1;
+	right = left + SUPERTILE_DIST_WIDE - 1;
+
+			/* FREE THE SUPERTILES THAT LEFT THE WINDOW */
+
+	for (int i = 0; i < MAX_SUPERTILES; i++)
 	{
-		ScrollTerrainLeft();
-		CalcNewItemDeleteWindow();							// recalc item delete window
+		if (gSuperTileMemoryList[i].mode != SUPERTILE_MODE_USED)
+			continue;
+
+		int row = gSuperTileMemoryList[i].row / SUPERTILE_SIZE;
+		int col = gSuperTileMemoryList[i].col / SUPERTILE_SIZE;
+
+		if (row < top || row > bottom || col < left || col > right)
+		{
+			ReleaseSuperTileObject(i);
+			gTerrainScrollBuffer[row][col] = EMPTY_SUPERTILE;
+		}
 	}
 
-	gDisableHiccupTimer = false;
+			/* CLAIM MEMORY FOR THE EMPTY SPOTS */
+
+	if (top < 0)
+		top = 0;
+	if (left < 0)
+		left = 0;
+	if (bottom >= gNumSuperTilesDeep)
+		bottom = gNumSuperTilesDeep - 1;
+	if (right >= gNumSuperTilesWide)
+		right = gNumSuperTilesWide - 1;
+
+	newSuperTiles = (int *) AllocPtr(sizeof(int) * MAX_SUPERTILES);
+	GAME_ASSERT(newSuperTiles);
+
+	for (int row = top; row <= bottom; row++)
+	{
+		for (int col = left; col <= right; col++)
+		{
+			if (gTerrainScrollBuffer[row][col] != EMPTY_SUPERTILE)
+				continue;
+
+			int superTileNum = StartSuperTile(col * SUPERTILE_SIZE, row * SUPERTILE_SIZE);
+			gSuperTileMemoryList[superTileNum].hiccupTimer = 0;		// all uploaded right away, nothing to stagger
+			gTerrainScrollBuffer[row][col] = superTileNum;
+			newSuperTiles[numNew++] = superTileNum;
+		}
+	}
+
+			/* BUILD THEM */
+
+	BuildSuperTilesInParallel(newSuperTiles, numNew);
+
+	DisposePtr((Ptr) newSuperTiles);
+	return(numNew);
+}
+
+
+/**************** BUILD SUPERTILES IN PARALLEL ***********************/
+//
+// Builds the geometry & textures of supertiles set up by StartSuperTile, spreading
+// them over worker threads.  The map layers must already be paged in.
+//
+// Texture uploads have to happen on this thread, so the supertiles are done in batches
+// that each get their own texture buffer; a batch is uploaded once all its supertiles
+// are built.  If threads can't be created, everything is built on this thread.
+//
+
+typedef struct
+{
+	SuperTileMemoryType*	superTile;
+	UInt16*					textureBuffer;
+	const UInt16*			textureData;						// what to upload (set by the builder)
+}SuperTileBuildJob;
+
+typedef struct
+{
+	SuperTileBuildJob*		jobs;
+	int						numJobs;
+	SDL_AtomicInt			nextJob;
+}SuperTileBuildBatch;
+
+static int SDLCALL SuperTileBuildThread(void* data)
+{
+	SuperTileBuildBatch* batch = (SuperTileBuildBatch*) data;
+	TQ3Point3D workGrid[SUPERTILE_SIZE+1][SUPERTILE_SIZE+1];
+
+	for (int i = SDL_AddAtomicInt(&batch->nextJob, 1); i < batch->numJobs; i = SDL_AddAtomicInt(&batch->nextJob, 1))
+	{
+		SuperTileBuildJob* job = &batch->jobs[i];
+
+		BuildSuperTileGeometry(job->superTile, workGrid);
+		job->textureData = DrawSuperTileTexture(job->superTile, job->textureBuffer);
+	}
+
+	return 0;
+}
+
+static void BuildSuperTilesInParallel(const int* superTileNums, int count)
+{
+const size_t		textureBufferSize = TEMP_TEXTURE_BUFF_SIZE * TEMP_TEXTURE_BUFF_SIZE;
+int					numThreads,batchSize;
+SuperTileBuildJob	*jobs;
+UInt16				*textureBuffers;
+SDL_Thread			*threads[MAX_TERRAIN_BUILD_THREADS];
+SuperTileBuildBatch	batch;
+
+	if (count <= 0)
+		return;
+
+	numThreads = SDL_clamp(SDL_GetNumLogicalCPUCores(), 1, MAX_TERRAIN_BUILD_THREADS);
+	batchSize = SDL_min(numThreads * SUPERTILES_PER_BUILD_THREAD, count);
+
+	jobs = (SuperTileBuildJob *) AllocPtr(sizeof(SuperTileBuildJob) * batchSize);
+	textureBuffers = (UInt16 *) AllocPtr(sizeof(UInt16) * textureBufferSize * batchSize);
+	GAME_ASSERT(jobs && textureBuffers);
+
+	for (int first = 0; first < count; first += batchSize)
+	{
+		int numHelpers = 0;
+
+		batch.jobs = jobs;
+		batch.numJobs = SDL_min(batchSize, count - first);
+		SDL_SetAtomicInt(&batch.nextJob, 0);
+
+		for (int i = 0; i < batch.numJobs; i++)
+		{
+			jobs[i].superTile = &gSuperTileMemoryList[superTileNums[first + i]];
+			jobs[i].textureBuffer = textureBuffers + i * textureBufferSize;
+			jobs[i].textureData = nil;
+		}
+
+				/* BUILD ON THE HELPERS & THIS THREAD */
+
+		while (numHelpers < numThreads - 1 && numHelpers < batch.numJobs - 1)
+		{
+			threads[numHelpers] = SDL_CreateThread(SuperTileBuildThread, "SuperTileBuild", &batch);
+			if (!threads[numHelpers])								// make do with what we've got
+				break;
+			numHelpers++;
+		}
+
+		SuperTileBuildThread(&batch);
+
+		for (int t = 0; t < numHelpers; t++)
+			SDL_WaitThread(threads[t], NULL);
+
+				/* UPLOAD THE BATCH'S MESHES & TEXTURES */
+
+		for (int i = 0; i < batch.numJobs; i++)
+		{
+			Render_UpdatePooledMesh(jobs[i].superTile->triMeshPtr);
+			UploadSuperTileTexture(jobs[i].superTile, jobs[i].textureData);
+		}
+	}
+
+	DisposePtr((Ptr) textureBuffers);
+	DisposePtr((Ptr) jobs);
+}
+
+
+/**************** ADD ITEMS IN ITEM WINDOW ***********************/
+//
+// Adds the terrain items within ITEM_WINDOW supertiles of the scroll window.
+// Items already in play have ITEM_FLAGS_INUSE set, so they won't be added twice.
+//
+
+static void AddItemsInItemWindow(void)
+{
+int	top,bottom,left,right;
+
+	top = gCurrentSuperTileRow - ITEM_WINDOW;
+	bottom = gCurrentSuperTileRow + (SUPERTILE_DIST_DEEP-1) + ITEM_WINDOW;
+	left = gCurrentSuperTileCol - ITEM_WINDOW;
+	right = gCurrentSuperTileCol + (SUPERTILE_DIST_WIDE-1) + ITEM_WINDOW;
+
+	if (top < 0)
+		top = 0;
+	if (left < 0)
+		left = 0;
+	if (bottom >= gNumSuperTilesDeep)
+		bottom = gNumSuperTilesDeep - 1;
+	if (right >= gNumSuperTilesWide)
+		right = gNumSuperTilesWide - 1;
+
+	if (top > bottom || left > right)							// window is entirely off the map
+		return;
+
+	ScanForPlayfieldItems(top, bottom, left, right);
+}
+
+
+/**************** SET SUPERTILE ACTIVE RANGE ***********************/
+//
+// Changes how many supertiles are kept around the player in mid-level.
+//
+// The supertile memory list and the scroll window are both sized by SUPERTILE_ACTIVE_RANGE,
+// so throw all the supertiles away, rebuild the list for the new range, and prime the
+// scroll buffer again around the player just like at the start of the level.
+// Terrain items already in play keep their ITEM_FLAGS_INUSE flag, so priming won't add them twice.
+//
+
+void SetSuperTileActiveRange(int range)
+{
+	if (range == SUPERTILE_ACTIVE_RANGE)
+		return;
+
+	DisposeSuperTileMemoryList();							// list is sized by the old range
+
+	SUPERTILE_ACTIVE_RANGE = range;
+
+	RecenterTerrainOnPlayer();
+}
+
+
+/**************** RECENTER TERRAIN ON PLAYER ***********************/
+//
+// Throws away every supertile and primes the scroll window again around gMyCoord,
+// so the player can be put anywhere on the map.
+// Terrain items with ITEM_FLAGS_INUSE set are left alone, same as when priming at level start.
+//
+
+void RecenterTerrainOnPlayer(void)
+{
+long	x,y;
+int		dummy1,dummy2;
+
+	DisposeSuperTileMemoryList();
+	CreateSuperTileMemoryList();
+	ClearScrollBuffer();
+
+			/* RECENTER SCROLL WINDOW ON PLAYER */
+
+	x = gMyCoord.x-(SUPERTILE_ACTIVE_RANGE*SUPERTILE_SIZE*TERRAIN_POLYGON_SIZE);
+	y = gMyCoord.z-(SUPERTILE_ACTIVE_RANGE*SUPERTILE_SIZE*TERRAIN_POLYGON_SIZE);
+	GetSuperTileInfo(x, y, &gCurrentSuperTileCol, &gCurrentSuperTileRow, &dummy1, &dummy2);
+
+	PrimeInitialTerrain();
 }
 
 
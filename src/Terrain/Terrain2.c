@@ -376,6 +376,7 @@ TQ3Matrix4x4	*matrix = &theNode->BaseTransformMatrix;
 TQ3Vector3D		lookAt,upVector,theXAxis;
 
 	Q3Matrix4x4_SetIdentity(matrix);											// init the matrix
+	theNode->XformRotOrder = XFORM_NEEDS_REBUILD;								// matrix no longer matches Coord/Rot/Scale
 	
 	rotY = theNode->Rot.y;
 	
@@ -0,0 +1,247 @@
+/****************************/
+/*   	TERRAIN PAGING.C    */
+/****************************/
+//
+// The texture, heightmap and path layers are the only parts of a .ter file that grow with the
+// area of the map (2 bytes per tile each), so instead of holding them in RAM for the whole level
+// they're read from the open terrain file one band of SUPERTILE_SIZE rows at a time.
+//
+// Only the bands around the scroll window are resident.  The rest of the game keeps indexing
+// gTerrainTextureLayer[row][col] etc. as before: a row that isn't paged in points at a shared
+// row of zeros, which reads back as a blank tile / no path.  Nothing that looks at the layers
+// (supertile building, height & collision queries, terrain items) reaches further from the
+// player than the item delete window, and the resident bands cover that with room to spare.
+//
+
+
+/****************************/
+/*    EXTERNALS             */
+/****************************/
+
+#include "game.h"
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	NUM_PAGED_LAYERS	3
+
+#define	BAND_ROWS			SUPERTILE_SIZE				// # tile rows per page
+
+#define	PAGE_MARGIN			3							// # extra bands kept on each side of the scroll window (covers item window + slack)
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+typedef struct
+{
+	UInt16		***rowTable;							// the layer's row pointer array (e.g. &gTerrainTextureLayer)
+	SInt32		fileOffset;								// where the layer starts in the file (0 == layer not in file)
+	UInt16		**bands;								// [numBands] resident band data or nil
+}PagedLayer;
+
+static	short		gTerrainFileRefNum = -1;
+static	PagedLayer	gPagedLayers[NUM_PAGED_LAYERS];
+static	int			gNumBands = 0;
+static	int			gResidentTop = 0, gResidentBottom = -1;		// range of resident bands (inclusive)
+static	UInt16		*gBlankTerrainRow = nil;
+
+
+/******************** INIT TERRAIN PAGING *************************/
+//
+// Takes ownership of the open terrain file and sets every layer row to the blank row.
+// gTerrainTileWidth/Depth must be set already.
+//
+// INPUT:	refNum = open terrain file
+//			xxxOffset = file offsets of the layers from the .ter header (0 if not present)
+//
+
+void InitTerrainPaging(short refNum, SInt32 textureOffset, SInt32 heightmapOffset, SInt32 pathOffset)
+{
+	GAME_ASSERT(gTerrainFileRefNum == -1);
+	GAME_ASSERT(gTerrainTileWidth > 0 && gTerrainTileDepth > 0);
+
+	gTerrainFileRefNum = refNum;
+
+	gNumBands = (gTerrainTileDepth + BAND_ROWS - 1) / BAND_ROWS;
+	gResidentTop = 0;
+	gResidentBottom = -1;
+
+	gBlankTerrainRow = (UInt16 *) NewPtrClear(sizeof(UInt16) * gTerrainTileWidth);
+	GAME_ASSERT(gBlankTerrainRow);
+
+	gPagedLayers[0] = (PagedLayer) { &gTerrainTextureLayer,		textureOffset,		nil };
+	gPagedLayers[1] = (PagedLayer) { &gTerrainHeightMapLayer,	heightmapOffset,	nil };
+	gPagedLayers[2] = (PagedLayer) { &gTerrainPathLayer,		pathOffset,			nil };
+
+	for (int i = 0; i < NUM_PAGED_LAYERS; i++)
+	{
+		PagedLayer* layer = &gPagedLayers[i];
+
+		*layer->rowTable = (UInt16 **) AllocPtr(sizeof(UInt16 *) * gTerrainTileDepth);		// alloc mem for 1st dimension of array
+		GAME_ASSERT(*layer->rowTable);
+
+		for (int row = 0; row < gTerrainTileDepth; row++)
+			(*layer->rowTable)[row] = gBlankTerrainRow;
+
+		if (layer->fileOffset > 0)
+		{
+			layer->bands = (UInt16 **) NewPtrClear(sizeof(UInt16 *) * gNumBands);
+			GAME_ASSERT(layer->bands);
+		}
+	}
+}
+
+
+/******************** PAGE IN BAND *************************/
+
+static void PageInBand(int band)
+{
+int		firstRow = band * BAND_ROWS;
+int		numRows = gTerrainTileDepth - firstRow;
+long	count;
+OSErr	iErr;
+
+	if (numRows > BAND_ROWS)
+		numRows = BAND_ROWS;
+
+	for (int i = 0; i < NUM_PAGED_LAYERS; i++)
+	{
+		PagedLayer* layer = &gPagedLayers[i];
+
+		if (!layer->bands || layer->bands[band])						// not in file, or already resident
+			continue;
+
+		UInt16* data = (UInt16 *) AllocPtr(sizeof(UInt16) * gTerrainTileWidth * numRows);
+		GAME_ASSERT(data);
+
+				/* READ THE BAND'S ROWS */
+
+		iErr = SetFPos(gTerrainFileRefNum, fsFromStart, layer->fileOffset + (long)firstRow * gTerrainTileWidth * sizeof(UInt16));
+		GAME_ASSERT(iErr == noErr);
+
+		count = sizeof(UInt16) * gTerrainTileWidth * numRows;
+		iErr = FSRead(gTerrainFileRefNum, &count, (Ptr) data);
+		GAME_ASSERT(iErr == noErr);
+
+#if !(__BIG_ENDIAN__)
+		ByteswapInts(sizeof(UInt16), gTerrainTileWidth * numRows, data);
+#endif
+
+		layer->bands[band] = data;
+
+		for (int r = 0; r < numRows; r++)								// set [row] to point to layer's row(n)
+			(*layer->rowTable)[firstRow + r] = data + r * gTerrainTileWidth;
+	}
+}
+
+
+/******************** PAGE OUT BAND *************************/
+
+static void PageOutBand(int band)
+{
+int		firstRow = band * BAND_ROWS;
+
+	for (int i = 0; i < NUM_PAGED_LAYERS; i++)
+	{
+		PagedLayer* layer = &gPagedLayers[i];
+
+		if (!layer->bands || !layer->bands[band])
+			continue;
+
+		for (int row = firstRow; row < firstRow + BAND_ROWS && row < gTerrainTileDepth; row++)
+			(*layer->rowTable)[row] = gBlankTerrainRow;
+
+		DisposePtr((Ptr) layer->bands[band]);
+		layer->bands[band] = nil;
+	}
+}
+
+
+/******************** PAGE TERRAIN AROUND SCROLL WINDOW *************************/
+//
+// Makes sure every band within PAGE_MARGIN supertiles of the scroll window is resident
+// and drops the ones that fell out of it.  Cheap when nothing changed.
+//
+// Call whenever gCurrentSuperTileRow may have moved, before touching the layers.
+//
+
+void PageTerrainAroundScrollWindow(void)
+{
+int		top,bottom;
+
+	if (gTerrainFileRefNum == -1)
+		return;
+
+	top = gCurrentSuperTileRow - PAGE_MARGIN;
+	bottom = gCurrentSuperTileRow + SUPERTILE_DIST_DEEP - 1 + PAGE_MARGIN;
+
+	if (top < 0)
+		top = 0;
+	if (bottom >= gNumBands)
+		bottom = gNumBands - 1;
+
+	if (top == gResidentTop && bottom == gResidentBottom)
+		return;
+
+			/* DROP BANDS THAT LEFT THE WINDOW */
+
+	for (int band = gResidentTop; band <= gResidentBottom; band++)
+	{
+		if (band < top || band > bottom)
+			PageOutBand(band);
+	}
+
+			/* READ BANDS THAT ENTERED IT */
+
+	for (int band = top; band <= bottom; band++)
+		PageInBand(band);
+
+	gResidentTop = top;
+	gResidentBottom = bottom;
+}
+
+
+/******************** DISPOSE TERRAIN PAGING *************************/
+//
+// Frees all resident bands and closes the terrain file.
+// The layers' row pointer arrays are freed by DisposeTerrain.
+//
+
+void DisposeTerrainPaging(void)
+{
+	if (gTerrainFileRefNum == -1)
+		return;
+
+	for (int i = 0; i < NUM_PAGED_LAYERS; i++)
+	{
+		PagedLayer* layer = &gPagedLayers[i];
+
+		if (layer->bands)
+		{
+			for (int band = 0; band < gNumBands; band++)
+			{
+				if (layer->bands[band])
+					DisposePtr((Ptr) layer->bands[band]);
+			}
+			DisposePtr((Ptr) layer->bands);
+			layer->bands = nil;
+		}
+	}
+
+	if (gBlankTerrainRow)
+	{
+		DisposePtr((Ptr) gBlankTerrainRow);
+		gBlankTerrainRow = nil;
+	}
+
+	FSClose(gTerrainFileRefNum);
+	gTerrainFileRefNum = -1;
+
+	gNumBands = 0;
+	gResidentTop = 0;
+	gResidentBottom = -1;
+}
@@ -0,0 +1,1112 @@
+// NANOSAUR MICROBENCHMARKS
+// Times engine hot paths on the real game data, with nothing shown on screen.
+//
+// Usage:
+//     NanosaurBench [--filter TEXT] [--min-time SECONDS] [--repeat N]
+//                   [--json FILE|-] [--terrain-file FILE.ter] [--data DIR] [--list]
+//                   [--vulkan [--compare-frames [--max-frame-diff N]]]
+//
+// Each case is run in batches until a batch lasts at least --min-time, then --repeat
+// batches are timed. We report the median and best ns/op, plus heap allocations per op.
+// Cases that need a loaded level (terrain, skeletons, collision, depth sort) are skipped
+// if no OpenGL context can be created; pool, TGA & transform cases always run.
+//
+// Builds with NANOSAUR_VULKAN also take --vulkan, which mirrors the 3D view into the Vulkan
+// backend (so render/frame times both), and --compare-frames, which draws a frame with both
+// backends and reports how far apart the pixels & the CPU submission times are.
+
+#include <SDL3/SDL.h>
+
+#include "Pomme.h"
+#include "PommeGraphics.h"
+#include "PommeInit.h"
+#include "PommeFiles.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+	#include "game.h"
+
+	SDL_Window* gSDLWindow = nullptr;
+	WindowPtr gCoverWindow = nullptr;
+	UInt32* gBackdropPixels = nullptr;
+	FSSpec gDataSpec;
+	int gCurrentAntialiasingLevel = 0;
+
+	extern int gWindowWidth;
+	extern int gWindowHeight;
+
+	void FSMakeCustomSpec(const char* hostPath, FSSpec* outSpec)
+	{
+		*outSpec = Pomme::Files::HostPathToFSSpec(hostPath);
+	}
+}
+
+#pragma mark - Allocation counter
+
+// Counts heap allocations made anywhere in the process (game code, Pomme, STL).
+// With BENCH_WRAP_MALLOC (GNU-style linkers), malloc/calloc/realloc are routed through
+// the __wrap_ functions below; otherwise we can only see C++ operator new.
+
+static std::atomic<uint64_t> gAllocCount{0};
+
+#if BENCH_WRAP_MALLOC
+extern "C"
+{
+	void* __real_malloc(size_t size);
+	void* __real_calloc(size_t count, size_t size);
+	void* __real_realloc(void* ptr, size_t size);
+
+	void* __wrap_malloc(size_t size)
+	{
+		gAllocCount.fetch_add(1, std::memory_order_relaxed);
+		return __real_malloc(size);
+	}
+
+	void* __wrap_calloc(size_t count, size_t size)
+	{
+		gAllocCount.fetch_add(1, std::memory_order_relaxed);
+		return __real_calloc(count, size);
+	}
+
+	void* __wrap_realloc(void* ptr, size_t size)
+	{
+		gAllocCount.fetch_add(1, std::memory_order_relaxed);
+		return __real_realloc(ptr, size);
+	}
+}
+#endif
+
+void* operator new(size_t size)
+{
+#if !BENCH_WRAP_MALLOC
+	gAllocCount.fetch_add(1, std::memory_order_relaxed);
+#endif
+	void* p = std::malloc(size ? size : 1);			// counted by __wrap_malloc if wrapping
+	if (!p)
+		throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void* p) noexcept				{ std::free(p); }
+void operator delete(void* p, size_t) noexcept		{ std::free(p); }
+void* operator new[](size_t size)					{ return operator new(size); }
+void operator delete[](void* p) noexcept			{ std::free(p); }
+void operator delete[](void* p, size_t) noexcept	{ std::free(p); }
+
+#pragma mark - Harness
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchCase
+{
+	std::string						name;
+	std::string						description;
+	bool							needsLevel;
+	std::function<void()>			setup;			// may be empty
+	std::function<long(long)>		body;			// runs N iterations, returns # of ops performed
+	std::function<void()>			teardown;		// may be empty
+};
+
+struct BenchResult
+{
+	std::string		name;
+	std::string		description;
+	double			medianNsPerOp;
+	double			bestNsPerOp;
+	double			allocsPerOp;
+	long			opsPerSample;
+	int				samples;
+};
+
+static double	gMinTime		= 0.2;				// seconds per timed batch
+static int		gRepeat			= 5;
+static bool		gHaveLevel		= false;
+static volatile float gSink		= 0;				// keeps results alive so the optimizer can't drop the work
+
+struct FrameCompare
+{
+	std::string		deviceName;
+	int				width;
+	int				height;
+	double			glSubmitMs;
+	double			vulkanSubmitMs;
+	double			vulkanGpuMs;
+	double			meanDiff;				// mean absolute difference per RGB channel, 0-255
+	int				maxDiff;
+};
+
+static BenchResult RunCase(const BenchCase& bc)
+{
+	if (bc.setup)
+		bc.setup();
+
+	bc.body(1);										// warm caches
+
+			/* FIND A BATCH SIZE THAT TAKES AT LEAST gMinTime */
+
+	long iterations = 1;
+	while (true)
+	{
+		auto t0 = Clock::now();
+		bc.body(iterations);
+		double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+
+		if (seconds >= gMinTime || iterations >= (1L << 30))
+			break;
+
+		if (seconds <= 0)
+			iterations *= 16;
+		else
+			iterations = (long) std::min<double>(iterations * 16.0, iterations * (gMinTime * 1.2 / seconds) + 1);
+	}
+
+			/* TIME THE SAMPLES */
+
+	std::vector<double> nsPerOp;
+	uint64_t totalAllocs = 0;
+	long totalOps = 0;
+	long opsPerSample = 0;
+
+	for (int r = 0; r < gRepeat; r++)
+	{
+		uint64_t allocs0 = gAllocCount.load();
+		auto t0 = Clock::now();
+		long ops = bc.body(iterations);
+		auto t1 = Clock::now();
+		uint64_t allocs1 = gAllocCount.load();
+
+		ops = std::max(ops, 1L);
+		nsPerOp.push_back(std::chrono::duration<double, std::nano>(t1 - t0).count() / ops);
+		totalAllocs += allocs1 - allocs0;
+		totalOps += ops;
+		opsPerSample = ops;
+	}
+
+	if (bc.teardown)
+		bc.teardown();
+
+	std::sort(nsPerOp.begin(), nsPerOp.end());
+
+	BenchResult result;
+	result.name				= bc.name;
+	result.description		= bc.description;
+	result.medianNsPerOp	= nsPerOp[nsPerOp.size() / 2];
+	result.bestNsPerOp		= nsPerOp[0];
+	result.allocsPerOp		= (double) totalAllocs / totalOps;
+	result.opsPerSample		= opsPerSample;
+	result.samples			= gRepeat;
+	return result;
+}
+
+#pragma mark - Cases: Pool
+
+static Pool* gBenchPool = nullptr;
+
+static void AddPoolCases(std::vector<BenchCase>& cases)
+{
+	static const int kCapacity = 1024;					// same as OBJ_BUDGET in Objects.c
+
+	cases.push_back({
+		"pool/allocate_release", "allocate every index of a full-size pool, then release them all (1 op = 1 pair)",
+		false,
+		[] { gBenchPool = Pool_New(kCapacity); },
+		[](long n) -> long
+		{
+			for (long it = 0; it < n; it++)
+			{
+				for (int i = 0; i < kCapacity; i++)
+					Pool_AllocateIndex(gBenchPool);
+				for (int i = 0; i < kCapacity; i++)
+					Pool_ReleaseIndex(gBenchPool, (i * 7) % kCapacity);		// 7 is coprime to the capacity: scattered order
+			}
+			return n * kCapacity;
+		},
+		[] { Pool_Free(gBenchPool); gBenchPool = nullptr; },
+	});
+
+	cases.push_back({
+		"pool/iterate_half_full", "walk the used indices of a pool with every other index released (1 op = 1 index visited)",
+		false,
+		[]
+		{
+			gBenchPool = Pool_New(kCapacity);
+			for (int i = 0; i < kCapacity; i++)
+				Pool_AllocateIndex(gBenchPool);
+			for (int i = 0; i < kCapacity; i += 2)
+				Pool_ReleaseIndex(gBenchPool, i);
+		},
+		[](long n) -> long
+		{
+			long sum = 0;
+			for (long it = 0; it < n; it++)
+				for (int i = Pool_First(gBenchPool); i >= 0; i = Pool_Next(gBenchPool, i))
+					sum += i;
+			gSink = (float) sum;
+			return n * Pool_Size(gBenchPool);
+		},
+		[] { Pool_Free(gBenchPool); gBenchPool = nullptr; },
+	});
+}
+
+#pragma mark - Cases: TGA
+
+static void AddTGACases(std::vector<BenchCase>& cases)
+{
+	static const char* kImages[] = { "Shadow", "Infobar", "Map" };
+
+	for (const char* image : kImages)
+	{
+		std::string path = std::string(":Images:") + image + ".tga";
+
+		cases.push_back({
+			std::string("tga/read/") + image, "ReadTGA + convert to ARGB + DisposePtr",
+			false,
+			{},
+			[path](long n) -> long
+			{
+				FSSpec spec;
+				OSErr err = FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, path.c_str(), &spec);
+				GAME_ASSERT(!err);
+
+				for (long it = 0; it < n; it++)
+				{
+					uint8_t* pixels = nil;
+					TGAHeader header;
+					err = ReadTGA(&spec, &pixels, &header, true);
+					GAME_ASSERT(!err);
+					gSink = pixels[0];
+					DisposePtr((Ptr) pixels);
+				}
+				return n;
+			},
+			{},
+		});
+	}
+}
+
+#pragma mark - Cases: Terrain
+
+static std::vector<TQ3Point3D> gBenchCoords;
+
+static void MakeCoordsAroundPlayer(void)
+{
+	const float range = SUPERTILE_ACTIVE_RANGE * TERRAIN_SUPERTILE_UNIT_SIZE;
+	uint32_t seed = 12345;
+
+	gBenchCoords.resize(4096);
+	for (auto& p : gBenchCoords)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		p.x = gMyCoord.x + ((seed >> 8) / (float) (1 << 24) * 2 - 1) * range;
+		seed = seed * 1664525u + 1013904223u;
+		p.z = gMyCoord.z + ((seed >> 8) / (float) (1 << 24) * 2 - 1) * range;
+		p.y = 0;
+	}
+}
+
+static void AddTerrainCases(std::vector<BenchCase>& cases)
+{
+	static const struct
+	{
+		const char*		name;
+		float			(*func)(float x, float z);
+	} kHeightFuncs[] =
+	{
+		{ "terrain/height_at_coord",			GetTerrainHeightAtCoord },
+		{ "terrain/height_at_coord_planar",		GetTerrainHeightAtCoord_Planar },
+		{ "terrain/height_at_coord_quick",		[](float x, float z) { return GetTerrainHeightAtCoord_Quick((long) x, (long) z); } },
+	};
+
+	for (const auto& hf : kHeightFuncs)
+	{
+		auto func = hf.func;
+
+		cases.push_back({
+			hf.name, "terrain height query at random spots within the active supertile range",
+			true,
+			MakeCoordsAroundPlayer,
+			[func](long n) -> long
+			{
+				float sum = 0;
+				for (long it = 0; it < n; it++)
+				{
+					const TQ3Point3D& p = gBenchCoords[it & 4095];
+					sum += func(p.x, p.z);
+				}
+				gSink = sum;
+				return n;
+			},
+			{},
+		});
+	}
+
+	for (int textureOnly = 0; textureOnly <= 1; textureOnly++)
+	{
+		cases.push_back({
+			textureOnly ? "terrain/update_supertile_texture" : "terrain/build_supertile",
+			textureOnly ? "UpdateSuperTileTexture on active supertiles (includes the glTexSubImage2D call)"
+						: "BuildTerrainSuperTile on active supertiles (mesh, normals, planes & texture)",
+			true,
+			{},
+			[textureOnly](long n) -> long
+			{
+				static int next = 0;
+				long ops = 0;
+
+				for (long it = 0; it < n; it++)
+				{
+					for (int tries = 0; tries < MAX_SUPERTILES; tries++)		// find the next active supertile
+					{
+						next = (next + 1) % MAX_SUPERTILES;
+						if (RebuildSuperTile(next, textureOnly))
+						{
+							ops++;
+							break;
+						}
+					}
+				}
+				return ops;
+			},
+			{},
+		});
+	}
+}
+
+#pragma mark - Cases: Skeletons
+
+static const char* kSkeletonNames[MAX_SKELETON_TYPES] = { "ptera", "rex", "stego", "deinon", "tricer", "spitter" };
+
+static ObjNode* gBenchSkeleton = nullptr;
+
+static void MakeBenchSkeleton(int type)
+{
+	gNewObjectDefinition.type		= type;
+	gNewObjectDefinition.animNum	= 0;
+	gNewObjectDefinition.coord		= gMyCoord;
+	gNewObjectDefinition.coord.x	+= 2000;						// out of the player's way
+	gNewObjectDefinition.slot		= SLOT_OF_DUMB - 1;
+	gNewObjectDefinition.flags		= 0;
+	gNewObjectDefinition.moveCall	= nil;
+	gNewObjectDefinition.rot		= 0;
+	gNewObjectDefinition.scale		= 1.0f;
+	gBenchSkeleton = MakeNewSkeletonObject(&gNewObjectDefinition);
+	GAME_ASSERT(gBenchSkeleton);
+	UpdateObjectTransforms(gBenchSkeleton);
+}
+
+static void DeleteBenchSkeleton(void)
+{
+	DeleteObject(gBenchSkeleton);
+	gBenchSkeleton = nullptr;
+}
+
+static void AddSkeletonCases(std::vector<BenchCase>& cases)
+{
+	for (int type = 0; type < MAX_SKELETON_TYPES; type++)
+	{
+		cases.push_back({
+			std::string("skeleton/update_skinned_geometry/") + kSkeletonNames[type], "UpdateSkinnedGeometry on one skeleton in its first pose",
+			true,
+			[type] { MakeBenchSkeleton(type); },
+			[](long n) -> long
+			{
+				for (long it = 0; it < n; it++)
+					UpdateSkinnedGeometry(gBenchSkeleton);
+				return n;
+			},
+			DeleteBenchSkeleton,
+		});
+
+		cases.push_back({
+			std::string("skeleton/decompose/") + kSkeletonNames[type], "DecomposeATriMesh over every mesh of the skeleton's reference model",
+			true,
+			[type] { MakeBenchSkeleton(type); },
+			[](long n) -> long
+			{
+				SkeletonDefType* def = (SkeletonDefType*) gBenchSkeleton->Skeleton->skeletonDefinition;
+				for (long it = 0; it < n; it++)
+					DecomposeReferenceModel(def);								// rebuilds identical lists
+				return n;
+			},
+			DeleteBenchSkeleton,
+		});
+	}
+}
+
+#pragma mark - Cases: Collision
+
+static std::vector<ObjNode*> gBenchColliders;
+
+static void AddCollisionCases(std::vector<BenchCase>& cases)
+{
+	static const int kCounts[] = { 16, 128, 1024 };
+
+	for (int count : kCounts)
+	{
+		cases.push_back({
+			"collision/detect/" + std::to_string(count), "CollisionDetect for the player with N extra solid boxes out of reach (on top of the level's own objects)",
+			true,
+			[count]
+			{
+				uint32_t seed = 777;
+
+				for (int i = 0; i < count; i++)
+				{
+					seed = seed * 1664525u + 1013904223u;
+					float angle = (seed >> 8) / (float) (1 << 24) * PI2;
+					seed = seed * 1664525u + 1013904223u;
+					float dist = 1500 + (seed >> 8) / (float) (1 << 24) * 4000;
+
+					gNewObjectDefinition.genre		= EVENT_GENRE;
+					gNewObjectDefinition.coord.x	= gMyCoord.x + SDL_cosf(angle) * dist;
+					gNewObjectDefinition.coord.z	= gMyCoord.z + SDL_sinf(angle) * dist;
+					gNewObjectDefinition.coord.y	= gMyCoord.y;
+					gNewObjectDefinition.slot		= 100;
+					gNewObjectDefinition.flags		= 0;
+					gNewObjectDefinition.moveCall	= nil;
+					ObjNode* node = MakeNewObject(&gNewObjectDefinition);
+					GAME_ASSERT(node);
+
+					node->CType = CTYPE_MISC;
+					node->CBits = CBITS_ALLSOLID;
+					SetObjectCollisionBounds(node, 100, -100, -100, 100, 100, -100);
+					gBenchColliders.push_back(node);
+				}
+			},
+			[](long n) -> long
+			{
+				for (long it = 0; it < n; it++)
+				{
+					GetObjectInfo(gPlayerObj);
+					CollisionDetect(gPlayerObj, CTYPE_MISC);
+				}
+				gSink = (float) gNumCollisions;
+				return n;
+			},
+			[]
+			{
+				for (ObjNode* node : gBenchColliders)
+					DeleteObject(node);
+				gBenchColliders.clear();
+			},
+		});
+	}
+}
+
+#pragma mark - Cases: Depth sort
+
+static std::vector<TQ3Point3D>			gBenchCenters;
+static std::vector<RenderModifiers>		gBenchMods;
+
+static void AddDepthSortCases(std::vector<BenchCase>& cases)
+{
+	static const int kCounts[] = { 64, 512, 2048 };
+
+	for (int count : kCounts)
+	{
+		cases.push_back({
+			"render/depth_sort/" + std::to_string(count), "submit N meshes at random depths & priorities, then sort the queue with DepthSortCompare (1 op = 1 mesh)",
+			true,
+			[count]
+			{
+				uint32_t seed = 4242;
+
+				gBenchCenters.resize(count);
+				gBenchMods.resize(count);
+				for (int i = 0; i < count; i++)
+				{
+					seed = seed * 1664525u + 1013904223u;
+					gBenchCenters[i].x = gMyCoord.x + ((seed >> 8) % 8000) - 4000.0f;
+					seed = seed * 1664525u + 1013904223u;
+					gBenchCenters[i].z = gMyCoord.z + ((seed >> 8) % 8000) - 4000.0f;
+					gBenchCenters[i].y = gMyCoord.y;
+
+					Render_SetDefaultModifiers(&gBenchMods[i]);
+					if ((i & 7) == 0)
+						gBenchMods[i].sortPriority = ((i >> 3) & 1) ? 1 : -1;		// a few meshes with a manual priority, like the game's
+				}
+			},
+			[count](long n) -> long
+			{
+				for (long it = 0; it < n; it++)
+				{
+					for (int i = 0; i < count; i++)
+						Render_SubmitMesh(nil, nil, &gBenchMods[i], &gBenchCenters[i]);
+					Render_SortMeshQueue();
+					Render_DiscardMeshQueue();
+				}
+				return n * count;
+			},
+			[] { gBenchCenters.clear(); gBenchMods.clear(); },
+		});
+	}
+}
+
+#pragma mark - Cases: Frame
+
+// One frame of the level's 3D view, as QD3D_DrawScene draws it, minus the backdrop & the swap
+// (so the frame can still be read back).
+static void DrawBenchFrame(void)
+{
+	QD3DSetupOutputType* setup = gGameViewInfoPtr;
+
+	SDL_GetWindowSizeInPixels(gSDLWindow, &gWindowWidth, &gWindowHeight);
+	TQ3Area pane = { {0, 0}, {(float) gWindowWidth, (float) gWindowHeight} };
+	setup->viewportAspectRatio = (float) gWindowWidth / (float) gWindowHeight;
+
+	CalcCameraMatrixInfo(setup);
+	Render_StartFrame();
+	Render_SetViewportClearColor(setup->clearColor);
+	Render_SetViewport(pane);
+	UpdateFrustumPlanes();
+	DrawTerrain(setup);
+	Render_EndFrame();
+}
+
+static void AddFrameCases(std::vector<BenchCase>& cases)
+{
+	cases.push_back({
+		"render/frame", "draw the level's 3D view from the player's spot: DrawTerrain + Render_EndFrame, no swap (also drawn with Vulkan under --vulkan)",
+		true,
+		{},
+		[](long n) -> long
+		{
+			for (long it = 0; it < n; it++)
+				DrawBenchFrame();
+			glFinish();
+			return n;
+		},
+		{},
+	});
+}
+
+#if RENDER_VULKAN
+// Draws warm-up frames with both backends, then reads the last one back from each.
+static bool CompareFrames(FrameCompare& out)
+{
+	static const int kNumFrames = 30;
+
+	float savedFade = gFadeOverlayOpacity;
+	gFadeOverlayOpacity = 0;								// the fade overlay is GL-only
+
+	double glMs = 0;
+	double vulkanMs = 0;
+	for (int i = 0; i < kNumFrames; i++)
+	{
+		if (i == kNumFrames - 1)
+			VkRender_RequestReadback();
+		DrawBenchFrame();
+		glMs += gRenderStats.submitMilliseconds;
+		vulkanMs += gRenderStats.vulkanSubmitMilliseconds;
+	}
+
+	gFadeOverlayOpacity = savedFade;
+
+	int w = gWindowWidth;
+	int h = gWindowHeight;
+	std::vector<uint8_t> glPixels((size_t) w * h * 4);
+	std::vector<uint8_t> vulkanPixels((size_t) w * h * 4);
+
+	glReadPixels(0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, glPixels.data());
+	if (!VkRender_ReadPixels(vulkanPixels.data(), w, h))
+		return false;
+
+			/* COMPARE (GL'S ROWS ARE BOTTOM-UP, VULKAN'S TOP-DOWN) */
+
+	uint64_t sum = 0;
+	int maxDiff = 0;
+	for (int y = 0; y < h; y++)
+	{
+		const uint8_t* glRow = &glPixels[(size_t) (h - 1 - y) * w * 4];
+		const uint8_t* vulkanRow = &vulkanPixels[(size_t) y * w * 4];
+		for (int x = 0; x < w; x++)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				int d = std::abs(glRow[x*4 + c] - vulkanRow[x*4 + c]);
+				sum += d;
+				maxDiff = std::max(maxDiff, d);
+			}
+		}
+	}
+
+	VulkanFrameInfo info;
+	VkRender_GetFrameInfo(&info);
+
+	out.deviceName		= info.deviceName;
+	out.width			= w;
+	out.height			= h;
+	out.glSubmitMs		= glMs / kNumFrames;
+	out.vulkanSubmitMs	= vulkanMs / kNumFrames;
+	out.vulkanGpuMs		= info.gpuMilliseconds;
+	out.meanDiff		= (double) sum / ((double) w * h * 3);
+	out.maxDiff			= maxDiff;
+	return true;
+}
+#endif
+
+#pragma mark - Cases: Object transforms
+
+static std::vector<ObjNode>		gBenchXformNodes;
+
+// UpdateObjectTransforms as it was before the closed-form build & the unchanged-input check,
+// kept here so the two can be compared.
+static void UpdateObjectTransforms_MultiplyChain(ObjNode* theNode)
+{
+	TQ3Matrix4x4 matrix;
+
+	Q3Matrix4x4_SetIdentity(&theNode->BaseTransformMatrix);
+
+	if ((theNode->Scale.x != 1) || (theNode->Scale.y != 1) || (theNode->Scale.z != 1))
+	{
+		Q3Matrix4x4_SetScale(&matrix, theNode->Scale.x, theNode->Scale.y, theNode->Scale.z);
+		Q3Matrix4x4_Multiply(&theNode->BaseTransformMatrix, &matrix, &theNode->BaseTransformMatrix);
+	}
+
+	if (theNode->StatusBits & STATUS_BIT_ROTZYX)
+	{
+		Q3Matrix4x4_SetRotate_Z(&matrix, theNode->Rot.z);
+		Q3Matrix4x4_Multiply(&theNode->BaseTransformMatrix, &matrix, &theNode->BaseTransformMatrix);
+		Q3Matrix4x4_SetRotate_Y(&matrix, theNode->Rot.y);
+		Q3Matrix4x4_Multiply(&theNode->BaseTransformMatrix, &matrix, &theNode->BaseTransformMatrix);
+		Q3Matrix4x4_SetRotate_X(&matrix, theNode->Rot.x);
+		Q3Matrix4x4_Multiply(&theNode->BaseTransformMatrix, &matrix, &theNode->BaseTransformMatrix);
+	}
+	else if (theNode->StatusBits & STATUS_BIT_ROTXZY)
+	{
+		Q3Matrix4x4_SetRotate_X(&matrix, theNode->Rot.x);
+		Q3Matrix4x4_Multiply(&theNode->BaseTransformMatrix, &matrix, &theNode->BaseTransformMatrix);
+		Q3Matrix4x4_SetRotate_Z(&matrix, theNode->Rot.z);
+		Q3Matrix4x4_Multiply(&theNode->BaseTransformMatrix, &matrix, &theNode->BaseTransformMatrix);
+		Q3Matrix4x4_SetRotate_Y(&matrix, theNode->Rot.y);
+		Q3Matrix4x4_Multiply(&theNode->BaseTransformMatrix, &matrix, &theNode->BaseTransformMatrix);
+	}
+	else
+	{
+		Q3Matrix4x4_SetRotate_XYZ(&matrix, theNode->Rot.x, theNode->Rot.y, theNode->Rot.z);
+		Q3Matrix4x4_Multiply(&theNode->BaseTransformMatrix, &matrix, &theNode->BaseTransformMatrix);
+	}
+
+	Q3Matrix4x4_SetTranslate(&matrix, theNode->Coord.x, theNode->Coord.y, theNode->Coord.z);
+	Q3Matrix4x4_Multiply(&theNode->BaseTransformMatrix, &matrix, &theNode->BaseTransformMatrix);
+}
+
+// Loose ObjNodes (not linked into the object list) with random placements,
+// a mix of rotation orders and about a quarter of them scaled, like the game's objects.
+static void MakeBenchXformNodes(void)
+{
+	static const uint32_t kRotOrders[] = { 0, 0, STATUS_BIT_ROTZYX, STATUS_BIT_ROTXZY };
+	uint32_t seed = 9001;
+
+	gBenchXformNodes.assign(1024, ObjNode{});
+	for (size_t i = 0; i < gBenchXformNodes.size(); i++)
+	{
+		ObjNode& node = gBenchXformNodes[i];
+		float* fields[] = { &node.Coord.x, &node.Coord.y, &node.Coord.z, &node.Rot.x, &node.Rot.y, &node.Rot.z };
+
+		for (int j = 0; j < 6; j++)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			*fields[j] = ((seed >> 8) / (float) (1 << 24) * 2 - 1) * (j >= 3 ? PI : 5000.0f);		// coords, then angles
+		}
+
+		float s = (i & 3) == 0 ? 1.0f + (i & 7) * 0.25f : 1.0f;
+		node.Scale = TQ3Vector3D{ s, s, s };
+		node.StatusBits = kRotOrders[i & 3];
+		node.XformRotOrder = XFORM_NEEDS_REBUILD;
+	}
+}
+
+static void AddTransformCases(std::vector<BenchCase>& cases)
+{
+	cases.push_back({
+		"transform/multiply_chain", "old UpdateObjectTransforms: Q3Matrix4x4 scale, per-axis rotations & translate concatenated with Q3Matrix4x4_Multiply (1 op = 1 object)",
+		false,
+		MakeBenchXformNodes,
+		[](long n) -> long
+		{
+			size_t count = gBenchXformNodes.size();
+			for (long it = 0; it < n; it++)
+				UpdateObjectTransforms_MultiplyChain(&gBenchXformNodes[it % count]);
+			gSink = gBenchXformNodes[0].BaseTransformMatrix.value[3][0];
+			return n;
+		},
+		[] { gBenchXformNodes.clear(); },
+	});
+
+	cases.push_back({
+		"transform/closed_form", "SetScaleRotateTranslateMatrix on the same inputs (1 op = 1 object)",
+		false,
+		MakeBenchXformNodes,
+		[](long n) -> long
+		{
+			size_t count = gBenchXformNodes.size();
+			for (long it = 0; it < n; it++)
+			{
+				ObjNode& node = gBenchXformNodes[it % count];
+				SetScaleRotateTranslateMatrix(&node.BaseTransformMatrix, &node.Scale, &node.Rot, &node.Coord,
+											node.StatusBits & (STATUS_BIT_ROTZYX | STATUS_BIT_ROTXZY));
+			}
+			gSink = gBenchXformNodes[0].BaseTransformMatrix.value[3][0];
+			return n;
+		},
+		[] { gBenchXformNodes.clear(); },
+	});
+
+	for (int affine = 0; affine <= 1; affine++)
+	{
+		cases.push_back({
+			affine ? "transform/multiply_affine" : "transform/q3_multiply",
+			affine	? "MultiplyAffineMatrices on two object matrices, as UpdateJointTransforms does (1 op = 1 multiply)"
+					: "Q3Matrix4x4_Multiply on the same matrices (1 op = 1 multiply)",
+			false,
+			[]
+			{
+				MakeBenchXformNodes();
+				for (ObjNode& node : gBenchXformNodes)
+					UpdateObjectTransforms(&node);
+			},
+			[affine](long n) -> long
+			{
+				size_t count = gBenchXformNodes.size();
+				TQ3Matrix4x4 result;
+				float sum = 0;
+				for (long it = 0; it < n; it++)
+				{
+					const TQ3Matrix4x4* a = &gBenchXformNodes[it % count].BaseTransformMatrix;
+					const TQ3Matrix4x4* b = &gBenchXformNodes[(it * 7) % count].BaseTransformMatrix;
+					if (affine)
+						MultiplyAffineMatrices(a, b, &result);
+					else
+						Q3Matrix4x4_Multiply(a, b, &result);
+					sum += result.value[3][0];
+				}
+				gSink = sum;
+				return n;
+			},
+			[] { gBenchXformNodes.clear(); },
+		});
+	}
+
+	for (int moving = 0; moving <= 1; moving++)
+	{
+		cases.push_back({
+			moving ? "transform/update_object/moving" : "transform/update_object/still",
+			moving	? "UpdateObjectTransforms with Rot.y nudged every call, so every call rebuilds (1 op = 1 object)"
+					: "UpdateObjectTransforms on objects that didn't move since their last build (1 op = 1 object)",
+			false,
+			MakeBenchXformNodes,
+			[moving](long n) -> long
+			{
+				size_t count = gBenchXformNodes.size();
+				for (long it = 0; it < n; it++)
+				{
+					ObjNode& node = gBenchXformNodes[it % count];
+					if (moving)
+						node.Rot.y += 0.001f;
+					UpdateObjectTransforms(&node);
+				}
+				gSink = gBenchXformNodes[0].BaseTransformMatrix.value[3][0];
+				return n;
+			},
+			[] { gBenchXformNodes.clear(); },
+		});
+	}
+}
+
+#pragma mark - Boot
+
+static bool SetDataFolder(const std::string& dataPath)
+{
+	FSSpec someDataFileSpec;
+
+	gDataSpec = Pomme::Files::HostPathToFSSpec(fs::path(dataPath) / "System");
+	return 0 == FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, ":System:gamecontrollerdb.txt", &someDataFileSpec);
+}
+
+static bool FindGameData(const char* executablePath, const std::string& userDataPath)
+{
+	if (!userDataPath.empty())
+		return SetDataFolder(userDataPath);
+
+	if (executablePath && SetDataFolder((fs::path(executablePath).parent_path() / "Data").string()))
+		return true;
+
+	if (SetDataFolder("Data"))
+		return true;
+
+#ifdef BENCH_DATA_DIR
+	if (SetDataFolder(BENCH_DATA_DIR))
+		return true;
+#endif
+
+	return false;
+}
+
+static bool CreateHiddenGLWindow(void)
+{
+	if (!SDL_Init(SDL_INIT_VIDEO))
+	{
+		SDL_Log("No video device (%s); trying the offscreen driver", SDL_GetError());
+		SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+		if (!SDL_Init(SDL_INIT_VIDEO))
+			return false;
+	}
+
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_COMPATIBILITY);
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 2);
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
+
+	gSDLWindow = SDL_CreateWindow("NanosaurBench", 640, 480, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+	if (!gSDLWindow)
+		return false;
+
+	gCoverWindow = Pomme::Graphics::GetScreenPort();
+	gBackdropPixels = (UInt32*) GetPixBaseAddr(GetGWorldPixMap(gCoverWindow));
+	return true;
+}
+
+// Same as ToolBoxInit + InitLevel, minus anything that would show up on the user's screen or speakers.
+static void BootLevel(void)
+{
+	OSErr iErr = FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, ":Skeletons", &gDataSpec);
+	GAME_ASSERT(!iErr);
+
+	QD3D_Boot();
+
+	LoadPrefs();
+	gGamePrefs.fullscreen			= false;
+	gGamePrefs.music				= false;
+	gGamePrefs.antialiasingLevel	= 0;
+
+	InitSkeletonManager();
+	InitSoundTools();
+	Init3DMFManager();
+	InitObjectManager();
+	InitSpriteManager();
+
+	InitLevel();
+}
+
+#pragma mark - Output
+
+static std::string JSONEscape(const std::string& s)
+{
+	std::string out;
+	for (char c : s)
+	{
+		if (c == '"' || c == '\\')
+			out += '\\';
+		out += c;
+	}
+	return out;
+}
+
+static void WriteJSON(FILE* f, const std::vector<BenchResult>& results, const std::vector<std::string>& skipped, const FrameCompare* compare)
+{
+	fprintf(f, "{\n");
+	fprintf(f, "  \"benchmark\": \"NanosaurBench\",\n");
+	fprintf(f, "  \"version\": \"%s\",\n", GAME_VERSION);
+	fprintf(f, "  \"terrain\": \"%s\",\n", JSONEscape(gCustomTerrainFile[0] ? gCustomTerrainFile : "Level1.ter").c_str());
+	fprintf(f, "  \"min_time_s\": %g,\n", gMinTime);
+#if BENCH_WRAP_MALLOC
+	fprintf(f, "  \"alloc_counter\": \"malloc+new\",\n");
+#else
+	fprintf(f, "  \"alloc_counter\": \"new\",\n");
+#endif
+	fprintf(f, "  \"results\": [\n");
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchResult& r = results[i];
+		fprintf(f, "    {\"name\": \"%s\", \"ns_per_op\": %.3f, \"best_ns_per_op\": %.3f, \"allocs_per_op\": %.4f, \"ops_per_sample\": %ld, \"samples\": %d, \"description\": \"%s\"}%s\n",
+				JSONEscape(r.name).c_str(), r.medianNsPerOp, r.bestNsPerOp, r.allocsPerOp, r.opsPerSample, r.samples,
+				JSONEscape(r.description).c_str(),
+				i + 1 < results.size() ? "," : "");
+	}
+	fprintf(f, "  ],\n");
+	fprintf(f, "  \"skipped\": [");
+	for (size_t i = 0; i < skipped.size(); i++)
+		fprintf(f, "%s\"%s\"", i ? ", " : "", JSONEscape(skipped[i]).c_str());
+	fprintf(f, "]");
+	if (compare)
+	{
+		fprintf(f, ",\n  \"frame_compare\": {\"vulkan_device\": \"%s\", \"width\": %d, \"height\": %d, \"gl_submit_ms\": %.3f, \"vulkan_submit_ms\": %.3f, \"vulkan_gpu_ms\": %.3f, \"mean_diff\": %.3f, \"max_diff\": %d}",
+				JSONEscape(compare->deviceName).c_str(), compare->width, compare->height,
+				compare->glSubmitMs, compare->vulkanSubmitMs, compare->vulkanGpuMs, compare->meanDiff, compare->maxDiff);
+	}
+	fprintf(f, "\n}\n");
+}
+
+#pragma mark - Main
+
+int main(int argc, char** argv)
+{
+	std::string filter;
+	std::string jsonPath;
+	std::string dataPath;
+	bool listOnly = false;
+	bool compareFrames = false;
+#if RENDER_VULKAN
+	double maxFrameDiff = -1;
+#endif
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "--filter" && hasValue)				filter = argv[++i];
+		else if (arg == "--min-time" && hasValue)		gMinTime = SDL_atof(argv[++i]);
+		else if (arg == "--repeat" && hasValue)			gRepeat = std::max(1, SDL_atoi(argv[++i]));
+		else if (arg == "--json" && hasValue)			jsonPath = argv[++i];
+		else if (arg == "--data" && hasValue)			dataPath = argv[++i];
+		else if (arg == "--terrain-file" && hasValue)	SDL_strlcpy(gCustomTerrainFile, argv[++i], sizeof(gCustomTerrainFile));
+		else if (arg == "--list")						listOnly = true;
+#if RENDER_VULKAN
+		else if (arg == "--vulkan")						gVulkanMode = true;
+		else if (arg == "--compare-frames")				compareFrames = true;
+		else if (arg == "--max-frame-diff" && hasValue)	maxFrameDiff = SDL_atof(argv[++i]);
+#endif
+		else
+		{
+			fprintf(stderr, "usage: %s [--filter TEXT] [--min-time SECONDS] [--repeat N] [--json FILE|-] [--terrain-file FILE] [--data DIR] [--list]"
+#if RENDER_VULKAN
+					" [--vulkan [--compare-frames [--max-frame-diff N]]]"
+#endif
+					"\n", argv[0]);
+			return 2;
+		}
+	}
+
+	std::vector<BenchCase> cases;
+	AddPoolCases(cases);
+	AddTransformCases(cases);
+	AddTGACases(cases);
+	AddTerrainCases(cases);
+	AddSkeletonCases(cases);
+	AddCollisionCases(cases);
+	AddDepthSortCases(cases);
+	AddFrameCases(cases);
+
+	cases.erase(std::remove_if(cases.begin(), cases.end(),
+			[&](const BenchCase& bc) { return bc.name.find(filter) == std::string::npos; }),
+			cases.end());
+
+	if (listOnly)
+	{
+		for (const auto& bc : cases)
+			printf("%-44s %s\n", bc.name.c_str(), bc.description.c_str());
+		return 0;
+	}
+
+	std::vector<BenchResult> results;
+	std::vector<std::string> skipped;
+	FrameCompare compare = {};
+	bool haveCompare = false;
+	FILE* report = jsonPath == "-" ? stderr : stdout;			// keep stdout clean for --json -
+	int exitCode = 0;
+
+	try
+	{
+		Pomme::Init();
+
+		if (!FindGameData(argc > 0 ? argv[0] : nullptr, dataPath))
+			throw std::runtime_error("Couldn't find the Data folder (use --data).");
+
+		bool wantLevel = compareFrames || std::any_of(cases.begin(), cases.end(), [](const BenchCase& bc) { return bc.needsLevel; });
+		if (wantLevel)
+		{
+			if (CreateHiddenGLWindow())
+			{
+				BootLevel();
+				gHaveLevel = true;
+			}
+			else
+			{
+				SDL_Log("Couldn't create an OpenGL context (%s); skipping cases that need a level", SDL_GetError());
+			}
+		}
+
+		for (const auto& bc : cases)
+		{
+			if (bc.needsLevel && !gHaveLevel)
+			{
+				skipped.push_back(bc.name);
+				continue;
+			}
+
+			BenchResult r = RunCase(bc);
+			fprintf(report, "%-44s %12.1f ns/op  (best %10.1f)  %8.3f allocs/op\n", r.name.c_str(), r.medianNsPerOp, r.bestNsPerOp, r.allocsPerOp);
+			fflush(report);
+			results.push_back(r);
+		}
+
+#if RENDER_VULKAN
+		if (compareFrames)
+		{
+			if (!gHaveLevel || !VkRender_IsActive())
+				throw std::runtime_error("--compare-frames needs a level and --vulkan with a working Vulkan device.");
+			if (!CompareFrames(compare))
+				throw std::runtime_error("Couldn't read back the Vulkan frame.");
+			haveCompare = true;
+
+			fprintf(report, "frame compare (%s, %dx%d): submit %.3f ms GL, %.3f ms Vulkan (GPU %.3f ms); pixel diff mean %.3f, max %d\n",
+					compare.deviceName.c_str(), compare.width, compare.height,
+					compare.glSubmitMs, compare.vulkanSubmitMs, compare.vulkanGpuMs, compare.meanDiff, compare.maxDiff);
+
+			if (maxFrameDiff >= 0 && compare.meanDiff > maxFrameDiff)
+			{
+				fprintf(stderr, "The Vulkan frame is too far from the GL frame (mean diff %.3f > %g).\n", compare.meanDiff, maxFrameDiff);
+				exitCode = 1;
+			}
+		}
+#endif
+
+		if (gHaveLevel)
+			CleanupLevel();
+	}
+	catch (Pomme::QuitRequest&)
+	{
+		fprintf(stderr, "The game asked to quit (fatal alert?) -- results are incomplete.\n");
+		exitCode = 1;
+	}
+	catch (std::exception& ex)
+	{
+		fprintf(stderr, "Error: %s\n", ex.what());
+		exitCode = 1;
+	}
+
+	if (!jsonPath.empty())
+	{
+		FILE* f = jsonPath == "-" ? stdout : fopen(jsonPath.c_str(), "w");
+		if (!f)
+		{
+			fprintf(stderr, "Couldn't write %s\n", jsonPath.c_str());
+			exitCode = 1;
+		}
+		else
+		{
+			WriteJSON(f, results, skipped, haveCompare ? &compare : nullptr);
+			if (f != stdout)
+				fclose(f);
+		}
+	}
+
+	Pomme::Shutdown();
+	if (gSDLWindow)
+		SDL_DestroyWindow(gSDLWindow);
+	SDL_Quit();
+
+	return exitCode;
+}
@@ -0,0 +1,266 @@
+#!/usr/bin/env python3
+
+"""
+Writes a procedurally generated Nanosaur terrain (.ter) file for scaling tests.
+
+The map uses the stock Level1 tileset (Level1.trt), so only the terrain file changes.
+Load it with:
+
+    Nanosaur --terrain-file path/to/stress.ter
+
+Layout written (all big-endian, same as the shipped Level1.ter):
+
+    header          40 bytes (see LoadTerrain in src/System/File.c)
+    texture layer   width*depth UInt16 (tile # into the .trt tileset)
+    heightmap layer width*depth UInt16 (heightmap tile #)
+    path layer      width*depth UInt16 (all 0 = no paths)
+    tile attributes NUM_TILE_ATTRIBS * TileAttribType (all 0 = nothing solid)
+    heightmap tiles 256 * 32*32 signed bytes
+    item list       SInt32 count + count * TerrainItemEntryType, sorted by x
+
+Heightmap tiles are bilinear ramps between 4 quantized corner heights (4^4 = 256 tiles),
+so neighbouring map tiles always agree along their shared edges.
+"""
+
+import argparse
+import math
+import random
+import struct
+import sys
+
+#----------------------------------------------------------------
+# Constants mirrored from src/Headers/terrain.h and Terrain2.c
+
+SUPERTILE_SIZE          = 5
+OREOMAP_TILE_SIZE       = 32        # map pixels per tile (item coords are in map pixels)
+TERRAIN_HMTILE_SIZE     = 32
+MAX_TERRAIN_TILES       = (300*3)+1
+NUM_TILE_ATTRIBS        = MAX_TERRAIN_TILES
+MAX_ITEM_COORD          = 0xFFFF    # TerrainItemEntryType.x/y are UInt16
+
+HEIGHT_LEVELS           = 4
+HEIGHT_STEP             = 30        # heightmap pixel units per level (x HEIGHT_EXTRUDE_FACTOR in game)
+
+MAP_ITEM = {
+    "start":    0,
+    "powerup":  1,
+    "tricer":   2,
+    "rex":      3,
+    "ptera":    7,
+    "stego":    8,
+    "tree":     10,
+    "boulder":  11,
+    "mushroom": 12,
+    "bush":     13,
+    "crystal":  15,
+    "spitter":  16,
+}
+
+ENEMY_KINDS = ["tricer", "rex", "ptera", "stego", "spitter"]
+PROP_KINDS  = ["tree", "boulder", "mushroom", "bush"]
+
+#----------------------------------------------------------------
+
+def parse_mix(text, allowed):
+    mix = {}
+    for entry in text.split(","):
+        if not entry:
+            continue
+        name, _, weight = entry.partition(":")
+        if name not in allowed:
+            raise argparse.ArgumentTypeError(f"unknown kind '{name}' (expected one of {', '.join(allowed)})")
+        mix[name] = float(weight) if weight else 1.0
+    return mix
+
+def pick(rng, mix):
+    total = sum(mix.values())
+    r = rng.uniform(0, total)
+    for name, weight in mix.items():
+        r -= weight
+        if r <= 0:
+            return name
+    return next(iter(mix))
+
+def poisson(rng, mean):
+    # Knuth; means here are small
+    limit = math.exp(-mean)
+    k, p = 0, 1.0
+    while True:
+        p *= rng.random()
+        if p <= limit:
+            return k
+        k += 1
+
+#----------------------------------------------------------------
+
+def make_height_field(rng, width, depth, feature_size):
+    """ Value noise on the (width+1) x (depth+1) tile corner grid, quantized to HEIGHT_LEVELS. """
+
+    gw = width // feature_size + 2
+    gd = depth // feature_size + 2
+    lattice = [[rng.random() for _ in range(gw)] for _ in range(gd)]
+
+    def smooth(t):
+        return t * t * (3 - 2 * t)
+
+    corners = []
+    for row in range(depth + 1):
+        fy = row / feature_size
+        iy = int(fy)
+        ty = smooth(fy - iy)
+        line = bytearray(width + 1)
+        for col in range(width + 1):
+            fx = col / feature_size
+            ix = int(fx)
+            tx = smooth(fx - ix)
+            a = lattice[iy][ix]     * (1 - tx) + lattice[iy][ix + 1]     * tx
+            b = lattice[iy + 1][ix] * (1 - tx) + lattice[iy + 1][ix + 1] * tx
+            v = a * (1 - ty) + b * ty
+            line[col] = min(HEIGHT_LEVELS - 1, int(v * HEIGHT_LEVELS))
+        corners.append(line)
+    return corners
+
+def make_heightmap_tiles():
+    """ Tile # = tl + 4*tr + 16*bl + 64*br.  Pixel (x,y) is the bilinear blend at (x/32, y/32). """
+
+    tiles = bytearray()
+    n = HEIGHT_LEVELS
+    for tile in range(n ** 4):
+        tl = (tile           % n) * HEIGHT_STEP
+        tr = (tile // n      % n) * HEIGHT_STEP
+        bl = (tile // (n*n)  % n) * HEIGHT_STEP
+        br = (tile // (n*n*n)% n) * HEIGHT_STEP
+        for y in range(TERRAIN_HMTILE_SIZE):
+            ty = y / TERRAIN_HMTILE_SIZE
+            for x in range(TERRAIN_HMTILE_SIZE):
+                tx = x / TERRAIN_HMTILE_SIZE
+                h = (tl * (1 - tx) * (1 - ty) + tr * tx * (1 - ty)
+                     + bl * (1 - tx) * ty + br * tx * ty)
+                tiles += struct.pack(">b", int(round(h)))
+    return bytes(tiles)
+
+#----------------------------------------------------------------
+
+def make_items(rng, args):
+    items = []
+
+    def add(kind, tile_x, tile_z, parm0=0):
+        x = int(tile_x * OREOMAP_TILE_SIZE)
+        y = int(tile_z * OREOMAP_TILE_SIZE)
+        if x > MAX_ITEM_COORD or y > MAX_ITEM_COORD:
+            return False
+        items.append((x, y, MAP_ITEM[kind], parm0))
+        return True
+
+    add("start", args.width / 2, args.depth / 2, 0)
+
+    dropped = 0
+    for super_row in range(args.depth // SUPERTILE_SIZE):
+        for super_col in range(args.width // SUPERTILE_SIZE):
+            def spot():
+                return (super_col * SUPERTILE_SIZE + rng.uniform(.5, SUPERTILE_SIZE - .5),
+                        super_row * SUPERTILE_SIZE + rng.uniform(.5, SUPERTILE_SIZE - .5))
+
+            for _ in range(poisson(rng, args.props)):
+                dropped += not add(pick(rng, args.prop_mix), *spot(), rng.randrange(6))
+            for _ in range(poisson(rng, args.enemies)):
+                dropped += not add(pick(rng, args.enemy_mix), *spot())
+            for _ in range(poisson(rng, args.powerups)):
+                dropped += not add("powerup", *spot(), rng.randrange(5))
+
+    if dropped:
+        print(f"warning: {dropped} items fell past the UInt16 item coordinate limit "
+              f"({MAX_ITEM_COORD // OREOMAP_TILE_SIZE} tiles) and were skipped", file=sys.stderr)
+
+    items.sort(key=lambda item: (item[0], item[1]))     # BuildTerrainItemList needs them sorted by column
+    return items
+
+#----------------------------------------------------------------
+
+def write_terrain(path, args):
+    rng = random.Random(args.seed)
+
+    width, depth = args.width, args.depth
+    corners = make_height_field(rng, width, depth, args.feature_size)
+    texture_tiles = args.texture_tiles
+
+    texture_layer = bytearray()
+    heightmap_layer = bytearray()
+    for row in range(depth):
+        for col in range(width):
+            tl = corners[row][col]
+            tr = corners[row][col + 1]
+            bl = corners[row + 1][col]
+            br = corners[row + 1][col + 1]
+            heightmap_layer += struct.pack(">H", tl + HEIGHT_LEVELS * (tr + HEIGHT_LEVELS * (bl + HEIGHT_LEVELS * br)))
+            level = max(tl, tr, bl, br)
+            texture_layer += struct.pack(">H", texture_tiles[level * len(texture_tiles) // HEIGHT_LEVELS])
+    path_layer = bytes(width * depth * 2)
+
+    tile_attribs = bytes(NUM_TILE_ATTRIBS * struct.calcsize(">Hhbbh"))
+    heightmap_tiles = make_heightmap_tiles()
+
+    items = make_items(rng, args)
+    item_list = bytearray(struct.pack(">l", len(items)))
+    for x, y, kind, parm0 in items:
+        item_list += struct.pack(">HHH4BHll", x, y, kind, parm0, 0, 0, 0, 0, 0, 0)
+
+            # lay out sections
+
+    header_size = 40
+    texture_at      = header_size
+    heightmap_at    = texture_at + len(texture_layer)
+    path_at         = heightmap_at + len(heightmap_layer)
+    attribs_at      = path_at + len(path_layer)
+    anims_at        = attribs_at + len(tile_attribs)
+    hm_tiles_at     = anims_at
+    items_at        = hm_tiles_at + len(heightmap_tiles)
+
+    header = struct.pack(">lllllllhhll",
+                         texture_at, heightmap_at, path_at, items_at, 0, hm_tiles_at, 0,
+                         width, depth, attribs_at, anims_at)
+    assert len(header) == header_size
+
+    with open(path, "wb") as f:
+        for chunk in (header, texture_layer, heightmap_layer, path_layer, tile_attribs, heightmap_tiles, item_list):
+            f.write(chunk)
+
+    counts = {}
+    for _, _, kind, _ in items:
+        counts[kind] = counts.get(kind, 0) + 1
+    names = {v: k for k, v in MAP_ITEM.items()}
+    summary = ", ".join(f"{counts[k]} {names[k]}" for k in sorted(counts))
+    print(f"{path}: {width}x{depth} tiles, {len(items)} items ({summary})")
+
+#----------------------------------------------------------------
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate a stress-test Nanosaur terrain file.")
+    parser.add_argument("output", help="path of the .ter file to write")
+    parser.add_argument("--width", type=int, default=400, help="map width in tiles (multiple of 5)")
+    parser.add_argument("--depth", type=int, default=400, help="map depth in tiles (multiple of 5)")
+    parser.add_argument("--seed", type=int, default=1, help="random seed (same seed = same file)")
+    parser.add_argument("--feature-size", type=int, default=24, help="tiles between height noise lattice points")
+    parser.add_argument("--props", type=float, default=2.0, help="mean # trees/bushes/etc. per supertile")
+    parser.add_argument("--enemies", type=float, default=.15, help="mean # enemies per supertile")
+    parser.add_argument("--powerups", type=float, default=.05, help="mean # powerups per supertile")
+    parser.add_argument("--enemy-mix", type=lambda s: parse_mix(s, ENEMY_KINDS),
+                        default="tricer:3,rex:1,ptera:2,stego:2,spitter:1",
+                        help="comma-separated kind:weight list of " + ", ".join(ENEMY_KINDS))
+    parser.add_argument("--prop-mix", type=lambda s: parse_mix(s, PROP_KINDS),
+                        default="tree:4,bush:3,mushroom:2,boulder:1",
+                        help="comma-separated kind:weight list of " + ", ".join(PROP_KINDS))
+    parser.add_argument("--texture-tiles", type=lambda s: [int(t) for t in s.split(",")],
+                        default="1,2,3,4",
+                        help="Level1.trt tile #'s to use from lowest to highest ground")
+    args = parser.parse_args()
+
+    if args.width <= 0 or args.depth <= 0 or args.width % SUPERTILE_SIZE or args.depth % SUPERTILE_SIZE:
+        parser.error("width and depth must be positive multiples of 5")
+    if args.width > 32767 or args.depth > 32767:
+        parser.error("width and depth are stored as shorts in the header")
+
+    write_terrain(args.output, args)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+
+"""
+Reads live metrics from a running Nanosaur started with --metrics-socket.
+
+    Nanosaur --metrics-socket /tmp/nanosaur.sock &
+    tools/metrics_reader.py /tmp/nanosaur.sock            # one table per second
+    tools/metrics_reader.py /tmp/nanosaur.sock --once     # print one snapshot and quit
+    tools/metrics_reader.py /tmp/nanosaur.sock --raw      # pass the Prometheus text through
+
+The game sends a snapshot every second in the Prometheus text format, ending with "# EOF"
+(see src/System/Metrics.c). --raw output can be fed to a node_exporter textfile collector.
+"""
+
+import argparse
+import socket
+import sys
+import time
+
+#----------------------------------------------------------------
+
+def read_snapshots(path):
+    """ Yields the text of each snapshot, without the "# EOF" line. """
+
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    sock.connect(path)
+    pending = b""
+    try:
+        while True:
+            chunk = sock.recv(65536)
+            if not chunk:
+                return
+            pending += chunk
+            while b"# EOF\n" in pending:
+                snapshot, _, pending = pending.partition(b"# EOF\n")
+                yield snapshot.decode("utf-8")
+    finally:
+        sock.close()
+
+def parse_snapshot(text):
+    """ Returns [(name, value)], with histograms summarized as mean & count. """
+
+    rows = []
+    sums, counts = {}, {}
+    for line in text.splitlines():
+        if not line or line.startswith("#"):
+            continue
+        name, _, value = line.rpartition(" ")
+        if "_bucket{" in name:
+            continue
+        if name.endswith("_sum"):
+            sums[name[:-4]] = float(value)
+        elif name.endswith("_count"):
+            counts[name[:-6]] = float(value)
+        else:
+            rows.append((name, float(value)))
+    for base, count in counts.items():
+        rows.append((base + " (mean)", sums.get(base, 0) / count if count else 0))
+        rows.append((base + " (count)", count))
+    return rows
+
+def histogram_percentile(text, name, fraction):
+    """ Upper bound of the bucket holding the given fraction of observations. """
+
+    buckets = []
+    for line in text.splitlines():
+        if line.startswith(name + "_bucket{le=\""):
+            bound = line.split("\"")[1]
+            buckets.append((float("inf") if bound == "+Inf" else float(bound), float(line.rpartition(" ")[2])))
+    if not buckets or buckets[-1][1] == 0:
+        return None
+    target = buckets[-1][1] * fraction
+    for bound, cumulative in buckets:
+        if cumulative >= target:
+            return bound
+    return None
+
+#----------------------------------------------------------------
+
+def main():
+    parser = argparse.ArgumentParser(description="Print live metrics from a running Nanosaur.")
+    parser.add_argument("socket", help="path given to Nanosaur --metrics-socket")
+    parser.add_argument("--once", action="store_true", help="print one snapshot and quit")
+    parser.add_argument("--raw", action="store_true", help="print the Prometheus text as received")
+    parser.add_argument("--filter", default="", help="only show metrics whose name contains this")
+    args = parser.parse_args()
+
+    try:
+        for text in read_snapshots(args.socket):
+            if args.raw:
+                sys.stdout.write(text + "# EOF\n")
+            else:
+                print(time.strftime("%H:%M:%S"))
+                for name, value in parse_snapshot(text):
+                    if args.filter in name:
+                        print(f"  {name:44} {value:14.2f}")
+                for histogram in ("nanosaur_frame_ms", "nanosaur_input_latency_ms", "nanosaur_input_event_latency_ms", "nanosaur_terrain_jump_ms"):
+                    p99 = histogram_percentile(text, histogram, .99)
+                    if p99 is not None and args.filter in histogram:
+                        print(f"  {histogram + ' (p99 bucket)':44} {p99:14.2f}")
+                print()
+            sys.stdout.flush()
+            if args.once:
+                break
+    except (ConnectionRefusedError, FileNotFoundError) as e:
+        sys.exit(f"can't connect to {args.socket}: {e}")
+    except KeyboardInterrupt:
+        pass
+
+if __name__ == "__main__":
+    main()